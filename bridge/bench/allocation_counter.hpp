@@ -0,0 +1,29 @@
+/**
+ * allocation_counter.hpp — Heap allocations on a measured path
+ *
+ * Linking allocation_counter.cpp replaces global operator new/delete for
+ * the whole binary (focus_bridge_bench and focus_bridge_tests both do).
+ * Counting covers every thread but is only switched on between
+ * start_counting_allocations() and stop_counting_allocations(), so the
+ * rest of the run pays one relaxed load per allocation.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace focus_wizard {
+namespace bench {
+
+/**
+ * Reset the count to zero and start counting.
+ */
+void start_counting_allocations();
+
+/**
+ * Stop counting; returns the allocations since the matching start.
+ */
+uint64_t stop_counting_allocations();
+
+} // namespace bench
+} // namespace focus_wizard
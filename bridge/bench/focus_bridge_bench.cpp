@@ -0,0 +1,543 @@
+/**
+ * focus_bridge_bench.cpp — Offline replay benchmark for the bridge pipeline
+ *
+ * Replays a recorded session log (see session_log.hpp) through the
+ * publish_* functions (publish.hpp) the live callbacks call, in the same
+ * order, as fast as possible, and reports:
+ *
+ *   - per-stage latency (p50 / p99 / p999 / max, nanoseconds)
+ *   - messages emitted per second
+ *   - heap allocations per frame on the measured path
+ *   - encoded bytes per edge frame (what the SDK serializes and the
+ *     bridge decodes; dominated by the landmark set)
+ *
+ * Protobuf decoding happens once up front and is reported separately; the
+ * SDK hands the callbacks already-parsed messages, so it isn't part of the
+ * bridge's own per-frame cost. Emitted messages go to /dev/null.
+ *
+ * Without --session a synthetic session is generated, so the benchmark can
+ * run in CI without a camera or recorded data. --landmarks picks the gaze
+ * landmark set (see LandmarkMode): the synthetic session carries the dense
+ * mesh or the sparse keypoints to match, so running both shows what the
+ * dense mesh costs per frame. --emit and --history switch on the stages
+ * those bridge flags add. The frame-feature stage works on camera pixels,
+ * which a session log doesn't have, so it isn't replayed.
+ *
+ * Usage:
+ *   ./focus_bridge_bench --session=session.fwsl --passes=10
+ *   ./focus_bridge_bench --synthetic_frames=9000 --report_format=json
+ *   ./focus_bridge_bench --landmarks=sparse
+ */
+
+// ── Standard Library ─────────────────────────────────────
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+// ── Third-party ──────────────────────────────────────────
+#include <absl/flags/flag.h>
+#include <absl/flags/parse.h>
+#include <absl/flags/usage.h>
+#include <physiology/modules/messages/metrics.h>
+
+// ── Focus Wizard ─────────────────────────────────────────
+#include "allocation_counter.hpp"
+#include "focus_analyzer.hpp"
+#include "focus_history.hpp"
+#include "focus_summary.hpp"
+#include "json_emitter.hpp"
+#include "json_writer.hpp"
+#include "latency_histogram.hpp"
+#include "metrics_collector.hpp"
+#include "publish.hpp"
+#include "session_log.hpp"
+
+// ── Command-line Flags ───────────────────────────────────
+ABSL_FLAG(std::string, session, "",
+    "Session log to replay. Empty = generate a synthetic session.");
+ABSL_FLAG(int, synthetic_frames, 3000,
+    "Edge frames in the synthetic session (30 fps, one core update per second).");
+ABSL_FLAG(int, passes, 5,
+    "Measured passes over the session.");
+ABSL_FLAG(int, warmup_passes, 1,
+    "Unmeasured passes first, so buffers reach their steady-state capacity.");
+ABSL_FLAG(std::string, output_format, "ndjson",
+    "Emitter wire format: 'ndjson' or 'binary'.");
+ABSL_FLAG(bool, async_output, true,
+    "Measure with the background writer, as the bridge runs by default.");
+ABSL_FLAG(std::string, emit, "full",
+    "Emit level, as the bridge's --emit: 'full', 'focus' or 'summary'.");
+ABSL_FLAG(float, summary_window_s, 10.0f,
+    "--emit=summary: seconds of recorded time per summary window.");
+ABSL_FLAG(bool, history, false,
+    "Fold every frame into a memory-only focus history, as the bridge's --history.");
+ABSL_FLAG(std::string, landmarks, "dense",
+    "Gaze landmark set: 'dense', 'sparse' or 'off'. Also selects the landmarks "
+    "the synthetic session carries.");
+ABSL_FLAG(std::string, report_format, "text",
+    "Report as 'text' (table) or 'json' (one object, for CI).");
+
+namespace {
+
+using focus_wizard::bench::LatencyHistogram;
+using Clock = std::chrono::steady_clock;
+
+uint64_t elapsed_ns(Clock::time_point from, Clock::time_point to) {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count());
+}
+
+// ── Replay Input ─────────────────────────────────────────
+
+struct ReplayEntry {
+    focus_wizard::SessionRecordKind kind;
+    int64_t timestamp_us;
+    size_t index;   // into Session::core or Session::edge
+};
+
+struct Session {
+    std::vector<ReplayEntry> entries;
+    std::vector<presage::physiology::MetricsBuffer> core;
+    std::vector<presage::physiology::Metrics> edge;
+    uint64_t edge_bytes = 0;    // encoded size of all edge records
+    int64_t duration_us = 0;
+};
+
+/**
+ * A face at the centre of a 640x480 frame whose nose drifts slowly left
+ * and right, blinking every ~3 s, with a core update (rates plus the
+ * second of pulse trace it covers) once per second.
+ * The face carries the 468-point mesh unless `landmark_mode` is SPARSE or
+ * OFF, which get the 6 sparse keypoints the SDK sends without it.
+ */
+void generate_synthetic_session(int frames, focus_wizard::LandmarkMode landmark_mode,
+                                std::string& out) {
+    constexpr int64_t kFramePeriodUs = 33333;
+    const bool dense = landmark_mode == focus_wizard::LandmarkMode::DENSE;
+    const int landmark_count = dense ? 468 : 6;
+
+    focus_wizard::append_session_header(out);
+    std::string payload;
+
+    for (int i = 0; i < frames; ++i) {
+        int64_t ts = 1'000'000 + i * kFramePeriodUs;
+
+        presage::physiology::Metrics edge;
+        auto* face = edge.mutable_face();
+        face->add_blinking()->set_detected(i % 100 < 3);
+        face->add_talking()->set_detected(false);
+
+        auto* landmarks = face->add_landmarks();
+        for (int j = 0; j < landmark_count; ++j) {
+            auto* point = landmarks->add_value();
+            point->set_x(320.0f);
+            point->set_y(240.0f);
+        }
+        float drift = 40.0f * std::sin(static_cast<float>(i) / 90.0f);
+        if (dense) {
+            landmarks->mutable_value(4)->set_x(320.0f + drift);
+            landmarks->mutable_value(234)->set_x(220.0f);
+            landmarks->mutable_value(454)->set_x(420.0f);
+            landmarks->mutable_value(10)->set_y(120.0f);
+            landmarks->mutable_value(152)->set_y(360.0f);
+        } else {
+            landmarks->mutable_value(2)->set_x(320.0f + drift);   // nose tip
+            landmarks->mutable_value(4)->set_x(220.0f);           // ear tragions
+            landmarks->mutable_value(5)->set_x(420.0f);
+            landmarks->mutable_value(0)->set_y(200.0f);           // eyes
+            landmarks->mutable_value(1)->set_y(200.0f);
+            landmarks->mutable_value(3)->set_y(300.0f);           // mouth
+        }
+
+        payload.clear();
+        edge.SerializeToString(&payload);
+        focus_wizard::append_session_record(out, focus_wizard::SessionRecordKind::EDGE, ts,
+                                            payload.data(), static_cast<uint32_t>(payload.size()));
+
+        if (i % 30 == 29) {
+            presage::physiology::MetricsBuffer core;
+            auto* pulse = core.mutable_pulse()->add_rate();
+            pulse->set_value(72.0f + static_cast<float>(i % 7));
+            pulse->set_confidence(0.9f);
+            pulse->set_timestamp(ts);
+
+            // The second of pulse trace the batch covers, beating at 72 BPM
+            for (int k = 29; k >= 0; --k) {
+                int64_t sample_ts = ts - k * kFramePeriodUs;
+                auto* trace = core.mutable_pulse()->add_trace();
+                trace->set_timestamp(sample_ts);
+                trace->set_value(std::sin(static_cast<float>(sample_ts) * 1.2e-6f * 6.2831853f));
+            }
+            auto* breathing = core.mutable_breathing()->add_rate();
+            breathing->set_value(14.0f + static_cast<float>(i % 3));
+            breathing->set_confidence(0.8f);
+
+            payload.clear();
+            core.SerializeToString(&payload);
+            focus_wizard::append_session_record(out, focus_wizard::SessionRecordKind::CORE, ts,
+                                                payload.data(), static_cast<uint32_t>(payload.size()));
+        }
+    }
+}
+
+bool load_session(focus_wizard::SessionLogView view, Session* session,
+                  LatencyHistogram* decode, std::string* error) {
+    focus_wizard::SessionRecord record;
+    int64_t first_ts = 0;
+    int64_t last_ts = 0;
+
+    while (view.next(&record)) {
+        auto start = Clock::now();
+        bool parsed;
+        size_t index;
+        if (record.kind == focus_wizard::SessionRecordKind::CORE) {
+            index = session->core.size();
+            parsed = session->core.emplace_back().ParseFromArray(
+                record.data, static_cast<int>(record.size));
+        } else {
+            index = session->edge.size();
+            parsed = session->edge.emplace_back().ParseFromArray(
+                record.data, static_cast<int>(record.size));
+            session->edge_bytes += record.size;
+        }
+        decode->record(elapsed_ns(start, Clock::now()));
+
+        if (!parsed) {
+            *error = "record " + std::to_string(session->entries.size()) + " failed to parse";
+            return false;
+        }
+
+        if (session->entries.empty()) first_ts = record.timestamp_us;
+        last_ts = record.timestamp_us;
+        session->entries.push_back({record.kind, record.timestamp_us, index});
+    }
+
+    if (view.truncated()) {
+        std::fprintf(stderr, "warning: session log is truncated; replaying %zu complete records\n",
+                     session->entries.size());
+    }
+    if (session->edge.empty()) {
+        *error = "session has no edge frames";
+        return false;
+    }
+
+    // One extra frame period so consecutive passes don't share a timestamp
+    int64_t frame_period = session->edge.size() > 1
+        ? (last_ts - first_ts) / static_cast<int64_t>(session->edge.size() - 1)
+        : 33333;
+    session->duration_us = last_ts - first_ts + std::max<int64_t>(frame_period, 1);
+    return true;
+}
+
+// ── Measured Pipeline ────────────────────────────────────
+// The live callbacks' sequence (main.cpp): the same publish_* calls, in
+// the same order, with a clock read between them.
+
+struct StageStats {
+    LatencyHistogram core;       // publish_core: collector fold + metrics message
+    LatencyHistogram edge;       // publish_edge: collector fold + edge message
+    LatencyHistogram focus;      // publish_focus: analyzer + focus / state_changed
+    LatencyHistogram history;    // FocusHistory::add (--history)
+    LatencyHistogram summary;    // publish_summary (--emit=summary)
+    LatencyHistogram frame;      // whole edge callback
+    uint64_t edge_frames = 0;
+};
+
+class ReplayPipeline {
+public:
+    ReplayPipeline(focus_wizard::JsonEmitter& emitter,
+                   focus_wizard::MetricsCollector& collector,
+                   focus_wizard::FocusAnalyzer& analyzer,
+                   focus_wizard::FocusHistory* history,
+                   focus_wizard::FocusSummary* summary)
+        : emitter_(emitter)
+        , collector_(collector)
+        , analyzer_(analyzer)
+        , history_(history)
+        , summary_(summary)
+    {
+    }
+
+    void core(const presage::physiology::MetricsBuffer& metrics, int64_t ts, StageStats& stats) {
+        auto t0 = Clock::now();
+        focus_wizard::publish_core(emitter_, collector_, metrics, ts);
+        stats.core.record(elapsed_ns(t0, Clock::now()));
+    }
+
+    void edge(const presage::physiology::Metrics& metrics, int64_t ts, StageStats& stats) {
+        auto t0 = Clock::now();
+        focus_wizard::publish_edge(emitter_, collector_, metrics, ts);
+        auto t1 = Clock::now();
+        stats.edge.record(elapsed_ns(t0, t1));
+
+        focus_wizard::FocusMetrics snapshot = collector_.current();
+        focus_wizard::FocusResult result = focus_wizard::publish_focus(emitter_, analyzer_, snapshot);
+        auto t2 = Clock::now();
+        stats.focus.record(elapsed_ns(t1, t2));
+
+        // Recorded time, so buckets roll over as they would live
+        if (history_) {
+            history_->add(snapshot, result, ts);
+            auto t3 = Clock::now();
+            stats.history.record(elapsed_ns(t2, t3));
+            t2 = t3;
+        }
+        if (summary_) {
+            focus_wizard::publish_summary(emitter_, *summary_, snapshot, result);
+            stats.summary.record(elapsed_ns(t2, Clock::now()));
+        }
+
+        stats.frame.record(elapsed_ns(t0, Clock::now()));
+        ++stats.edge_frames;
+    }
+
+private:
+    focus_wizard::JsonEmitter& emitter_;
+    focus_wizard::MetricsCollector& collector_;
+    focus_wizard::FocusAnalyzer& analyzer_;
+    focus_wizard::FocusHistory* history_;
+    focus_wizard::FocusSummary* summary_;
+};
+
+void replay_pass(const Session& session, int64_t ts_offset,
+                 ReplayPipeline& pipeline, StageStats& stats) {
+    for (const ReplayEntry& entry : session.entries) {
+        int64_t ts = entry.timestamp_us + ts_offset;
+        if (entry.kind == focus_wizard::SessionRecordKind::CORE) {
+            pipeline.core(session.core[entry.index], ts, stats);
+        } else {
+            pipeline.edge(session.edge[entry.index], ts, stats);
+        }
+    }
+}
+
+// ── Reporting ────────────────────────────────────────────
+
+struct NamedHistogram {
+    const char* name;
+    const LatencyHistogram* histogram;
+};
+
+double edge_bytes_per_frame(const Session& session) {
+    return static_cast<double>(session.edge_bytes) / static_cast<double>(session.edge.size());
+}
+
+void print_text_report(const Session& session, int passes, const std::string& landmarks,
+                       const NamedHistogram* stages, size_t stage_count,
+                       double messages_per_sec, double allocs_per_frame, uint64_t dropped) {
+    std::printf("focus_bridge_bench: %zu edge + %zu core records x %d passes (%s landmarks)\n\n",
+                session.edge.size(), session.core.size(), passes, landmarks.c_str());
+    std::printf("%-10s %10s %9s %9s %9s %9s %9s\n",
+                "stage", "count", "mean", "p50", "p99", "p999", "max");
+    for (size_t i = 0; i < stage_count; ++i) {
+        const LatencyHistogram& h = *stages[i].histogram;
+        std::printf("%-10s %10llu %9.0f %9llu %9llu %9llu %9llu\n",
+                    stages[i].name,
+                    static_cast<unsigned long long>(h.count()),
+                    h.mean(),
+                    static_cast<unsigned long long>(h.percentile(0.50)),
+                    static_cast<unsigned long long>(h.percentile(0.99)),
+                    static_cast<unsigned long long>(h.percentile(0.999)),
+                    static_cast<unsigned long long>(h.max()));
+    }
+    std::printf("(latencies in ns)\n\n");
+    std::printf("messages/sec:      %.0f\n", messages_per_sec);
+    std::printf("allocations/frame: %.3f\n", allocs_per_frame);
+    std::printf("edge bytes/frame:  %.0f\n", edge_bytes_per_frame(session));
+    if (dropped) {
+        std::printf("dropped messages:  %llu\n", static_cast<unsigned long long>(dropped));
+    }
+}
+
+void print_json_report(const Session& session, int passes, const std::string& landmarks,
+                       const NamedHistogram* stages, size_t stage_count,
+                       double messages_per_sec, double allocs_per_frame, uint64_t dropped) {
+    std::string out;
+    focus_wizard::JsonWriter writer(out);
+    writer.begin_object();
+    writer.field("edge_records", static_cast<int64_t>(session.edge.size()));
+    writer.field("core_records", static_cast<int64_t>(session.core.size()));
+    writer.field("passes", static_cast<int64_t>(passes));
+    writer.string_field("landmarks", landmarks);
+
+    std::string stage_json;
+    focus_wizard::JsonWriter stage_writer(stage_json);
+    stage_writer.begin_object();
+    for (size_t i = 0; i < stage_count; ++i) {
+        const LatencyHistogram& h = *stages[i].histogram;
+        std::string one;
+        focus_wizard::JsonWriter w(one);
+        w.begin_object();
+        w.field("count", static_cast<int64_t>(h.count()));
+        w.field("mean_ns", static_cast<float>(h.mean()), 1);
+        w.field("p50_ns", static_cast<int64_t>(h.percentile(0.50)));
+        w.field("p99_ns", static_cast<int64_t>(h.percentile(0.99)));
+        w.field("p999_ns", static_cast<int64_t>(h.percentile(0.999)));
+        w.field("max_ns", static_cast<int64_t>(h.max()));
+        w.end_object();
+        stage_writer.raw_field(stages[i].name, one);
+    }
+    stage_writer.end_object();
+
+    writer.raw_field("stages", stage_json);
+    writer.field("messages_per_sec", static_cast<float>(messages_per_sec), 0);
+    writer.field("allocations_per_frame", static_cast<float>(allocs_per_frame), 3);
+    writer.field("edge_bytes_per_frame", static_cast<float>(edge_bytes_per_frame(session)), 0);
+    writer.field("dropped_messages", static_cast<int64_t>(dropped));
+    writer.end_object();
+    std::printf("%s\n", out.c_str());
+}
+
+} // namespace
+
+// ── Main ─────────────────────────────────────────────────
+int main(int argc, char** argv) {
+    absl::SetProgramUsageMessage(
+        "Replays a recorded (or synthetic) session through the bridge pipeline "
+        "and reports per-stage latency, throughput and allocations.\n\n"
+        "focus_bridge_bench --session=session.fwsl --passes=10");
+    absl::ParseCommandLine(argc, argv);
+
+    focus_wizard::LandmarkMode landmark_mode;
+    const std::string landmarks = absl::GetFlag(FLAGS_landmarks);
+    if (!focus_wizard::parse_landmark_mode(landmarks, &landmark_mode)) {
+        std::fprintf(stderr, "error: unknown --landmarks '%s'\n", landmarks.c_str());
+        return 1;
+    }
+
+    // ── Load Session ─────────────────────────────────────
+    std::string synthetic;
+    focus_wizard::MappedSessionLog mapped;
+    focus_wizard::SessionLogView view;
+    std::string error;
+
+    if (absl::GetFlag(FLAGS_session).empty()) {
+        generate_synthetic_session(std::max(1, absl::GetFlag(FLAGS_synthetic_frames)),
+                                   landmark_mode, synthetic);
+        view = focus_wizard::SessionLogView(reinterpret_cast<const uint8_t*>(synthetic.data()),
+                                            synthetic.size());
+    } else {
+        if (!mapped.open(absl::GetFlag(FLAGS_session), &error)) {
+            std::fprintf(stderr, "error: %s\n", error.c_str());
+            return 1;
+        }
+        view = mapped.view();
+    }
+
+    Session session;
+    LatencyHistogram decode;
+    if (!load_session(view, &session, &decode, &error)) {
+        std::fprintf(stderr, "error: %s\n", error.c_str());
+        return 1;
+    }
+
+    // ── Build Pipeline ───────────────────────────────────
+    focus_wizard::OutputFormat format;
+    if (!focus_wizard::parse_output_format(absl::GetFlag(FLAGS_output_format), &format)) {
+        std::fprintf(stderr, "error: unknown --output_format '%s'\n",
+                     absl::GetFlag(FLAGS_output_format).c_str());
+        return 1;
+    }
+
+    int null_fd = ::open("/dev/null", O_WRONLY | O_CLOEXEC);
+    if (null_fd < 0) {
+        std::perror("open /dev/null");
+        return 1;
+    }
+
+    focus_wizard::EmitLevel emit_level;
+    if (!focus_wizard::parse_emit_level(absl::GetFlag(FLAGS_emit), &emit_level)) {
+        std::fprintf(stderr, "error: unknown --emit '%s'\n", absl::GetFlag(FLAGS_emit).c_str());
+        return 1;
+    }
+
+    focus_wizard::JsonEmitter emitter;
+    emitter.configure(format, null_fd);
+    emitter.set_level(emit_level);
+    if (absl::GetFlag(FLAGS_async_output)) {
+        emitter.start_async_writer(focus_wizard::AsyncWriterOptions{});
+    }
+
+    focus_wizard::MetricsCollector collector({}, landmark_mode);
+    focus_wizard::FocusAnalyzer analyzer;
+
+    std::optional<focus_wizard::FocusHistory> history;
+    if (absl::GetFlag(FLAGS_history)) {
+        history.emplace();
+        if (!history->open(&error)) {
+            std::fprintf(stderr, "error: %s\n", error.c_str());
+            return 1;
+        }
+    }
+    std::optional<focus_wizard::FocusSummary> summary;
+    if (emit_level == focus_wizard::EmitLevel::SUMMARY) {
+        focus_wizard::FocusSummaryOptions summary_options;
+        summary_options.window_s = std::max(1.0f, absl::GetFlag(FLAGS_summary_window_s));
+        summary.emplace(summary_options);
+    }
+    ReplayPipeline pipeline(emitter, collector, analyzer,
+                            history ? &*history : nullptr, summary ? &*summary : nullptr);
+
+    // ── Replay ───────────────────────────────────────────
+    int warmup = std::max(0, absl::GetFlag(FLAGS_warmup_passes));
+    int passes = std::max(1, absl::GetFlag(FLAGS_passes));
+    int64_t ts_offset = 0;
+
+    StageStats warmup_stats;
+    for (int i = 0; i < warmup; ++i) {
+        replay_pass(session, ts_offset, pipeline, warmup_stats);
+        ts_offset += session.duration_us;
+    }
+
+    StageStats stats;
+    uint64_t messages_before = emitter.messages_emitted();
+    focus_wizard::bench::start_counting_allocations();
+    auto start = Clock::now();
+    for (int i = 0; i < passes; ++i) {
+        replay_pass(session, ts_offset, pipeline, stats);
+        ts_offset += session.duration_us;
+    }
+    double elapsed_s = static_cast<double>(elapsed_ns(start, Clock::now())) / 1e9;
+    uint64_t allocations = focus_wizard::bench::stop_counting_allocations();
+    uint64_t messages = emitter.messages_emitted() - messages_before;
+    uint64_t dropped = emitter.dropped_messages();
+
+    emitter.stop_async_writer();
+    ::close(null_fd);
+
+    // ── Report ───────────────────────────────────────────
+    // Stages a flag left off are not listed
+    NamedHistogram stages[] = {
+        {"decode",    &decode},
+        {"core",      &stats.core},
+        {"edge",      &stats.edge},
+        {"focus",     &stats.focus},
+        {"history",   &stats.history},
+        {"summary",   &stats.summary},
+        {"frame",     &stats.frame},
+    };
+    size_t stage_count = 0;
+    for (const NamedHistogram& stage : stages) {
+        if (stage.histogram->count() > 0) stages[stage_count++] = stage;
+    }
+
+    double messages_per_sec = elapsed_s > 0 ? static_cast<double>(messages) / elapsed_s : 0.0;
+    double allocs_per_frame = stats.edge_frames
+        ? static_cast<double>(allocations) / static_cast<double>(stats.edge_frames)
+        : 0.0;
+
+    if (absl::GetFlag(FLAGS_report_format) == "json") {
+        print_json_report(session, passes, landmarks, stages, stage_count,
+                          messages_per_sec, allocs_per_frame, dropped);
+    } else {
+        print_text_report(session, passes, landmarks, stages, stage_count,
+                          messages_per_sec, allocs_per_frame, dropped);
+    }
+    return 0;
+}
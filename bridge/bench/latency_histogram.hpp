@@ -0,0 +1,84 @@
+/**
+ * latency_histogram.hpp — Fixed-size log-linear latency histogram
+ *
+ * Each power of two is split into 16 linear sub-buckets, so any recorded
+ * value is reported within ~6% of its true value. Buckets are a fixed
+ * array: record() never allocates, which matters because the benchmark
+ * counts allocations on the path it is measuring.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+namespace focus_wizard {
+namespace bench {
+
+class LatencyHistogram {
+public:
+    void record(uint64_t value_ns) {
+        ++buckets_[bucket_index(value_ns)];
+        ++count_;
+        sum_ += value_ns;
+        min_ = std::min(min_, value_ns);
+        max_ = std::max(max_, value_ns);
+    }
+
+    /**
+     * Smallest value v such that a fraction `q` of samples are <= v.
+     */
+    uint64_t percentile(double q) const {
+        if (count_ == 0) return 0;
+        uint64_t target = static_cast<uint64_t>(std::ceil(q * static_cast<double>(count_)));
+        target = std::max<uint64_t>(target, 1);
+
+        uint64_t seen = 0;
+        for (size_t i = 0; i < buckets_.size(); ++i) {
+            seen += buckets_[i];
+            if (seen >= target) {
+                return std::min(bucket_upper_bound(i), max_);
+            }
+        }
+        return max_;
+    }
+
+    uint64_t count() const { return count_; }
+    uint64_t min() const { return count_ ? min_ : 0; }
+    uint64_t max() const { return max_; }
+    double mean() const { return count_ ? static_cast<double>(sum_) / count_ : 0.0; }
+
+    void reset() { *this = LatencyHistogram(); }
+
+private:
+    static constexpr int kSubBits = 4;
+    static constexpr uint64_t kSubBuckets = uint64_t{1} << kSubBits;
+
+    static size_t bucket_index(uint64_t v) {
+        if (v < kSubBuckets) return static_cast<size_t>(v);
+        int msb = 63 - __builtin_clzll(v);
+        int shift = msb - kSubBits;
+        return (static_cast<size_t>(shift + 1) << kSubBits) +
+               static_cast<size_t>((v >> shift) & (kSubBuckets - 1));
+    }
+
+    static uint64_t bucket_upper_bound(size_t index) {
+        if (index < kSubBuckets) return index;
+        int shift = static_cast<int>(index >> kSubBits) - 1;
+        uint64_t sub = index & (kSubBuckets - 1);
+        uint64_t lower = (kSubBuckets + sub) << shift;
+        return lower + ((uint64_t{1} << shift) - 1);
+    }
+
+    std::array<uint64_t, 64 << kSubBits> buckets_{};
+    uint64_t count_ = 0;
+    uint64_t sum_ = 0;
+    uint64_t min_ = std::numeric_limits<uint64_t>::max();
+    uint64_t max_ = 0;
+};
+
+} // namespace bench
+} // namespace focus_wizard
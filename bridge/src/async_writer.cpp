@@ -0,0 +1,151 @@
+/**
+ * async_writer.cpp — Implementation
+ */
+
+#include "async_writer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <unistd.h>
+
+namespace focus_wizard {
+
+AsyncWriter::AsyncWriter(int fd, AsyncWriterOptions options)
+    : fd_(fd)
+    , options_(options)
+    , queue_(options.queue_capacity)
+{
+    // Keep 1/8 of the ring for messages that must not be dropped
+    droppable_limit_ = queue_.capacity() - std::max<size_t>(queue_.capacity() / 8, 1);
+
+    out_buffer_.reserve(options_.flush_bytes * 2);
+    thread_ = std::thread([this] { run(); });
+}
+
+AsyncWriter::~AsyncWriter() {
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        stopping_.store(true, std::memory_order_release);
+    }
+    wake_cv_.notify_one();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+bool AsyncWriter::submit(uint8_t kind, bool droppable, const char* data, size_t length) {
+    if (droppable && queue_.size_approx() >= droppable_limit_) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    bool queued = queue_.try_push([&](Message& message) {
+        message.kind = kind;
+        message.droppable = droppable;
+        message.bytes.assign(data, length);
+    });
+    if (!queued) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return queued;
+}
+
+void AsyncWriter::run() {
+    using clock = std::chrono::steady_clock;
+    // A zero interval would make the idle wait below return at once and spin
+    const auto interval = std::chrono::milliseconds(std::max(1, options_.flush_interval_ms));
+
+    // One slot per queue cell; strings are swapped with the cells so both
+    // sides keep their capacity and the steady state never allocates.
+    std::vector<Message> batch(queue_.capacity());
+    clock::time_point oldest_pending;
+
+    for (;;) {
+        bool stopping = stopping_.load(std::memory_order_acquire);
+        size_t count = 0;
+        while (count < batch.size() && queue_.try_pop([&](Message& message) {
+            batch[count].kind = message.kind;
+            batch[count].droppable = message.droppable;
+            std::swap(batch[count].bytes, message.bytes);
+        })) {
+            ++count;
+        }
+
+        if (count > 0) {
+            if (out_buffer_.empty()) {
+                oldest_pending = clock::now();
+            }
+            append_batch(batch, count);
+        }
+
+        if (!out_buffer_.empty() &&
+            (stopping ||
+             out_buffer_.size() >= options_.flush_bytes ||
+             clock::now() - oldest_pending >= interval)) {
+            flush();
+        }
+
+        if (stopping && count == 0) {
+            break;
+        }
+
+        if (count == 0) {
+            auto timeout = interval;
+            if (!out_buffer_.empty()) {
+                auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    oldest_pending + interval - clock::now());
+                timeout = std::max(std::chrono::milliseconds(0), remaining);
+            }
+            std::unique_lock<std::mutex> lock(wake_mutex_);
+            wake_cv_.wait_for(lock, timeout, [this] {
+                return stopping_.load(std::memory_order_acquire);
+            });
+        }
+    }
+}
+
+void AsyncWriter::append_batch(std::vector<Message>& batch, size_t count) {
+    // Falling behind: keep only the newest droppable message of each kind
+    bool catching_up = count > queue_.capacity() / 2;
+    std::array<bool, 256> seen{};
+
+    for (size_t i = count; i-- > 0;) {
+        Message& message = batch[i];
+        if (catching_up && message.droppable) {
+            if (seen[message.kind]) {
+                message.bytes.clear();
+                merged_.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            seen[message.kind] = true;
+        }
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        out_buffer_ += batch[i].bytes;
+    }
+}
+
+void AsyncWriter::flush() {
+    const char* data = out_buffer_.data();
+    size_t length = out_buffer_.size();
+
+    while (length > 0 && !output_broken_) {
+        ssize_t written = ::write(fd_, data, length);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            // Reader went away (EPIPE etc.) — discard from now on
+            output_broken_ = true;
+            break;
+        }
+        data += written;
+        length -= static_cast<size_t>(written);
+        bytes_written_.fetch_add(static_cast<uint64_t>(written), std::memory_order_relaxed);
+    }
+
+    out_buffer_.clear();
+}
+
+} // namespace focus_wizard
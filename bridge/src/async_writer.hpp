@@ -0,0 +1,116 @@
+/**
+ * async_writer.hpp — Background writer thread for emitter output
+ *
+ * SmartSpectra callbacks hand finished messages to submit(), which only
+ * copies the bytes into a lock-free queue cell and returns. A dedicated
+ * thread drains the queue, coalesces messages into one buffer and writes
+ * it out when either flush_bytes have accumulated or flush_interval_ms
+ * has passed since the oldest unflushed message.
+ *
+ * Backpressure (a slow reader on the other end of the pipe):
+ *   - Droppable messages (edge, focus) are refused once the queue is
+ *     within a small reserve of full; the reserve keeps room for
+ *     status/error/metrics messages, which are never refused early.
+ *   - When the writer falls behind by more than half the queue, each
+ *     drained batch keeps only the newest message of every droppable
+ *     kind — older edge/focus snapshots are stale anyway.
+ * Both cases are counted and exposed via dropped() / merged().
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bounded_mpsc_queue.hpp"
+
+namespace focus_wizard {
+
+struct AsyncWriterOptions {
+    // Queue cells (rounded up to a power of two)
+    size_t queue_capacity = 1024;
+
+    // Upper bound on how long a message may sit in the coalescing buffer;
+    // also the idle poll period, so values below 1 are raised to 1
+    int flush_interval_ms = 5;
+
+    // Write as soon as this many bytes are buffered
+    size_t flush_bytes = 16 * 1024;
+};
+
+class AsyncWriter {
+public:
+    AsyncWriter(int fd, AsyncWriterOptions options);
+
+    /**
+     * Flushes everything still queued, then joins the writer thread.
+     */
+    ~AsyncWriter();
+
+    AsyncWriter(const AsyncWriter&) = delete;
+    AsyncWriter& operator=(const AsyncWriter&) = delete;
+
+    /**
+     * Queue one message. Never blocks.
+     * `kind` groups messages for merging; `droppable` marks messages that
+     * may be refused or merged under backpressure.
+     * Returns false if the message was dropped.
+     */
+    bool submit(uint8_t kind, bool droppable, const char* data, size_t length);
+
+    /**
+     * Messages refused because the queue was full.
+     */
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+    /**
+     * Stale droppable messages discarded while catching up.
+     */
+    uint64_t merged() const { return merged_.load(std::memory_order_relaxed); }
+
+    /**
+     * Bytes handed to write(2) so far.
+     */
+    uint64_t bytes_written() const { return bytes_written_.load(std::memory_order_relaxed); }
+
+    /**
+     * Current queue depth (approximate).
+     */
+    size_t queue_depth() const { return queue_.size_approx(); }
+
+private:
+    struct Message {
+        uint8_t kind = 0;
+        bool droppable = false;
+        std::string bytes;
+    };
+
+    void run();
+    void append_batch(std::vector<Message>& batch, size_t count);
+    void flush();
+
+    const int fd_;
+    const AsyncWriterOptions options_;
+
+    BoundedMpscQueue<Message> queue_;
+    size_t droppable_limit_ = 0;
+    std::string out_buffer_;
+    bool output_broken_ = false;
+
+    std::atomic<bool> stopping_{false};
+    std::mutex wake_mutex_;
+    std::condition_variable wake_cv_;
+
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> merged_{0};
+    std::atomic<uint64_t> bytes_written_{0};
+
+    std::thread thread_;
+};
+
+} // namespace focus_wizard
@@ -0,0 +1,169 @@
+/**
+ * binary_protocol.hpp — Length-prefixed binary records (--output_format=binary)
+ *
+ * An alternative to JSON Lines for high-rate consumers. Every record is a
+ * fixed 8-byte header followed by `length` payload bytes:
+ *
+ *   uint32 length    — payload size in bytes
+ *   uint8  type      — MessageType
+ *   uint8  version   — kBinaryProtocolVersion
+ *   uint16 track     — camera track (1..kMaxTracks); 0 = the process
+ *
+ * High-rate messages (edge, metrics, focus) carry a packed SnapshotRecord so
+ * the reader can decode them with fixed-offset loads. SnapshotRecord only
+ * grows at the end: readers take the fields they know from a record at
+ * least as long as their layout and ignore the rest. Low-rate messages
+ * (status, error, ready) carry the same `data` object as the NDJSON protocol,
+ * encoded as UTF-8 JSON.
+ *
+ * In --mode=net the client sends frames to the bridge with the same header
+ * (type FRAME, see FrameRecord).
+ *
+ * All integers and floats are in host byte order (little-endian on every
+ * platform the bridge ships for).
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#include "frame_trace.hpp"
+#include "metrics_collector.hpp"
+
+namespace focus_wizard {
+
+constexpr uint8_t kBinaryProtocolVersion = 1;
+
+// Camera tracks per process (see camera_host.hpp); the async writer
+// merges per type and track within one byte
+constexpr uint16_t kMaxTracks = 15;
+
+enum class MessageType : uint8_t {
+    STATUS  = 1,
+    READY   = 2,
+    EDGE    = 3,
+    METRICS = 4,
+    FOCUS   = 5,
+    ERROR   = 6,
+    FRAME   = 7,    // inbound only (--mode=net)
+    STATE_CHANGED = 8,
+    HISTORY = 9,
+    SUMMARY = 10,
+};
+
+/**
+ * Map an NDJSON message type name to its binary tag.
+ * Returns false for names the binary protocol doesn't know.
+ */
+inline bool message_type_from_string(std::string_view name, MessageType* out) {
+    if      (name == "status")  *out = MessageType::STATUS;
+    else if (name == "ready")   *out = MessageType::READY;
+    else if (name == "edge")    *out = MessageType::EDGE;
+    else if (name == "metrics") *out = MessageType::METRICS;
+    else if (name == "focus")   *out = MessageType::FOCUS;
+    else if (name == "error")   *out = MessageType::ERROR;
+    else if (name == "state_changed") *out = MessageType::STATE_CHANGED;
+    else if (name == "history") *out = MessageType::HISTORY;
+    else if (name == "summary") *out = MessageType::SUMMARY;
+    else return false;
+    return true;
+}
+
+// Bits in SnapshotRecord::flags
+enum SnapshotFlags : uint16_t {
+    SNAPSHOT_HAS_PULSE      = 1u << 0,
+    SNAPSHOT_HAS_BREATHING  = 1u << 1,
+    SNAPSHOT_FACE_DETECTED  = 1u << 2,
+    SNAPSHOT_IS_BLINKING    = 1u << 3,
+    SNAPSHOT_IS_TALKING     = 1u << 4,
+    SNAPSHOT_HAS_GAZE       = 1u << 5,
+};
+
+#pragma pack(push, 1)
+
+struct RecordHeader {
+    uint32_t length;
+    uint8_t  type;
+    uint8_t  version;
+    uint16_t track;
+};
+
+/**
+ * Packed FocusMetrics plus the derived focus state.
+ * `state` and `focus_score` are only meaningful on FOCUS records;
+ * `state` holds the FocusState enum value.
+ */
+struct SnapshotRecord {
+    int64_t  timestamp_us;
+    float    pulse_rate_bpm;
+    float    pulse_confidence;
+    float    breathing_rate_bpm;
+    float    breathing_confidence;
+    float    blink_rate_per_min;
+    float    gaze_x;
+    float    gaze_y;
+    float    focus_score;
+    uint16_t flags;
+    uint8_t  state;
+    uint8_t  reserved;
+    int64_t  capture_us;    // see frame_trace.hpp
+    int64_t  callback_us;
+    int64_t  emit_us;
+};
+
+/**
+ * Prefix of an inbound FRAME record; the pixel payload follows.
+ * `format` holds a FramePixelFormat value.
+ */
+struct FrameRecord {
+    int64_t  timestamp_us;
+    uint32_t width;
+    uint32_t height;
+    uint32_t stride;    // bytes per row (raw formats)
+    uint32_t format;
+};
+
+#pragma pack(pop)
+
+static_assert(sizeof(RecordHeader) == 8, "RecordHeader layout is part of the wire protocol");
+static_assert(sizeof(SnapshotRecord) == 68, "SnapshotRecord layout is part of the wire protocol");
+static_assert(sizeof(FrameRecord) == 24, "FrameRecord layout is part of the wire protocol");
+
+/**
+ * Pack a metrics snapshot (and optionally a focus result) into a record.
+ */
+inline SnapshotRecord make_snapshot_record(
+    const FocusMetrics& metrics,
+    uint8_t state = 0,
+    float focus_score = 0.0f
+) {
+    SnapshotRecord record;
+    std::memset(&record, 0, sizeof(record));
+    record.timestamp_us         = metrics.timestamp_us;
+    record.pulse_rate_bpm       = metrics.pulse_rate_bpm;
+    record.pulse_confidence     = metrics.pulse_confidence;
+    record.breathing_rate_bpm   = metrics.breathing_rate_bpm;
+    record.breathing_confidence = metrics.breathing_confidence;
+    record.blink_rate_per_min   = metrics.blink_rate_per_min;
+    record.gaze_x               = metrics.gaze_x;
+    record.gaze_y               = metrics.gaze_y;
+    record.focus_score          = focus_score;
+    record.state                = state;
+    record.capture_us           = metrics.capture_us;
+    record.callback_us          = metrics.callback_us;
+    record.emit_us              = wall_clock_us();
+
+    uint16_t flags = 0;
+    if (metrics.has_pulse)     flags |= SNAPSHOT_HAS_PULSE;
+    if (metrics.has_breathing) flags |= SNAPSHOT_HAS_BREATHING;
+    if (metrics.face_detected) flags |= SNAPSHOT_FACE_DETECTED;
+    if (metrics.is_blinking)   flags |= SNAPSHOT_IS_BLINKING;
+    if (metrics.is_talking)    flags |= SNAPSHOT_IS_TALKING;
+    if (metrics.has_gaze)      flags |= SNAPSHOT_HAS_GAZE;
+    record.flags = flags;
+    return record;
+}
+
+} // namespace focus_wizard
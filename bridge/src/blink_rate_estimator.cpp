@@ -0,0 +1,74 @@
+/**
+ * blink_rate_estimator.cpp — Implementation
+ */
+
+#include "blink_rate_estimator.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace focus_wizard {
+
+BlinkRateEstimator::BlinkRateEstimator(BlinkRateOptions options) {
+    float resolution_s = std::max(options.resolution_s, 0.001f);
+    float window_s = std::max(options.window_s, resolution_s);
+
+    size_t bucket_count = static_cast<size_t>(std::ceil(window_s / resolution_s));
+    buckets_.assign(bucket_count, 0);
+    resolution_us_ = static_cast<int64_t>(resolution_s * 1e6f);
+    per_minute_scale_ = 60.0f / (static_cast<float>(bucket_count) * resolution_s);
+}
+
+float BlinkRateEstimator::update(bool currently_blinking, int64_t timestamp_us) {
+    int64_t bucket = timestamp_us / resolution_us_;
+    if (!started_) {
+        head_bucket_ = bucket;
+        started_ = true;
+    }
+    advance_to(bucket);
+
+    // Detect rising edge (transition from not-blinking to blinking)
+    if (currently_blinking && !prev_blinking_) {
+        size_t slot = static_cast<size_t>(head_bucket_ % static_cast<int64_t>(buckets_.size()));
+        ++buckets_[slot];
+        ++window_count_;
+    }
+    prev_blinking_ = currently_blinking;
+
+    return rate();
+}
+
+float BlinkRateEstimator::rate() const {
+    return static_cast<float>(window_count_) * per_minute_scale_;
+}
+
+void BlinkRateEstimator::reset() {
+    std::fill(buckets_.begin(), buckets_.end(), 0);
+    head_bucket_ = 0;
+    started_ = false;
+    prev_blinking_ = false;
+    window_count_ = 0;
+}
+
+void BlinkRateEstimator::advance_to(int64_t bucket) {
+    if (bucket <= head_bucket_) return;
+
+    const int64_t size = static_cast<int64_t>(buckets_.size());
+    if (bucket - head_bucket_ >= size) {
+        // Jumped past the whole window — everything expired
+        std::fill(buckets_.begin(), buckets_.end(), 0);
+        window_count_ = 0;
+        head_bucket_ = bucket;
+        return;
+    }
+
+    // Evict the buckets that slid out of the window
+    while (head_bucket_ < bucket) {
+        ++head_bucket_;
+        size_t slot = static_cast<size_t>(head_bucket_ % size);
+        window_count_ -= buckets_[slot];
+        buckets_[slot] = 0;
+    }
+}
+
+} // namespace focus_wizard
@@ -0,0 +1,61 @@
+/**
+ * blink_rate_estimator.hpp — Sliding-window blink counter
+ *
+ * Counts blink onsets (not-blinking → blinking transitions) over a sliding
+ * window and reports them as blinks per minute. Time comes from the SDK
+ * frame timestamps, not the wall clock, so replaying a recorded session
+ * faster than real time gives the same numbers.
+ *
+ * The window is a fixed ring of `window / resolution` buckets allocated
+ * once at construction. Advancing time clears only the buckets that fell
+ * out of the window and a running total is kept, so each update is O(1)
+ * amortized and never allocates.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace focus_wizard {
+
+struct BlinkRateOptions {
+    // Length of the sliding window
+    float window_s = 60.0f;
+
+    // Bucket width; blinks are counted at this granularity
+    float resolution_s = 1.0f;
+};
+
+class BlinkRateEstimator {
+public:
+    explicit BlinkRateEstimator(BlinkRateOptions options = {});
+
+    /**
+     * Feed the current blink state for a frame and return blinks/min.
+     * Timestamps older than the newest one seen are counted in the
+     * newest bucket.
+     */
+    float update(bool currently_blinking, int64_t timestamp_us);
+
+    /**
+     * Blinks/min over the window as of the last update.
+     */
+    float rate() const;
+
+    void reset();
+
+private:
+    void advance_to(int64_t bucket);
+
+    std::vector<uint32_t> buckets_;
+    int64_t resolution_us_;
+    float per_minute_scale_;
+
+    int64_t head_bucket_ = 0;     // absolute index of the newest bucket
+    bool started_ = false;
+    bool prev_blinking_ = false;
+    uint32_t window_count_ = 0;
+};
+
+} // namespace focus_wizard
@@ -0,0 +1,120 @@
+/**
+ * bounded_mpsc_queue.hpp — Fixed-capacity lock-free multi-producer queue
+ *
+ * A bounded ring of cells, each guarded by its own sequence number
+ * (Dmitry Vyukov's bounded queue). Producers claim a cell with one CAS on
+ * the enqueue cursor and publish it with a release store; the single
+ * consumer never contends with them. Nothing is allocated after
+ * construction — cells are filled in place, so element types such as
+ * std::string keep their capacity from one lap of the ring to the next.
+ *
+ * try_push fails instead of waiting when the queue is full; callers decide
+ * whether to drop, retry, or merge.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace focus_wizard {
+
+template <typename T>
+class BoundedMpscQueue {
+public:
+    /**
+     * capacity is rounded up to the next power of two.
+     */
+    explicit BoundedMpscQueue(size_t capacity)
+        : mask_(round_up_pow2(capacity) - 1)
+        , cells_(new Cell[mask_ + 1])
+    {
+        for (size_t i = 0; i <= mask_; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    BoundedMpscQueue(const BoundedMpscQueue&) = delete;
+    BoundedMpscQueue& operator=(const BoundedMpscQueue&) = delete;
+
+    size_t capacity() const { return mask_ + 1; }
+
+    /**
+     * Approximate number of queued elements (exact when quiescent).
+     */
+    size_t size_approx() const {
+        size_t head = dequeue_pos_.load(std::memory_order_relaxed);
+        size_t tail = enqueue_pos_.load(std::memory_order_relaxed);
+        return tail >= head ? tail - head : 0;
+    }
+
+    /**
+     * Claim a free cell and let `fill(T&)` write into it in place.
+     * Returns false without calling `fill` when the queue is full.
+     */
+    template <typename Fill>
+    bool try_push(Fill&& fill) {
+        size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &cells_[pos & mask_];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueue_pos_.compare_exchange_weak(
+                        pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false; // full
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        fill(cell->value);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Pop the oldest element by letting `take(T&)` consume it in place.
+     * Single consumer only. Returns false when the queue is empty.
+     */
+    template <typename Take>
+    bool try_pop(Take&& take) {
+        size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        Cell* cell = &cells_[pos & mask_];
+        size_t seq = cell->sequence.load(std::memory_order_acquire);
+        if (static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1) < 0) {
+            return false; // empty
+        }
+        dequeue_pos_.store(pos + 1, std::memory_order_relaxed);
+        take(cell->value);
+        cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence{0};
+        T value;
+    };
+
+    static size_t round_up_pow2(size_t n) {
+        size_t p = 2;
+        while (p < n) p <<= 1;
+        return p;
+    }
+
+    const size_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+
+    // Separate cache lines so producers and the consumer don't false-share
+    alignas(64) std::atomic<size_t> enqueue_pos_{0};
+    alignas(64) std::atomic<size_t> dequeue_pos_{0};
+};
+
+} // namespace focus_wizard
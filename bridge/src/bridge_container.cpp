@@ -0,0 +1,140 @@
+/**
+ * bridge_container.cpp — Implementation
+ */
+
+#include "bridge_container.hpp"
+
+#include <smartspectra/container/foreground_container.hpp>
+
+namespace focus_wizard {
+
+namespace container = presage::smartspectra::container;
+
+using CpuContainer = container::CpuContinuousRestForegroundContainer;
+#if FOCUS_BRIDGE_WITH_GPU
+// Only exported by SDK builds with OpenGL support
+using GpuContainer = container::OpenGlContinuousRestForegroundContainer;
+#endif
+
+struct BridgeContainer::Impl {
+    std::unique_ptr<CpuContainer> cpu;
+#if FOCUS_BRIDGE_WITH_GPU
+    std::unique_ptr<GpuContainer> gpu;
+#endif
+};
+
+bool parse_backend(const std::string& name, Backend* out) {
+    if (name == "cpu") {
+        *out = Backend::CPU;
+        return true;
+    }
+    if (name == "gpu") {
+        *out = Backend::GPU;
+        return true;
+    }
+    return false;
+}
+
+const char* backend_to_string(Backend backend) {
+    switch (backend) {
+        case Backend::CPU: return "cpu";
+        case Backend::GPU: return "gpu";
+    }
+    return "cpu";
+}
+
+bool gpu_backend_compiled() {
+#if FOCUS_BRIDGE_WITH_GPU
+    return true;
+#else
+    return false;
+#endif
+}
+
+BridgeContainer::BridgeContainer(const BridgeSettings& settings, Backend requested)
+    : settings_(settings)
+    , requested_(requested)
+    , backend_(requested)
+    , impl_(std::make_unique<Impl>())
+{
+}
+
+BridgeContainer::~BridgeContainer() = default;
+
+absl::Status BridgeContainer::SetOnCoreMetricsOutput(CoreCallback callback) {
+    on_core_ = std::move(callback);
+    return absl::OkStatus();
+}
+
+absl::Status BridgeContainer::SetOnEdgeMetricsOutput(EdgeCallback callback) {
+    on_edge_ = std::move(callback);
+    return absl::OkStatus();
+}
+
+absl::Status BridgeContainer::SetOnVideoOutput(VideoCallback callback) {
+    on_video_ = std::move(callback);
+    return absl::OkStatus();
+}
+
+absl::Status BridgeContainer::SetOnStatusChange(StatusCallback callback) {
+    on_status_ = std::move(callback);
+    return absl::OkStatus();
+}
+
+absl::Status BridgeContainer::SetVideoSourceFactory(VideoSourceFactory factory) {
+    video_source_ = std::move(factory);
+    return absl::OkStatus();
+}
+
+template <typename Container>
+absl::Status BridgeContainer::build(std::unique_ptr<Container>& container) {
+    container = std::make_unique<Container>(settings_);
+
+    if (video_source_) {
+        if (auto status = container->SetVideoSource(video_source_()); !status.ok()) {
+            return status;
+        }
+    }
+    if (on_core_) {
+        if (auto status = container->SetOnCoreMetricsOutput(on_core_); !status.ok()) return status;
+    }
+    if (on_edge_) {
+        if (auto status = container->SetOnEdgeMetricsOutput(on_edge_); !status.ok()) return status;
+    }
+    if (on_video_) {
+        if (auto status = container->SetOnVideoOutput(on_video_); !status.ok()) return status;
+    }
+    if (on_status_) {
+        if (auto status = container->SetOnStatusChange(on_status_); !status.ok()) return status;
+    }
+    return container->Initialize();
+}
+
+absl::Status BridgeContainer::Initialize() {
+    if (requested_ == Backend::GPU) {
+#if FOCUS_BRIDGE_WITH_GPU
+        absl::Status status = build(impl_->gpu);
+        if (status.ok()) {
+            backend_ = Backend::GPU;
+            return status;
+        }
+        impl_->gpu.reset();
+        fallback_reason_ = "GPU backend failed to initialize: " + std::string(status.message());
+#else
+        fallback_reason_ = "GPU backend not compiled in (build with -DFOCUS_BRIDGE_GPU=ON)";
+#endif
+    }
+
+    backend_ = Backend::CPU;
+    return build(impl_->cpu);
+}
+
+absl::Status BridgeContainer::Run() {
+#if FOCUS_BRIDGE_WITH_GPU
+    if (impl_->gpu) return impl_->gpu->Run();
+#endif
+    if (impl_->cpu) return impl_->cpu->Run();
+    return absl::FailedPreconditionError("Run() before a successful Initialize()");
+}
+
+} // namespace focus_wizard
@@ -0,0 +1,123 @@
+/**
+ * bridge_container.hpp — SmartSpectra container with a CPU/GPU backend choice
+ *
+ * The SDK's containers are templates on the device type, so the CPU and
+ * GPU (OpenGL) graphs are different classes with the same interface.
+ * BridgeContainer hides which one runs: callers set the callbacks as on an
+ * SDK container, and Initialize() builds the container for the requested
+ * backend and wires them in.
+ *
+ * GPU falls back to CPU automatically when
+ *   - the binary was built without FOCUS_BRIDGE_GPU (no GPU container
+ *     compiled in), or
+ *   - the GPU container fails to initialize (no GPU, no driver, no EGL
+ *     display in the container, ...).
+ * fallback_reason() says why; backend() is what actually runs.
+ *
+ * Because a failed GPU attempt consumes the video source, it is passed as
+ * a factory that Initialize() calls once per attempt.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include <absl/status/status.h>
+#include <opencv2/core.hpp>
+#include <physiology/modules/messages/metrics.h>
+#include <physiology/modules/messages/status.h>
+#include <smartspectra/container/settings.hpp>
+#include <smartspectra/video_source/video_source.hpp>
+
+namespace focus_wizard {
+
+using BridgeSettings = presage::smartspectra::container::settings::Settings<
+    presage::smartspectra::container::settings::OperationMode::Continuous,
+    presage::smartspectra::container::settings::IntegrationMode::Rest>;
+
+enum class Backend {
+    CPU,
+    GPU,
+};
+
+/**
+ * Parse a --backend value ("cpu" or "gpu").
+ * Returns false if the name is not recognized.
+ */
+bool parse_backend(const std::string& name, Backend* out);
+
+const char* backend_to_string(Backend backend);
+
+/**
+ * Whether this binary was built with the GPU container (FOCUS_BRIDGE_GPU).
+ */
+bool gpu_backend_compiled();
+
+class BridgeContainer {
+public:
+    using CoreCallback =
+        std::function<absl::Status(const presage::physiology::MetricsBuffer&, int64_t)>;
+    using EdgeCallback =
+        std::function<absl::Status(const presage::physiology::Metrics&, int64_t)>;
+    using VideoCallback = std::function<absl::Status(cv::Mat&, int64_t)>;
+    using StatusCallback = std::function<absl::Status(presage::physiology::StatusValue)>;
+    using VideoSourceFactory =
+        std::function<std::unique_ptr<presage::smartspectra::video_source::VideoSource>()>;
+
+    BridgeContainer(const BridgeSettings& settings, Backend requested);
+    ~BridgeContainer();
+
+    BridgeContainer(const BridgeContainer&) = delete;
+    BridgeContainer& operator=(const BridgeContainer&) = delete;
+
+    // Same signatures as the SDK container's; the callbacks are stored and
+    // wired in by Initialize(), so set them all before it
+    absl::Status SetOnCoreMetricsOutput(CoreCallback callback);
+    absl::Status SetOnEdgeMetricsOutput(EdgeCallback callback);
+    absl::Status SetOnVideoOutput(VideoCallback callback);
+    absl::Status SetOnStatusChange(StatusCallback callback);
+
+    /**
+     * Frames come from the factory's sources instead of the settings'
+     * video_source (camera, file stream).
+     */
+    absl::Status SetVideoSourceFactory(VideoSourceFactory factory);
+
+    /**
+     * Build, wire and initialize the container, falling back to CPU if the
+     * GPU one can't be used. Errors are from the last backend tried.
+     */
+    absl::Status Initialize();
+
+    /**
+     * Blocks until cancelled or an error, like the SDK's Run().
+     */
+    absl::Status Run();
+
+    Backend backend() const { return backend_; }
+    const std::string& fallback_reason() const { return fallback_reason_; }
+
+private:
+    struct Impl;
+
+    template <typename Container>
+    absl::Status build(std::unique_ptr<Container>& container);
+
+    BridgeSettings settings_;
+    Backend requested_;
+    Backend backend_;
+    std::string fallback_reason_;
+
+    CoreCallback on_core_;
+    EdgeCallback on_edge_;
+    VideoCallback on_video_;
+    StatusCallback on_status_;
+    VideoSourceFactory video_source_;
+
+    std::unique_ptr<Impl> impl_;
+};
+
+} // namespace focus_wizard
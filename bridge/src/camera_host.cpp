@@ -0,0 +1,123 @@
+/**
+ * camera_host.cpp — Implementation
+ */
+
+#include "camera_host.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+
+#include <absl/strings/numbers.h>
+#include <absl/strings/str_split.h>
+
+#include "binary_protocol.hpp"
+
+namespace focus_wizard {
+
+// How often run() re-checks the shutdown flag
+static constexpr int kPollIntervalMs = 100;
+
+bool parse_camera_indices(const std::string& list, std::vector<int>* out, std::string* error) {
+    std::vector<int> devices;
+    for (absl::string_view part : absl::StrSplit(list, ',', absl::SkipWhitespace())) {
+        int device = -1;
+        if (!absl::SimpleAtoi(part, &device) || device < 0) {
+            *error = "'" + std::string(part) + "' is not a camera index";
+            return false;
+        }
+        if (std::find(devices.begin(), devices.end(), device) != devices.end()) {
+            *error = "camera " + std::to_string(device) + " is listed twice";
+            return false;
+        }
+        devices.push_back(device);
+    }
+    if (devices.empty()) {
+        *error = "no camera index given";
+        return false;
+    }
+    if (devices.size() > kMaxTracks) {
+        *error = "at most " + std::to_string(kMaxTracks) + " cameras";
+        return false;
+    }
+    *out = std::move(devices);
+    return true;
+}
+
+struct CameraHost::Track {
+    Track(uint16_t id, int device, const CameraHostOptions& options, JsonEmitter& log)
+        : id(id)
+        , device(device)
+        , pipeline(options, id,
+                   [&log, id](MessageType type, const char* data, size_t length) {
+                       log.forward(type, id, data, length);
+                   })
+    {
+    }
+
+    const uint16_t id;
+    const int device;
+
+    std::atomic<bool> finished{false};
+    std::thread thread;
+
+    TrackPipeline pipeline;
+};
+
+CameraHost::CameraHost(const BridgeSettings& settings, std::vector<int> devices,
+                       const CameraHostOptions& options, JsonEmitter& log)
+    : settings_(settings)
+    , options_(options)
+    , log_(log)
+{
+    for (size_t i = 0; i < devices.size(); ++i) {
+        tracks_.push_back(std::make_unique<Track>(static_cast<uint16_t>(i + 1), devices[i],
+                                                  options_, log_));
+    }
+}
+
+CameraHost::~CameraHost() {
+    join_all();
+}
+
+void CameraHost::run(const volatile std::sig_atomic_t* shutdown) {
+    shutdown_ = shutdown;
+    for (const auto& track : tracks_) {
+        Track* raw = track.get();
+        raw->thread = std::thread([this, raw] { run_track(*raw); });
+        log_.emit_status("Track " + std::to_string(raw->id) + " on camera " +
+                         std::to_string(raw->device));
+    }
+
+    auto all_finished = [this] {
+        return std::all_of(tracks_.begin(), tracks_.end(), [](const auto& track) {
+            return track->finished.load(std::memory_order_acquire);
+        });
+    };
+    while (!*shutdown && !all_finished()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(kPollIntervalMs));
+    }
+
+    // Each track's video callback sees the flag and cancels its Run()
+    join_all();
+}
+
+void CameraHost::join_all() {
+    for (const auto& track : tracks_) {
+        if (track->thread.joinable()) {
+            track->thread.join();
+        }
+    }
+}
+
+void CameraHost::run_track(Track& track) {
+    BridgeSettings settings = settings_;
+    settings.video_source.device_index = track.device;
+
+    TrackPipelineHooks hooks;
+    hooks.stop = shutdown_;
+    run_track_pipeline(track.pipeline, settings, options_.backend, hooks);
+    track.finished.store(true, std::memory_order_release);
+}
+
+} // namespace focus_wizard
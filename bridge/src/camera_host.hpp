@@ -0,0 +1,84 @@
+/**
+ * camera_host.hpp — Several local cameras in one process (--camera_device_indices)
+ *
+ * A shared workstation or meeting room has more than one camera, and one
+ * bridge process per camera loads the graph, the runtime and every shared
+ * library once per camera. With more than one index in
+ * --camera_device_indices, local mode runs a track per camera instead:
+ * each track is a TrackPipeline (track_pipeline.hpp) whose container
+ * captures from its device, and everything it emits is tagged with its track id (1 = the first index in
+ * the list) before going out on the process's one output.
+ *
+ * Tracks share the process — code, runtime and model files mapped once —
+ * and the output writer. The SDK offers no way to share one graph between
+ * containers, so each track still builds its own graph and runs it on its
+ * own thread (the container's Run() blocks for the track's lifetime).
+ *
+ * One face per camera: the SDK reports the landmarks of a single face per
+ * frame, so a track is a camera, not a person.
+ *
+ * A track whose camera fails reports the error under its id; the others
+ * keep running.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <csignal>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <string>
+
+#include "bridge_container.hpp"
+#include "json_emitter.hpp"
+#include "track_pipeline.hpp"
+
+namespace focus_wizard {
+
+using CameraHostOptions = TrackPipelineOptions;
+
+/**
+ * Parse a --camera_device_indices value ("0,2"): non-negative, distinct,
+ * at most kMaxTracks. On failure returns false and describes why in `error`.
+ */
+bool parse_camera_indices(const std::string& list, std::vector<int>* out, std::string* error);
+
+class CameraHost {
+public:
+    /**
+     * One track per entry of `devices`; `settings` is the local-mode
+     * settings every track starts from. Track status goes to `log`, tagged.
+     */
+    CameraHost(const BridgeSettings& settings, std::vector<int> devices,
+               const CameraHostOptions& options, JsonEmitter& log);
+    ~CameraHost();
+
+    CameraHost(const CameraHost&) = delete;
+    CameraHost& operator=(const CameraHost&) = delete;
+
+    /**
+     * Run every track until `*shutdown` is set or all of them have ended.
+     * Returns after every track has been joined.
+     */
+    void run(const volatile std::sig_atomic_t* shutdown);
+
+    size_t tracks() const { return tracks_.size(); }
+
+private:
+    struct Track;
+
+    void run_track(Track& track);
+    void join_all();
+
+    BridgeSettings settings_;
+    CameraHostOptions options_;
+    JsonEmitter& log_;
+    const volatile std::sig_atomic_t* shutdown_ = nullptr;
+
+    std::vector<std::unique_ptr<Track>> tracks_;
+};
+
+} // namespace focus_wizard
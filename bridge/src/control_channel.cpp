@@ -0,0 +1,304 @@
+/**
+ * control_channel.cpp — Implementation
+ */
+
+#include "control_channel.hpp"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace focus_wizard {
+
+namespace {
+
+constexpr size_t kMaxLineBytes = 64 * 1024;
+
+// ── Flat JSON Parsing ────────────────────────────────────
+
+class Cursor {
+public:
+    explicit Cursor(std::string_view text) : text_(text) {}
+
+    void skip_space() {
+        while (pos_ < text_.size() &&
+               (text_[pos_] == ' ' || text_[pos_] == '\t' ||
+                text_[pos_] == '\r' || text_[pos_] == '\n')) {
+            ++pos_;
+        }
+    }
+
+    bool consume(char c) {
+        skip_space();
+        if (pos_ < text_.size() && text_[pos_] == c) {
+            ++pos_;
+            return true;
+        }
+        return false;
+    }
+
+    bool at_end() {
+        skip_space();
+        return pos_ == text_.size();
+    }
+
+    char peek() {
+        skip_space();
+        return pos_ < text_.size() ? text_[pos_] : '\0';
+    }
+
+    // A JSON string, unescaped. \u escapes outside ASCII are kept as '?'
+    // — command values are names, paths and numbers.
+    bool string(std::string* out) {
+        if (!consume('"')) return false;
+        out->clear();
+        while (pos_ < text_.size()) {
+            char c = text_[pos_++];
+            if (c == '"') return true;
+            if (c != '\\') {
+                *out += c;
+                continue;
+            }
+            if (pos_ >= text_.size()) return false;
+            char escaped = text_[pos_++];
+            switch (escaped) {
+                case '"':  *out += '"';  break;
+                case '\\': *out += '\\'; break;
+                case '/':  *out += '/';  break;
+                case 'b':  *out += '\b'; break;
+                case 'f':  *out += '\f'; break;
+                case 'n':  *out += '\n'; break;
+                case 'r':  *out += '\r'; break;
+                case 't':  *out += '\t'; break;
+                case 'u': {
+                    if (pos_ + 4 > text_.size()) return false;
+                    std::string hex(text_.substr(pos_, 4));
+                    pos_ += 4;
+                    long code = std::strtol(hex.c_str(), nullptr, 16);
+                    *out += code < 0x80 ? static_cast<char>(code) : '?';
+                    break;
+                }
+                default: return false;
+            }
+        }
+        return false;
+    }
+
+    // A number, true, false or null, as written
+    bool literal(std::string* out) {
+        skip_space();
+        size_t start = pos_;
+        while (pos_ < text_.size() && text_[pos_] != ',' && text_[pos_] != '}' &&
+               text_[pos_] != ' ' && text_[pos_] != '\t' &&
+               text_[pos_] != '\r' && text_[pos_] != '\n') {
+            ++pos_;
+        }
+        *out = std::string(text_.substr(start, pos_ - start));
+        if (out->empty()) return false;
+        if (*out == "true" || *out == "false" || *out == "null") return true;
+
+        // JSON numbers only: strtod alone would also take nan, inf and hex
+        if (out->find_first_not_of("0123456789+-.eE") != std::string::npos ||
+            !((*out)[0] == '-' || ((*out)[0] >= '0' && (*out)[0] <= '9'))) {
+            return false;
+        }
+        char* end = nullptr;
+        std::strtod(out->c_str(), &end);
+        return end == out->c_str() + out->size();
+    }
+
+private:
+    std::string_view text_;
+    size_t pos_ = 0;
+};
+
+} // namespace
+
+bool parse_control_command(std::string_view line, ControlCommand* out, std::string* error) {
+    *out = ControlCommand();
+    Cursor cursor(line);
+    if (!cursor.consume('{')) {
+        *error = "expected a JSON object";
+        return false;
+    }
+
+    if (!cursor.consume('}')) {
+        for (;;) {
+            std::string key;
+            if (!cursor.string(&key)) {
+                *error = "expected a string key";
+                return false;
+            }
+            if (!cursor.consume(':')) {
+                *error = "expected ':' after \"" + key + "\"";
+                return false;
+            }
+
+            std::string value;
+            bool is_string = cursor.peek() == '"';
+            if (cursor.peek() == '{' || cursor.peek() == '[') {
+                *error = "\"" + key + "\": nested values are not supported";
+                return false;
+            }
+            if (!(is_string ? cursor.string(&value) : cursor.literal(&value))) {
+                *error = "bad value for \"" + key + "\"";
+                return false;
+            }
+
+            if (key == "cmd") {
+                if (!is_string) {
+                    *error = "\"cmd\" must be a string";
+                    return false;
+                }
+                out->cmd = std::move(value);
+            } else {
+                out->values.push_back({std::move(key), std::move(value), is_string});
+            }
+
+            if (cursor.consume(',')) continue;
+            if (cursor.consume('}')) break;
+            *error = "expected ',' or '}'";
+            return false;
+        }
+    }
+
+    if (!cursor.at_end()) {
+        *error = "trailing characters after the object";
+        return false;
+    }
+    if (out->cmd.empty()) {
+        *error = "missing \"cmd\"";
+        return false;
+    }
+    return true;
+}
+
+// ── Command ──────────────────────────────────────────────
+
+const ControlValue* ControlCommand::find(std::string_view key) const {
+    for (const ControlValue& value : values) {
+        if (value.key == key) return &value;
+    }
+    return nullptr;
+}
+
+bool ControlCommand::get_string(std::string_view key, std::string* out) const {
+    const ControlValue* value = find(key);
+    if (!value || !value->quoted) return false;
+    *out = value->text;
+    return true;
+}
+
+bool ControlCommand::get_number(std::string_view key, double* out) const {
+    const ControlValue* value = find(key);
+    // "640" is a string; the parser already checked unquoted numbers
+    if (!value || value->quoted || value->text.empty()) return false;
+    char* end = nullptr;
+    double number = std::strtod(value->text.c_str(), &end);
+    if (end != value->text.c_str() + value->text.size()) return false;
+    *out = number;
+    return true;
+}
+
+bool ControlCommand::get_bool(std::string_view key, bool* out) const {
+    const ControlValue* value = find(key);
+    if (!value || value->quoted || (value->text != "true" && value->text != "false")) {
+        return false;
+    }
+    *out = value->text == "true";
+    return true;
+}
+
+// ── Channel ──────────────────────────────────────────────
+
+ControlChannel::~ControlChannel() {
+    stop();
+}
+
+bool ControlChannel::start(int fd, CommandCallback on_command, ErrorCallback on_error,
+                           EndCallback on_end, std::string* error) {
+    if (thread_.joinable()) {
+        *error = "control channel already running";
+        return false;
+    }
+    wake_fd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wake_fd_ < 0) {
+        *error = std::string("eventfd: ") + std::strerror(errno);
+        return false;
+    }
+    fd_ = fd;
+    on_command_ = std::move(on_command);
+    on_error_ = std::move(on_error);
+    on_end_ = std::move(on_end);
+    thread_ = std::thread([this] { run(); });
+    return true;
+}
+
+void ControlChannel::stop() {
+    if (thread_.joinable()) {
+        uint64_t one = 1;
+        (void)!::write(wake_fd_, &one, sizeof(one));
+        thread_.join();
+    }
+    if (wake_fd_ >= 0) {
+        ::close(wake_fd_);
+        wake_fd_ = -1;
+    }
+}
+
+void ControlChannel::run() {
+    std::string pending;
+    char buffer[4096];
+
+    for (;;) {
+        struct pollfd fds[2] = {
+            {fd_, POLLIN, 0},
+            {wake_fd_, POLLIN, 0},
+        };
+        int ready = ::poll(fds, 2, -1);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (fds[1].revents) return; // stop(): not the end of input
+
+        ssize_t n = ::read(fd_, buffer, sizeof(buffer));
+        if (n < 0 && (errno == EINTR || errno == EAGAIN)) continue;
+        if (n <= 0) break;
+        pending.append(buffer, static_cast<size_t>(n));
+
+        size_t start = 0;
+        for (size_t newline; (newline = pending.find('\n', start)) != std::string::npos;
+             start = newline + 1) {
+            dispatch(std::string_view(pending).substr(start, newline - start));
+        }
+        pending.erase(0, start);
+        if (pending.size() > kMaxLineBytes) {
+            if (on_error_) on_error_("control line too long");
+            pending.clear();
+        }
+    }
+
+    // EOF or a read error: whatever is left is the last line
+    if (!pending.empty()) dispatch(pending);
+    if (on_end_) on_end_();
+}
+
+void ControlChannel::dispatch(std::string_view line) {
+    // Blank lines are keepalives
+    if (line.find_first_not_of(" \t\r") == std::string_view::npos) return;
+
+    ControlCommand command;
+    std::string error;
+    if (!parse_control_command(line, &command, &error)) {
+        if (on_error_) on_error_(error);
+        return;
+    }
+    if (on_command_) on_command_(command);
+}
+
+} // namespace focus_wizard
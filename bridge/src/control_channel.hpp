@@ -0,0 +1,95 @@
+/**
+ * control_channel.hpp — Line-based command input
+ *
+ * A single-session bridge is driven by one flat JSON object per line on
+ * stdin:
+ *
+ *   {"cmd":"start"}
+ *   {"cmd":"configure","camera_device_index":1,"capture_width":640}
+ *
+ * Values are strings, numbers, booleans or null; nested objects and
+ * arrays are not part of the protocol. ControlChannel reads the lines
+ * on its own thread and hands each parsed command to a callback; a line
+ * that doesn't parse is reported to the callback as an error. End of
+ * input (the parent went away) is reported once, after the last line.
+ */
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace focus_wizard {
+
+struct ControlValue {
+    std::string key;
+    std::string text;      // unescaped string, or the literal as written
+    bool quoted = false;   // a JSON string, not a number/true/false/null
+};
+
+struct ControlCommand {
+    std::string cmd;
+
+    // Every other key, in the order given
+    std::vector<ControlValue> values;
+
+    /**
+     * Look up `key`; false if it is missing or has the wrong type.
+     */
+    bool get_string(std::string_view key, std::string* out) const;
+    bool get_number(std::string_view key, double* out) const;
+    bool get_bool(std::string_view key, bool* out) const;
+
+    bool has(std::string_view key) const { return find(key) != nullptr; }
+
+private:
+    const ControlValue* find(std::string_view key) const;
+};
+
+/**
+ * Parse one command line. On failure returns false and describes why in
+ * `error`.
+ */
+bool parse_control_command(std::string_view line, ControlCommand* out, std::string* error);
+
+class ControlChannel {
+public:
+    using CommandCallback = std::function<void(const ControlCommand& command)>;
+    using ErrorCallback = std::function<void(const std::string& error)>;
+    using EndCallback = std::function<void()>;
+
+    ControlChannel() = default;
+    ~ControlChannel();
+
+    ControlChannel(const ControlChannel&) = delete;
+    ControlChannel& operator=(const ControlChannel&) = delete;
+
+    /**
+     * Start reading `fd` on a background thread. The callbacks run on that
+     * thread and must be thread-safe with respect to the pipeline.
+     * On failure returns false and describes why in `error`.
+     */
+    bool start(int fd, CommandCallback on_command, ErrorCallback on_error,
+               EndCallback on_end, std::string* error);
+
+    /**
+     * Stop reading and join the thread. Safe to call twice.
+     */
+    void stop();
+
+private:
+    void run();
+    void dispatch(std::string_view line);
+
+    int fd_ = -1;
+    int wake_fd_ = -1;          // eventfd: stop
+    CommandCallback on_command_;
+    ErrorCallback on_error_;
+    EndCallback on_end_;
+    std::thread thread_;
+};
+
+} // namespace focus_wizard
@@ -9,15 +9,19 @@
  *   5. DISTRACTED — excessive blinking / restless behaviour
  *   6. FOCUSED — everything looks good
  *   7. UNKNOWN — not enough data yet
+ *
+ * The decision runs on smoothed inputs, and commit() applies the dwell
+ * time before the decided state becomes current_state_.
  */
 
 #include "focus_analyzer.hpp"
+#include "frame_trace.hpp"
+#include "json_writer.hpp"
 
 #include <cmath>
-#include <sstream>
-#include <iomanip>
 #include <algorithm>
 #include <numeric>
+#include <tuple>
 
 namespace focus_wizard {
 
@@ -34,14 +38,240 @@ const char* focus_state_to_string(FocusState state) {
     }
 }
 
-FocusAnalyzer::FocusAnalyzer(FocusThresholds thresholds)
+void write_json_value(std::string& out, FocusState state, int /*precision*/) {
+    write_json_string(out, focus_state_to_string(state));
+}
+
+// ── Payload schema ───────────────────────────────────────
+// Field order and precision are the wire format — don't reorder.
+
+static constexpr auto kResultSchema = std::make_tuple(
+    json_field("state",       &FocusResult::state),
+    json_field("focus_score", &FocusResult::focus_score, 3)
+);
+
+static constexpr auto kTransitionSchema = std::make_tuple(
+    json_field("from",                &FocusTransition::from),
+    json_field("to",                  &FocusTransition::to),
+    json_field("focus_score",         &FocusTransition::focus_score, 3),
+    json_field("previous_duration_s", &FocusTransition::previous_duration_s, 3)
+);
+
+static constexpr auto kFocusMetricsSchema = std::make_tuple(
+    json_field("face_detected",      &FocusMetrics::face_detected),
+    json_field("is_talking",         &FocusMetrics::is_talking),
+    json_field("is_blinking",        &FocusMetrics::is_blinking),
+    json_field("blink_rate_per_min", &FocusMetrics::blink_rate_per_min, 3),
+    json_field("gaze_x",             &FocusMetrics::gaze_x, 3),
+    json_field("gaze_y",             &FocusMetrics::gaze_y, 3),
+    json_field("has_gaze",           &FocusMetrics::has_gaze),
+    json_field("pulse_bpm",          &FocusMetrics::pulse_rate_bpm, 3),
+    json_field("breathing_bpm",      &FocusMetrics::breathing_rate_bpm, 3),
+    json_field("capture_us",         &FocusMetrics::capture_us),
+    json_field("callback_us",        &FocusMetrics::callback_us)
+);
+
+// Only with --frame_features
+static constexpr auto kFrameFeatureSchema = std::make_tuple(
+    json_field("brightness",         &FocusMetrics::brightness, 3),
+    json_field("motion",             &FocusMetrics::motion, 3),
+    json_field("sharpness",          &FocusMetrics::sharpness, 1),
+    json_field("roi_exposure",       &FocusMetrics::roi_exposure, 3),
+    json_field("low_quality_frame",  &FocusMetrics::low_quality_frame)
+);
+
+// Do two snapshots differ in any field the analysis or the focus payload
+// depends on? Floats compare at their serialized precision (3 decimals),
+// so sub-precision jitter doesn't count as a change. The vitals weights
+// are left out: they decay a little with every frame, and a decision that
+// waits for the next real input change loses nothing. Likewise the frame
+// features only count through the low-quality flag they gate.
+static bool same_at_precision(float a, float b) {
+    return std::lround(a * 1000.0f) == std::lround(b * 1000.0f);
+}
+
+static bool analysis_inputs_equal(const FocusMetrics& a, const FocusMetrics& b) {
+    return a.face_detected == b.face_detected &&
+           a.is_talking    == b.is_talking &&
+           a.is_blinking   == b.is_blinking &&
+           a.has_gaze      == b.has_gaze &&
+           a.has_pulse     == b.has_pulse &&
+           a.has_breathing == b.has_breathing &&
+           a.low_quality_frame == b.low_quality_frame &&
+           same_at_precision(a.blink_rate_per_min, b.blink_rate_per_min) &&
+           same_at_precision(a.gaze_x, b.gaze_x) &&
+           same_at_precision(a.gaze_y, b.gaze_y) &&
+           same_at_precision(a.pulse_rate_bpm, b.pulse_rate_bpm) &&
+           same_at_precision(a.breathing_rate_bpm, b.breathing_rate_bpm);
+}
+
+FocusAnalyzer::FocusAnalyzer(FocusThresholds thresholds, FocusEmitPolicy policy,
+                             FocusSmoothing smoothing)
     : thresholds_(thresholds)
-    , last_face_seen_(std::chrono::steady_clock::now())
+    , policy_(policy)
+    , smoothing_(smoothing)
+    , gaze_x_(smoothing.gaze)
+    , gaze_y_(smoothing.gaze)
+    , pulse_(smoothing.vitals_time_constant_s)
+    , breathing_(smoothing.vitals_time_constant_s)
+    , state_since_(Clock::now())
+    , last_face_seen_(Clock::now())
 {
 }
 
-std::string FocusAnalyzer::analyze(const FocusMetrics& metrics) {
-    auto now = std::chrono::steady_clock::now();
+void FocusAnalyzer::set_clock(ClockFn clock) {
+    clock_ = clock;
+    state_since_ = now();
+    last_face_seen_ = state_since_;
+}
+
+void FocusAnalyzer::set_live_thresholds(const LiveThresholds* live) {
+    live_thresholds_ = live;
+    if (live) {
+        thresholds_version_ = live->version();
+        thresholds_ = live->load();
+    }
+}
+
+bool FocusAnalyzer::refresh_thresholds() {
+    if (!live_thresholds_) return false;
+    // Version first: a store racing the load is picked up next frame
+    uint64_t version = live_thresholds_->version();
+    if (version == thresholds_version_) return false;
+    thresholds_version_ = version;
+    thresholds_ = live_thresholds_->load();
+    return true;
+}
+
+std::string_view FocusAnalyzer::analyze(const FocusMetrics& metrics) {
+    FocusResult result = evaluate(metrics);
+    return build_json(result, metrics);
+}
+
+bool FocusAnalyzer::update(const FocusMetrics& metrics, FocusResult* result) {
+    auto now = this->now();
+
+    // A skipped frame still shows the face, or the away timer would run
+    // from the first of a stretch of unchanged frames instead of the last
+    if (metrics.face_detected) {
+        last_face_seen_ = now;
+        ever_seen_face_ = true;
+    }
+
+    bool inputs_changed = !has_emitted_ ||
+                          !analysis_inputs_equal(metrics, last_emitted_input_);
+
+    // With the face gone, AWAY is reached by time alone — keep evaluating
+    // until it is, even though the inputs stay the same.
+    bool away_pending = ever_seen_face_ && !metrics.face_detected &&
+                        current_state_ != FocusState::AWAY;
+
+    // Likewise a state waiting out its dwell time commits by time alone
+    bool transition_pending = candidate_state_ != current_state_;
+
+    // New thresholds can change the state of unchanged inputs
+    bool thresholds_changed = refresh_thresholds();
+
+    if (policy_.change_detection && !inputs_changed && !away_pending && !transition_pending &&
+        !thresholds_changed) {
+        *result = last_result_;
+        return false;
+    }
+
+    FocusState previous_state = current_state_;
+    last_result_ = evaluate(metrics);
+    *result = last_result_;
+
+    bool state_changed = !has_emitted_ || last_result_.state != previous_state;
+    if (!state_changed) {
+        if (policy_.change_detection && !inputs_changed) {
+            return false;
+        }
+        if (policy_.max_emit_hz > 0.0f) {
+            auto min_interval = std::chrono::duration<float>(1.0f / policy_.max_emit_hz);
+            if (now - last_emit_time_ < min_interval) {
+                return false;
+            }
+        }
+    }
+
+    last_emitted_input_ = metrics;
+    last_emit_time_ = now;
+    has_emitted_ = true;
+    return true;
+}
+
+FocusMetrics FocusAnalyzer::smooth(const FocusMetrics& metrics, Clock::time_point now) {
+    float dt_s = has_filtered_ ? std::chrono::duration<float>(now - last_filtered_).count() : 0.0f;
+    last_filtered_ = now;
+    has_filtered_ = true;
+
+    FocusMetrics smoothed = metrics;
+    if (metrics.has_gaze) {
+        smoothed.gaze_x = gaze_x_.filter(metrics.gaze_x, dt_s);
+        smoothed.gaze_y = gaze_y_.filter(metrics.gaze_y, dt_s);
+    } else {
+        gaze_x_.reset();
+        gaze_y_.reset();
+    }
+    if (metrics.has_pulse) {
+        smoothed.pulse_rate_bpm = pulse_.filter(metrics.pulse_rate_bpm, dt_s);
+    } else {
+        pulse_.reset();
+    }
+    if (metrics.has_breathing) {
+        smoothed.breathing_rate_bpm = breathing_.filter(metrics.breathing_rate_bpm, dt_s);
+    } else {
+        breathing_.reset();
+    }
+    return smoothed;
+}
+
+FocusResult FocusAnalyzer::commit(FocusResult decided, Clock::time_point now) {
+    if (decided.state == current_state_) {
+        candidate_state_ = decided.state;
+        committed_score_ = decided.focus_score;
+        return decided;
+    }
+
+    if (decided.state != candidate_state_) {
+        candidate_state_ = decided.state;
+        candidate_since_ = now;
+    }
+
+    bool immediate = !smoothing_.enabled ||
+                     current_state_ == FocusState::UNKNOWN ||
+                     current_state_ == FocusState::AWAY ||
+                     decided.state == FocusState::AWAY;
+    auto dwell = std::chrono::duration<float>(smoothing_.dwell_s);
+    if (!immediate && now - candidate_since_ < dwell) {
+        // Hold the current state (and its score) until the new one has lasted
+        return FocusResult{current_state_, committed_score_};
+    }
+
+    transition_.from = current_state_;
+    transition_.to = decided.state;
+    transition_.focus_score = decided.focus_score;
+    transition_.previous_duration_s = std::chrono::duration<float>(now - state_since_).count();
+    has_transition_ = true;
+
+    current_state_ = decided.state;
+    state_since_ = now;
+    committed_score_ = decided.focus_score;
+    return decided;
+}
+
+bool FocusAnalyzer::take_transition(FocusTransition* transition) {
+    if (!has_transition_) return false;
+    *transition = transition_;
+    has_transition_ = false;
+    return true;
+}
+
+FocusResult FocusAnalyzer::evaluate(const FocusMetrics& raw_metrics) {
+    auto now = this->now();
+    refresh_thresholds();
+    const FocusMetrics metrics = smoothing_.enabled ? smooth(raw_metrics, now) : raw_metrics;
 
     // ── Track face presence ──────────────────────────────
     if (metrics.face_detected) {
@@ -69,6 +299,20 @@ std::string FocusAnalyzer::analyze(const FocusMetrics& metrics) {
     // Only analyze further if we have a face
     bool can_analyze = metrics.face_detected;
 
+    // A frame too dark, blurred or badly exposed to read (frame_features.hpp)
+    // is no evidence either way: the current state holds through it
+    if (can_analyze && metrics.low_quality_frame && current_state_ != FocusState::AWAY) {
+        state = current_state_;
+        focus_score = committed_score_;
+        can_analyze = false;
+    }
+
+    // Low-confidence or long-stale REST vitals don't count
+    bool pulse_usable = metrics.has_pulse &&
+                        metrics.pulse_weight >= thresholds_.min_vitals_weight;
+    bool breathing_usable = metrics.has_breathing &&
+                            metrics.breathing_weight >= thresholds_.min_vitals_weight;
+
     if (state == FocusState::UNKNOWN && can_analyze) {
         // 2. Check talking
         if (metrics.is_talking) {
@@ -91,7 +335,7 @@ std::string FocusAnalyzer::analyze(const FocusMetrics& metrics) {
         // 4. Check drowsy indicators
         if (state == FocusState::UNKNOWN) {
             bool high_blink_rate = metrics.blink_rate_per_min > thresholds_.blink_rate_drowsy_threshold;
-            bool slow_breathing = metrics.has_breathing &&
+            bool slow_breathing = breathing_usable &&
                                   metrics.breathing_rate_bpm < 12.0f; // unusually slow
 
             if (high_blink_rate || (high_blink_rate && slow_breathing)) {
@@ -102,9 +346,9 @@ std::string FocusAnalyzer::analyze(const FocusMetrics& metrics) {
 
         // 5. Check stress indicators
         if (state == FocusState::UNKNOWN) {
-            bool elevated_pulse = metrics.has_pulse &&
+            bool elevated_pulse = pulse_usable &&
                                   metrics.pulse_rate_bpm > thresholds_.pulse_stressed_threshold;
-            bool fast_breathing = metrics.has_breathing &&
+            bool fast_breathing = breathing_usable &&
                                   metrics.breathing_rate_bpm > thresholds_.breathing_stressed_threshold;
 
             // Need at least one strong signal, or both moderate
@@ -119,10 +363,13 @@ std::string FocusAnalyzer::analyze(const FocusMetrics& metrics) {
             state = FocusState::FOCUSED;
             // Score based on physiological calm
             float vitals_score = 1.0f;
-            if (metrics.has_pulse && metrics.pulse_rate_bpm > 0) {
-                // Penalize slightly if pulse is elevated (but not enough for STRESSED)
-                vitals_score = std::min(1.0f,
+            if (pulse_usable && metrics.pulse_rate_bpm > 0) {
+                // Penalize slightly if pulse is elevated (but not enough for
+                // STRESSED), less so the less the measurement is trusted
+                float pulse_score = std::min(1.0f,
                     thresholds_.pulse_stressed_threshold / metrics.pulse_rate_bpm);
+                float weight = std::min(1.0f, metrics.pulse_weight);
+                vitals_score = 1.0f - weight * (1.0f - pulse_score);
             }
             focus_score = vitals_score;
         }
@@ -133,31 +380,35 @@ std::string FocusAnalyzer::analyze(const FocusMetrics& metrics) {
         focus_score = 0.5f; // neutral
     }
 
-    current_state_ = state;
-    return build_json(state, focus_score, metrics);
+    return commit(FocusResult{state, focus_score}, now);
 }
 
-std::string FocusAnalyzer::build_json(
-    FocusState state,
-    float focus_score,
+std::string_view FocusAnalyzer::build_json(
+    const FocusResult& result,
     const FocusMetrics& metrics
 ) {
-    std::ostringstream json;
-    json << std::fixed << std::setprecision(3);
-    json << "{";
-    json << "\"state\":\"" << focus_state_to_string(state) << "\"";
-    json << ",\"focus_score\":" << focus_score;
-    json << ",\"face_detected\":" << (metrics.face_detected ? "true" : "false");
-    json << ",\"is_talking\":" << (metrics.is_talking ? "true" : "false");
-    json << ",\"is_blinking\":" << (metrics.is_blinking ? "true" : "false");
-    json << ",\"blink_rate_per_min\":" << metrics.blink_rate_per_min;
-    json << ",\"gaze_x\":" << metrics.gaze_x;
-    json << ",\"gaze_y\":" << metrics.gaze_y;
-    json << ",\"has_gaze\":" << (metrics.has_gaze ? "true" : "false");
-    json << ",\"pulse_bpm\":" << metrics.pulse_rate_bpm;
-    json << ",\"breathing_bpm\":" << metrics.breathing_rate_bpm;
-    json << "}";
-    return json.str();
+    std::string& out = thread_payload_buffer();
+    out.clear();
+    JsonWriter writer(out);
+    writer.begin_object();
+    write_fields(writer, result, kResultSchema);
+    write_fields(writer, metrics, kFocusMetricsSchema);
+    if (metrics.has_frame_features) {
+        write_fields(writer, metrics, kFrameFeatureSchema);
+    }
+    writer.field("emit_us", wall_clock_us());
+    writer.end_object();
+    return out;
+}
+
+std::string_view FocusAnalyzer::build_transition_json(const FocusTransition& transition) {
+    std::string& out = thread_payload_buffer();
+    out.clear();
+    JsonWriter writer(out);
+    writer.begin_object();
+    write_fields(writer, transition, kTransitionSchema);
+    writer.end_object();
+    return out;
 }
 
 } // namespace focus_wizard
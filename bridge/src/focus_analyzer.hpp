@@ -6,18 +6,37 @@
  *
  * Focus states:
  *   FOCUSED     — user is looking at screen, vitals are calm, engaged
- *   DISTRACTED  — (reserved for future gaze/iris tracking)
+ *   DISTRACTED  — gaze beyond gaze_distraction_threshold (head pose, or
+ *                 eye-in-head gaze with the GazeEstimator)
  *   DROWSY      — high blink rate, slowing breathing
  *   STRESSED    — elevated pulse, fast breathing
  *   AWAY        — no face detected (user left desk)
  *   TALKING     — user is on a call / talking to someone
  *   UNKNOWN     — insufficient data to determine state
+ *
+ * Smoothing: by default the inputs are filtered before the decision (1€
+ * filter on gaze, EMA on pulse / breathing) and a new state must persist
+ * for a dwell time before it replaces the current one, so a blink or a
+ * glance doesn't flip the state. Each update is O(1) with fixed memory.
+ * Every committed change is also reported as a FocusTransition, which the
+ * publisher emits as a `state_changed` message.
+ *
+ * Thresholds can be replaced while the analyzer runs (LiveThresholds,
+ * the `set_thresholds` command); the analyzer notices on its next frame.
+ *
+ * Dwell, face absence and the rate cap are timed on steady_clock unless
+ * set_clock() substitutes another source (the tests' mock clock).
  */
 
 #pragma once
 
 #include "metrics_collector.hpp"
+#include "seqlock.hpp"
+#include "signal_filter.hpp"
+#include <atomic>
+#include <mutex>
 #include <string>
+#include <string_view>
 #include <chrono>
 
 namespace focus_wizard {
@@ -37,6 +56,11 @@ enum class FocusState {
  */
 const char* focus_state_to_string(FocusState state);
 
+/**
+ * JSON value overload so FocusState can appear in a field schema.
+ */
+void write_json_value(std::string& out, FocusState state, int precision);
+
 /**
  * Configurable thresholds for focus analysis.
  * These can be tuned based on user feedback.
@@ -51,6 +75,10 @@ struct FocusThresholds {
     // Breathing: normal is 12-20/min; elevated suggests stress/anxiety
     float breathing_stressed_threshold = 22.0f;
 
+    // Vitals whose fused weight (confidence x freshness, see FusionOptions)
+    // is below this are ignored; above it they count in proportion
+    float min_vitals_weight = 0.2f;
+
     // Gaze: deviation magnitude above which user is distracted
     float gaze_distraction_threshold = 0.3f;
 
@@ -58,32 +86,184 @@ struct FocusThresholds {
     float face_absence_timeout_s = 3.0f;
 };
 
+/**
+ * FocusThresholds replaced at runtime. Readers keep their own copy and
+ * check version() once per frame — one atomic load — reloading only when
+ * it moved. store() may be called from any thread.
+ */
+class LiveThresholds {
+public:
+    explicit LiveThresholds(const FocusThresholds& initial) : cell_(initial) {}
+
+    void store(const FocusThresholds& thresholds) {
+        std::lock_guard<std::mutex> lock(write_mutex_);  // SeqLock: one writer
+        cell_.store(thresholds);
+        version_.fetch_add(1, std::memory_order_release);
+    }
+
+    FocusThresholds load() const { return cell_.load(); }
+
+    uint64_t version() const { return version_.load(std::memory_order_acquire); }
+
+private:
+    std::mutex write_mutex_;
+    SeqLock<FocusThresholds> cell_;
+    std::atomic<uint64_t> version_{0};
+};
+
+/**
+ * When a `focus` message is worth emitting.
+ */
+struct FocusEmitPolicy {
+    // Skip analysis and emission while the analyzed inputs are unchanged
+    // (at the precision they're serialized with)
+    bool change_detection = true;
+
+    // Cap on focus messages per second that only carry new inputs;
+    // state transitions always go out immediately. 0 = no cap.
+    float max_emit_hz = 0.0f;
+};
+
+/**
+ * Temporal filtering ahead of (and hysteresis on) the state decision.
+ */
+struct FocusSmoothing {
+    bool enabled = true;
+
+    // 1€ filter on gaze_x / gaze_y
+    OneEuroOptions gaze;
+
+    // EMA time constant for pulse and breathing rate
+    float vitals_time_constant_s = 5.0f;
+
+    // A different state must hold this long before it replaces the
+    // current one. Leaving UNKNOWN and entering or leaving AWAY (which has
+    // its own timeout) are immediate.
+    float dwell_s = 1.0f;
+};
+
+/**
+ * Outcome of one analysis pass.
+ */
+struct FocusResult {
+    FocusState state = FocusState::UNKNOWN;
+    float focus_score = 0.5f;
+};
+
+/**
+ * A committed state change, for `state_changed` messages.
+ */
+struct FocusTransition {
+    FocusState from = FocusState::UNKNOWN;
+    FocusState to = FocusState::UNKNOWN;
+    float focus_score = 0.5f;
+    float previous_duration_s = 0.0f;  // how long `from` lasted
+};
+
 class FocusAnalyzer {
 public:
-    explicit FocusAnalyzer(FocusThresholds thresholds = {});
+    using Clock = std::chrono::steady_clock;
+    using ClockFn = Clock::time_point (*)();
+
+    explicit FocusAnalyzer(FocusThresholds thresholds = {}, FocusEmitPolicy policy = {},
+                           FocusSmoothing smoothing = {});
 
     /**
      * Analyze current metrics and return the focus state + a JSON payload.
+     * The view points into this thread's reusable payload buffer.
+     */
+    std::string_view analyze(const FocusMetrics& metrics);
+
+    /**
+     * Analyze current metrics without serializing the result.
+     */
+    FocusResult evaluate(const FocusMetrics& metrics);
+
+    /**
+     * Analyze only if needed, according to the emit policy.
+     * Returns true when a `focus` message should be emitted; `result`
+     * receives the latest result either way.
+     */
+    bool update(const FocusMetrics& metrics, FocusResult* result);
+
+    /**
+     * Build the JSON output for an analysis result.
+     * The view points into this thread's reusable payload buffer.
+     */
+    std::string_view build_json(const FocusResult& result, const FocusMetrics& metrics);
+
+    /**
+     * If the last evaluate() / update() committed a state change, return
+     * it in `transition` (once) and return true.
+     */
+    bool take_transition(FocusTransition* transition);
+
+    /**
+     * Build the JSON output for a `state_changed` message.
+     * The view points into this thread's reusable payload buffer.
      */
-    std::string analyze(const FocusMetrics& metrics);
+    std::string_view build_transition_json(const FocusTransition& transition);
 
     /**
      * Get the current determined focus state.
      */
     FocusState current_state() const { return current_state_; }
 
+    /**
+     * Follow `live` instead of the constructor's thresholds (nullptr:
+     * keep the current ones). `live` must outlive the analyzer.
+     */
+    void set_live_thresholds(const LiveThresholds* live);
+
+    const FocusThresholds& thresholds() const { return thresholds_; }
+
+    /**
+     * Read time from `clock` instead of steady_clock (nullptr: back to
+     * steady_clock). Call before the first frame; the state timers restart.
+     */
+    void set_clock(ClockFn clock);
+
 private:
+    Clock::time_point now() const { return clock_ ? clock_() : Clock::now(); }
+
+    // Reload thresholds_ if the live ones moved; true if it did
+    bool refresh_thresholds();
+    FocusMetrics smooth(const FocusMetrics& metrics, Clock::time_point now);
+    FocusResult commit(FocusResult candidate, Clock::time_point now);
+
+    ClockFn clock_ = nullptr;
     FocusThresholds thresholds_;
+    const LiveThresholds* live_thresholds_ = nullptr;
+    uint64_t thresholds_version_ = 0;
+    FocusEmitPolicy policy_;
+    FocusSmoothing smoothing_;
     FocusState current_state_ = FocusState::UNKNOWN;
 
+    // Input filters (see FocusSmoothing)
+    OneEuroFilter gaze_x_;
+    OneEuroFilter gaze_y_;
+    EmaFilter pulse_;
+    EmaFilter breathing_;
+    Clock::time_point last_filtered_;
+    bool has_filtered_ = false;
+
+    // Hysteresis: the state waiting out its dwell time, and since when
+    FocusState candidate_state_ = FocusState::UNKNOWN;
+    Clock::time_point candidate_since_;
+    Clock::time_point state_since_;
+    float committed_score_ = 0.5f;
+    FocusTransition transition_;
+    bool has_transition_ = false;
+
+    // Change detection / rate limiting (see update())
+    FocusResult last_result_;
+    FocusMetrics last_emitted_input_;
+    bool has_emitted_ = false;
+    Clock::time_point last_emit_time_;
+
     // Track face absence duration
-    std::chrono::steady_clock::time_point last_face_seen_;
+    Clock::time_point last_face_seen_;
     bool ever_seen_face_ = false;
-
-    /**
-     * Build the JSON output for the current analysis.
-     */
-    std::string build_json(FocusState state, float focus_score, const FocusMetrics& metrics);
 };
 
 } // namespace focus_wizard
@@ -0,0 +1,467 @@
+/**
+ * focus_history.cpp — Implementation
+ */
+
+#include "focus_history.hpp"
+#include "json_writer.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace focus_wizard {
+
+namespace {
+
+constexpr char     kHistoryMagic[4] = {'F', 'W', 'H', 'S'};
+constexpr uint32_t kHistoryVersion  = 1;
+
+constexpr int64_t kSecondUs = 1'000'000;
+constexpr std::array<int64_t, kHistoryTiers> kBucketUs = {
+    kSecondUs, 60 * kSecondUs, 3600 * kSecondUs,
+};
+
+constexpr size_t align8(size_t bytes) {
+    return (bytes + 7) & ~size_t{7};
+}
+
+template <typename T>
+T* carve(uint8_t** cursor, size_t capacity) {
+    T* column = reinterpret_cast<T*>(*cursor);
+    *cursor += align8(capacity * sizeof(T));
+    return column;
+}
+
+int64_t align_down(int64_t time_us, int64_t bucket_us) {
+    int64_t start = time_us - time_us % bucket_us;
+    return time_us < 0 && start != time_us ? start - bucket_us : start;
+}
+
+float mean(double sum, uint32_t samples) {
+    return samples > 0 ? static_cast<float>(sum / samples) : 0.0f;
+}
+
+} // namespace
+
+bool parse_history_tier(const std::string& name, HistoryTier* out, bool* tier_auto) {
+    *tier_auto = false;
+    if      (name == "1s")   *out = HistoryTier::SECOND;
+    else if (name == "1m")   *out = HistoryTier::MINUTE;
+    else if (name == "1h")   *out = HistoryTier::HOUR;
+    else if (name == "auto") *tier_auto = true;
+    else return false;
+    return true;
+}
+
+const char* history_tier_to_string(HistoryTier tier) {
+    switch (tier) {
+        case HistoryTier::SECOND: return "1s";
+        case HistoryTier::MINUTE: return "1m";
+        case HistoryTier::HOUR:   return "1h";
+    }
+    return "1s";
+}
+
+void write_history_json(const HistorySummary& summary, int64_t from_us, int64_t to_us,
+                        std::string_view id, std::string* out) {
+    std::string states;
+    JsonWriter state_writer(states);
+    state_writer.begin_object();
+    for (size_t i = 0; i < kHistoryStates; ++i) {
+        state_writer.field(focus_state_to_string(static_cast<FocusState>(i)),
+                           summary.state_s[i], 1);
+    }
+    state_writer.end_object();
+
+    out->clear();
+    JsonWriter writer(*out);
+    writer.begin_object();
+    if (!id.empty()) writer.string_field("id", id);
+    writer.field("tier", history_tier_to_string(summary.tier));
+    writer.field("from_ms", from_us / 1000);
+    writer.field("to_ms", to_us / 1000);
+    writer.field("buckets", static_cast<int64_t>(summary.buckets));
+    writer.field("samples", static_cast<int64_t>(summary.samples));
+    if (summary.buckets > 0) {
+        writer.field("first_ms", summary.first_us / 1000);
+        writer.field("last_ms", summary.last_us / 1000);
+    }
+    writer.field("covered_s", summary.covered_s, 0);
+    writer.field("focus_score", summary.focus_score, 3);
+    writer.field("blink_rate_per_min", summary.blink_rate_per_min, 2);
+    writer.field("has_pulse", summary.has_pulse);
+    if (summary.has_pulse) writer.field("pulse_bpm", summary.pulse_rate_bpm, 2);
+    writer.field("has_breathing", summary.has_breathing);
+    if (summary.has_breathing) writer.field("breathing_bpm", summary.breathing_rate_bpm, 2);
+    writer.field("has_gaze", summary.has_gaze);
+    if (summary.has_gaze) {
+        writer.field("gaze_x", summary.gaze_x, 3);
+        writer.field("gaze_y", summary.gaze_y, 3);
+    }
+    writer.raw_field("state_s", states);
+    writer.end_object();
+}
+
+// ── Buckets ──────────────────────────────────────────────
+
+void FocusHistory::Bucket::merge(const Bucket& other) {
+    seconds           += other.seconds;
+    samples           += other.samples;
+    score_sum         += other.score_sum;
+    blink_sum         += other.blink_sum;
+    pulse_sum         += other.pulse_sum;
+    pulse_samples     += other.pulse_samples;
+    breathing_sum     += other.breathing_sum;
+    breathing_samples += other.breathing_samples;
+    gaze_x_sum        += other.gaze_x_sum;
+    gaze_y_sum        += other.gaze_y_sum;
+    gaze_samples      += other.gaze_samples;
+    for (size_t i = 0; i < kHistoryStates; ++i) {
+        state_samples[i] += other.state_samples[i];
+    }
+}
+
+// Must match carve_columns(): start_us, 6 float and 5 + kHistoryStates count columns
+size_t FocusHistory::columns_bytes(size_t capacity) {
+    return align8(capacity * sizeof(int64_t)) +
+           6 * align8(capacity * sizeof(float)) +
+           (5 + kHistoryStates) * align8(capacity * sizeof(uint32_t));
+}
+
+FocusHistory::HistoryColumns FocusHistory::carve_columns(uint8_t** cursor, size_t capacity) {
+    HistoryColumns columns;
+    columns.start_us          = carve<int64_t>(cursor, capacity);
+    columns.seconds           = carve<uint32_t>(cursor, capacity);
+    columns.samples           = carve<uint32_t>(cursor, capacity);
+    columns.score             = carve<float>(cursor, capacity);
+    columns.blink             = carve<float>(cursor, capacity);
+    columns.pulse             = carve<float>(cursor, capacity);
+    columns.pulse_samples     = carve<uint32_t>(cursor, capacity);
+    columns.breathing         = carve<float>(cursor, capacity);
+    columns.breathing_samples = carve<uint32_t>(cursor, capacity);
+    columns.gaze_x            = carve<float>(cursor, capacity);
+    columns.gaze_y            = carve<float>(cursor, capacity);
+    columns.gaze_samples      = carve<uint32_t>(cursor, capacity);
+    for (auto& state : columns.state_samples) state = carve<uint32_t>(cursor, capacity);
+    return columns;
+}
+
+void FocusHistory::store_slot(size_t tier, size_t slot, const Bucket& bucket) {
+    const HistoryColumns& c = columns_[tier];
+    c.start_us[slot]          = bucket.start_us;
+    c.seconds[slot]           = bucket.seconds;
+    c.samples[slot]           = bucket.samples;
+    c.score[slot]             = mean(bucket.score_sum, bucket.samples);
+    c.blink[slot]             = mean(bucket.blink_sum, bucket.samples);
+    c.pulse[slot]             = mean(bucket.pulse_sum, bucket.pulse_samples);
+    c.pulse_samples[slot]     = bucket.pulse_samples;
+    c.breathing[slot]         = mean(bucket.breathing_sum, bucket.breathing_samples);
+    c.breathing_samples[slot] = bucket.breathing_samples;
+    c.gaze_x[slot]            = mean(bucket.gaze_x_sum, bucket.gaze_samples);
+    c.gaze_y[slot]            = mean(bucket.gaze_y_sum, bucket.gaze_samples);
+    c.gaze_samples[slot]      = bucket.gaze_samples;
+    for (size_t i = 0; i < kHistoryStates; ++i) {
+        c.state_samples[i][slot] = bucket.state_samples[i];
+    }
+}
+
+FocusHistory::Bucket FocusHistory::load_slot(size_t tier, size_t slot) const {
+    const HistoryColumns& c = columns_[tier];
+    Bucket bucket;
+    bucket.start_us          = c.start_us[slot];
+    bucket.seconds           = c.seconds[slot];
+    bucket.samples           = c.samples[slot];
+    bucket.score_sum         = static_cast<double>(c.score[slot]) * bucket.samples;
+    bucket.blink_sum         = static_cast<double>(c.blink[slot]) * bucket.samples;
+    bucket.pulse_samples     = c.pulse_samples[slot];
+    bucket.pulse_sum         = static_cast<double>(c.pulse[slot]) * bucket.pulse_samples;
+    bucket.breathing_samples = c.breathing_samples[slot];
+    bucket.breathing_sum     = static_cast<double>(c.breathing[slot]) * bucket.breathing_samples;
+    bucket.gaze_samples      = c.gaze_samples[slot];
+    bucket.gaze_x_sum        = static_cast<double>(c.gaze_x[slot]) * bucket.gaze_samples;
+    bucket.gaze_y_sum        = static_cast<double>(c.gaze_y[slot]) * bucket.gaze_samples;
+    for (size_t i = 0; i < kHistoryStates; ++i) {
+        bucket.state_samples[i] = c.state_samples[i][slot];
+    }
+    return bucket;
+}
+
+// ── Open / Close ─────────────────────────────────────────
+
+FocusHistory::FocusHistory(FocusHistoryOptions options)
+    : options_(std::move(options))
+{
+}
+
+FocusHistory::~FocusHistory() {
+    close();
+}
+
+bool FocusHistory::open(std::string* error) {
+    close();
+
+    const std::array<size_t, kHistoryTiers> capacities = {
+        std::max<size_t>(options_.second_buckets, 1),
+        std::max<size_t>(options_.minute_buckets, 1),
+        std::max<size_t>(options_.hour_buckets, 1),
+    };
+    size_t size = sizeof(FocusHistoryHeader);
+    for (size_t capacity : capacities) size += columns_bytes(capacity);
+
+    bool restore = false;
+    if (options_.path.empty()) {
+        heap_.assign(size, 0);
+        base_ = heap_.data();
+    } else {
+        int fd = ::open(options_.path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+        if (fd < 0) {
+            *error = "open " + options_.path + ": " + std::strerror(errno);
+            return false;
+        }
+        struct stat st;
+        restore = ::fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) == size;
+        if (!restore && (::ftruncate(fd, 0) != 0 ||
+                         ::ftruncate(fd, static_cast<off_t>(size)) != 0)) {
+            *error = "ftruncate " + options_.path + ": " + std::strerror(errno);
+            ::close(fd);
+            return false;
+        }
+        void* mapped = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED) {
+            *error = "mmap " + options_.path + ": " + std::strerror(errno);
+            return false;
+        }
+        base_ = static_cast<uint8_t*>(mapped);
+        mapped_ = true;
+    }
+    size_ = size;
+    header_ = reinterpret_cast<FocusHistoryHeader*>(base_);
+
+    // Same size is not enough: the capacities must match too
+    if (restore) {
+        restore = std::memcmp(header_->magic, kHistoryMagic, sizeof(header_->magic)) == 0 &&
+                  header_->version == kHistoryVersion && header_->tiers == kHistoryTiers;
+        for (size_t t = 0; restore && t < kHistoryTiers; ++t) {
+            const FocusHistoryTierHeader& tier = header_->tier[t];
+            restore = tier.capacity == capacities[t] && tier.bucket_us == kBucketUs[t] &&
+                      tier.count <= tier.capacity && tier.head < tier.capacity;
+        }
+    }
+    if (!restore) {
+        std::memset(base_, 0, size_);
+        std::memcpy(header_->magic, kHistoryMagic, sizeof(header_->magic));
+        header_->version = kHistoryVersion;
+        header_->tiers = kHistoryTiers;
+        for (size_t t = 0; t < kHistoryTiers; ++t) {
+            header_->tier[t].capacity = capacities[t];
+            header_->tier[t].bucket_us = kBucketUs[t];
+        }
+    }
+
+    uint8_t* cursor = base_ + sizeof(FocusHistoryHeader);
+    for (size_t t = 0; t < kHistoryTiers; ++t) {
+        columns_[t] = carve_columns(&cursor, capacities[t]);
+    }
+
+    // Pick the newest bucket of every tier up where it was left
+    std::lock_guard<std::mutex> lock(mutex_);
+    restored_ = 0;
+    for (size_t t = 0; t < kHistoryTiers; ++t) {
+        const FocusHistoryTierHeader& tier = header_->tier[t];
+        open_[t] = tier.count > 0 ? load_slot(t, tier.head) : Bucket();
+        restored_ += tier.count;
+    }
+    current_ = Bucket();
+    return true;
+}
+
+void FocusHistory::close() {
+    if (!base_) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (current_.samples > 0) commit_second(current_);
+        current_ = Bucket();
+    }
+    if (mapped_) {
+        ::msync(base_, size_, MS_SYNC);
+        ::munmap(base_, size_);
+    }
+    heap_.clear();
+    base_ = nullptr;
+    header_ = nullptr;
+    mapped_ = false;
+    size_ = 0;
+}
+
+void FocusHistory::flush() {
+    if (mapped_) ::msync(base_, size_, MS_ASYNC);
+}
+
+// ── Edge Callback ────────────────────────────────────────
+
+void FocusHistory::add(const FocusMetrics& metrics, const FocusResult& result, int64_t time_us) {
+    if (!base_) return;
+
+    int64_t second_us = align_down(time_us, kSecondUs);
+    if (current_.samples > 0 && current_.start_us != second_us) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            commit_second(current_);
+        }
+        current_ = Bucket();
+
+        if (options_.flush_interval_s > 0.0f &&
+            time_us - last_flush_us_ >= static_cast<int64_t>(options_.flush_interval_s * 1e6f)) {
+            flush();
+            last_flush_us_ = time_us;
+        }
+    }
+    if (current_.samples == 0) {
+        current_.start_us = second_us;
+        current_.seconds = 1;
+    }
+
+    current_.samples += 1;
+    current_.score_sum += result.focus_score;
+    current_.blink_sum += metrics.blink_rate_per_min;
+    if (metrics.has_pulse) {
+        current_.pulse_sum += metrics.pulse_rate_bpm;
+        current_.pulse_samples += 1;
+    }
+    if (metrics.has_breathing) {
+        current_.breathing_sum += metrics.breathing_rate_bpm;
+        current_.breathing_samples += 1;
+    }
+    if (metrics.has_gaze) {
+        current_.gaze_x_sum += metrics.gaze_x;
+        current_.gaze_y_sum += metrics.gaze_y;
+        current_.gaze_samples += 1;
+    }
+    current_.state_samples[static_cast<size_t>(result.state)] += 1;
+}
+
+void FocusHistory::commit_second(const Bucket& second) {
+    for (size_t t = 0; t < kHistoryTiers; ++t) merge_into(t, second);
+}
+
+void FocusHistory::merge_into(size_t t, const Bucket& second) {
+    FocusHistoryTierHeader& tier = header_->tier[t];
+    Bucket& open = open_[t];
+    int64_t start_us = align_down(second.start_us, kBucketUs[t]);
+
+    if (tier.count == 0) {
+        tier.head = 0;
+        tier.count = 1;
+        open = Bucket();
+        open.start_us = start_us;
+    } else if (start_us != open.start_us) {
+        // The newest bucket is finished; the next slot becomes the newest.
+        // A clock stepping back lands in the newest bucket instead.
+        if (start_us > open.start_us) {
+            tier.head = (tier.head + 1) % tier.capacity;
+            tier.count = std::min<uint64_t>(tier.count + 1, tier.capacity);
+            open = Bucket();
+            open.start_us = start_us;
+        }
+    }
+    open.merge(second);
+    store_slot(t, tier.head, open);
+}
+
+// ── Queries ──────────────────────────────────────────────
+
+HistoryTier FocusHistory::tier_for(int64_t from_us) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!header_) return HistoryTier::SECOND;
+    for (size_t t = 0; t < kHistoryTiers; ++t) {
+        const FocusHistoryTierHeader& tier = header_->tier[t];
+        if (tier.count == 0) continue;
+        // The buffer is full once count == capacity; until then nothing
+        // older was ever dropped from it
+        size_t oldest = (tier.head + tier.capacity - (tier.count - 1)) % tier.capacity;
+        if (tier.count < tier.capacity || columns_[t].start_us[oldest] <= from_us) {
+            return static_cast<HistoryTier>(t);
+        }
+    }
+    return HistoryTier::HOUR;
+}
+
+bool FocusHistory::query(int64_t from_us, int64_t to_us, HistoryTier which,
+                         HistorySummary* out) const {
+    *out = HistorySummary();
+    out->tier = which;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!header_) return false;
+
+    size_t t = static_cast<size_t>(which);
+    const FocusHistoryTierHeader& tier = header_->tier[t];
+    const HistoryColumns& c = columns_[t];
+    const int64_t bucket_us = kBucketUs[t];
+
+    double score_sum = 0.0, blink_sum = 0.0, pulse_sum = 0.0, breathing_sum = 0.0;
+    double gaze_x_sum = 0.0, gaze_y_sum = 0.0;
+    uint64_t pulse_samples = 0, breathing_samples = 0, gaze_samples = 0;
+    uint64_t seconds = 0;
+    std::array<double, kHistoryStates> state_s{};
+
+    // Oldest to newest, so first_us / last_us fall out in order
+    size_t oldest = tier.count > 0
+        ? (tier.head + tier.capacity - (tier.count - 1)) % tier.capacity : 0;
+    for (size_t i = 0; i < tier.count; ++i) {
+        size_t slot = (oldest + i) % tier.capacity;
+        int64_t start = c.start_us[slot];
+        uint32_t samples = c.samples[slot];
+        if (samples == 0 || start + bucket_us <= from_us || start >= to_us) continue;
+
+        if (out->buckets == 0) out->first_us = start;
+        out->last_us = start + bucket_us;
+        out->buckets += 1;
+        out->samples += samples;
+        seconds += c.seconds[slot];
+
+        score_sum         += static_cast<double>(c.score[slot]) * samples;
+        blink_sum         += static_cast<double>(c.blink[slot]) * samples;
+        pulse_sum         += static_cast<double>(c.pulse[slot]) * c.pulse_samples[slot];
+        pulse_samples     += c.pulse_samples[slot];
+        breathing_sum     += static_cast<double>(c.breathing[slot]) * c.breathing_samples[slot];
+        breathing_samples += c.breathing_samples[slot];
+        gaze_x_sum        += static_cast<double>(c.gaze_x[slot]) * c.gaze_samples[slot];
+        gaze_y_sum        += static_cast<double>(c.gaze_y[slot]) * c.gaze_samples[slot];
+        gaze_samples      += c.gaze_samples[slot];
+
+        // A bucket's seconds split over its states by sample share
+        double seconds_per_sample = static_cast<double>(c.seconds[slot]) / samples;
+        for (size_t s = 0; s < kHistoryStates; ++s) {
+            state_s[s] += c.state_samples[s][slot] * seconds_per_sample;
+        }
+    }
+    if (out->buckets == 0) return false;
+
+    out->covered_s = static_cast<float>(seconds);
+    out->focus_score = static_cast<float>(score_sum / out->samples);
+    out->blink_rate_per_min = static_cast<float>(blink_sum / out->samples);
+    out->has_pulse = pulse_samples > 0;
+    if (out->has_pulse) out->pulse_rate_bpm = static_cast<float>(pulse_sum / pulse_samples);
+    out->has_breathing = breathing_samples > 0;
+    if (out->has_breathing) {
+        out->breathing_rate_bpm = static_cast<float>(breathing_sum / breathing_samples);
+    }
+    out->has_gaze = gaze_samples > 0;
+    if (out->has_gaze) {
+        out->gaze_x = static_cast<float>(gaze_x_sum / gaze_samples);
+        out->gaze_y = static_cast<float>(gaze_y_sum / gaze_samples);
+    }
+    for (size_t s = 0; s < kHistoryStates; ++s) {
+        out->state_s[s] = static_cast<float>(state_s[s]);
+    }
+    return true;
+}
+
+} // namespace focus_wizard
@@ -0,0 +1,231 @@
+/**
+ * focus_history.hpp — Columnar focus history with 1 s / 1 min / 1 h tiers
+ *
+ * Every analyzed frame is folded into one-second buckets; each finished
+ * second is merged into the three tiers:
+ *
+ *   1s   second_buckets one-second buckets (default: the last hour)
+ *   1m   minute_buckets one-minute buckets (default: the last day)
+ *   1h   hour_buckets one-hour buckets (default: the last 30 days)
+ *
+ * A tier is a ring stored as columns (struct of arrays): bucket start,
+ * seconds and samples folded in, mean focus score, pulse, breathing,
+ * blink rate, gaze and the sample count of every focus state. A bucket
+ * holds means and sample counts, so any run of buckets combines into
+ * exact weighted means. The newest bucket of each tier is updated in place
+ * until its interval is over, so the rings are always current up to the
+ * last finished second.
+ *
+ * With a path the columns live in a shared memory-mapped file (layout
+ * below) that is msync'ed every flush_interval_s. A file with the same
+ * capacities is picked up again at start, so history survives restarts.
+ *
+ *   FocusHistoryHeader, then per tier each column in the order of
+ *   HistoryColumns, capacity entries each, 8-byte aligned
+ *
+ * Threading: add() from the edge callback; query() from any thread. The
+ * edge callback only takes the lock when a second is over.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "focus_analyzer.hpp"
+#include "metrics_collector.hpp"
+
+namespace focus_wizard {
+
+constexpr size_t kHistoryStates = static_cast<size_t>(FocusState::UNKNOWN) + 1;
+
+enum class HistoryTier : uint8_t {
+    SECOND = 0,
+    MINUTE = 1,
+    HOUR   = 2,
+};
+constexpr size_t kHistoryTiers = 3;
+
+/**
+ * "1s", "1m" or "1h"; "auto" leaves `tier_auto` set instead.
+ * Returns false if the name is not recognized.
+ */
+bool parse_history_tier(const std::string& name, HistoryTier* out, bool* tier_auto);
+const char* history_tier_to_string(HistoryTier tier);
+
+struct FocusHistoryOptions {
+    size_t second_buckets = 3600;
+    size_t minute_buckets = 24 * 60;
+    size_t hour_buckets   = 30 * 24;
+
+    // Memory-mapped backing file; empty = memory only
+    std::string path;
+    float flush_interval_s = 10.0f;
+};
+
+/**
+ * Aggregates over the buckets of one tier that overlap a time range.
+ */
+struct HistorySummary {
+    HistoryTier tier = HistoryTier::SECOND;
+    uint32_t buckets = 0;
+    uint64_t samples = 0;
+    int64_t first_us = 0;        // start of the oldest matching bucket
+    int64_t last_us = 0;         // end of the newest matching bucket
+    float covered_s = 0.0f;      // seconds with frames in them
+
+    float focus_score = 0.0f;
+    float blink_rate_per_min = 0.0f;
+    bool has_pulse = false;
+    float pulse_rate_bpm = 0.0f;
+    bool has_breathing = false;
+    float breathing_rate_bpm = 0.0f;
+    bool has_gaze = false;
+    float gaze_x = 0.0f;
+    float gaze_y = 0.0f;
+
+    // Seconds spent in each FocusState
+    std::array<float, kHistoryStates> state_s{};
+};
+
+/**
+ * Build the `history` message payload; `id` is echoed when not empty.
+ */
+void write_history_json(const HistorySummary& summary, int64_t from_us, int64_t to_us,
+                        std::string_view id, std::string* out);
+
+#pragma pack(push, 1)
+struct FocusHistoryTierHeader {
+    uint64_t capacity;
+    uint64_t head;          // slot of the newest bucket
+    uint64_t count;
+    int64_t  bucket_us;
+};
+
+struct FocusHistoryHeader {
+    char     magic[4];
+    uint32_t version;
+    uint32_t tiers;
+    uint32_t reserved;
+    FocusHistoryTierHeader tier[kHistoryTiers];
+};
+#pragma pack(pop)
+
+static_assert(sizeof(FocusHistoryHeader) == 112, "history file layout");
+
+class FocusHistory {
+public:
+    explicit FocusHistory(FocusHistoryOptions options = {});
+    ~FocusHistory();
+
+    FocusHistory(const FocusHistory&) = delete;
+    FocusHistory& operator=(const FocusHistory&) = delete;
+
+    /**
+     * Allocate the rings, mapping options.path if set. An existing file
+     * with the same capacities is restored; any other is replaced.
+     * On failure returns false and describes why in `error`.
+     */
+    bool open(std::string* error);
+
+    /**
+     * Sync the mapped file and release the rings.
+     */
+    void close();
+
+    /**
+     * Buckets restored from the file by open().
+     */
+    uint64_t restored() const { return restored_; }
+
+    // ── Edge callback ────────────────────────────────────
+
+    /**
+     * Fold one analyzed frame in; `time_us` is wall-clock time.
+     */
+    void add(const FocusMetrics& metrics, const FocusResult& result, int64_t time_us);
+
+    // ── Any thread ───────────────────────────────────────
+
+    /**
+     * Aggregate the buckets of `tier` that overlap [from_us, to_us).
+     * Returns false if none do.
+     */
+    bool query(int64_t from_us, int64_t to_us, HistoryTier tier, HistorySummary* out) const;
+
+    /**
+     * The finest tier that reaches back to `from_us`, or the coarsest one.
+     */
+    HistoryTier tier_for(int64_t from_us) const;
+
+private:
+    // An open bucket, with sums rather than means
+    struct Bucket {
+        int64_t start_us = 0;
+        uint32_t seconds = 0;
+        uint32_t samples = 0;
+        double score_sum = 0.0;
+        double blink_sum = 0.0;
+        double pulse_sum = 0.0;
+        uint32_t pulse_samples = 0;
+        double breathing_sum = 0.0;
+        uint32_t breathing_samples = 0;
+        double gaze_x_sum = 0.0;
+        double gaze_y_sum = 0.0;
+        uint32_t gaze_samples = 0;
+        std::array<uint32_t, kHistoryStates> state_samples{};
+
+        void merge(const Bucket& other);
+    };
+
+    // Column pointers into the mapped file or heap block
+    struct HistoryColumns {
+        int64_t*  start_us;
+        uint32_t* seconds;
+        uint32_t* samples;
+        float*    score;
+        float*    blink;
+        float*    pulse;
+        uint32_t* pulse_samples;
+        float*    breathing;
+        uint32_t* breathing_samples;
+        float*    gaze_x;
+        float*    gaze_y;
+        uint32_t* gaze_samples;
+        std::array<uint32_t*, kHistoryStates> state_samples;
+    };
+
+    static size_t columns_bytes(size_t capacity);
+    static HistoryColumns carve_columns(uint8_t** cursor, size_t capacity);
+
+    void commit_second(const Bucket& second);     // with mutex_
+    void merge_into(size_t tier, const Bucket& second);
+    void store_slot(size_t tier, size_t slot, const Bucket& bucket);
+    Bucket load_slot(size_t tier, size_t slot) const;
+    void flush();
+
+    const FocusHistoryOptions options_;
+
+    // The rings: mapped file (MAP_SHARED) or heap
+    uint8_t* base_ = nullptr;
+    size_t size_ = 0;
+    bool mapped_ = false;
+    std::vector<uint8_t> heap_;
+    FocusHistoryHeader* header_ = nullptr;
+    std::array<HistoryColumns, kHistoryTiers> columns_{};
+    uint64_t restored_ = 0;
+
+    mutable std::mutex mutex_;
+    std::array<Bucket, kHistoryTiers> open_;      // under mutex_
+
+    // Edge callback only
+    Bucket current_;
+    int64_t last_flush_us_ = 0;
+};
+
+} // namespace focus_wizard
@@ -0,0 +1,155 @@
+/**
+ * focus_summary.cpp — Implementation
+ */
+
+#include "focus_summary.hpp"
+#include "json_writer.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace focus_wizard {
+
+namespace {
+
+// Longer gaps between frames are not counted as time in any state
+constexpr int64_t kMaxFrameGapUs = 1'000'000;
+
+} // namespace
+
+FocusSummary::FocusSummary(FocusSummaryOptions options)
+    : window_us_(std::max<int64_t>(static_cast<int64_t>(options.window_s * 1e6f), 1'000'000))
+{
+    payload_.reserve(512);
+}
+
+bool FocusSummary::add(const FocusMetrics& metrics, const FocusResult& result, int64_t time_us) {
+    if (!open_) {
+        clear_window(time_us);
+        open_ = true;
+    }
+
+    // Time since the previous frame goes to the state it was in, split at
+    // the window end if the frame crosses it
+    int64_t end_us = start_us_ + window_us_;
+    bool gap_counted = has_last_ && time_us > last_us_ && time_us - last_us_ <= kMaxFrameGapUs;
+    if (gap_counted) {
+        state_us_[static_cast<size_t>(last_state_)] += std::min(time_us, end_us) - last_us_;
+    }
+
+    bool closed = false;
+    if (time_us >= end_us) {
+        if (frames_ > 0) {
+            build(end_us);
+            closed = true;
+        }
+        // Skip windows the stream had no frames in
+        clear_window(end_us + (time_us - end_us) / window_us_ * window_us_);
+        if (gap_counted && last_us_ < start_us_) {
+            state_us_[static_cast<size_t>(last_state_)] += time_us - start_us_;
+        }
+    }
+
+    ++frames_;
+    float score = std::clamp(result.focus_score, 0.0f, 1.0f);
+    score_sum_ += score;
+    score_min_ = std::min(score_min_, score);
+    score_max_ = std::max(score_max_, score);
+    ++score_bins_[static_cast<size_t>(std::lround(score * (kScoreBins - 1)))];
+    if (metrics.is_blinking && !last_blinking_) ++blinks_;
+    if (has_last_ && result.state != last_state_) ++transitions_;
+
+    has_last_ = true;
+    last_us_ = time_us;
+    last_state_ = result.state;
+    last_blinking_ = metrics.is_blinking;
+    return closed;
+}
+
+bool FocusSummary::flush() {
+    if (!open_ || frames_ == 0) return false;
+    build(std::max(last_us_, start_us_ + 1));
+    open_ = false;
+    return true;
+}
+
+void FocusSummary::reset() {
+    open_ = false;
+    has_last_ = false;
+    last_blinking_ = false;
+    last_state_ = FocusState::UNKNOWN;
+}
+
+void FocusSummary::clear_window(int64_t start_us) {
+    start_us_ = start_us;
+    frames_ = 0;
+    score_sum_ = 0.0;
+    score_min_ = 1.0f;
+    score_max_ = 0.0f;
+    score_bins_.fill(0);
+    state_us_.fill(0);
+    blinks_ = 0;
+    transitions_ = 0;
+}
+
+// The score below which `fraction` of the window's frames fall, to the
+// histogram's resolution
+float FocusSummary::percentile(float fraction) const {
+    uint64_t rank = static_cast<uint64_t>(std::ceil(fraction * frames_));
+    rank = std::max<uint64_t>(rank, 1);
+    uint64_t seen = 0;
+    for (size_t bin = 0; bin < kScoreBins; ++bin) {
+        seen += score_bins_[bin];
+        if (seen >= rank) return static_cast<float>(bin) / (kScoreBins - 1);
+    }
+    return 1.0f;
+}
+
+void FocusSummary::build(int64_t end_us) {
+    std::string score;
+    JsonWriter score_writer(score);
+    score_writer.begin_object();
+    score_writer.field("mean", static_cast<float>(score_sum_ / frames_), 3);
+    score_writer.field("min", score_min_, 3);
+    score_writer.field("max", score_max_, 3);
+    score_writer.field("p10", percentile(0.10f), 2);
+    score_writer.field("p50", percentile(0.50f), 2);
+    score_writer.field("p90", percentile(0.90f), 2);
+    score_writer.end_object();
+
+    std::string states;
+    JsonWriter state_writer(states);
+    state_writer.begin_object();
+    int64_t covered_us = 0;
+    size_t dominant = static_cast<size_t>(FocusState::UNKNOWN);
+    for (size_t i = 0; i < kStates; ++i) {
+        covered_us += state_us_[i];
+        if (state_us_[i] > state_us_[dominant]) dominant = i;
+        if (state_us_[i] > 0) {
+            state_writer.field(focus_state_to_string(static_cast<FocusState>(i)),
+                               static_cast<float>(state_us_[i] / 1e6), 2);
+        }
+    }
+    state_writer.end_object();
+    // A single-frame window has no time in it yet: report the frame's state
+    if (covered_us == 0) dominant = static_cast<size_t>(last_state_);
+
+    float span_min = static_cast<float>(end_us - start_us_) / 60e6f;
+
+    payload_.clear();
+    JsonWriter writer(payload_);
+    writer.begin_object();
+    writer.field("start_us", start_us_);
+    writer.field("end_us", end_us);
+    writer.field("frames", static_cast<int64_t>(frames_));
+    writer.field("covered_s", static_cast<float>(covered_us / 1e6), 2);
+    writer.raw_field("focus_score", score);
+    writer.raw_field("state_s", states);
+    writer.field("dominant_state", focus_state_to_string(static_cast<FocusState>(dominant)));
+    writer.field("blinks", static_cast<int64_t>(blinks_));
+    writer.field("blinks_per_min", span_min > 0.0f ? blinks_ / span_min : 0.0f, 1);
+    writer.field("transitions", static_cast<int64_t>(transitions_));
+    writer.end_object();
+}
+
+} // namespace focus_wizard
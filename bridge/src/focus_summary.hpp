@@ -0,0 +1,98 @@
+/**
+ * focus_summary.hpp — Windowed focus aggregates for --emit=summary
+ *
+ * Consumers that only chart or log focus don't need an edge message per
+ * frame. FocusSummary folds every analyzed frame into a window of
+ * window_s seconds (frame time) and, once the window is over, builds one
+ * compact `summary` record:
+ *
+ *   { "start_us", "end_us", "frames", "covered_s",
+ *     "focus_score": { "mean", "min", "max", "p10", "p50", "p90" },
+ *     "state_s": { "<state>": seconds, ... }, "dominant_state",
+ *     "blinks", "blinks_per_min", "transitions" }
+ *
+ * Percentiles come from a fixed 0.01-wide score histogram, so a window
+ * costs the same memory whatever its length. A frame's time counts
+ * towards the state it was in until the next frame; gaps longer than
+ * kMaxFrameGapUs (camera paused, face lost by the SDK) are not counted.
+ * A window with no frames in it produces no record.
+ *
+ * Threading: edge callback only.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "focus_analyzer.hpp"
+#include "metrics_collector.hpp"
+
+namespace focus_wizard {
+
+struct FocusSummaryOptions {
+    float window_s = 10.0f;
+};
+
+class FocusSummary {
+public:
+    explicit FocusSummary(FocusSummaryOptions options = {});
+
+    /**
+     * Fold one analyzed frame in; `time_us` is the frame's timestamp.
+     * Returns true when the frame closed a window, whose record is then
+     * in json().
+     */
+    bool add(const FocusMetrics& metrics, const FocusResult& result, int64_t time_us);
+
+    /**
+     * Close the open window early (shutdown). Returns false if it holds
+     * no frames.
+     */
+    bool flush();
+
+    /**
+     * Forget the open window and the previous frame.
+     */
+    void reset();
+
+    /**
+     * The record of the last window closed. Valid until the next add().
+     */
+    std::string_view json() const { return payload_; }
+
+private:
+    static constexpr size_t kStates = static_cast<size_t>(FocusState::UNKNOWN) + 1;
+    static constexpr size_t kScoreBins = 101;  // 0.00 .. 1.00
+
+    void build(int64_t end_us);
+    void clear_window(int64_t start_us);
+    float percentile(float fraction) const;
+
+    const int64_t window_us_;
+
+    // Open window
+    bool open_ = false;
+    int64_t start_us_ = 0;
+    uint32_t frames_ = 0;
+    double score_sum_ = 0.0;
+    float score_min_ = 1.0f;
+    float score_max_ = 0.0f;
+    std::array<uint32_t, kScoreBins> score_bins_{};
+    std::array<int64_t, kStates> state_us_{};
+    uint32_t blinks_ = 0;
+    uint32_t transitions_ = 0;
+
+    // Previous frame
+    bool has_last_ = false;
+    int64_t last_us_ = 0;
+    FocusState last_state_ = FocusState::UNKNOWN;
+    bool last_blinking_ = false;
+
+    std::string payload_;
+};
+
+} // namespace focus_wizard
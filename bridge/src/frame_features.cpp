@@ -0,0 +1,194 @@
+/**
+ * frame_features.cpp — Implementation
+ */
+
+#include "frame_features.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include <opencv2/imgproc.hpp>
+
+namespace focus_wizard {
+
+namespace {
+
+// Luma at or beyond these counts as crushed / blown out
+constexpr int kBlackLevel = 6;
+constexpr int kWhiteLevel = 249;
+
+// Area-resample `input` to `width` pixels wide into `out`, keeping the
+// aspect ratio. `out` keeps its buffer while the size stays the same.
+void resample(const cv::Mat& input, int width, cv::Mat* out) {
+    width = std::min(width, input.cols);
+    int height = std::max(1, static_cast<int>(std::lround(
+        static_cast<double>(input.rows) * width / input.cols)));
+    cv::resize(input, *out, cv::Size(width, height), 0.0, 0.0, cv::INTER_AREA);
+}
+
+} // namespace
+
+FrameFeatureStage::FrameFeatureStage(FrameFeatureOptions options)
+    : options_(options)
+{
+}
+
+FrameFeatureStage::~FrameFeatureStage() {
+    stop();
+}
+
+void FrameFeatureStage::start() {
+    if (thread_.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = false;
+        has_pending_ = false;
+    }
+    thread_ = std::thread([this] { run(); });
+}
+
+void FrameFeatureStage::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_cv_.notify_one();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+// ── Video Callback ───────────────────────────────────────
+
+void FrameFeatureStage::submit(const cv::Mat& frame, int64_t timestamp_us) {
+    if (frame.empty() || frame.depth() != CV_8U) return;
+    if (options_.interval_frames > 1 && frames_seen_++ % options_.interval_frames != 0) return;
+
+    filling_.timestamp_us = timestamp_us;
+    resample(frame, options_.sample_width, &filling_.frame);
+
+    // The face box, clamped to the frame, as a view into the same buffer
+    FaceRoi roi = face_roi_.load();
+    cv::Rect box(static_cast<int>(roi.x), static_cast<int>(roi.y),
+                 static_cast<int>(roi.width), static_cast<int>(roi.height));
+    box &= cv::Rect(0, 0, frame.cols, frame.rows);
+    filling_.has_roi = box.width >= 8 && box.height >= 8;
+    if (filling_.has_roi) {
+        // Fixed size whatever the box's shape, so the buffer is reused
+        cv::resize(frame(box), filling_.roi, cv::Size(options_.roi_width, options_.roi_width),
+                   0.0, 0.0, cv::INTER_AREA);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (has_pending_) replaced_.fetch_add(1, std::memory_order_relaxed);
+        std::swap(filling_, pending_);
+        has_pending_ = true;
+    }
+    wake_cv_.notify_one();
+}
+
+// ── Edge Callback ────────────────────────────────────────
+
+void FrameFeatureStage::update_face_roi(const presage::physiology::Metrics& metrics) {
+    FaceRoi roi;
+    if (metrics.has_face() && !metrics.face().landmarks().empty()) {
+        const auto& points = *metrics.face().landmarks().rbegin();
+        if (points.value_size() > 0) {
+            float min_x = points.value(0).x(), max_x = min_x;
+            float min_y = points.value(0).y(), max_y = min_y;
+            for (int i = 1; i < points.value_size(); ++i) {
+                const auto& point = points.value(i);
+                min_x = std::min(min_x, point.x());
+                max_x = std::max(max_x, point.x());
+                min_y = std::min(min_y, point.y());
+                max_y = std::max(max_y, point.y());
+            }
+            roi = FaceRoi{min_x, min_y, max_x - min_x, max_y - min_y};
+        }
+    }
+    face_roi_.store(roi);
+}
+
+void FrameFeatureStage::apply(FocusMetrics* metrics) const {
+    FrameFeatures features = published_.load();
+    if (features.timestamp_us == 0) return;
+    metrics->brightness         = features.brightness;
+    metrics->motion             = features.motion;
+    metrics->sharpness          = features.sharpness;
+    metrics->roi_exposure       = features.roi_exposure;
+    metrics->low_quality_frame  = features.low_quality;
+    metrics->has_frame_features = true;
+}
+
+// ── Worker ───────────────────────────────────────────────
+
+void FrameFeatureStage::run() {
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_cv_.wait(lock, [this] { return stopping_ || has_pending_; });
+            if (stopping_) return;
+            std::swap(pending_, working_);
+            has_pending_ = false;
+        }
+        analyze(working_);
+    }
+}
+
+void FrameFeatureStage::to_gray(const cv::Mat& input, cv::Mat* gray) {
+    switch (input.channels()) {
+        case 1:  input.copyTo(*gray); break;
+        case 3:  cv::cvtColor(input, *gray, cv::COLOR_BGR2GRAY); break;
+        case 4:  cv::cvtColor(input, *gray, cv::COLOR_BGRA2GRAY); break;
+        default: gray->release(); break;
+    }
+}
+
+void FrameFeatureStage::analyze(const Sample& sample) {
+    to_gray(sample.frame, &gray_);
+    if (gray_.empty()) return;
+
+    FrameFeatures features;
+    features.timestamp_us = sample.timestamp_us;
+    features.brightness = static_cast<float>(cv::mean(gray_)[0] / 255.0);
+
+    if (previous_gray_.size() == gray_.size()) {
+        cv::absdiff(gray_, previous_gray_, diff_);
+        features.motion = static_cast<float>(cv::mean(diff_)[0] / 255.0);
+    }
+    std::swap(gray_, previous_gray_);
+
+    if (sample.has_roi) {
+        to_gray(sample.roi, &roi_gray_);
+        if (!roi_gray_.empty()) {
+            features.has_roi = true;
+
+            cv::Scalar mean, stddev;
+            cv::Laplacian(roi_gray_, laplacian_, CV_16S);
+            cv::meanStdDev(laplacian_, mean, stddev);
+            features.sharpness = static_cast<float>(stddev[0] * stddev[0]);
+
+            features.roi_exposure = static_cast<float>(cv::mean(roi_gray_)[0] / 255.0);
+            cv::inRange(roi_gray_, cv::Scalar(kBlackLevel), cv::Scalar(kWhiteLevel), in_range_);
+            double total = static_cast<double>(roi_gray_.total());
+            features.roi_clipped = static_cast<float>(
+                1.0 - cv::countNonZero(in_range_) / total);
+        }
+    }
+
+    const FrameFeatureOptions& gate = options_;
+    features.low_quality =
+        (gate.min_brightness > 0.0f && features.brightness < gate.min_brightness) ||
+        (gate.max_motion > 0.0f && features.motion > gate.max_motion) ||
+        (features.has_roi && gate.min_sharpness > 0.0f &&
+         features.sharpness < gate.min_sharpness) ||
+        (features.has_roi && gate.max_roi_clipped > 0.0f &&
+         features.roi_clipped > gate.max_roi_clipped);
+
+    published_.store(features);
+    analyzed_.fetch_add(1, std::memory_order_relaxed);
+    if (features.low_quality) low_quality_.fetch_add(1, std::memory_order_relaxed);
+}
+
+} // namespace focus_wizard
@@ -0,0 +1,182 @@
+/**
+ * frame_features.hpp — Cheap per-frame image features off the graph thread
+ *
+ * The SDK hands every processed frame to the video callback and the
+ * bridge otherwise ignores the pixels. FrameFeatureStage takes a few
+ * image statistics from them that the face mesh doesn't give us:
+ *
+ *   brightness     mean luma of the whole frame, 0..1
+ *   motion         mean absolute luma change since the previous sample, 0..1
+ *   sharpness      variance of the Laplacian over the face box (blur)
+ *   roi_exposure   mean luma of the face box, 0..1
+ *   roi_clipped    share of face-box pixels crushed to black or blown out
+ *
+ * The video callback only reads the frame in place: the whole frame and
+ * the face box (a cv::Mat header into the same buffer) are area-resampled
+ * straight into sample buffers that are reused from frame to frame: the
+ * frame sample_width pixels wide, the box to a roi_width square. Nothing
+ * full-size is copied or converted. The buffers are
+ * handed to a worker thread by swapping Mat headers under a short lock;
+ * if the worker is still busy the older sample is replaced, so the
+ * callback never waits. The worker does the color conversion and the
+ * statistics with OpenCV's vectorized kernels (cv::resize, cvtColor,
+ * Laplacian, meanStdDev, absdiff, inRange all dispatch to the HAL /
+ * universal intrinsics) and publishes the result through a SeqLock.
+ *
+ * A sample below min_brightness or min_sharpness, above max_roi_clipped
+ * or (if enabled) above max_motion is flagged low_quality; FocusAnalyzer holds its
+ * state through such frames instead of reading gaze and blinks off them.
+ *
+ * The face box is the bounding box of the landmarks in the edge metrics,
+ * so it trails the frame by the graph latency.
+ *
+ * Threading: submit() from the video callback, update_face_roi() and
+ * apply() from the edge callback, latest() from any thread.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+#include <opencv2/core.hpp>
+#include <physiology/modules/messages/metrics.h>
+
+#include "metrics_collector.hpp"
+#include "seqlock.hpp"
+
+namespace focus_wizard {
+
+struct FrameFeatureOptions {
+    // Sample sizes: frame width (height keeps the aspect ratio) and the
+    // side of the square the face box is resampled to
+    int sample_width = 160;
+    int roi_width = 96;
+
+    // Take a sample every Nth frame
+    int interval_frames = 1;
+
+    // Low-quality gates; 0 disables one. Sharpness is measured at
+    // roi_width, so its scale depends on it. Motion is off by default:
+    // turning away or standing up moves the whole frame too, and holding
+    // the state through that would hide the transition it causes.
+    float min_brightness = 0.08f;
+    float min_sharpness = 12.0f;
+    float max_roi_clipped = 0.3f;
+    float max_motion = 0.0f;
+};
+
+struct FrameFeatures {
+    int64_t timestamp_us = 0;   // frame the sample was taken from; 0 = none yet
+    float brightness = 0.0f;
+    float motion = 0.0f;
+    bool has_roi = false;       // the rest need a face box
+    float sharpness = 0.0f;
+    float roi_exposure = 0.0f;
+    float roi_clipped = 0.0f;
+    bool low_quality = false;
+};
+
+class FrameFeatureStage {
+public:
+    explicit FrameFeatureStage(FrameFeatureOptions options = {});
+    ~FrameFeatureStage();
+
+    FrameFeatureStage(const FrameFeatureStage&) = delete;
+    FrameFeatureStage& operator=(const FrameFeatureStage&) = delete;
+
+    /**
+     * Start the worker thread.
+     */
+    void start();
+
+    /**
+     * Stop and join the worker. Safe to call twice.
+     */
+    void stop();
+
+    // ── Video callback ───────────────────────────────────
+
+    /**
+     * Sample `frame` (8-bit gray, BGR or BGRA) for the worker. Reads the
+     * frame in place and never blocks on the worker.
+     */
+    void submit(const cv::Mat& frame, int64_t timestamp_us);
+
+    // ── Edge callback ────────────────────────────────────
+
+    /**
+     * Take the face box from the newest landmarks in `metrics`; without a
+     * face the box is cleared.
+     */
+    void update_face_roi(const presage::physiology::Metrics& metrics);
+
+    /**
+     * Copy the latest features into `metrics` for the analyzer.
+     */
+    void apply(FocusMetrics* metrics) const;
+
+    // ── Any thread ───────────────────────────────────────
+
+    FrameFeatures latest() const { return published_.load(); }
+
+    uint64_t analyzed() const { return analyzed_.load(std::memory_order_relaxed); }
+    uint64_t replaced() const { return replaced_.load(std::memory_order_relaxed); }
+    uint64_t low_quality() const { return low_quality_.load(std::memory_order_relaxed); }
+
+private:
+    struct FaceRoi {
+        float x = 0.0f;
+        float y = 0.0f;
+        float width = 0.0f;
+        float height = 0.0f;
+    };
+
+    // One resampled frame; buffers are reused from sample to sample
+    struct Sample {
+        int64_t timestamp_us = 0;
+        bool has_roi = false;
+        cv::Mat frame;
+        cv::Mat roi;
+    };
+
+    void run();
+    void analyze(const Sample& sample);
+    static void to_gray(const cv::Mat& input, cv::Mat* gray);
+
+    const FrameFeatureOptions options_;
+
+    SeqLock<FaceRoi> face_roi_;
+    SeqLock<FrameFeatures> published_;
+
+    // Video callback only
+    Sample filling_;
+    uint64_t frames_seen_ = 0;
+
+    // Handoff, under mutex_
+    std::mutex mutex_;
+    std::condition_variable wake_cv_;
+    Sample pending_;
+    bool has_pending_ = false;
+    bool stopping_ = false;
+
+    // Worker only
+    Sample working_;
+    cv::Mat gray_;
+    cv::Mat previous_gray_;
+    cv::Mat diff_;
+    cv::Mat roi_gray_;
+    cv::Mat laplacian_;
+    cv::Mat in_range_;
+
+    std::atomic<uint64_t> analyzed_{0};
+    std::atomic<uint64_t> replaced_{0};
+    std::atomic<uint64_t> low_quality_{0};
+
+    std::thread thread_;
+};
+
+} // namespace focus_wizard
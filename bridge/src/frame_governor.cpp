@@ -0,0 +1,171 @@
+/**
+ * frame_governor.cpp — Implementation
+ */
+
+#include "frame_governor.hpp"
+
+#include <algorithm>
+
+namespace focus_wizard {
+
+namespace {
+
+// Latency feedback: smallest throttle applied, and how often it may change
+constexpr int64_t kMinThrottleUs    = 1000000 / 30;
+constexpr int64_t kAdjustIntervalUs = 500000;
+
+int64_t fps_to_interval_us(float fps) {
+    return fps > 0.0f ? static_cast<int64_t>(1e6f / fps) : 0;
+}
+
+} // namespace
+
+const char* governor_level_to_string(GovernorLevel level) {
+    switch (level) {
+        case GovernorLevel::FULL:   return "full";
+        case GovernorLevel::STABLE: return "stable";
+        case GovernorLevel::IDLE:   return "idle";
+    }
+    return "full";
+}
+
+FrameGovernor::FrameGovernor(FrameGovernorOptions options)
+    : options_(options)
+    , stable_interval_us_(fps_to_interval_us(options.stable_fps))
+    , idle_interval_us_(fps_to_interval_us(options.idle_fps))
+{
+}
+
+// ── Analysis Side ────────────────────────────────────────
+
+void FrameGovernor::observe(FocusState state, bool face_detected, int64_t now_us) {
+    if (!has_state_ || state != state_) {
+        state_ = state;
+        state_since_us_ = now_us;
+        has_state_ = true;
+    }
+
+    GovernorLevel next;
+    if (state == FocusState::AWAY) {
+        // A face in view means the user is coming back: don't wait for the
+        // analyzer to leave AWAY before restoring the full rate
+        next = face_detected ? GovernorLevel::FULL : GovernorLevel::IDLE;
+    } else if (state != FocusState::UNKNOWN &&
+               now_us - state_since_us_ >= static_cast<int64_t>(options_.stable_after_s * 1e6f)) {
+        next = GovernorLevel::STABLE;
+    } else {
+        next = GovernorLevel::FULL;
+    }
+
+    GovernorLevel previous = level_.exchange(next, std::memory_order_relaxed);
+    if (next == GovernorLevel::FULL && previous != GovernorLevel::FULL) {
+        level_epoch_.fetch_add(1, std::memory_order_release);
+    }
+}
+
+void FrameGovernor::frame_processed(int64_t frame_timestamp_us, int64_t now_us) {
+    int64_t submitted_us = -1;
+    {
+        std::lock_guard<std::mutex> lock(submissions_mutex_);
+        for (Submission& submission : submissions_) {
+            if (submission.frame_timestamp_us == frame_timestamp_us) {
+                submitted_us = submission.submitted_us;
+                submission.frame_timestamp_us = -1;
+                break;
+            }
+        }
+    }
+    if (submitted_us < 0) return; // not admitted through us, or already evicted
+
+    // EMA over ~8 frames
+    int64_t latency = std::max<int64_t>(0, now_us - submitted_us);
+    int64_t average = latency_us_.load(std::memory_order_relaxed);
+    average += (latency - average) / 8;
+    latency_us_.store(average, std::memory_order_relaxed);
+
+    if (options_.latency_budget_ms <= 0.0f || now_us - last_adjust_us_ < kAdjustIntervalUs) {
+        return;
+    }
+    last_adjust_us_ = now_us;
+
+    int64_t budget = static_cast<int64_t>(options_.latency_budget_ms * 1000.0f);
+    int64_t throttle = throttle_us_.load(std::memory_order_relaxed);
+    if (average > budget) {
+        throttle = std::max(kMinThrottleUs, throttle + throttle / 4);
+        if (idle_interval_us_ > 0) throttle = std::min(throttle, idle_interval_us_);
+    } else if (average < budget / 2 && throttle > 0) {
+        // Back off gently, recover quickly
+        throttle /= 2;
+        if (throttle < kMinThrottleUs) throttle = 0;
+    }
+    throttle_us_.store(throttle, std::memory_order_relaxed);
+}
+
+// ── Capture Side ─────────────────────────────────────────
+
+int64_t FrameGovernor::interval_us() const {
+    int64_t interval = 0;
+    switch (level()) {
+        case GovernorLevel::FULL:   interval = 0; break;
+        case GovernorLevel::STABLE: interval = stable_interval_us_; break;
+        case GovernorLevel::IDLE:   interval = idle_interval_us_; break;
+    }
+    return std::max(interval, throttle_us_.load(std::memory_order_relaxed));
+}
+
+float FrameGovernor::scale() const {
+    switch (level()) {
+        case GovernorLevel::FULL:   return 1.0f;
+        case GovernorLevel::STABLE: return options_.stable_scale;
+        case GovernorLevel::IDLE:   return options_.idle_scale;
+    }
+    return 1.0f;
+}
+
+bool FrameGovernor::take_ramp_up() {
+    uint64_t epoch = level_epoch_.load(std::memory_order_acquire);
+    if (epoch == seen_epoch_) return false;
+    seen_epoch_ = epoch;
+    return true;
+}
+
+bool FrameGovernor::admit(int64_t frame_timestamp_us, int64_t now_us) {
+    if (take_ramp_up()) next_due_us_ = 0;
+
+    int64_t interval = interval_us();
+    if (interval > 0) {
+        if (now_us < next_due_us_) {
+            skipped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        // Stay on the schedule unless we fell a whole interval behind it
+        next_due_us_ = (now_us - next_due_us_ > interval) ? now_us + interval
+                                                          : next_due_us_ + interval;
+    } else {
+        next_due_us_ = 0;
+    }
+
+    record_submit(frame_timestamp_us, now_us);
+    return true;
+}
+
+int64_t FrameGovernor::pace(int64_t frame_timestamp_us, int64_t now_us) {
+    record_submit(frame_timestamp_us, now_us);
+    if (take_ramp_up()) next_due_us_ = 0;
+
+    int64_t interval = interval_us();
+    if (interval == 0) {
+        next_due_us_ = 0;
+        return 0;
+    }
+    next_due_us_ = std::max(now_us, next_due_us_) + interval;
+    return next_due_us_ - now_us;
+}
+
+void FrameGovernor::record_submit(int64_t frame_timestamp_us, int64_t now_us) {
+    std::lock_guard<std::mutex> lock(submissions_mutex_);
+    submissions_[submissions_next_] = {frame_timestamp_us, now_us};
+    submissions_next_ = (submissions_next_ + 1) % submissions_.size();
+}
+
+} // namespace focus_wizard
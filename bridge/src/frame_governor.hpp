@@ -0,0 +1,156 @@
+/**
+ * frame_governor.hpp — Adaptive processed-frame-rate and resolution control
+ *
+ * Running the full graph on every 720p frame is wasted work once the focus
+ * state has been steady for minutes, and pure waste while the user is
+ * away. The governor picks one of three levels from the analyzer's output:
+ *
+ *   FULL    every frame, full resolution — the default, and the level the
+ *           governor jumps back to as soon as a face reappears or the state
+ *           changes or is UNKNOWN
+ *   STABLE  the same non-UNKNOWN state for stable_after_s: stable_fps
+ *   IDLE    AWAY with no face in view: idle_fps, optionally downscaled
+ *
+ * Independently, the end-to-end latency of admitted frames (admission to
+ * edge callback) is tracked; while it exceeds the budget the admitted rate
+ * is throttled further, and recovers once latency falls back.
+ *
+ * Two ways to apply the decision, depending on who owns the capture loop:
+ *
+ *   admit()   drop a frame before it reaches the SDK (FrameVideoSource)
+ *   pace()    sleep the SDK's own capture loop (local camera)
+ *
+ * Threading: observe()/frame_processed() are called from the edge metrics
+ * callback, admit()/pace() from the capture thread; the shared level and
+ * throttle are atomics. Times are passed in (microseconds, one monotonic
+ * clock) so the policy is deterministic under test and replay.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+#include "focus_analyzer.hpp"
+
+namespace focus_wizard {
+
+enum class GovernorLevel : uint8_t {
+    FULL   = 0,
+    STABLE = 1,
+    IDLE   = 2,
+};
+
+const char* governor_level_to_string(GovernorLevel level);
+
+/**
+ * Microseconds on the steady clock, the time base live callers pass in.
+ */
+inline int64_t governor_clock_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct FrameGovernorOptions {
+    // Processed frame rate once the state has been stable. Keep this high
+    // enough to catch blinks (~100-400 ms) or the blink rate drifts low.
+    float stable_fps = 15.0f;
+    float stable_after_s = 120.0f;
+
+    // Processed frame rate while AWAY
+    float idle_fps = 2.0f;
+
+    // Downscale factor per level where the bridge owns the frames
+    // (shm/net/multi modes); 1 = full resolution
+    float stable_scale = 1.0f;
+    float idle_scale = 0.5f;
+
+    // Throttle further while admitted frames take longer than this to come
+    // out of the graph. 0 disables latency feedback.
+    float latency_budget_ms = 250.0f;
+};
+
+class FrameGovernor {
+public:
+    explicit FrameGovernor(FrameGovernorOptions options = {});
+
+    // ── Analysis side (edge callback) ────────────────────
+
+    /**
+     * Feed the analyzer's current state for one processed frame.
+     */
+    void observe(FocusState state, bool face_detected, int64_t now_us);
+
+    /**
+     * Report that the frame admitted with `frame_timestamp_us` has come out
+     * of the graph, for latency feedback.
+     */
+    void frame_processed(int64_t frame_timestamp_us, int64_t now_us);
+
+    // ── Capture side ─────────────────────────────────────
+
+    /**
+     * Decide whether to hand this frame to the SDK. Frames that are not
+     * admitted are counted in skipped().
+     */
+    bool admit(int64_t frame_timestamp_us, int64_t now_us);
+
+    /**
+     * For capture loops the bridge doesn't own: record that this frame was
+     * submitted and return how long (us) to wait before taking the next.
+     */
+    int64_t pace(int64_t frame_timestamp_us, int64_t now_us);
+
+    /**
+     * Downscale factor to apply to admitted frames (1 = none).
+     */
+    float scale() const;
+
+    /**
+     * Current minimum interval between processed frames (0 = every frame).
+     */
+    int64_t interval_us() const;
+
+    GovernorLevel level() const { return level_.load(std::memory_order_relaxed); }
+    float latency_ms() const { return latency_us_.load(std::memory_order_relaxed) / 1000.0f; }
+    uint64_t skipped() const { return skipped_.load(std::memory_order_relaxed); }
+
+private:
+    void record_submit(int64_t frame_timestamp_us, int64_t now_us);
+    bool take_ramp_up();
+
+    FrameGovernorOptions options_;
+    int64_t stable_interval_us_;
+    int64_t idle_interval_us_;
+
+    // Written by observe()/frame_processed(), read by the capture side
+    std::atomic<GovernorLevel> level_{GovernorLevel::FULL};
+    std::atomic<int64_t> throttle_us_{0};
+    std::atomic<int64_t> latency_us_{0};
+    std::atomic<uint64_t> level_epoch_{0};   // bumped on every return to FULL
+
+    // Analysis side only
+    FocusState state_ = FocusState::UNKNOWN;
+    int64_t state_since_us_ = 0;
+    bool has_state_ = false;
+    int64_t last_adjust_us_ = 0;
+
+    // Capture side only
+    int64_t next_due_us_ = 0;
+    uint64_t seen_epoch_ = 0;
+    std::atomic<uint64_t> skipped_{0};
+
+    // Admission times of recent frames, keyed by frame timestamp
+    struct Submission {
+        int64_t frame_timestamp_us = -1;
+        int64_t submitted_us = 0;
+    };
+    std::mutex submissions_mutex_;
+    std::array<Submission, 32> submissions_;
+    size_t submissions_next_ = 0;
+};
+
+} // namespace focus_wizard
@@ -0,0 +1,76 @@
+/**
+ * frame_provider.hpp — Source of externally produced webcam frames
+ *
+ * Implemented by the transports that receive frames from outside the
+ * process (the shared-memory ring, the network ingest server) and consumed
+ * by FrameVideoSource, which hands them to SmartSpectra.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace focus_wizard {
+
+enum class FramePixelFormat : uint32_t {
+    JPEG = 1,   // encoded; width/height/stride informational
+    RGBA = 2,   // 4 bytes per pixel (canvas ImageData)
+    BGR  = 3,   // 3 bytes per pixel (OpenCV native)
+};
+
+/**
+ * One received frame. `data` keeps its capacity between reads, so
+ * steady-state reads don't allocate.
+ */
+struct ReceivedFrame {
+    uint64_t sequence = 0;
+    int64_t timestamp_us = 0;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t stride = 0;
+    FramePixelFormat format = FramePixelFormat::JPEG;
+    std::vector<uint8_t> data;
+};
+
+/**
+ * True if a raw (RGBA / BGR) frame's geometry describes memory inside
+ * `data`: non-zero dimensions, rows at least `width` pixels apart, and the
+ * last row ending within the buffer. Frames come from other processes and
+ * network clients, so a view is never built over a frame that fails this.
+ */
+inline bool raw_frame_fits(const ReceivedFrame& frame, uint32_t bytes_per_pixel) {
+    constexpr uint64_t kMaxDimension = std::numeric_limits<int>::max();
+    if (frame.width == 0 || frame.height == 0) return false;
+    if (frame.width > kMaxDimension || frame.height > kMaxDimension) return false;
+    uint64_t row_bytes = static_cast<uint64_t>(frame.width) * bytes_per_pixel;
+    if (frame.stride < row_bytes) return false;
+    uint64_t needed = static_cast<uint64_t>(frame.stride) * (frame.height - 1) + row_bytes;
+    return frame.data.size() >= needed;
+}
+
+class FrameProvider {
+public:
+    virtual ~FrameProvider() = default;
+
+    /**
+     * Block until a frame newer than the last one read is available, or
+     * `timeout_ms` passes. Returns true if a new frame is available.
+     */
+    virtual bool wait(int timeout_ms) = 0;
+
+    /**
+     * Copy the newest frame into `frame`. Older unread frames are skipped —
+     * the pipeline wants the freshest image, not a backlog. Returns false
+     * if nothing new is available.
+     */
+    virtual bool read_latest(ReceivedFrame* frame) = 0;
+
+    /**
+     * Frames received but never read (superseded or corrupted).
+     */
+    virtual uint64_t skipped() const = 0;
+};
+
+} // namespace focus_wizard
@@ -0,0 +1,174 @@
+/**
+ * frame_ring.cpp — Implementation
+ */
+
+#include "frame_ring.hpp"
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace focus_wizard {
+
+namespace {
+
+// The ring is shared with another process, so there is no std::atomic
+// object to use; the GCC/Clang builtins give the same ordering on the raw
+// (8-byte aligned) words.
+uint64_t load_acquire(const uint8_t* p) {
+    return __atomic_load_n(reinterpret_cast<const uint64_t*>(p), __ATOMIC_ACQUIRE);
+}
+
+constexpr size_t kWriteSequenceOffset = offsetof(FrameRingHeader, write_sequence);
+
+} // namespace
+
+FrameRingReader::~FrameRingReader() {
+    close();
+}
+
+bool FrameRingReader::open(const std::string& ring_path, const std::string& doorbell_path,
+                           std::string* error) {
+    close();
+
+    int fd = ::open(ring_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        *error = "open " + ring_path + ": " + std::strerror(errno);
+        return false;
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(FrameRingHeader)) {
+        *error = ring_path + ": not a frame ring (too short)";
+        ::close(fd);
+        return false;
+    }
+
+    size_t size = static_cast<size_t>(st.st_size);
+    void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        *error = "mmap " + ring_path + ": " + std::strerror(errno);
+        return false;
+    }
+    base_ = static_cast<uint8_t*>(mapped);
+    size_ = size;
+
+    FrameRingHeader header;
+    std::memcpy(&header, base_, sizeof(header));
+    size_t slot_stride = sizeof(FrameSlotHeader) + header.slot_bytes;
+    if (std::memcmp(header.magic, kFrameRingMagic, sizeof(header.magic)) != 0 ||
+        header.version != kFrameRingVersion) {
+        *error = ring_path + ": not a frame ring (bad magic or version)";
+        close();
+        return false;
+    }
+    if (header.slot_count == 0 || header.slot_bytes % 64 != 0 ||
+        sizeof(FrameRingHeader) + header.slot_count * slot_stride > size_) {
+        *error = ring_path + ": frame ring header doesn't match the file size";
+        close();
+        return false;
+    }
+    slot_count_ = header.slot_count;
+    slot_bytes_ = header.slot_bytes;
+
+    // Start from whatever is already published; don't replay stale frames
+    last_read_ = write_sequence();
+
+    // The doorbell is opened read-write so it never reports POLLHUP when
+    // the producer closes (or hasn't opened) its end.
+    if (::mkfifo(doorbell_path.c_str(), 0600) != 0 && errno != EEXIST) {
+        *error = "mkfifo " + doorbell_path + ": " + std::strerror(errno);
+        close();
+        return false;
+    }
+    doorbell_fd_ = ::open(doorbell_path.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if (doorbell_fd_ < 0) {
+        *error = "open " + doorbell_path + ": " + std::strerror(errno);
+        close();
+        return false;
+    }
+    return true;
+}
+
+uint64_t FrameRingReader::write_sequence() const {
+    return load_acquire(base_ + kWriteSequenceOffset);
+}
+
+bool FrameRingReader::wait(int timeout_ms) {
+    if (write_sequence() > last_read_) return true;
+
+    struct pollfd pfd{doorbell_fd_, POLLIN, 0};
+    int ready = ::poll(&pfd, 1, timeout_ms);
+    if (ready > 0) drain_doorbell();
+    return write_sequence() > last_read_;
+}
+
+void FrameRingReader::drain_doorbell() {
+    char sink[256];
+    while (::read(doorbell_fd_, sink, sizeof(sink)) > 0) {
+    }
+}
+
+bool FrameRingReader::read_latest(ReceivedFrame* frame) {
+    uint64_t newest = write_sequence();
+    if (newest <= last_read_) return false;
+
+    skipped_ += newest - last_read_ - 1;
+    last_read_ = newest;
+
+    size_t slot_stride = sizeof(FrameSlotHeader) + slot_bytes_;
+    const uint8_t* slot = base_ + sizeof(FrameRingHeader) +
+                          ((newest - 1) % slot_count_) * slot_stride;
+
+    if (load_acquire(slot) != newest) {
+        ++skipped_;
+        return false; // already being overwritten
+    }
+
+    FrameSlotHeader header;
+    std::memcpy(&header, slot, sizeof(header));
+    if (header.bytes > slot_bytes_) {
+        ++skipped_;
+        return false;
+    }
+
+    frame->data.resize(header.bytes);
+    std::memcpy(frame->data.data(), slot + sizeof(FrameSlotHeader), header.bytes);
+
+    // Producer lapped us mid-copy?
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (load_acquire(slot) != newest) {
+        ++skipped_;
+        return false;
+    }
+
+    frame->sequence = newest;
+    frame->timestamp_us = header.timestamp_us;
+    frame->width = header.width;
+    frame->height = header.height;
+    frame->stride = header.stride;
+    frame->format = static_cast<FramePixelFormat>(header.format);
+    return true;
+}
+
+void FrameRingReader::close() {
+    if (base_) {
+        ::munmap(base_, size_);
+        base_ = nullptr;
+        size_ = 0;
+    }
+    if (doorbell_fd_ >= 0) {
+        ::close(doorbell_fd_);
+        doorbell_fd_ = -1;
+    }
+}
+
+} // namespace focus_wizard
@@ -0,0 +1,112 @@
+/**
+ * frame_ring.hpp — Shared-memory webcam frame ring (reader side)
+ *
+ * Server mode used to hand every frame over as a JPEG file in a watched
+ * directory. With --mode=shm the Electron FrameWriter instead writes frames
+ * into a fixed ring of slots in a file under /dev/shm, and the bridge maps
+ * that file and reads the newest frame in place.
+ *
+ * Layout (little-endian):
+ *
+ *   FrameRingHeader                         64 bytes
+ *   { FrameSlotHeader, payload[slot_bytes] } x slot_count
+ *
+ * Producer protocol, per frame n (n starts at 1):
+ *   1. slot = (n - 1) % slot_count; set slot.sequence = 0
+ *   2. write payload, then the other slot header fields
+ *   3. set slot.sequence = n
+ *   4. set header.write_sequence = n
+ *
+ * A reader that sees slot.sequence == n both before and after copying the
+ * payload got a complete frame; otherwise the producer lapped it and the
+ * frame is skipped. The reader never writes to the ring.
+ *
+ * Doorbell: the producer writes one byte to a FIFO per frame so the reader
+ * can sleep in poll() instead of spinning. The bytes carry no data — the
+ * reader always re-checks write_sequence — so lost or coalesced wakeups are
+ * harmless. (A futex/eventfd would save the syscall, but the producer is
+ * Node.js, which can reach neither without a native addon.)
+ *
+ * Payloads are either encoded JPEG or raw pixels (RGBA / BGR), see
+ * FramePixelFormat in frame_provider.hpp.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "frame_provider.hpp"
+
+namespace focus_wizard {
+
+constexpr char     kFrameRingMagic[4] = {'F', 'W', 'F', 'R'};
+constexpr uint32_t kFrameRingVersion  = 1;
+
+#pragma pack(push, 1)
+struct FrameRingHeader {
+    char     magic[4];
+    uint32_t version;
+    uint32_t slot_count;
+    uint32_t slot_bytes;        // payload capacity per slot
+    uint64_t write_sequence;    // last published frame number (0 = none)
+    uint8_t  reserved[40];
+};
+
+struct FrameSlotHeader {
+    uint64_t sequence;          // frame number stored here (0 = being written)
+    int64_t  timestamp_us;
+    uint32_t width;
+    uint32_t height;
+    uint32_t stride;            // bytes per row (raw formats)
+    uint32_t format;            // FramePixelFormat
+    uint32_t bytes;             // payload length
+    uint8_t  reserved[28];
+};
+#pragma pack(pop)
+
+static_assert(sizeof(FrameRingHeader) == 64, "ring header layout is shared with frame-ring.ts");
+static_assert(sizeof(FrameSlotHeader) == 64, "slot header layout is shared with frame-ring.ts");
+
+class FrameRingReader : public FrameProvider {
+public:
+    FrameRingReader() = default;
+    ~FrameRingReader() override;
+
+    FrameRingReader(const FrameRingReader&) = delete;
+    FrameRingReader& operator=(const FrameRingReader&) = delete;
+
+    /**
+     * Map the ring at `ring_path` (created by the producer) and open the
+     * doorbell FIFO at `doorbell_path`, creating it if needed.
+     * On failure returns false and describes why in `error`.
+     */
+    bool open(const std::string& ring_path, const std::string& doorbell_path,
+              std::string* error);
+
+    bool wait(int timeout_ms) override;
+
+    /**
+     * Also returns false if the slot was overwritten while being copied.
+     */
+    bool read_latest(ReceivedFrame* frame) override;
+
+    uint64_t skipped() const override { return skipped_; }
+
+private:
+    uint64_t write_sequence() const;
+    void drain_doorbell();
+    void close();
+
+    uint8_t* base_ = nullptr;
+    size_t size_ = 0;
+    uint32_t slot_count_ = 0;
+    uint32_t slot_bytes_ = 0;
+    int doorbell_fd_ = -1;
+
+    uint64_t last_read_ = 0;
+    uint64_t skipped_ = 0;
+};
+
+} // namespace focus_wizard
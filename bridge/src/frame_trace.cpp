@@ -0,0 +1,141 @@
+/**
+ * frame_trace.cpp — Implementation
+ */
+
+#include "frame_trace.hpp"
+#include "json_writer.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace focus_wizard {
+
+namespace {
+
+// Indexed by TraceStage
+const char* const kStageNames[] = {"edge", "focus", "done"};
+const char* const kStageFields[] = {"edge_us", "focus_us", "done_us"};
+
+// Capture stamps past this (2001) are taken to be wall-clock time; camera
+// clocks count from boot or stream start
+constexpr int64_t kMinWallClockUs = 1'000'000'000'000'000;
+
+void write_span(JsonWriter& writer, const char* name, int64_t from_us, int64_t to_us) {
+    if (from_us <= 0 || to_us <= 0) return;
+    writer.field(name, static_cast<float>(to_us - from_us) / 1000.0f, 3);
+}
+
+} // namespace
+
+FrameTracer::~FrameTracer() {
+    close();
+}
+
+bool FrameTracer::open(const std::string& path, int every, std::string* error) {
+    close();
+    fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        *error = path + ": " + std::strerror(errno);
+        return false;
+    }
+    every_ = std::max(every, 1);
+
+    // Trace lines are rare; a small queue and a lazy flush are plenty
+    AsyncWriterOptions options;
+    options.queue_capacity = 64;
+    options.flush_interval_ms = 100;
+    options.flush_bytes = 4096;
+    writer_ = std::make_unique<AsyncWriter>(fd_, options);
+    return true;
+}
+
+void FrameTracer::close() {
+    writer_.reset();
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+// ── Video Callback ───────────────────────────────────────
+
+void FrameTracer::on_video(int64_t timestamp_us) {
+    if (!writer_ || frames_++ % static_cast<uint64_t>(every_) != 0) return;
+
+    std::lock_guard<std::mutex> lock(pending_mutex_);
+    pending_[pending_next_] = {timestamp_us, wall_clock_us()};
+    pending_next_ = (pending_next_ + 1) % pending_.size();
+    pending_count_.store(std::min(pending_count_.load(std::memory_order_relaxed) + 1,
+                                  pending_.size()),
+                         std::memory_order_release);
+}
+
+// ── Edge Callback ────────────────────────────────────────
+
+bool FrameTracer::begin(int64_t timestamp_us, int64_t callback_us) {
+    if (pending_count_.load(std::memory_order_acquire) == 0) return false;
+
+    std::lock_guard<std::mutex> lock(pending_mutex_);
+    // Frames the graph dropped never get an edge callback; their entries
+    // are overwritten as new frames are picked
+    for (Pending& pending : pending_) {
+        if (pending.timestamp_us != timestamp_us || pending.video_us == 0) continue;
+
+        capture_us_ = timestamp_us;
+        video_us_ = pending.video_us;
+        callback_us_ = callback_us;
+        stage_us_.fill(0);
+        pending = Pending();
+        pending_count_.store(pending_count_.load(std::memory_order_relaxed) - 1,
+                             std::memory_order_release);
+        return true;
+    }
+    return false;
+}
+
+void FrameTracer::mark(TraceStage stage) {
+    stage_us_[static_cast<size_t>(stage)] = wall_clock_us();
+}
+
+void FrameTracer::end() {
+    if (stage_us_[static_cast<size_t>(TraceStage::DONE)] == 0) mark(TraceStage::DONE);
+
+    // Spans in milliseconds; each stage against the one before it
+    spans_.clear();
+    JsonWriter spans(spans_);
+    spans.begin_object();
+    if (capture_us_ > kMinWallClockUs) {
+        write_span(spans, "capture_to_video", capture_us_, video_us_);
+    }
+    write_span(spans, "graph", video_us_, callback_us_);
+    int64_t previous_us = callback_us_;
+    for (size_t i = 0; i < stage_us_.size(); ++i) {
+        if (stage_us_[i] == 0) continue;
+        write_span(spans, kStageNames[i], previous_us, stage_us_[i]);
+        previous_us = stage_us_[i];
+    }
+    write_span(spans, "total", video_us_, previous_us);
+    spans.end_object();
+
+    line_.clear();
+    JsonWriter writer(line_);
+    writer.begin_object();
+    writer.field("capture_us", capture_us_);
+    writer.field("video_us", video_us_);
+    writer.field("callback_us", callback_us_);
+    for (size_t i = 0; i < stage_us_.size(); ++i) {
+        if (stage_us_[i] != 0) writer.field(kStageFields[i], stage_us_[i]);
+    }
+    writer.raw_field("spans_ms", spans_);
+    writer.end_object();
+    line_ += '\n';
+
+    writer_->submit(0, false, line_.data(), line_.size());
+    traced_.fetch_add(1, std::memory_order_relaxed);
+}
+
+} // namespace focus_wizard
@@ -0,0 +1,142 @@
+/**
+ * frame_trace.hpp — Capture-to-emit latency of the focus path
+ *
+ * Every edge/metrics/focus message carries three times (FocusMetrics and
+ * the JSON/binary writers fill them in):
+ *
+ *   capture_us   SDK timestamp of the frame (edge, focus) or batch
+ *                (metrics): the camera clock, or in server mode the
+ *                microsecond file name the relay wrote
+ *   callback_us  wall clock when the SDK callback started on it
+ *   emit_us      wall clock when the message was built for the emitter
+ *
+ * Wall-clock times are comparable with Date.now() * 1000 on the same
+ * host, so the receiver can split its observed age into SDK, bridge and
+ * transport time. capture_us is only on the same clock when the frame
+ * source stamps frames with wall-clock time.
+ *
+ * FrameTracer (--trace_every=N) follows one frame in N through the
+ * single-session pipeline and writes one NDJSON line of stage times and
+ * spans per traced frame to --trace_path:
+ *
+ *   video     video callback for the frame (SDK input side)
+ *   callback  edge callback for the same frame timestamp
+ *   edge      collector fold and "edge" message done
+ *   focus     analysis and "focus" message done
+ *   done      remaining callback work (cadence, governor) done
+ *
+ * Frames are picked in the video callback and matched in the edge
+ * callback by timestamp; untraced frames cost one relaxed atomic load.
+ * Lines go through an AsyncWriter, so neither callback blocks on the
+ * trace file.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "async_writer.hpp"
+
+namespace focus_wizard {
+
+/**
+ * Microseconds since the Unix epoch.
+ */
+inline int64_t wall_clock_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+enum class TraceStage : uint8_t {
+    EDGE  = 0,
+    FOCUS = 1,
+    DONE  = 2,
+};
+
+class FrameTracer {
+public:
+    FrameTracer() = default;
+    ~FrameTracer();
+
+    FrameTracer(const FrameTracer&) = delete;
+    FrameTracer& operator=(const FrameTracer&) = delete;
+
+    /**
+     * Trace one frame in `every`, writing to `path` (truncated).
+     * On failure returns false and describes why in `error`.
+     */
+    bool open(const std::string& path, int every, std::string* error);
+
+    /**
+     * Flush and close the trace file.
+     */
+    void close();
+
+    bool active() const { return writer_ != nullptr; }
+
+    /**
+     * Frames traced so far.
+     */
+    uint64_t traced() const { return traced_.load(std::memory_order_relaxed); }
+
+    // ── Video callback ───────────────────────────────────
+
+    /**
+     * Count the frame and pick it for tracing if it is due.
+     */
+    void on_video(int64_t timestamp_us);
+
+    // ── Edge callback ────────────────────────────────────
+
+    /**
+     * Start tracing the frame if on_video() picked it. Returns whether it
+     * did; only then call mark()/end().
+     */
+    bool begin(int64_t timestamp_us, int64_t callback_us);
+
+    void mark(TraceStage stage);
+
+    /**
+     * Write the frame's line.
+     */
+    void end();
+
+private:
+    static constexpr size_t kPendingFrames = 8;
+
+    struct Pending {
+        int64_t timestamp_us = 0;
+        int64_t video_us = 0;
+    };
+
+    int every_ = 0;
+    std::unique_ptr<AsyncWriter> writer_;
+    int fd_ = -1;
+
+    // Video callback only
+    uint64_t frames_ = 0;
+
+    // Picked frames waiting for their edge callback
+    std::mutex pending_mutex_;
+    std::array<Pending, kPendingFrames> pending_{};
+    size_t pending_next_ = 0;
+    std::atomic<size_t> pending_count_{0};
+
+    // Edge callback only: the frame being traced
+    int64_t capture_us_ = 0;
+    int64_t video_us_ = 0;
+    int64_t callback_us_ = 0;
+    std::array<int64_t, 3> stage_us_{};
+    std::string line_;
+    std::string spans_;
+
+    std::atomic<uint64_t> traced_{0};
+};
+
+} // namespace focus_wizard
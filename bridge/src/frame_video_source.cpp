@@ -0,0 +1,92 @@
+/**
+ * frame_video_source.cpp — Implementation
+ */
+
+#include "frame_video_source.hpp"
+
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+
+namespace focus_wizard {
+
+// How often a blocked read re-checks the stop flag
+static constexpr int kWaitSliceMs = 100;
+
+FrameVideoSource::FrameVideoSource(FrameProvider& provider, int width, int height,
+                                   const volatile std::sig_atomic_t* stop_flag)
+    : provider_(provider)
+    , stop_flag_(stop_flag)
+    , width_(width)
+    , height_(height)
+{
+}
+
+void FrameVideoSource::operator>>(cv::Mat& frame) {
+    while (!*stop_flag_) {
+        if (!provider_.wait(kWaitSliceMs)) continue;
+        if (!provider_.read_latest(&scratch_)) continue;
+
+        int64_t now = governor_clock_us();
+        bool watching = watch_ && watch_->active();
+        if (watching) {
+            PresenceWatch::Action action = watch_->next(now);
+            if (action == PresenceWatch::Action::DROP) continue;
+            if (action == PresenceWatch::Action::CHECK && !watch_->check(scratch_, now)) continue;
+        } else if (governor_ && !governor_->admit(scratch_.timestamp_us, now)) {
+            continue;
+        }
+
+        if (!convert(scratch_, frame)) {
+            ++undecodable_;
+            continue;
+        }
+        if (governor_ && !watching) {
+            float scale = governor_->scale();
+            if (scale > 0.0f && scale < 1.0f) {
+                // Fresh Mat: the SDK may still hold the previous frame's buffer
+                cv::Mat scaled;
+                cv::resize(frame, scaled, cv::Size(), scale, scale, cv::INTER_AREA);
+                frame = scaled;
+            }
+        }
+        timestamp_us_ = scratch_.timestamp_us;
+        width_ = frame.cols;
+        height_ = frame.rows;
+        return;
+    }
+    frame.release(); // end of stream
+}
+
+bool FrameVideoSource::convert(const ReceivedFrame& source, cv::Mat& frame) {
+    auto* data = const_cast<uint8_t*>(source.data.data());
+    int rows = static_cast<int>(source.height);
+    int cols = static_cast<int>(source.width);
+
+    // Fresh Mat on every path: writing into `frame` in place would reuse the
+    // previous frame's buffer, which the SDK may still hold
+    cv::Mat converted;
+    switch (source.format) {
+        case FramePixelFormat::JPEG: {
+            if (source.data.empty()) return false;
+            cv::Mat encoded(1, static_cast<int>(source.data.size()), CV_8UC1, data);
+            cv::imdecode(encoded, cv::IMREAD_COLOR, &converted);
+            break;
+        }
+        case FramePixelFormat::RGBA:
+            if (!raw_frame_fits(source, 4)) return false;
+            cv::cvtColor(cv::Mat(rows, cols, CV_8UC4, data, source.stride),
+                         converted, cv::COLOR_RGBA2BGR);
+            break;
+        case FramePixelFormat::BGR:
+            if (!raw_frame_fits(source, 3)) return false;
+            cv::Mat(rows, cols, CV_8UC3, data, source.stride).copyTo(converted);
+            break;
+        default:
+            return false;
+    }
+    if (converted.empty()) return false;
+    frame = converted;
+    return true;
+}
+
+} // namespace focus_wizard
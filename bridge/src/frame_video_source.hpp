@@ -0,0 +1,78 @@
+/**
+ * frame_video_source.hpp — SmartSpectra video source for external frames
+ *
+ * Adapts a FrameProvider (shared-memory ring, network ingest) to the SDK's
+ * VideoSource interface, so those modes feed the container directly
+ * instead of through file_stream's directory scan. JPEG payloads are
+ * decoded with cv::imdecode; raw RGBA/BGR payloads are converted or copied.
+ *
+ * With a FrameGovernor attached, frames it doesn't admit are dropped here,
+ * before the SDK sees them, and admitted frames are downscaled by its
+ * current scale factor. While a PresenceWatch is active it decides instead
+ * (keepalive frames, cheap presence checks, the rest dropped).
+ *
+ * operator>> blocks until the provider has a frame. It returns an empty
+ * frame (end of stream) once `stop_flag` is set, so SIGTERM still shuts
+ * the pipeline down while no frames are arriving.
+ */
+
+#pragma once
+
+#include <csignal>
+#include <cstdint>
+
+#include <opencv2/core.hpp>
+#include <smartspectra/video_source/video_source.hpp>
+
+#include "frame_governor.hpp"
+#include "frame_provider.hpp"
+#include "presence_watch.hpp"
+
+namespace focus_wizard {
+
+class FrameVideoSource : public presage::smartspectra::video_source::VideoSource {
+public:
+    /**
+     * `provider` must outlive the source. `width`/`height` are reported
+     * until the first frame arrives.
+     */
+    FrameVideoSource(FrameProvider& provider, int width, int height,
+                     const volatile std::sig_atomic_t* stop_flag);
+
+    /**
+     * Optional; must outlive the source. Set before the pipeline starts.
+     */
+    void set_governor(FrameGovernor* governor) { governor_ = governor; }
+    void set_presence_watch(PresenceWatch* watch) { watch_ = watch; }
+
+    bool SupportsExactFrameTimestamp() const override { return true; }
+    int64_t GetFrameTimestamp() const override { return timestamp_us_; }
+    void operator>>(cv::Mat& frame) override;
+    int GetWidth() override { return width_; }
+    int GetHeight() override { return height_; }
+
+    /**
+     * Frames received that were never handed to the SDK (superseded,
+     * undecodable, not admitted by the governor or withheld while away).
+     */
+    uint64_t skipped_frames() const {
+        return provider_.skipped() + undecodable_ +
+               (governor_ ? governor_->skipped() : 0) + (watch_ ? watch_->withheld() : 0);
+    }
+
+private:
+    bool convert(const ReceivedFrame& source, cv::Mat& frame);
+
+    FrameProvider& provider_;
+    ReceivedFrame scratch_;
+    const volatile std::sig_atomic_t* stop_flag_;
+    FrameGovernor* governor_ = nullptr;
+    PresenceWatch* watch_ = nullptr;
+
+    int width_;
+    int height_;
+    int64_t timestamp_us_ = 0;
+    uint64_t undecodable_ = 0;
+};
+
+} // namespace focus_wizard
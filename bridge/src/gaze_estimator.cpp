@@ -0,0 +1,305 @@
+/**
+ * gaze_estimator.cpp — Implementation
+ */
+
+#include "gaze_estimator.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace focus_wizard {
+
+namespace {
+
+// ── Landmark indices ─────────────────────────────────────
+// MediaPipe face mesh with refined iris landmarks. Per eye, in
+// {subject's right (image left), subject's left} order.
+constexpr int kIrisMinPoints = 478;
+constexpr int kEyeOuter[2] = {33, 263};
+constexpr int kEyeInner[2] = {133, 362};
+constexpr int kLidUpper[2] = {159, 386};
+constexpr int kLidLower[2] = {145, 374};
+constexpr int kIrisCenter[2] = {468, 473};
+
+// Calibration fit: the head has to have moved this much (variance of the
+// eye offset, in eye widths^2) and head/eye have to correlate this well
+// before the fitted gain replaces the default
+constexpr double kMinEyeVariance = 1e-4;
+constexpr double kMinCorrelation = 0.5;
+
+// ── Cache file ───────────────────────────────────────────
+constexpr char     kCalibrationMagic[4] = {'F', 'W', 'G', 'C'};
+constexpr uint32_t kCalibrationVersion  = 1;
+
+#pragma pack(push, 1)
+struct CalibrationFile {
+    char     magic[4];
+    uint32_t version;
+    float    center_x;
+    float    center_y;
+    float    gain_x;
+    float    gain_y;
+    uint32_t samples;
+    uint32_t has_iris;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(CalibrationFile) == 32, "calibration cache layout");
+
+bool make_directories(const std::string& dir, std::string* error) {
+    for (size_t pos = 1; pos <= dir.size(); ++pos) {
+        if (pos != dir.size() && dir[pos] != '/') continue;
+        std::string prefix = dir.substr(0, pos);
+        if (::mkdir(prefix.c_str(), 0700) != 0 && errno != EEXIST) {
+            *error = "mkdir " + prefix + ": " + std::strerror(errno);
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+// ── Estimator ────────────────────────────────────────────
+
+GazeEstimator::GazeEstimator(GazeEstimatorOptions options)
+    : options_(options)
+{
+    calibration_.gain_x = options_.eye_gain;
+    calibration_.gain_y = options_.eye_gain;
+}
+
+void GazeEstimator::start_calibration() {
+    moments_x_ = {};
+    moments_y_ = {};
+    calibration_start_us_ = 0;
+    calibration_saw_iris_ = false;
+    state_ = GazeCalibrationState::CALIBRATING;
+}
+
+void GazeEstimator::set_calibration(const GazeCalibration& calibration) {
+    calibration_ = calibration;
+    state_ = GazeCalibrationState::CALIBRATED;
+}
+
+bool GazeEstimator::estimate(const presage::physiology::Landmarks& landmarks,
+                             float head_x, float head_y, int64_t timestamp_us,
+                             float* gaze_x, float* gaze_y) {
+    float eye_x = 0.0f;
+    float eye_y = 0.0f;
+    bool has_eye = eye_offset(landmarks, &eye_x, &eye_y);
+
+    if (state_ == GazeCalibrationState::CALIBRATING) {
+        if (moments_x_.n == 0) calibration_start_us_ = timestamp_us;
+        moments_x_.add(eye_x, head_x);
+        moments_y_.add(eye_y, head_y);
+        calibration_saw_iris_ |= has_eye;
+
+        if (timestamp_us - calibration_start_us_ >=
+                static_cast<int64_t>(options_.calibration_s * 1e6f) &&
+            moments_x_.n >= options_.min_calibration_samples) {
+            finish_calibration();
+        }
+        return false;
+    }
+
+    *gaze_x = head_x + calibration_.gain_x * eye_x - calibration_.center_x;
+    *gaze_y = head_y + calibration_.gain_y * eye_y - calibration_.center_y;
+    return true;
+}
+
+bool GazeEstimator::eye_offset(const presage::physiology::Landmarks& landmarks,
+                               float* eye_x, float* eye_y) {
+    if (landmarks.value_size() < kIrisMinPoints) return false;
+
+    // Gather the points into per-eye arrays so the math below is one
+    // two-lane loop over contiguous floats (which the compiler vectorizes)
+    // instead of a walk through the message per field.
+    float outer_x[2], outer_y[2], inner_x[2], inner_y[2];
+    float upper_y[2], lower_y[2], iris_x[2], iris_y[2];
+    for (int e = 0; e < 2; ++e) {
+        const auto& outer = landmarks.value(kEyeOuter[e]);
+        const auto& inner = landmarks.value(kEyeInner[e]);
+        const auto& iris  = landmarks.value(kIrisCenter[e]);
+        outer_x[e] = outer.x();
+        outer_y[e] = outer.y();
+        inner_x[e] = inner.x();
+        inner_y[e] = inner.y();
+        upper_y[e] = landmarks.value(kLidUpper[e]).y();
+        lower_y[e] = landmarks.value(kLidLower[e]).y();
+        iris_x[e]  = iris.x();
+        iris_y[e]  = iris.y();
+    }
+
+    float offset_x[2], offset_y[2], width[2], opening[2];
+    for (int e = 0; e < 2; ++e) {
+        float dx = inner_x[e] - outer_x[e];
+        float dy = inner_y[e] - outer_y[e];
+        width[e] = std::sqrt(dx * dx + dy * dy);
+        float inv_width = width[e] > 1.0f ? 1.0f / width[e] : 0.0f;
+        offset_x[e] = (iris_x[e] - 0.5f * (outer_x[e] + inner_x[e])) * inv_width;
+        offset_y[e] = (iris_y[e] - 0.5f * (outer_y[e] + inner_y[e])) * inv_width;
+        opening[e]  = (lower_y[e] - upper_y[e]) * inv_width;
+    }
+
+    // Closed or degenerate eyes put the iris points anywhere; hold the
+    // last open-eye offset instead so a blink isn't a glance away
+    int open = 0;
+    float sum_x = 0.0f;
+    float sum_y = 0.0f;
+    for (int e = 0; e < 2; ++e) {
+        if (width[e] > 1.0f && opening[e] >= options_.eye_closed_ratio) {
+            sum_x += offset_x[e];
+            sum_y += offset_y[e];
+            ++open;
+        }
+    }
+    if (open > 0) {
+        eye_x_ = sum_x / static_cast<float>(open);
+        eye_y_ = sum_y / static_cast<float>(open);
+        has_eye_ = true;
+    }
+    if (!has_eye_) return false;
+
+    *eye_x = eye_x_;
+    *eye_y = eye_y_;
+    return true;
+}
+
+void GazeEstimator::Moments::add(double e, double h) {
+    n += 1;
+    sum_e += e;
+    sum_h += h;
+    sum_ee += e * e;
+    sum_hh += h * h;
+    sum_eh += e * h;
+}
+
+float GazeEstimator::fit_axis(const Moments& m, float* center) const {
+    double mean_e = m.sum_e / m.n;
+    double mean_h = m.sum_h / m.n;
+    double var_e = m.sum_ee / m.n - mean_e * mean_e;
+    double var_h = m.sum_hh / m.n - mean_h * mean_h;
+    double cov = m.sum_eh / m.n - mean_e * mean_h;
+
+    // Looking at one point, head + gain * eye is constant: the slope of
+    // head on eye is -gain. Only trust it if the head actually moved.
+    double gain = options_.eye_gain;
+    if (calibration_saw_iris_ && var_e > kMinEyeVariance && var_h > 0.0 &&
+        -cov / std::sqrt(var_e * var_h) > kMinCorrelation) {
+        gain = std::clamp(-cov / var_e, 0.5 * options_.eye_gain, 2.0 * options_.eye_gain);
+    }
+    *center = static_cast<float>(mean_h + gain * mean_e);
+    return static_cast<float>(gain);
+}
+
+void GazeEstimator::finish_calibration() {
+    GazeCalibration calibration;
+    calibration.gain_x = fit_axis(moments_x_, &calibration.center_x);
+    calibration.gain_y = fit_axis(moments_y_, &calibration.center_y);
+    calibration.samples = static_cast<uint32_t>(moments_x_.n);
+    calibration.has_iris = calibration_saw_iris_;
+    set_calibration(calibration);
+}
+
+// ── Calibration Cache ────────────────────────────────────
+
+std::string default_gaze_calibration_path(const std::string& user) {
+    std::string dir;
+    if (const char* xdg = std::getenv("XDG_CACHE_HOME"); xdg && xdg[0] == '/') {
+        dir = xdg;
+    } else if (const char* home = std::getenv("HOME"); home && home[0] != '\0') {
+        dir = std::string(home) + "/.cache";
+    } else {
+        dir = "/tmp";
+    }
+
+    // The user name becomes part of a file name
+    std::string name = user.empty() ? "default" : user;
+    for (char& c : name) {
+        bool safe = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                    (c >= '0' && c <= '9') || c == '-' || c == '_' || c == '.';
+        if (!safe) c = '_';
+    }
+    return dir + "/focus-wizard/gaze-" + name + ".cal";
+}
+
+bool load_gaze_calibration(const std::string& path, GazeCalibration* calibration,
+                           std::string* error) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        *error = "open " + path + ": " + std::strerror(errno);
+        return false;
+    }
+
+    CalibrationFile file;
+    ssize_t n = ::read(fd, &file, sizeof(file));
+    ::close(fd);
+    if (n != static_cast<ssize_t>(sizeof(file)) ||
+        std::memcmp(file.magic, kCalibrationMagic, sizeof(file.magic)) != 0 ||
+        file.version != kCalibrationVersion) {
+        *error = path + ": not a gaze calibration (bad size, magic or version)";
+        return false;
+    }
+    if (!std::isfinite(file.center_x) || !std::isfinite(file.center_y) ||
+        !std::isfinite(file.gain_x) || !std::isfinite(file.gain_y)) {
+        *error = path + ": gaze calibration holds non-finite values";
+        return false;
+    }
+
+    calibration->center_x = file.center_x;
+    calibration->center_y = file.center_y;
+    calibration->gain_x   = file.gain_x;
+    calibration->gain_y   = file.gain_y;
+    calibration->samples  = file.samples;
+    calibration->has_iris = file.has_iris != 0;
+    return true;
+}
+
+bool save_gaze_calibration(const std::string& path, const GazeCalibration& calibration,
+                           std::string* error) {
+    size_t slash = path.rfind('/');
+    if (slash != std::string::npos && slash > 0 &&
+        !make_directories(path.substr(0, slash), error)) {
+        return false;
+    }
+
+    CalibrationFile file;
+    std::memcpy(file.magic, kCalibrationMagic, sizeof(file.magic));
+    file.version  = kCalibrationVersion;
+    file.center_x = calibration.center_x;
+    file.center_y = calibration.center_y;
+    file.gain_x   = calibration.gain_x;
+    file.gain_y   = calibration.gain_y;
+    file.samples  = calibration.samples;
+    file.has_iris = calibration.has_iris ? 1 : 0;
+
+    std::string tmp = path + ".tmp";
+    int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        *error = "open " + tmp + ": " + std::strerror(errno);
+        return false;
+    }
+    bool written = ::write(fd, &file, sizeof(file)) == static_cast<ssize_t>(sizeof(file));
+    if (::close(fd) != 0) written = false;
+    if (!written) {
+        *error = "write " + tmp + ": " + std::strerror(errno);
+        ::unlink(tmp.c_str());
+        return false;
+    }
+    if (::rename(tmp.c_str(), path.c_str()) != 0) {
+        *error = "rename " + tmp + ": " + std::strerror(errno);
+        ::unlink(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+} // namespace focus_wizard
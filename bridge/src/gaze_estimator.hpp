@@ -0,0 +1,144 @@
+/**
+ * gaze_estimator.hpp — Eye-in-head gaze with a per-user calibration
+ *
+ * The collector's nose-tip offset measures head pose: turning the head
+ * while still reading the screen looks like looking away. With the iris
+ * points of a refined face mesh (478 landmarks) the estimator adds where
+ * the eyes point inside the head, which mostly cancels the head turn:
+ *
+ *   gaze = head + gain * eye - centre        (per axis)
+ *
+ *   head   nose tip vs face box, as computed by MetricsCollector
+ *   eye    iris centre vs eye-corner midpoint, in eye widths, averaged
+ *          over both eyes (held through blinks)
+ *
+ * Calibration: for calibration_s of face frames the user keeps looking at
+ * the centre of the screen while moving their head a little. Then
+ * head + gain * eye should stay constant, so `gain` is the regression
+ * slope of head on eye and `centre` the mean. Without iris points, or if
+ * the head barely moved, the default gain is kept and only the centre is
+ * learned. Results are cached per user (see load_gaze_calibration) so
+ * startup doesn't recalibrate every time.
+ *
+ * Threading: everything except the cache helpers runs on the edge
+ * callback thread; not thread-safe.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include <physiology/modules/messages/metrics.h>
+
+namespace focus_wizard {
+
+struct GazeEstimatorOptions {
+    // Face frames (by SDK timestamp) collected for one calibration
+    float calibration_s = 5.0f;
+    int min_calibration_samples = 30;
+
+    // head-vs-eye weight before (or without) calibration
+    float eye_gain = 2.5f;
+
+    // An eye whose lid gap is below this fraction of its width is closed;
+    // the last open-eye offset is used instead
+    float eye_closed_ratio = 0.12f;
+};
+
+/**
+ * What calibration learns; see the file comment for the model.
+ */
+struct GazeCalibration {
+    float center_x = 0.0f;
+    float center_y = 0.0f;
+    float gain_x = 0.0f;
+    float gain_y = 0.0f;
+    uint32_t samples = 0;
+    bool has_iris = false;   // false: gains are the defaults
+};
+
+enum class GazeCalibrationState : uint8_t {
+    UNCALIBRATED,   // defaults, no centre correction
+    CALIBRATING,    // collecting samples; no gaze is reported
+    CALIBRATED,
+};
+
+class GazeEstimator {
+public:
+    explicit GazeEstimator(GazeEstimatorOptions options = {});
+
+    /**
+     * Discard the current calibration and start collecting samples.
+     */
+    void start_calibration();
+
+    /**
+     * Use a cached calibration.
+     */
+    void set_calibration(const GazeCalibration& calibration);
+
+    const GazeCalibration& calibration() const { return calibration_; }
+    GazeCalibrationState state() const { return state_; }
+
+    /**
+     * Combine the head-pose estimate (`head_x`, `head_y`) with the eye
+     * offset from `landmarks`. Returns false while calibrating; the frame
+     * is used as a calibration sample instead.
+     */
+    bool estimate(const presage::physiology::Landmarks& landmarks,
+                  float head_x, float head_y, int64_t timestamp_us,
+                  float* gaze_x, float* gaze_y);
+
+private:
+    /**
+     * Running moments of head (h) against eye (e) for one axis.
+     */
+    struct Moments {
+        double n = 0, sum_e = 0, sum_h = 0, sum_ee = 0, sum_hh = 0, sum_eh = 0;
+        void add(double e, double h);
+    };
+
+    bool eye_offset(const presage::physiology::Landmarks& landmarks, float* eye_x, float* eye_y);
+    void finish_calibration();
+    float fit_axis(const Moments& m, float* center) const;
+
+    GazeEstimatorOptions options_;
+    GazeCalibration calibration_;
+    GazeCalibrationState state_ = GazeCalibrationState::UNCALIBRATED;
+
+    // Last open-eye offset, held through blinks
+    float eye_x_ = 0.0f;
+    float eye_y_ = 0.0f;
+    bool has_eye_ = false;
+
+    // Calibration in progress
+    Moments moments_x_;
+    Moments moments_y_;
+    int64_t calibration_start_us_ = 0;
+    bool calibration_saw_iris_ = false;
+};
+
+// ── Calibration cache ────────────────────────────────────
+
+/**
+ * Default cache file for `user`:
+ * $XDG_CACHE_HOME (or ~/.cache)/focus-wizard/gaze-<user>.cal
+ */
+std::string default_gaze_calibration_path(const std::string& user);
+
+/**
+ * Read a calibration written by save_gaze_calibration. Returns false (and
+ * describes why in `error`) if the file is missing or not a calibration.
+ */
+bool load_gaze_calibration(const std::string& path, GazeCalibration* calibration,
+                           std::string* error);
+
+/**
+ * Write `calibration` to `path`, creating its directory. The file is
+ * replaced atomically, so a crash never leaves a torn cache.
+ */
+bool save_gaze_calibration(const std::string& path, const GazeCalibration& calibration,
+                           std::string* error);
+
+} // namespace focus_wizard
@@ -3,23 +3,158 @@
  */
 
 #include "json_emitter.hpp"
+#include "json_writer.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <unistd.h>
 
 namespace focus_wizard {
 
-void JsonEmitter::emit(const std::string& type, const std::string& json_data) {
+bool parse_output_format(const std::string& name, OutputFormat* out) {
+    if (name == "ndjson") {
+        *out = OutputFormat::NDJSON;
+        return true;
+    }
+    if (name == "binary") {
+        *out = OutputFormat::BINARY;
+        return true;
+    }
+    return false;
+}
+
+bool parse_emit_level(const std::string& name, EmitLevel* out) {
+    if      (name == "full")    *out = EmitLevel::FULL;
+    else if (name == "focus")   *out = EmitLevel::FOCUS;
+    else if (name == "summary") *out = EmitLevel::SUMMARY;
+    else return false;
+    return true;
+}
+
+bool JsonEmitter::wants(MessageType type) const {
+    switch (type) {
+        case MessageType::EDGE:
+        case MessageType::METRICS:
+            return level_ == EmitLevel::FULL;
+        case MessageType::FOCUS:
+        case MessageType::STATE_CHANGED:
+            return level_ != EmitLevel::SUMMARY;
+        case MessageType::SUMMARY:
+            return level_ == EmitLevel::SUMMARY;
+        default:
+            return true;
+    }
+}
+
+void JsonEmitter::configure(OutputFormat format, int fd) {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    format_ = format;
+    fd_ = fd;
+}
+
+void JsonEmitter::set_sink(MessageSink sink) {
+    std::unique_ptr<MessageSink> previous;
+    {
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        previous = std::move(sink_);
+        if (sink) sink_ = std::make_unique<MessageSink>(std::move(sink));
+        active_sink_.store(sink_.get(), std::memory_order_release);
+    }
+    // The old sink's captures are released outside the lock
+}
+
+void JsonEmitter::start_async_writer(const AsyncWriterOptions& options) {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    writer_ = std::make_unique<AsyncWriter>(fd_, options);
+    active_writer_.store(writer_.get(), std::memory_order_release);
+}
+
+void JsonEmitter::stop_async_writer() {
+    std::unique_ptr<AsyncWriter> writer;
+    {
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        active_writer_.store(nullptr, std::memory_order_release);
+        writer = std::move(writer_);
+    }
+    // Destructor drains and joins outside the lock
+}
+
+uint64_t JsonEmitter::dropped_messages() {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    return writer_ ? writer_->dropped() + writer_->merged() : 0;
+}
+
+uint64_t JsonEmitter::messages_emitted() {
+    return messages_.load(std::memory_order_relaxed);
+}
+
+uint64_t JsonEmitter::bytes_written() {
+    // The lock keeps stop_async_writer() from freeing the writer under us
     std::lock_guard<std::mutex> lock(write_mutex_);
-    // Write a complete JSON line atomically
-    std::cout << "{\"type\":\"" << type << "\",\"data\":" << json_data << "}" << std::endl;
-    // std::endl flushes, which is critical for the pipe to Electron
+    uint64_t bytes = bytes_written_.load(std::memory_order_relaxed);
+    return writer_ ? bytes + writer_->bytes_written() : bytes;
 }
 
-void JsonEmitter::emit_status(const std::string& status_text) {
-    std::string data = "{\"status\":\"" + escape_json_string(status_text) + "\"}";
+size_t JsonEmitter::queue_depth() {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    return writer_ ? writer_->queue_depth() : 0;
+}
+
+void JsonEmitter::emit(std::string_view type, std::string_view json_data) {
+    MessageType tag;
+    bool known_type = message_type_from_string(type, &tag);
+
+    if (format_ == OutputFormat::BINARY) {
+        if (known_type) {
+            write_record(tag, json_data.data(), static_cast<uint32_t>(json_data.size()));
+        }
+        return;
+    }
+    if (!known_type) {
+        tag = MessageType::STATUS; // never dropped under backpressure
+    }
+
+    // Build the complete JSON line first so it goes out in a single write
+    std::string& line = thread_frame_buffer();
+    line.clear();
+    line += "{\"type\":\"";
+    line.append(type.data(), type.size());
+    line += '"';
+    if (track_ != 0) {
+        char digits[8];
+        auto end = std::to_chars(digits, digits + sizeof(digits), track_).ptr;
+        line += ",\"track\":";
+        line.append(digits, static_cast<size_t>(end - digits));
+    }
+    line += ",\"data\":";
+    line.append(json_data.data(), json_data.size());
+    line += "}\n";
+
+    output(tag, track_, line.data(), line.size());
+}
+
+void JsonEmitter::emit_record(MessageType type, const SnapshotRecord& record) {
+    write_record(type, &record, sizeof(record));
+}
+
+void JsonEmitter::emit_status(std::string_view status_text) {
+    std::string& data = thread_payload_buffer();
+    data.clear();
+    JsonWriter writer(data);
+    writer.begin_object();
+    writer.string_field("status", status_text);
+    writer.end_object();
     emit("status", data);
 }
 
-void JsonEmitter::emit_error(const std::string& error_text) {
-    std::string data = "{\"message\":\"" + escape_json_string(error_text) + "\"}";
+void JsonEmitter::emit_error(std::string_view error_text) {
+    std::string& data = thread_payload_buffer();
+    data.clear();
+    JsonWriter writer(data);
+    writer.begin_object();
+    writer.string_field("message", error_text);
+    writer.end_object();
     emit("error", data);
 }
 
@@ -27,28 +162,60 @@ void JsonEmitter::emit_ready() {
     emit("ready", "{}");
 }
 
-std::string JsonEmitter::escape_json_string(const std::string& input) {
-    std::ostringstream ss;
-    for (char c : input) {
-        switch (c) {
-            case '"':  ss << "\\\""; break;
-            case '\\': ss << "\\\\"; break;
-            case '\b': ss << "\\b";  break;
-            case '\f': ss << "\\f";  break;
-            case '\n': ss << "\\n";  break;
-            case '\r': ss << "\\r";  break;
-            case '\t': ss << "\\t";  break;
-            default:
-                if ('\x00' <= c && c <= '\x1f') {
-                    char buf[8];
-                    snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned char>(c));
-                    ss << buf;
-                } else {
-                    ss << c;
-                }
+void JsonEmitter::write_record(MessageType type, const void* payload, uint32_t length) {
+    RecordHeader header;
+    header.length   = length;
+    header.type     = static_cast<uint8_t>(type);
+    header.version  = kBinaryProtocolVersion;
+    header.track    = track_;
+
+    std::string& frame = thread_frame_buffer();
+    frame.clear();
+    frame.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    frame.append(static_cast<const char*>(payload), length);
+
+    output(type, track_, frame.data(), frame.size());
+}
+
+void JsonEmitter::forward(MessageType type, uint16_t track, const char* data, size_t length) {
+    output(type, track, data, length);
+}
+
+void JsonEmitter::output(MessageType type, uint16_t track, const char* data, size_t length) {
+    messages_.fetch_add(1, std::memory_order_relaxed);
+    if (const MessageSink* sink = active_sink_.load(std::memory_order_acquire)) {
+        (*sink)(type, data, length);
+        return;
+    }
+    if (AsyncWriter* writer = active_writer_.load(std::memory_order_acquire)) {
+        // Per-frame snapshots go stale quickly; everything else must arrive
+        bool droppable = (type == MessageType::EDGE || type == MessageType::FOCUS);
+        // Message types fit in the low nibble, tracks in the high one
+        auto kind = static_cast<uint8_t>(static_cast<unsigned>(type) |
+                                         (std::min<unsigned>(track, kMaxTracks) << 4));
+        writer->submit(kind, droppable, data, length);
+        return;
+    }
+
+    // One write per message is the flush that matters for the pipe to Electron
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    write_all(data, length);
+}
+
+void JsonEmitter::write_all(const char* data, size_t length) {
+    while (length > 0) {
+        ssize_t written = ::write(fd_, data, length);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            // Reader went away (EPIPE etc.) — nothing useful left to do
+            return;
         }
+        data += written;
+        length -= static_cast<size_t>(written);
+        // Only written under write_mutex_
+        bytes_written_.store(bytes_written_.load(std::memory_order_relaxed) +
+                             static_cast<uint64_t>(written), std::memory_order_relaxed);
     }
-    return ss.str();
 }
 
 } // namespace focus_wizard
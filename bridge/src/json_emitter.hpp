@@ -11,34 +11,180 @@
  *   { "type": "status",     "data": { "status": "..." } }
  *   { "type": "error",      "data": { "message": "..." } }
  *   { "type": "ready",      "data": {} }
+ *   { "type": "history",    "data": { ... } }   (query_history reply)
+ *   { "type": "summary",    "data": { ... } }   (--emit=summary)
+ *
+ * With OutputFormat::BINARY the same messages are written as
+ * length-prefixed records instead (see binary_protocol.hpp).
+ *
+ * Once start_async_writer() is called, emit() only queues the message and
+ * a background thread does the I/O (see async_writer.hpp). A message sink
+ * (set_sink) takes precedence over both and receives every finished
+ * message instead — --mode=net uses it to answer on the client socket.
+ *
+ * An emitter can be tagged with a camera track (set_track): its NDJSON
+ * lines then read { "type": ..., "track": N, "data": ... } and its binary
+ * records carry N in the header.
+ *
+ * The emit level (--emit) thins the stream for consumers that don't need
+ * every frame: the publishers ask wants() before building a message.
  */
 
 #pragma once
 
+#include <atomic>
+#include <functional>
 #include <string>
+#include <string_view>
 #include <mutex>
-#include <iostream>
-#include <sstream>
+#include <memory>
+
+#include "async_writer.hpp"
+#include "binary_protocol.hpp"
 
 namespace focus_wizard {
 
+/**
+ * Receives each finished message (a full NDJSON line or binary record).
+ */
+using MessageSink = std::function<void(MessageType type, const char* data, size_t length)>;
+
+enum class OutputFormat {
+    NDJSON,
+    BINARY
+};
+
+/**
+ * Parse an --output_format value ("ndjson" or "binary").
+ * Returns false if the name is not recognized.
+ */
+bool parse_output_format(const std::string& name, OutputFormat* out);
+
+/**
+ * How much of the pipeline a consumer subscribes to. Status, error,
+ * ready and history messages go out at every level.
+ *
+ *   FULL     edge, metrics, focus and state_changed
+ *   FOCUS    focus and state_changed only
+ *   SUMMARY  one summary record per window only
+ */
+enum class EmitLevel {
+    FULL,
+    FOCUS,
+    SUMMARY
+};
+
+/**
+ * Parse an --emit value ("full", "focus" or "summary").
+ * Returns false if the name is not recognized.
+ */
+bool parse_emit_level(const std::string& name, EmitLevel* out);
+
 class JsonEmitter {
 public:
+    /**
+     * Select the wire format and the file descriptor to write to.
+     * Defaults to NDJSON on stdout. Call before the pipeline starts.
+     */
+    void configure(OutputFormat format, int fd);
+
+    OutputFormat format() const { return format_; }
+
+    /**
+     * Select the emit level. Defaults to FULL. Call before the pipeline
+     * starts.
+     */
+    void set_level(EmitLevel level) { level_ = level; }
+
+    EmitLevel level() const { return level_; }
+
+    /**
+     * Whether messages of `type` go out at the current level.
+     */
+    bool wants(MessageType type) const;
+
+    /**
+     * Tag every message with camera track `track` (1..kMaxTracks; 0 = no
+     * tag, the default). Call before the pipeline starts.
+     */
+    void set_track(uint16_t track) { track_ = track; }
+
+    uint16_t track() const { return track_; }
+
+    /**
+     * Route all output to `sink` instead of the file descriptor.
+     * Pass nullptr to restore fd output. The sink is called on the
+     * emitting thread without a lock, so it must be thread-safe when
+     * several threads emit. Call before the pipeline starts or after it
+     * has stopped.
+     */
+    void set_sink(MessageSink sink);
+
+    /**
+     * Move all output onto a background writer thread.
+     * Call after configure() and before the pipeline starts.
+     */
+    void start_async_writer(const AsyncWriterOptions& options);
+
+    /**
+     * Flush everything queued and join the writer thread.
+     * Subsequent emits write synchronously again. Call once the
+     * SmartSpectra callbacks have stopped firing.
+     */
+    void stop_async_writer();
+
+    /**
+     * Messages dropped or merged away under backpressure (async mode).
+     * Safe to call from any thread.
+     */
+    uint64_t dropped_messages();
+
+    /**
+     * Messages handed to the sink, the writer thread or the fd, counting
+     * ones the writer later drops. Safe to call from any thread.
+     */
+    uint64_t messages_emitted();
+
+    /**
+     * Bytes written to the output fd (not counting a sink).
+     * Safe to call from any thread.
+     */
+    uint64_t bytes_written();
+
+    /**
+     * Messages waiting for the writer thread (0 when writing synchronously).
+     * Safe to call from any thread.
+     */
+    size_t queue_depth();
+
     /**
      * Emit a JSON line to stdout.
      * Thread-safe: multiple SmartSpectra callbacks may fire concurrently.
+     * In binary mode the JSON object becomes the record payload.
+     */
+    void emit(std::string_view type, std::string_view json_data);
+
+    /**
+     * Emit a fixed-layout snapshot record (binary mode only).
+     */
+    void emit_record(MessageType type, const SnapshotRecord& record);
+
+    /**
+     * Write a message another emitter finished (typically from that
+     * emitter's sink), going through this one's writer. `track` is the
+     * other emitter's, so backpressure merging keeps tracks apart.
      */
-    void emit(const std::string& type, const std::string& json_data);
+    void forward(MessageType type, uint16_t track, const char* data, size_t length);
 
     /**
      * Convenience: emit a simple status message.
      */
-    void emit_status(const std::string& status_text);
+    void emit_status(std::string_view status_text);
 
     /**
      * Convenience: emit an error message.
      */
-    void emit_error(const std::string& error_text);
+    void emit_error(std::string_view error_text);
 
     /**
      * Convenience: emit a ready signal.
@@ -46,12 +192,40 @@ public:
     void emit_ready();
 
 private:
+    // Synchronous writes, configure(), and swapping the sink or writer
     std::mutex write_mutex_;
+    OutputFormat format_ = OutputFormat::NDJSON;
+    EmitLevel level_ = EmitLevel::FULL;
+    uint16_t track_ = 0;
+    int fd_ = 1;
+
+    // Owned under write_mutex_, read by output() through the atomics
+    std::unique_ptr<AsyncWriter> writer_;
+    std::unique_ptr<MessageSink> sink_;
+    std::atomic<AsyncWriter*> active_writer_{nullptr};
+    std::atomic<const MessageSink*> active_sink_{nullptr};
+
+    std::atomic<uint64_t> bytes_written_{0};   // synchronous writes
+    std::atomic<uint64_t> messages_{0};
+
+    /**
+     * Hand a finished message to the sink or the writer thread, or write
+     * it now. Only the synchronous write takes write_mutex_; the sink and
+     * writer are read lock-free, which is why set_sink() and
+     * stop_async_writer() may only run while nothing emits.
+     */
+    void output(MessageType type, uint16_t track, const char* data, size_t length);
+
+    /**
+     * Write a framed binary record (header + payload) in one syscall.
+     */
+    void write_record(MessageType type, const void* payload, uint32_t length);
 
     /**
-     * Escape a string for safe JSON embedding.
+     * Write the whole buffer to fd_, retrying on short writes / EINTR.
+     * Caller must hold write_mutex_.
      */
-    static std::string escape_json_string(const std::string& input);
+    void write_all(const char* data, size_t length);
 };
 
 } // namespace focus_wizard
@@ -0,0 +1,54 @@
+/**
+ * json_writer.cpp — Implementation
+ */
+
+#include "json_writer.hpp"
+
+namespace focus_wizard {
+
+void write_json_string(std::string& out, std::string_view input) {
+    static const char kHex[] = "0123456789abcdef";
+
+    out += '"';
+    for (char c : input) {
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\b': out += "\\b";  break;
+            case '\f': out += "\\f";  break;
+            case '\n': out += "\\n";  break;
+            case '\r': out += "\\r";  break;
+            case '\t': out += "\\t";  break;
+            default:
+                if ('\x00' <= c && c <= '\x1f') {
+                    unsigned char u = static_cast<unsigned char>(c);
+                    out += "\\u00";
+                    out += kHex[u >> 4];
+                    out += kHex[u & 0x0f];
+                } else {
+                    out += c;
+                }
+        }
+    }
+    out += '"';
+}
+
+std::string& thread_payload_buffer() {
+    thread_local std::string buffer = [] {
+        std::string s;
+        s.reserve(1024);
+        return s;
+    }();
+    return buffer;
+}
+
+std::string& thread_frame_buffer() {
+    thread_local std::string buffer = [] {
+        std::string s;
+        s.reserve(1024);
+        return s;
+    }();
+    return buffer;
+}
+
+} // namespace focus_wizard
@@ -0,0 +1,149 @@
+/**
+ * json_writer.hpp — Allocation-free JSON object serialization
+ *
+ * Every payload builder (edge, metrics, focus, status, ...) appends into a
+ * caller-owned std::string — normally one of the per-thread buffers below,
+ * which keep their capacity between frames. Numbers go through
+ * std::to_chars, so formatting is locale-independent and never touches a
+ * stream. Floats are written in fixed notation with a per-field precision,
+ * byte-for-byte identical to `std::fixed << std::setprecision(n)`.
+ *
+ * Payload layouts are described once as compile-time field schemas:
+ *
+ *   constexpr auto kSchema = std::make_tuple(
+ *       json_field("gaze_x", &FocusMetrics::gaze_x, 4),
+ *       json_field("has_gaze", &FocusMetrics::has_gaze));
+ *   write_fields(writer, metrics, kSchema);
+ *
+ * Value types are dispatched through write_json_value(); other modules can
+ * add overloads for their own types (e.g. FocusState) found via ADL.
+ */
+
+#pragma once
+
+#include <charconv>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <tuple>
+
+namespace focus_wizard {
+
+// ── Value formatting ─────────────────────────────────────
+
+inline void write_json_value(std::string& out, bool value, int /*precision*/) {
+    out += value ? "true" : "false";
+}
+
+inline void write_json_value(std::string& out, int64_t value, int /*precision*/) {
+    char buf[24];
+    auto result = std::to_chars(buf, buf + sizeof(buf), value);
+    out.append(buf, result.ptr);
+}
+
+inline void write_json_value(std::string& out, float value, int precision) {
+    // Widest fixed float: 39 integer digits + sign + point + precision
+    char buf[96];
+    auto result = std::to_chars(buf, buf + sizeof(buf), value,
+                                std::chars_format::fixed, precision);
+    out.append(buf, result.ptr);
+}
+
+/**
+ * Append `input` as a quoted, escaped JSON string.
+ */
+void write_json_string(std::string& out, std::string_view input);
+
+inline void write_json_value(std::string& out, const char* value, int /*precision*/) {
+    write_json_string(out, value);
+}
+
+// ── Object writer ────────────────────────────────────────
+
+class JsonWriter {
+public:
+    /**
+     * Appends to `out`; the caller decides whether to clear it first.
+     */
+    explicit JsonWriter(std::string& out) : out_(out) {}
+
+    void begin_object() {
+        out_ += '{';
+        first_ = true;
+    }
+
+    void end_object() { out_ += '}'; }
+
+    template <typename T>
+    void field(const char* name, const T& value, int precision = 0) {
+        key(name);
+        write_json_value(out_, value, precision);
+    }
+
+    /**
+     * Write a field whose value is already-serialized JSON.
+     */
+    void raw_field(const char* name, std::string_view json) {
+        key(name);
+        out_.append(json.data(), json.size());
+    }
+
+    void string_field(const char* name, std::string_view value) {
+        key(name);
+        write_json_string(out_, value);
+    }
+
+    std::string& buffer() { return out_; }
+
+private:
+    void key(const char* name) {
+        if (!first_) out_ += ',';
+        first_ = false;
+        out_ += '"';
+        out_ += name;
+        out_ += "\":";
+    }
+
+    std::string& out_;
+    bool first_ = true;
+};
+
+// ── Compile-time field schemas ───────────────────────────
+
+template <typename T, typename M>
+struct JsonField {
+    const char* name;
+    M T::*member;
+    int precision;
+};
+
+template <typename T, typename M>
+constexpr JsonField<T, M> json_field(const char* name, M T::*member, int precision = 0) {
+    return JsonField<T, M>{name, member, precision};
+}
+
+/**
+ * Write every field of `schema`, in order, reading values from `object`.
+ */
+template <typename T, typename... Fields>
+void write_fields(JsonWriter& writer, const T& object, const std::tuple<Fields...>& schema) {
+    std::apply([&](const auto&... field) {
+        (writer.field(field.name, object.*(field.member), field.precision), ...);
+    }, schema);
+}
+
+// ── Per-thread reusable buffers ──────────────────────────
+
+/**
+ * Scratch buffer for payload builders. The returned reference (and any
+ * string_view into it) is valid until the next builder runs on this thread.
+ */
+std::string& thread_payload_buffer();
+
+/**
+ * Scratch buffer for the emitter's framing step; kept separate so a
+ * payload view can be framed without copying it first.
+ */
+std::string& thread_frame_buffer();
+
+} // namespace focus_wizard
@@ -1,7 +1,7 @@
 /**
  * main.cpp — Focus Wizard Bridge
  *
- * Headless SmartSpectra runner with two modes:
+ * Headless SmartSpectra runner with these modes:
  *
  *   LOCAL mode (default):
  *     Captures webcam directly on this machine via SmartSpectra SDK.
@@ -13,7 +13,43 @@
  *     SmartSpectra picks them up and processes them. Use when the Electron
  *     app is on Mac/Windows and this bridge runs on an Ubuntu server.
  *
- * Both modes emit JSON lines to stdout.
+ *   SHM mode (--mode=shm --shm_path=...):
+ *     Like server mode, but the Electron FrameWriter writes frames into a
+ *     shared-memory ring (see frame_ring.hpp) instead of image files, so
+ *     there is no file write, directory scan or unlink per frame. Needs the
+ *     producer on the same kernel (native, or Docker on a Linux host).
+ *
+ *   NET mode (--mode=net --listen=host:port):
+ *     The bridge accepts one TCP client that streams framed frames (see
+ *     net_ingest_server.hpp) and sends the output back on the same socket.
+ *     Replaces the server-mode relay process and frame directory.
+ *
+ *   MULTI mode (--mode=multi --listen=host:port --max_sessions=N):
+ *     Like net mode, but every client gets its own session (container,
+ *     collector, analyzer, output) inside one process (see session_host.hpp).
+ *
+ *   Local mode with --camera_device_indices=0,2 runs one track per camera
+ *   in one process; every message carries its track (see camera_host.hpp).
+ *
+ *   Any live mode can run with --integration=edge_only: nothing is uploaded
+ *   and no API key is needed; focus, blinks, talking and gaze come from the
+ *   on-device edge metrics and pulse is unavailable.
+ *
+ *   Any live mode can run with --backend=gpu: the SDK's OpenGL graph instead
+ *   of the CPU one, falling back to CPU if it can't be used (bridge_container.hpp).
+ *
+ *   Single-session live modes take JSON commands on stdin (start, stop,
+ *   configure, set_thresholds, shutdown; see control_channel.hpp). With
+ *   --daemon the process stays resident between sessions, so a new
+ *   session skips process start, SDK setup and camera open.
+ *
+ *   REPLAY mode (--mode=replay --replay_path=...):
+ *     Feeds a session log recorded with --record_path back through the
+ *     same pipeline. No camera, SDK container or API key is needed.
+ *
+ * All modes emit JSON lines to stdout (net/multi: to the client), or length-prefixed binary records
+ * with --output_format=binary (see binary_protocol.hpp). --emit=focus or --emit=summary
+ * thins the stream for consumers that don't need every frame.
  *
  * Usage:
  *   # Local mode (Ubuntu desktop with webcam)
@@ -23,16 +59,28 @@
  *   ./focus_bridge --api_key=YOUR_KEY --mode=server \
  *       --file_stream_path=/tmp/focus_frames/frame0000000000000000.png
  *
+ *   # Record a session, then replay it
+ *   ./focus_bridge --api_key=YOUR_KEY --record_path=/tmp/session.fwsl
+ *   ./focus_bridge --mode=replay --replay_path=/tmp/session.fwsl
+ *
  * The process runs until it receives SIGTERM/SIGINT or the parent
- * process closes the pipe.
+ * process closes the pipe (with --daemon: closes stdin or sends shutdown).
  */
 
 // ── Standard Library ─────────────────────────────────────
 #include <string>
+#include <atomic>
 #include <iostream>
 #include <csignal>
 #include <cstdlib>
 #include <memory>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <thread>
+#include <vector>
+#include <unistd.h>
 
 // ── Third-party ──────────────────────────────────────────
 #include <absl/status/status.h>
@@ -43,36 +91,67 @@
 
 // ── SmartSpectra SDK ─────────────────────────────────────
 #include <smartspectra/container/settings.hpp>
-#include <smartspectra/container/foreground_container.hpp>
 #include <smartspectra/video_source/camera/camera.hpp>
 #include <physiology/modules/messages/metrics.h>
 #include <physiology/modules/messages/status.h>
 
 // ── Focus Wizard ─────────────────────────────────────────
+#include "bridge_container.hpp"
+#include "camera_host.hpp"
+#include "control_channel.hpp"
 #include "json_emitter.hpp"
 #include "metrics_collector.hpp"
+#include "metrics_server.hpp"
 #include "focus_analyzer.hpp"
+#include "focus_history.hpp"
+#include "focus_summary.hpp"
+#include "frame_features.hpp"
+#include "frame_governor.hpp"
+#include "frame_ring.hpp"
+#include "frame_trace.hpp"
+#include "frame_video_source.hpp"
+#include "gaze_estimator.hpp"
+#include "net_ingest_server.hpp"
+#include "pipeline_metrics.hpp"
+#include "presence_watch.hpp"
+#include "publish.hpp"
+#include "rest_cadence.hpp"
+#include "session_host.hpp"
+#include "session_log.hpp"
+#include "session_recorder.hpp"
 
 // ── Aliases ──────────────────────────────────────────────
 namespace pcam     = presage::camera;
 namespace spectra  = presage::smartspectra;
 namespace settings = presage::smartspectra::container::settings;
 namespace vs       = presage::smartspectra::video_source;
-namespace container = presage::smartspectra::container;
 
 // ── Command-line Flags ───────────────────────────────────
 ABSL_FLAG(std::string, api_key, "",
     "Presage Physiology API key. Can also be set via SMARTSPECTRA_API_KEY env var.");
+ABSL_FLAG(std::string, backend, "cpu",
+    "Graph backend: 'cpu' or 'gpu' (OpenGL face mesh inference; needs a build with "
+    "-DFOCUS_BRIDGE_GPU=ON and a usable GPU, else falls back to cpu).");
+ABSL_FLAG(std::string, integration, "rest",
+    "Physiology integration: 'rest' (edge metrics plus pulse/breathing from the "
+    "Physiology REST API; needs an API key) or 'edge_only' (on-device edge graph "
+    "only: no uploads, no API key, no pulse; breathing from the edge trace).");
 ABSL_FLAG(std::string, mode, "local",
-    "Operating mode: 'local' (capture webcam directly) or 'server' (read frames from directory).");
+    "Operating mode: 'local' (capture webcam directly), 'server' (read frames from directory), "
+    "'shm' (read frames from a shared-memory ring), 'net' (accept frames over TCP), "
+    "'multi' (one session per TCP client) or 'replay' (play back a recorded session log).");
 
 // -- Local mode flags --
 ABSL_FLAG(int, camera_device_index, 0,
     "Index of the camera device to use (0 = default webcam). Local mode only.");
+ABSL_FLAG(std::string, camera_device_indices, "",
+    "Comma-separated camera indices, e.g. '0,2': one track per camera in this process, "
+    "each message tagged with its track (1 = the first index). Overrides "
+    "--camera_device_index. Local mode only.");
 ABSL_FLAG(int, capture_width, 1280,
-    "Capture width in pixels. Local mode only.");
+    "Capture width in pixels. Local mode (shm/net modes: size reported before the first frame).");
 ABSL_FLAG(int, capture_height, 720,
-    "Capture height in pixels. Local mode only.");
+    "Capture height in pixels. Local mode (shm/net modes: size reported before the first frame).");
 
 // -- Server mode flags --
 ABSL_FLAG(std::string, file_stream_path, "",
@@ -84,6 +163,55 @@ ABSL_FLAG(int, rescan_delay_ms, 5,
 ABSL_FLAG(bool, erase_read_files, true,
     "Erase frame files after they've been read. Server mode only.");
 
+// -- Shared-memory mode flags --
+ABSL_FLAG(std::string, shm_path, "/dev/shm/focus-wizard/frames.ring",
+    "Frame ring file created by the Electron FrameWriter. Shm mode only.");
+ABSL_FLAG(std::string, shm_doorbell_path, "",
+    "FIFO the producer pokes once per frame (created if missing). "
+    "Default: --shm_path + '.bell'. Shm mode only.");
+
+// -- Network ingest mode flags --
+ABSL_FLAG(std::string, listen, "0.0.0.0:9000",
+    "Address to accept the frame client on ('host:port', ':port' or 'port'). "
+    "Output goes back on the same connection. Net and multi modes.");
+ABSL_FLAG(int, net_max_frame_bytes, 16 * 1024 * 1024,
+    "Largest inbound frame payload accepted; bigger records drop the client. "
+    "Net and multi modes.");
+ABSL_FLAG(int, net_outbound_bytes, 1024 * 1024,
+    "Output buffered per client for a slow or not-yet-connected client before "
+    "messages are dropped. Net and multi modes.");
+ABSL_FLAG(int, max_sessions, 8,
+    "Concurrent client sessions; further connections are refused. Multi mode only.");
+
+// -- Recording / replay --
+ABSL_FLAG(std::string, record_path, "",
+    "Record every core/edge callback to this session log. Local, server, shm and net modes.");
+ABSL_FLAG(std::string, replay_path, "",
+    "Session log to play back. Replay mode only.");
+ABSL_FLAG(float, replay_speed, 1.0f,
+    "Replay speed relative to the recorded timestamps (2 = twice as fast, "
+    "0 = as fast as possible). Replay mode only.");
+
+// -- Output (both modes) --
+ABSL_FLAG(std::string, output_format, "ndjson",
+    "Wire format for emitted messages: 'ndjson' (JSON Lines) or 'binary' "
+    "(length-prefixed fixed-layout records).");
+ABSL_FLAG(int, output_fd, 1,
+    "File descriptor to write messages to (1 = stdout).");
+ABSL_FLAG(bool, async_output, true,
+    "Write messages from a background thread so callbacks never block on I/O.");
+ABSL_FLAG(int, flush_interval_ms, 5,
+    "Async output: longest time a message may wait in the coalescing buffer (>= 1).");
+ABSL_FLAG(int, flush_bytes, 16384,
+    "Async output: write as soon as this many bytes are buffered.");
+ABSL_FLAG(int, output_queue_capacity, 1024,
+    "Async output: queued messages before edge/focus updates start being dropped.");
+ABSL_FLAG(std::string, emit, "full",
+    "What to emit: 'full' (edge, metrics and focus), 'focus' (focus and state "
+    "changes only) or 'summary' (one aggregate record per --summary_window_s).");
+ABSL_FLAG(float, summary_window_s, 10.0f,
+    "Seconds of frames aggregated into each summary record. --emit=summary only.");
+
 // -- Focus analysis thresholds (both modes) --
 ABSL_FLAG(float, blink_threshold, 25.0f,
     "Blink rate threshold (blinks/min) for drowsiness detection.");
@@ -91,6 +219,168 @@ ABSL_FLAG(float, pulse_threshold, 100.0f,
     "Pulse rate threshold (BPM) for stress detection.");
 ABSL_FLAG(float, breathing_threshold, 22.0f,
     "Breathing rate threshold (breaths/min) for stress detection.");
+ABSL_FLAG(float, gaze_threshold, 0.3f,
+    "Gaze deviation magnitude above which the user is distracted.");
+ABSL_FLAG(float, face_absence_timeout_s, 3.0f,
+    "Seconds without a face before the state becomes AWAY.");
+ABSL_FLAG(float, vitals_half_life_s, 15.0f,
+    "Seconds by which a REST vital may lag the newest frame before its weight "
+    "in the focus decision halves. 0 = confidence only.");
+ABSL_FLAG(float, vitals_min_weight, 0.2f,
+    "Vitals weighted (confidence x freshness) below this are ignored.");
+ABSL_FLAG(float, vitals_window_s, 5.0f,
+    "Pulse and breathing rate are averaged over this many seconds of REST "
+    "samples, weighted by confidence. 0 = latest sample only.");
+ABSL_FLAG(float, hrv_window_s, 60.0f,
+    "Seconds of detected heartbeats the HRV features (RMSSD, SDNN) cover.");
+ABSL_FLAG(float, blink_window_s, 60.0f,
+    "Sliding window (seconds) for the blink rate estimate.");
+ABSL_FLAG(int, blink_resolution_ms, 1000,
+    "Bucket width (ms) of the blink rate window.");
+ABSL_FLAG(std::string, gaze_landmarks, "dense",
+    "Face landmarks gaze is estimated from: 'dense' (468-point face mesh), "
+    "'sparse' (the SDK's default keypoints; skips the dense mesh) or 'off'.");
+
+// -- Focus emission (both modes) --
+ABSL_FLAG(bool, focus_change_detection, true,
+    "Only re-analyze and emit 'focus' when an analyzed input or the state changed.");
+ABSL_FLAG(float, focus_emit_hz, 0.0f,
+    "Maximum 'focus' messages per second that carry only new inputs "
+    "(state changes are never delayed). 0 = unlimited.");
+
+// -- Focus smoothing (both modes) --
+ABSL_FLAG(bool, focus_smoothing, true,
+    "Filter gaze and vitals before the focus decision, and hold a new state "
+    "for --focus_dwell_s before switching to it.");
+ABSL_FLAG(float, focus_dwell_s, 1.0f,
+    "Focus smoothing: seconds a new state must persist before it is reported.");
+ABSL_FLAG(float, gaze_filter_min_cutoff_hz, 1.0f,
+    "Focus smoothing: 1-euro filter cutoff on gaze at rest (lower = smoother).");
+ABSL_FLAG(float, gaze_filter_beta, 0.3f,
+    "Focus smoothing: 1-euro filter speed coefficient on gaze (higher = less lag).");
+ABSL_FLAG(float, vitals_filter_s, 5.0f,
+    "Focus smoothing: EMA time constant (seconds) on pulse and breathing rate.");
+
+// -- REST integration (live modes) --
+ABSL_FLAG(float, rest_buffer_duration_s, 0.2f,
+    "Seconds of preprocessed data per Physiology REST request; longer = fewer, "
+    "larger requests and staler vitals.");
+ABSL_FLAG(bool, rest_adaptive, false,
+    "Lengthen the REST buffer while the focus state is stable or the user is away, "
+    "and return to --rest_buffer_duration_s when vitals near the stress thresholds. "
+    "Each change rebuilds the pipeline (not in --multi mode).");
+ABSL_FLAG(float, rest_stable_buffer_s, 1.0f,
+    "Adaptive REST: buffer duration once the state has been stable.");
+ABSL_FLAG(float, rest_idle_buffer_s, 2.0f,
+    "Adaptive REST: buffer duration once AWAY has been stable.");
+ABSL_FLAG(float, rest_stable_after_s, 120.0f,
+    "Adaptive REST: seconds in one state before it counts as stable.");
+ABSL_FLAG(float, rest_stress_fraction, 0.9f,
+    "Adaptive REST: fraction of a stress threshold at which a vital counts as "
+    "nearing it.");
+ABSL_FLAG(float, rest_min_restart_interval_s, 60.0f,
+    "Adaptive REST: minimum seconds between pipeline rebuilds (except on nearing stress).");
+ABSL_FLAG(float, rest_report_interval_s, 60.0f,
+    "Log REST request count and round-trip latency every this many seconds. "
+    "0 = only the totals at shutdown.");
+
+// -- Frame governor (live modes) --
+ABSL_FLAG(bool, frame_governor, false,
+    "Lower the processed frame rate (and, where the bridge owns the frames, the "
+    "resolution) while the focus state is stable or the user is away.");
+ABSL_FLAG(float, governor_stable_fps, 15.0f,
+    "Frame governor: processed fps once the state has been stable.");
+ABSL_FLAG(float, governor_stable_after_s, 120.0f,
+    "Frame governor: seconds in one state before it counts as stable.");
+ABSL_FLAG(float, governor_idle_fps, 2.0f,
+    "Frame governor: processed fps while AWAY.");
+ABSL_FLAG(float, governor_stable_scale, 1.0f,
+    "Frame governor: downscale factor while stable (shm/net/multi modes).");
+ABSL_FLAG(float, governor_idle_scale, 0.5f,
+    "Frame governor: downscale factor while AWAY (shm/net/multi modes).");
+ABSL_FLAG(float, governor_latency_budget_ms, 250.0f,
+    "Frame governor: throttle further while frames take longer than this to "
+    "come out of the graph. 0 = no latency feedback.");
+
+// -- Presence watch (live modes) --
+ABSL_FLAG(bool, presence_watch, false,
+    "While AWAY (no face for --face_absence_timeout_s), stop feeding the SDK and "
+    "only run a cheap face check until someone is back.");
+ABSL_FLAG(std::string, presence_cascade,
+    "/usr/share/opencv4/haarcascades/haarcascade_frontalface_default.xml",
+    "Presence watch: OpenCV Haar cascade used for the cheap face check.");
+ABSL_FLAG(int, presence_check_ms, 300,
+    "Presence watch: interval between cheap face checks.");
+ABSL_FLAG(int, presence_keepalive_ms, 2000,
+    "Presence watch: interval between frames still handed to the SDK.");
+
+// -- Metrics endpoint (live modes) --
+ABSL_FLAG(int, metrics_port, 0,
+    "Serve Prometheus metrics (frame and callback counters, latency histograms, "
+    "output queue depth) at http://<metrics_host>:<port>/metrics. 0 = off.");
+ABSL_FLAG(std::string, metrics_host, "127.0.0.1",
+    "Address the metrics endpoint binds to; 0.0.0.0 to scrape from another host.");
+
+// -- Latency tracing (single-session live modes) --
+ABSL_FLAG(int, trace_every, 0,
+    "Trace one frame in N from the video callback to the focus emit and write its "
+    "stage times to --trace_path (one JSON line per frame). 0 = off.");
+ABSL_FLAG(std::string, trace_path, "",
+    "File the frame traces are written to (truncated).");
+
+// -- Daemon (single-session live modes) --
+ABSL_FLAG(bool, daemon, false,
+    "Stay resident between sessions: start paused until a start command on stdin, "
+    "and shut down when stdin closes.");
+
+// -- Focus history (single-session live modes) --
+ABSL_FLAG(bool, history, false,
+    "Keep a 1 s / 1 min / 1 h history of focus, vitals and gaze for "
+    "query_history commands.");
+ABSL_FLAG(std::string, history_path, "",
+    "History: memory-mapped file it lives in and is restored from. Empty = memory only.");
+ABSL_FLAG(float, history_flush_s, 10.0f,
+    "History: seconds between syncs of --history_path to disk.");
+
+// -- Frame features (single-session live modes) --
+ABSL_FLAG(bool, frame_features, false,
+    "Measure brightness, motion, face sharpness and face exposure on a downscaled "
+    "copy of every frame (off the graph thread), and hold the focus state through "
+    "frames too poor to read.");
+ABSL_FLAG(int, frame_feature_width, 160,
+    "Frame features: width the whole frame is sampled at.");
+ABSL_FLAG(int, frame_feature_interval, 1,
+    "Frame features: sample every Nth frame.");
+ABSL_FLAG(float, min_frame_brightness, 0.08f,
+    "Frame features: mean luma (0..1) below which a frame is too dark. 0 = off.");
+ABSL_FLAG(float, min_face_sharpness, 12.0f,
+    "Frame features: Laplacian variance of the face below which it is too blurred. "
+    "0 = off.");
+ABSL_FLAG(float, max_face_clipped, 0.3f,
+    "Frame features: share of crushed or blown-out face pixels above which the face "
+    "is badly exposed. 0 = off.");
+ABSL_FLAG(float, max_frame_motion, 0.0f,
+    "Frame features: mean luma change (0..1) between samples above which a frame is "
+    "smeared by motion. 0 = off (default): a head turn moves the frame as much as "
+    "motion blur does, and is exactly when the state should change.");
+
+// -- Gaze engine (single-session live modes) --
+ABSL_FLAG(bool, gaze_engine, false,
+    "Refine gaze with the eyes' own offset (iris landmarks) and a per-user "
+    "calibration, so head turns while reading the screen aren't DISTRACTED.");
+ABSL_FLAG(std::string, gaze_user, "",
+    "Gaze engine: whose calibration to load and cache. Empty = $USER.");
+ABSL_FLAG(std::string, gaze_calibration_path, "",
+    "Gaze engine: calibration cache file. "
+    "Empty = $XDG_CACHE_HOME/focus-wizard/gaze-<user>.cal.");
+ABSL_FLAG(bool, gaze_recalibrate, false,
+    "Gaze engine: calibrate even if a cached calibration exists.");
+ABSL_FLAG(float, gaze_calibration_s, 5.0f,
+    "Gaze engine: seconds of face frames collected while the user looks at "
+    "the centre of the screen.");
+ABSL_FLAG(float, gaze_eye_gain, 2.5f,
+    "Gaze engine: eye-offset weight used before calibration, or when the head "
+    "didn't move enough during it to fit one.");
 
 // ── Globals ──────────────────────────────────────────────
 static focus_wizard::JsonEmitter g_emitter;
@@ -100,6 +390,275 @@ void signal_handler(int signal) {
     g_shutdown_requested = 1;
 }
 
+// ── Control Commands ─────────────────────────────────────
+// Set from the control channel thread, read by the pipeline callbacks.
+// Sessions start active unless --daemon.
+static std::atomic<bool> g_session_active{true};
+static std::atomic<bool> g_session_reset{false};      // edge thread: fresh analyzer
+static std::atomic<bool> g_rebuild_requested{false};  // new capture settings
+static std::atomic<bool> g_pipeline_ready{false};
+static bool g_capture_configurable = true;            // false in server mode
+static focus_wizard::LiveThresholds* g_live_thresholds = nullptr;
+static focus_wizard::FocusHistory* g_focus_history = nullptr;
+
+// configure bounds: well past any camera, far inside an int
+static constexpr int kMaxCameraIndex = 1024;
+static constexpr int kMaxCaptureDimension = 16384;
+
+// set_thresholds: keys are the flag names; omitted keys keep their value
+static void set_thresholds(const focus_wizard::ControlCommand& command) {
+    using focus_wizard::FocusThresholds;
+    struct Key {
+        const char* name;
+        float FocusThresholds::*field;
+    };
+    static constexpr Key kKeys[] = {
+        {"blink_threshold",        &FocusThresholds::blink_rate_drowsy_threshold},
+        {"pulse_threshold",        &FocusThresholds::pulse_stressed_threshold},
+        {"breathing_threshold",    &FocusThresholds::breathing_stressed_threshold},
+        {"gaze_threshold",         &FocusThresholds::gaze_distraction_threshold},
+        {"face_absence_timeout_s", &FocusThresholds::face_absence_timeout_s},
+        {"vitals_min_weight",      &FocusThresholds::min_vitals_weight},
+    };
+
+    FocusThresholds thresholds = g_live_thresholds->load();
+    for (const focus_wizard::ControlValue& value : command.values) {
+        const std::string& name = value.key;
+        const Key* key = nullptr;
+        for (const Key& candidate : kKeys) {
+            if (name == candidate.name) key = &candidate;
+        }
+        double number = 0.0;
+        if (!key) {
+            g_emitter.emit_error("set_thresholds: unknown threshold '" + name + "'");
+            return;
+        }
+        // NaN passes every comparison, and a float can't hold all doubles
+        if (!command.get_number(name, &number) || !std::isfinite(number) || number < 0.0 ||
+            number > std::numeric_limits<float>::max()) {
+            g_emitter.emit_error("set_thresholds: '" + name + "' must be a finite number >= 0");
+            return;
+        }
+        thresholds.*(key->field) = static_cast<float>(number);
+    }
+    g_live_thresholds->store(thresholds);
+    g_emitter.emit_status("Thresholds updated");
+}
+
+// query_history: aggregates over [from_ms, to_ms) (epoch ms, default all
+// of it until now); "tier" picks 1s/1m/1h, default the finest that reaches
+static void query_history(const focus_wizard::ControlCommand& command) {
+    if (!g_focus_history) {
+        g_emitter.emit_error("query_history: start the bridge with --history");
+        return;
+    }
+    double from_ms = 0.0;
+    double to_ms = static_cast<double>(focus_wizard::wall_clock_us() / 1000 + 1);
+    std::string tier_name = "auto";
+    std::string id;
+    if ((command.has("from_ms") && !command.get_number("from_ms", &from_ms)) ||
+        (command.has("to_ms") && !command.get_number("to_ms", &to_ms)) ||
+        (command.has("tier") && !command.get_string("tier", &tier_name)) ||
+        (command.has("id") && !command.get_string("id", &id))) {
+        g_emitter.emit_error("query_history: from_ms/to_ms must be numbers, tier and id strings");
+        return;
+    }
+    // Both end up in int64 microseconds; 9e15 ms (year ~287000) leaves room
+    // below INT64_MAX / 1000, which a double can't represent exactly
+    constexpr double kMaxMs = 9e15;
+    if (!std::isfinite(from_ms) || !std::isfinite(to_ms) || from_ms < 0.0 || to_ms < 0.0 ||
+        from_ms > kMaxMs || to_ms > kMaxMs) {
+        g_emitter.emit_error("query_history: from_ms/to_ms must be epoch milliseconds >= 0");
+        return;
+    }
+    focus_wizard::HistoryTier tier;
+    bool tier_auto;
+    if (!focus_wizard::parse_history_tier(tier_name, &tier, &tier_auto)) {
+        g_emitter.emit_error("query_history: unknown tier '" + tier_name +
+                             "'. Expected '1s', '1m', '1h' or 'auto'.");
+        return;
+    }
+
+    int64_t from_us = static_cast<int64_t>(from_ms) * 1000;
+    int64_t to_us = static_cast<int64_t>(to_ms) * 1000;
+    if (tier_auto) tier = g_focus_history->tier_for(from_us);
+    focus_wizard::HistorySummary summary;
+    g_focus_history->query(from_us, to_us, tier, &summary);
+
+    std::string payload;
+    focus_wizard::write_history_json(summary, from_us, to_us, id, &payload);
+    g_emitter.emit("history", payload);
+}
+
+// configure: new camera and capture size, applied by rebuilding the
+// container; omitted keys keep their value
+static void configure_capture(const focus_wizard::ControlCommand& command) {
+    if (!g_capture_configurable) {
+        g_emitter.emit_error("configure: server mode reads frames from --file_stream_path, "
+                             "not a camera");
+        return;
+    }
+    double device_index = absl::GetFlag(FLAGS_camera_device_index);
+    double width = absl::GetFlag(FLAGS_capture_width);
+    double height = absl::GetFlag(FLAGS_capture_height);
+    // NaN passes every comparison, and the casts below need an int's range
+    auto in_range = [](double value, double min, double max) {
+        return std::isfinite(value) && value >= min && value <= max;
+    };
+    if ((command.has("camera_device_index") &&
+         !command.get_number("camera_device_index", &device_index)) ||
+        (command.has("capture_width") && !command.get_number("capture_width", &width)) ||
+        (command.has("capture_height") && !command.get_number("capture_height", &height)) ||
+        !in_range(device_index, 0, kMaxCameraIndex) ||
+        !in_range(width, 1, kMaxCaptureDimension) || !in_range(height, 1, kMaxCaptureDimension)) {
+        g_emitter.emit_error("configure: camera_device_index must be a number in [0, " +
+                             std::to_string(kMaxCameraIndex) + "] and capture_width/"
+                             "capture_height numbers in [1, " +
+                             std::to_string(kMaxCaptureDimension) + "]");
+        return;
+    }
+    absl::SetFlag(&FLAGS_camera_device_index, static_cast<int>(device_index));
+    absl::SetFlag(&FLAGS_capture_width, static_cast<int>(width));
+    absl::SetFlag(&FLAGS_capture_height, static_cast<int>(height));
+    g_rebuild_requested = true;
+}
+
+static void handle_control_command(const focus_wizard::ControlCommand& command) {
+    if (command.cmd == "start") {
+        if (!g_session_active.exchange(true)) g_session_reset = true;
+        // Before the first Initialize() the pipeline signals ready itself
+        if (g_pipeline_ready) g_emitter.emit_ready();
+    } else if (command.cmd == "stop") {
+        g_session_active = false;
+        g_emitter.emit_status("Session stopped; waiting for start");
+    } else if (command.cmd == "configure") {
+        configure_capture(command);
+    } else if (command.cmd == "set_thresholds") {
+        set_thresholds(command);
+    } else if (command.cmd == "query_history") {
+        query_history(command);
+    } else if (command.cmd == "shutdown") {
+        g_shutdown_requested = 1;
+    } else {
+        g_emitter.emit_error("Unknown command '" + command.cmd + "'");
+    }
+}
+
+// Multi-camera mode: the tracks share the thresholds; there is one
+// pipeline per camera to start, stop or rebuild, and no history
+static void handle_camera_command(const focus_wizard::ControlCommand& command) {
+    if (command.cmd == "set_thresholds") {
+        set_thresholds(command);
+    } else if (command.cmd == "shutdown") {
+        g_shutdown_requested = 1;
+    } else {
+        g_emitter.emit_error("'" + command.cmd +
+                             "' is not available with --camera_device_indices");
+    }
+}
+
+// ── Shutdown ─────────────────────────────────────────────
+static void shutdown_output() {
+    if (uint64_t dropped = g_emitter.dropped_messages(); dropped > 0) {
+        LOG(INFO) << "Dropped " << dropped << " stale edge/focus messages under backpressure";
+    }
+    g_emitter.stop_async_writer();
+}
+
+// The partial window at the end of a session still goes out
+static void flush_summary(focus_wizard::FocusSummary* summary) {
+    if (summary && summary->flush()) {
+        g_emitter.emit("summary", summary->json());
+    }
+}
+
+// ── Gaze Calibration ─────────────────────────────────────
+// Runs on the edge callback thread after each frame: when a calibration
+// that was in progress has finished, report it and cache it.
+
+static void check_gaze_calibration(focus_wizard::GazeEstimator& estimator,
+                                   const std::string& path, bool* calibrating) {
+    bool now_calibrating = estimator.state() == focus_wizard::GazeCalibrationState::CALIBRATING;
+    if (!*calibrating || now_calibrating) {
+        *calibrating = now_calibrating;
+        return;
+    }
+    *calibrating = false;
+
+    const focus_wizard::GazeCalibration& calibration = estimator.calibration();
+    g_emitter.emit_status("Gaze calibration complete (" + std::to_string(calibration.samples) +
+                          " frames" + (calibration.has_iris ? "" : ", head pose only") + ")");
+    std::string error;
+    if (!focus_wizard::save_gaze_calibration(path, calibration, &error)) {
+        LOG(WARNING) << "Gaze calibration not cached: " << error;
+    }
+}
+
+// ── Replay ───────────────────────────────────────────────
+// Feeds a recorded session through the same publish helpers the live
+// callbacks use, paced by the recorded timestamps.
+
+static int run_replay(const std::string& path, float speed,
+                      focus_wizard::MetricsCollector& collector,
+                      focus_wizard::FocusAnalyzer& analyzer,
+                      focus_wizard::FocusSummary* summary) {
+    focus_wizard::MappedSessionLog log;
+    std::string error;
+    if (!log.open(path, &error)) {
+        g_emitter.emit_error("Failed to open replay log: " + error);
+        return 1;
+    }
+
+    g_emitter.emit_ready();
+
+    focus_wizard::SessionLogView view = log.view();
+    focus_wizard::SessionRecord record;
+    presage::physiology::MetricsBuffer core;
+    presage::physiology::Metrics edge;
+
+    const auto start = std::chrono::steady_clock::now();
+    int64_t first_timestamp = 0;
+    bool first = true;
+
+    while (!g_shutdown_requested && view.next(&record)) {
+        if (first) {
+            first_timestamp = record.timestamp_us;
+            first = false;
+        }
+        if (speed > 0.0f) {
+            auto offset = std::chrono::microseconds(static_cast<int64_t>(
+                static_cast<double>(record.timestamp_us - first_timestamp) / speed));
+            std::this_thread::sleep_until(start + offset);
+        }
+
+        if (record.kind == focus_wizard::SessionRecordKind::CORE) {
+            if (!core.ParseFromArray(record.data, static_cast<int>(record.size))) {
+                LOG(WARNING) << "Skipping unparseable core record at " << record.timestamp_us;
+                continue;
+            }
+            focus_wizard::publish_core(g_emitter, collector, core, record.timestamp_us);
+        } else {
+            if (!edge.ParseFromArray(record.data, static_cast<int>(record.size))) {
+                LOG(WARNING) << "Skipping unparseable edge record at " << record.timestamp_us;
+                continue;
+            }
+            focus_wizard::publish_edge(g_emitter, collector, edge, record.timestamp_us);
+            focus_wizard::FocusMetrics snapshot = collector.current();
+            focus_wizard::FocusResult result =
+                focus_wizard::publish_focus(g_emitter, analyzer, snapshot);
+            if (summary) focus_wizard::publish_summary(g_emitter, *summary, snapshot, result);
+        }
+    }
+    flush_summary(summary);
+
+    if (view.truncated()) {
+        g_emitter.emit_status("Replay log ends in a truncated record");
+    }
+    g_emitter.emit_status("Shutting down...");
+    shutdown_output();
+    return 0;
+}
+
 // ── Resolve API Key ──────────────────────────────────────
 std::string resolve_api_key() {
     std::string key = absl::GetFlag(FLAGS_api_key);
@@ -120,27 +679,201 @@ int main(int argc, char** argv) {
 
     absl::SetProgramUsageMessage(
         "Focus Wizard Bridge — headless SmartSpectra runner.\n"
-        "Two modes: 'local' (captures webcam) or 'server' (reads frame files).\n\n"
+        "Modes: 'local' (captures webcam), 'server' (reads frame files), "
+        "'shm' (reads a shared-memory frame ring), 'net' (accepts frames over TCP), "
+        "'multi' (one session per TCP client) or 'replay' (plays back a recorded session).\n\n"
         "Local:  focus_bridge --api_key=KEY\n"
         "Server: focus_bridge --api_key=KEY --mode=server "
-        "--file_stream_path=/tmp/focus_frames/frame0000000000000000.png"
+        "--file_stream_path=/tmp/focus_frames/frame0000000000000000.png\n"
+        "Net:    focus_bridge --api_key=KEY --mode=net --listen=0.0.0.0:9000\n"
+        "Multi:  focus_bridge --api_key=KEY --mode=multi --listen=0.0.0.0:9000 --max_sessions=16\n"
+        "Edge:   focus_bridge --integration=edge_only\n"
+        "Replay: focus_bridge --mode=replay --replay_path=/tmp/session.fwsl"
     );
     absl::ParseCommandLine(argc, argv);
 
+    // Select the output format before anything else is emitted
+    focus_wizard::OutputFormat output_format;
+    if (!focus_wizard::parse_output_format(absl::GetFlag(FLAGS_output_format), &output_format)) {
+        g_emitter.emit_error("Unknown --output_format '" + absl::GetFlag(FLAGS_output_format) +
+                             "'. Expected 'ndjson' or 'binary'.");
+        return 1;
+    }
+    g_emitter.configure(output_format, absl::GetFlag(FLAGS_output_fd));
+
+    focus_wizard::EmitLevel emit_level;
+    if (!focus_wizard::parse_emit_level(absl::GetFlag(FLAGS_emit), &emit_level)) {
+        g_emitter.emit_error("Unknown --emit '" + absl::GetFlag(FLAGS_emit) +
+                             "'. Expected 'full', 'focus' or 'summary'.");
+        return 1;
+    }
+    g_emitter.set_level(emit_level);
+
+    focus_wizard::LandmarkMode landmark_mode;
+    if (!focus_wizard::parse_landmark_mode(absl::GetFlag(FLAGS_gaze_landmarks), &landmark_mode)) {
+        g_emitter.emit_error("Unknown --gaze_landmarks '" + absl::GetFlag(FLAGS_gaze_landmarks) +
+                             "'. Expected 'dense', 'sparse' or 'off'.");
+        return 1;
+    }
+
+    const std::string integration = absl::GetFlag(FLAGS_integration);
+    if (integration != "rest" && integration != "edge_only") {
+        g_emitter.emit_error("Unknown --integration '" + integration +
+                             "'. Expected 'rest' or 'edge_only'.");
+        return 1;
+    }
+    const bool edge_only = integration == "edge_only";
+
+    focus_wizard::Backend backend;
+    if (!focus_wizard::parse_backend(absl::GetFlag(FLAGS_backend), &backend)) {
+        g_emitter.emit_error("Unknown --backend '" + absl::GetFlag(FLAGS_backend) +
+                             "'. Expected 'cpu' or 'gpu'.");
+        return 1;
+    }
+
+    if (absl::GetFlag(FLAGS_async_output)) {
+        focus_wizard::AsyncWriterOptions writer_options;
+        writer_options.queue_capacity    = static_cast<size_t>(
+            std::max(2, absl::GetFlag(FLAGS_output_queue_capacity)));
+        writer_options.flush_interval_ms = std::max(1, absl::GetFlag(FLAGS_flush_interval_ms));
+        writer_options.flush_bytes       = static_cast<size_t>(
+            std::max(1, absl::GetFlag(FLAGS_flush_bytes)));
+        g_emitter.start_async_writer(writer_options);
+    }
+
     // Handle signals for graceful shutdown
     std::signal(SIGINT, signal_handler);
     std::signal(SIGTERM, signal_handler);
 
-    // Resolve API key
-    std::string api_key = resolve_api_key();
-    if (api_key.empty()) {
-        g_emitter.emit_error("No API key provided. Use --api_key=KEY or set SMARTSPECTRA_API_KEY");
-        return 1;
+    // ── Setup Focus Analysis Pipeline ────────────────────
+    focus_wizard::BlinkRateOptions blink_options;
+    blink_options.window_s     = absl::GetFlag(FLAGS_blink_window_s);
+    blink_options.resolution_s = absl::GetFlag(FLAGS_blink_resolution_ms) / 1000.0f;
+    focus_wizard::FusionOptions fusion;
+    fusion.vitals_half_life_s = std::max(0.0f, absl::GetFlag(FLAGS_vitals_half_life_s));
+    focus_wizard::VitalsOptions vitals;
+    vitals.rate_window_s = std::max(0.0f, absl::GetFlag(FLAGS_vitals_window_s));
+    vitals.hrv_window_s  = std::max(1.0f, absl::GetFlag(FLAGS_hrv_window_s));
+    vitals.edge_breathing = edge_only;
+    focus_wizard::MetricsCollector collector(blink_options, landmark_mode, fusion, vitals);
+    focus_wizard::FocusThresholds thresholds;
+    thresholds.blink_rate_drowsy_threshold = absl::GetFlag(FLAGS_blink_threshold);
+    thresholds.pulse_stressed_threshold    = absl::GetFlag(FLAGS_pulse_threshold);
+    thresholds.breathing_stressed_threshold = absl::GetFlag(FLAGS_breathing_threshold);
+    thresholds.min_vitals_weight           = absl::GetFlag(FLAGS_vitals_min_weight);
+    thresholds.gaze_distraction_threshold  = absl::GetFlag(FLAGS_gaze_threshold);
+    thresholds.face_absence_timeout_s      = absl::GetFlag(FLAGS_face_absence_timeout_s);
+    focus_wizard::FocusEmitPolicy emit_policy;
+    emit_policy.change_detection = absl::GetFlag(FLAGS_focus_change_detection);
+    emit_policy.max_emit_hz      = absl::GetFlag(FLAGS_focus_emit_hz);
+    focus_wizard::FocusSmoothing smoothing;
+    smoothing.enabled                = absl::GetFlag(FLAGS_focus_smoothing);
+    smoothing.dwell_s                = std::max(0.0f, absl::GetFlag(FLAGS_focus_dwell_s));
+    smoothing.gaze.min_cutoff_hz     = std::max(0.01f, absl::GetFlag(FLAGS_gaze_filter_min_cutoff_hz));
+    smoothing.gaze.beta              = std::max(0.0f, absl::GetFlag(FLAGS_gaze_filter_beta));
+    smoothing.vitals_time_constant_s = std::max(0.0f, absl::GetFlag(FLAGS_vitals_filter_s));
+    focus_wizard::FocusAnalyzer analyzer(thresholds, emit_policy, smoothing);
+
+    // --emit=summary: windowed aggregates instead of per-frame messages
+    focus_wizard::FocusSummaryOptions summary_options;
+    summary_options.window_s = std::max(1.0f, absl::GetFlag(FLAGS_summary_window_s));
+    std::unique_ptr<focus_wizard::FocusSummary> summary;
+    if (emit_level == focus_wizard::EmitLevel::SUMMARY) {
+        summary = std::make_unique<focus_wizard::FocusSummary>(summary_options);
+    }
+    focus_wizard::FocusSummary* focus_summary = summary.get();
+
+    focus_wizard::RestCadenceOptions rest_options;
+    rest_options.base_s                 = std::max(0.05f, absl::GetFlag(FLAGS_rest_buffer_duration_s));
+    rest_options.adaptive               = absl::GetFlag(FLAGS_rest_adaptive) && !edge_only;
+    rest_options.stable_s               = std::max(rest_options.base_s,
+                                                   absl::GetFlag(FLAGS_rest_stable_buffer_s));
+    rest_options.idle_s                 = std::max(rest_options.base_s,
+                                                   absl::GetFlag(FLAGS_rest_idle_buffer_s));
+    rest_options.stable_after_s         = absl::GetFlag(FLAGS_rest_stable_after_s);
+    rest_options.stress_fraction        = absl::GetFlag(FLAGS_rest_stress_fraction);
+    rest_options.min_restart_interval_s = absl::GetFlag(FLAGS_rest_min_restart_interval_s);
+
+    focus_wizard::FrameGovernorOptions governor_options;
+    governor_options.stable_fps        = absl::GetFlag(FLAGS_governor_stable_fps);
+    governor_options.stable_after_s    = absl::GetFlag(FLAGS_governor_stable_after_s);
+    governor_options.idle_fps          = absl::GetFlag(FLAGS_governor_idle_fps);
+    governor_options.stable_scale      = absl::GetFlag(FLAGS_governor_stable_scale);
+    governor_options.idle_scale        = absl::GetFlag(FLAGS_governor_idle_scale);
+    governor_options.latency_budget_ms = absl::GetFlag(FLAGS_governor_latency_budget_ms);
+    std::unique_ptr<focus_wizard::FrameGovernor> governor;
+    if (absl::GetFlag(FLAGS_frame_governor)) {
+        governor = std::make_unique<focus_wizard::FrameGovernor>(governor_options);
+    }
+    focus_wizard::FrameGovernor* frame_governor = governor.get();
+
+    focus_wizard::PresenceWatchOptions watch_options;
+    watch_options.cascade_path = absl::GetFlag(FLAGS_presence_cascade);
+    watch_options.check_ms     = std::max(1, absl::GetFlag(FLAGS_presence_check_ms));
+    watch_options.keepalive_ms = std::max(1, absl::GetFlag(FLAGS_presence_keepalive_ms));
+    std::unique_ptr<focus_wizard::PresenceWatch> watch;
+    if (absl::GetFlag(FLAGS_presence_watch)) {
+        watch = std::make_unique<focus_wizard::PresenceWatch>(watch_options);
+        std::string error;
+        if (!watch->load(&error)) {
+            LOG(WARNING) << "Presence watch without a face detector: " << error;
+        }
     }
+    focus_wizard::PresenceWatch* presence_watch = watch.get();
 
     // Determine mode
     std::string mode = absl::GetFlag(FLAGS_mode);
     bool server_mode = (mode == "server");
+    g_capture_configurable = !server_mode;
+    bool shm_mode = (mode == "shm");
+    bool net_mode = (mode == "net");
+    bool multi_mode = (mode == "multi");
+
+    const bool daemon = absl::GetFlag(FLAGS_daemon);
+    if (daemon && (multi_mode || mode == "replay")) {
+        g_emitter.emit_error("--daemon needs a single-session live mode, not '" + mode + "'.");
+        return 1;
+    }
+
+    std::vector<int> camera_devices;
+    if (std::string indices = absl::GetFlag(FLAGS_camera_device_indices); !indices.empty()) {
+        std::string error;
+        if (!focus_wizard::parse_camera_indices(indices, &camera_devices, &error)) {
+            g_emitter.emit_error("Bad --camera_device_indices: " + error);
+            return 1;
+        }
+        if (mode != "local" || daemon) {
+            g_emitter.emit_error("--camera_device_indices needs local mode without --daemon.");
+            return 1;
+        }
+    }
+    // One index is just the single-camera path
+    if (camera_devices.size() == 1) {
+        absl::SetFlag(&FLAGS_camera_device_index, camera_devices.front());
+    }
+    const bool multi_camera = camera_devices.size() > 1;
+
+    if (mode == "replay") {
+        std::string replay_path = absl::GetFlag(FLAGS_replay_path);
+        if (replay_path.empty()) {
+            g_emitter.emit_error("Replay mode requires --replay_path.");
+            return 1;
+        }
+        g_emitter.emit_status("Starting in REPLAY mode (" + replay_path + ")...");
+        return run_replay(replay_path, absl::GetFlag(FLAGS_replay_speed), collector, analyzer,
+                          focus_summary);
+    }
+
+    // Resolve API key
+    std::string api_key = edge_only ? std::string() : resolve_api_key();
+    if (api_key.empty() && !edge_only) {
+        g_emitter.emit_error("No API key provided. Use --api_key=KEY or set SMARTSPECTRA_API_KEY "
+                             "(or run with --integration=edge_only)");
+        return 1;
+    }
+    if (edge_only) {
+        g_emitter.emit_status("Edge-only integration: no REST uploads, pulse unavailable");
+    }
 
     if (server_mode) {
         std::string fsp = absl::GetFlag(FLAGS_file_stream_path);
@@ -150,10 +883,138 @@ int main(int argc, char** argv) {
             return 1;
         }
         g_emitter.emit_status("Starting in SERVER mode (reading frames from directory)...");
+    } else if (shm_mode) {
+        g_emitter.emit_status("Starting in SHM mode (reading frames from shared memory)...");
+    } else if (net_mode) {
+        g_emitter.emit_status("Starting in NET mode (accepting frames on " +
+                              absl::GetFlag(FLAGS_listen) + ")...");
+    } else if (multi_mode) {
+        g_emitter.emit_status("Starting in MULTI mode (serving sessions on " +
+                              absl::GetFlag(FLAGS_listen) + ")...");
+    } else if (multi_camera) {
+        g_emitter.emit_status("Starting in LOCAL mode (capturing " +
+                              std::to_string(camera_devices.size()) + " cameras)...");
     } else {
         g_emitter.emit_status("Starting in LOCAL mode (capturing webcam)...");
     }
 
+    // ── Gaze Engine ──────────────────────────────────────
+    // Multi mode has no per-session user identity, so its sessions keep
+    // plain head-pose gaze; so do multi-camera tracks.
+    focus_wizard::GazeEstimatorOptions gaze_options;
+    gaze_options.calibration_s = std::max(0.0f, absl::GetFlag(FLAGS_gaze_calibration_s));
+    gaze_options.eye_gain      = absl::GetFlag(FLAGS_gaze_eye_gain);
+    std::unique_ptr<focus_wizard::GazeEstimator> gaze_engine;
+    std::string gaze_calibration_path = absl::GetFlag(FLAGS_gaze_calibration_path);
+    bool gaze_calibrating = false;
+    if (absl::GetFlag(FLAGS_gaze_engine) && !multi_mode && !multi_camera) {
+        gaze_engine = std::make_unique<focus_wizard::GazeEstimator>(gaze_options);
+        if (gaze_calibration_path.empty()) {
+            std::string user = absl::GetFlag(FLAGS_gaze_user);
+            if (user.empty()) {
+                const char* env_user = std::getenv("USER");
+                if (env_user) user = env_user;
+            }
+            gaze_calibration_path = focus_wizard::default_gaze_calibration_path(user);
+        }
+
+        focus_wizard::GazeCalibration calibration;
+        std::string error;
+        if (!absl::GetFlag(FLAGS_gaze_recalibrate) &&
+            focus_wizard::load_gaze_calibration(gaze_calibration_path, &calibration, &error)) {
+            gaze_engine->set_calibration(calibration);
+            g_emitter.emit_status("Using cached gaze calibration " + gaze_calibration_path);
+        } else {
+            gaze_engine->start_calibration();
+            gaze_calibrating = true;
+            g_emitter.emit_status("Gaze calibration: look at the centre of the screen and "
+                                  "move your head slowly");
+        }
+        collector.set_gaze_estimator(gaze_engine.get());
+    }
+    focus_wizard::GazeEstimator* gaze_estimator = gaze_engine.get();
+
+    // ── External Frame Transports ────────────────────────
+    // Declared before the container so they outlive its video source.
+    focus_wizard::FrameRingReader frame_ring;
+    focus_wizard::NetIngestServer net_server;
+    focus_wizard::FrameProvider* frame_provider = nullptr;
+
+    focus_wizard::NetIngestOptions net_options;
+    net_options.listen             = absl::GetFlag(FLAGS_listen);
+    net_options.max_clients        = multi_mode
+        ? static_cast<size_t>(std::max(1, absl::GetFlag(FLAGS_max_sessions))) : 1;
+    net_options.max_frame_bytes    = static_cast<size_t>(
+        std::max(1, absl::GetFlag(FLAGS_net_max_frame_bytes)));
+    net_options.max_outbound_bytes = static_cast<size_t>(
+        std::max(1, absl::GetFlag(FLAGS_net_outbound_bytes)));
+
+    if (shm_mode) {
+        std::string ring_path = absl::GetFlag(FLAGS_shm_path);
+        std::string doorbell_path = absl::GetFlag(FLAGS_shm_doorbell_path);
+        if (doorbell_path.empty()) doorbell_path = ring_path + ".bell";
+
+        std::string error;
+        if (!frame_ring.open(ring_path, doorbell_path, &error)) {
+            g_emitter.emit_error("Failed to open frame ring: " + error);
+            return 1;
+        }
+        frame_provider = &frame_ring;
+    } else if (net_mode) {
+        std::string error;
+        if (!net_server.start(net_options, &error)) {
+            g_emitter.emit_error("Failed to start frame ingest: " + error);
+            return 1;
+        }
+        focus_wizard::NetChannel& channel = net_server.channel(0);
+        frame_provider = &channel;
+
+        // From here on every message goes to the connected client
+        g_emitter.set_sink([&channel](focus_wizard::MessageType type,
+                                      const char* data, size_t length) {
+            channel.send(type, data, length);
+        });
+    }
+
+    // ── Metrics Endpoint ─────────────────────────────────
+    // Declared after everything its values read, so it stops first.
+    focus_wizard::MetricsServer metrics_server;
+    if (int metrics_port = absl::GetFlag(FLAGS_metrics_port); metrics_port > 0) {
+        using focus_wizard::MetricType;
+        metrics_server.add_value(
+            "focus_bridge_output_queue_depth", "Messages waiting for the output writer thread.",
+            MetricType::GAUGE, [] { return static_cast<double>(g_emitter.queue_depth()); });
+        metrics_server.add_value(
+            "focus_bridge_output_bytes_total", "Bytes written to the output fd.",
+            MetricType::COUNTER, [] { return static_cast<double>(g_emitter.bytes_written()); });
+        metrics_server.add_value(
+            "focus_bridge_output_dropped_total",
+            "Edge/focus messages dropped or merged away under output backpressure.",
+            MetricType::COUNTER, [] { return static_cast<double>(g_emitter.dropped_messages()); });
+        metrics_server.add_value(
+            "focus_bridge_frames_dropped_total",
+            "Frames replaced unread in the shm/net mailbox or skipped by the frame governor.",
+            MetricType::COUNTER, [frame_provider, frame_governor] {
+                uint64_t dropped = frame_provider ? frame_provider->skipped() : 0;
+                if (frame_governor) dropped += frame_governor->skipped();
+                return static_cast<double>(dropped);
+            });
+        if (multi_mode) {
+            metrics_server.add_value(
+                "focus_bridge_connections_refused_total",
+                "Connections refused because every session slot was in use.",
+                MetricType::COUNTER,
+                [&net_server] { return static_cast<double>(net_server.rejected()); });
+        }
+
+        std::string error;
+        focus_wizard::pipeline_metrics().set_enabled(true);
+        if (!metrics_server.start(absl::GetFlag(FLAGS_metrics_host), metrics_port, &error)) {
+            g_emitter.emit_error("Failed to start metrics endpoint: " + error);
+            return 1;
+        }
+    }
+
     try {
         // ── Configure SmartSpectra ───────────────────────
         settings::Settings<
@@ -171,6 +1032,12 @@ int main(int argc, char** argv) {
             // Leave input_video_path empty so factory picks file_stream
             ss_settings.video_source.input_video_path     = "";
             ss_settings.video_source.input_video_time_path = "";
+        } else if (frame_provider || multi_mode) {
+            // ── Shm/net/multi mode: frames come from FrameVideoSource ──
+            ss_settings.video_source.capture_width_px  = absl::GetFlag(FLAGS_capture_width);
+            ss_settings.video_source.capture_height_px = absl::GetFlag(FLAGS_capture_height);
+            ss_settings.video_source.input_video_path      = "";
+            ss_settings.video_source.input_video_time_path = "";
         } else {
             // ── Local mode: capture from webcam directly ─────────────
             ss_settings.video_source.device_index      = absl::GetFlag(FLAGS_camera_device_index);
@@ -187,145 +1054,546 @@ int main(int argc, char** argv) {
 
         // Start recording immediately (no GUI → no user press "s")
         // Without this the REST sync pipeline never receives data and
-        // the UsageSyncCalculator times out.
-        ss_settings.start_with_recording_on = true;
+        // the UsageSyncCalculator times out. Edge-only wants exactly that:
+        // the edge graph runs regardless and nothing is uploaded.
+        ss_settings.start_with_recording_on = !edge_only;
 
         // We want edge metrics for myofacial analysis (gaze, blinks, etc.)
         ss_settings.enable_edge_metrics = true;
 
-        // Enable dense face mesh (468 landmarks) for gaze estimation
-        ss_settings.enable_dense_facemesh_points = true;
+        // Dense face mesh (468 landmarks) only when gaze reads it
+        ss_settings.enable_dense_facemesh_points = landmark_mode == focus_wizard::LandmarkMode::DENSE;
 
         ss_settings.verbosity_level = 1; // moderate — helps debug startup issues
 
-        // Continuous mode: buffer duration (seconds).
+        // Continuous mode: buffer duration (seconds), one REST request each.
         // 0.2 matches Android SDK default; shorter = more frequent API updates.
-        ss_settings.continuous.preprocessed_data_buffer_duration_s = 0.2;
+        ss_settings.continuous.preprocessed_data_buffer_duration_s = rest_options.base_s;
 
-        // API key for REST integration
+        // API key for REST integration (empty when edge-only)
         ss_settings.integration.api_key = api_key;
 
-        // ── Create Container ─────────────────────────────
-        auto ss_container = std::make_unique<
-            container::CpuContinuousRestForegroundContainer
-        >(ss_settings);
-
-        // ── Setup Focus Analysis Pipeline ────────────────
-        focus_wizard::MetricsCollector collector;
-        focus_wizard::FocusThresholds thresholds;
-        thresholds.blink_rate_drowsy_threshold = absl::GetFlag(FLAGS_blink_threshold);
-        thresholds.pulse_stressed_threshold    = absl::GetFlag(FLAGS_pulse_threshold);
-        thresholds.breathing_stressed_threshold = absl::GetFlag(FLAGS_breathing_threshold);
-        focus_wizard::FocusAnalyzer analyzer(thresholds);
-
-        // ── Core Metrics Callback ────────────────────────
-        // Fires when the Physiology REST API returns refined metrics
-        // (pulse rate, breathing rate, HRV, etc.)
-        auto core_status = ss_container->SetOnCoreMetricsOutput(
-            [&collector, &analyzer](
-                const presage::physiology::MetricsBuffer& metrics,
-                int64_t timestamp
-            ) {
-                // Extract metrics
-                std::string metrics_json = collector.process_core_metrics(metrics, timestamp);
-                g_emitter.emit("metrics", metrics_json);
-
-                // Run focus analysis on updated state
-                std::string focus_json = analyzer.analyze(collector.current());
-                g_emitter.emit("focus", focus_json);
-
-                return absl::OkStatus();
+        // ── Multi-session: one container per client ──────
+        if (multi_mode) {
+            focus_wizard::SessionHostOptions host_options;
+            host_options.blink          = blink_options;
+            host_options.landmark_mode  = landmark_mode;
+            host_options.fusion         = fusion;
+            host_options.vitals         = vitals;
+            host_options.thresholds     = thresholds;
+            host_options.emit_policy    = emit_policy;
+            host_options.smoothing      = smoothing;
+            host_options.format         = output_format;
+            host_options.emit_level     = emit_level;
+            host_options.summary        = summary_options;
+            host_options.backend        = backend;
+            host_options.capture_width  = absl::GetFlag(FLAGS_capture_width);
+            host_options.capture_height = absl::GetFlag(FLAGS_capture_height);
+            host_options.governor       = absl::GetFlag(FLAGS_frame_governor);
+            host_options.governor_options = governor_options;
+            host_options.presence_watch = absl::GetFlag(FLAGS_presence_watch);
+            host_options.presence_options = watch_options;
+            focus_wizard::SessionHost host(net_server, ss_settings, host_options, g_emitter);
+
+            std::string error;
+            if (!net_server.start(net_options, &error)) {
+                g_emitter.emit_error("Failed to start frame ingest: " + error);
+                return 1;
             }
-        );
-        if (!core_status.ok()) {
-            g_emitter.emit_error("Failed to set core metrics callback: " +
-                                 std::string(core_status.message()));
-            return 1;
+            g_emitter.emit_ready();
+            host.run(&g_shutdown_requested);
+
+            g_emitter.emit_status("Shutting down...");
+            net_server.stop();
+            LOG(INFO) << "Served " << host.sessions_started() << " sessions ("
+                      << net_server.rejected() << " connections refused)";
+            shutdown_output();
+            return 0;
         }
 
-        // ── Edge Metrics Callback ────────────────────────
-        // Fires per-frame with on-device computed data
-        // (face landmarks, blinks, talking, etc.)
-        auto edge_status = ss_container->SetOnEdgeMetricsOutput(
-            [&collector, &analyzer](
-                const presage::physiology::Metrics& metrics,
-                int64_t timestamp
-            ) {
-                // Extract edge metrics
-                std::string edge_json = collector.process_edge_metrics(metrics);
-                g_emitter.emit("edge", edge_json);
+        // ── Multi-camera: one container per camera ───────
+        if (multi_camera) {
+            focus_wizard::CameraHostOptions host_options;
+            host_options.blink          = blink_options;
+            host_options.landmark_mode  = landmark_mode;
+            host_options.fusion         = fusion;
+            host_options.vitals         = vitals;
+            host_options.thresholds     = thresholds;
+            host_options.emit_policy    = emit_policy;
+            host_options.smoothing      = smoothing;
+            host_options.format         = output_format;
+            host_options.emit_level     = emit_level;
+            host_options.summary        = summary_options;
+            host_options.backend        = backend;
 
-                // Run focus analysis on updated state
-                std::string focus_json = analyzer.analyze(collector.current());
-                g_emitter.emit("focus", focus_json);
+            focus_wizard::LiveThresholds live_thresholds(thresholds);
+            g_live_thresholds = &live_thresholds;
+            host_options.live_thresholds = &live_thresholds;
+            focus_wizard::CameraHost host(ss_settings, camera_devices, host_options, g_emitter);
 
-                return absl::OkStatus();
+            focus_wizard::ControlChannel control;
+            std::string error;
+            if (!control.start(
+                    STDIN_FILENO, handle_camera_command,
+                    [](const std::string& error) {
+                        g_emitter.emit_error("Bad command: " + error);
+                    },
+                    {}, &error)) {
+                g_emitter.emit_error("Failed to read commands: " + error);
+                return 1;
             }
-        );
-        if (!edge_status.ok()) {
-            g_emitter.emit_error("Failed to set edge metrics callback: " +
-                                 std::string(edge_status.message()));
-            return 1;
+            host.run(&g_shutdown_requested);
+
+            g_emitter.emit_status("Shutting down...");
+            control.stop();
+            LOG(INFO) << "Ran " << host.tracks() << " camera tracks";
+            shutdown_output();
+            return 0;
         }
 
-        // ── Video Output Callback (headless) ─────────────
-        // We don't display anything, but we need to handle the callback
-        // to keep the pipeline flowing. We also check for shutdown here.
-        auto video_status = ss_container->SetOnVideoOutput(
-            [](cv::Mat& frame, int64_t timestamp) {
-                if (g_shutdown_requested) {
-                    return absl::CancelledError("Shutdown requested");
-                }
-                // In headless mode, we just let the frame pass through.
-                // Could optionally do frame analysis here (ambient light, etc.)
-                return absl::OkStatus();
+        // ── Optional Session Recording ───────────────────
+        std::unique_ptr<focus_wizard::SessionRecorder> recorder;
+        if (std::string record_path = absl::GetFlag(FLAGS_record_path); !record_path.empty()) {
+            recorder = std::make_unique<focus_wizard::SessionRecorder>();
+            std::string error;
+            if (!recorder->open(record_path, &error)) {
+                g_emitter.emit_error("Failed to open --record_path: " + error);
+                return 1;
             }
-        );
-        if (!video_status.ok()) {
-            g_emitter.emit_error("Failed to set video callback: " +
-                                 std::string(video_status.message()));
-            return 1;
         }
+        focus_wizard::SessionRecorder* session_recorder = recorder.get();
 
-        // ── Status Change Callback ───────────────────────
-        auto status_cb_status = ss_container->SetOnStatusChange(
-            [](presage::physiology::StatusValue imaging_status) {
-                std::string desc = presage::physiology::GetStatusDescription(
-                    imaging_status.value()
-                );
-                g_emitter.emit_status(desc);
-                return absl::OkStatus();
+        // ── Optional Frame Tracing ───────────────────────
+        focus_wizard::FrameTracer tracer;
+        if (int trace_every = absl::GetFlag(FLAGS_trace_every); trace_every > 0) {
+            std::string trace_path = absl::GetFlag(FLAGS_trace_path);
+            std::string error;
+            if (trace_path.empty()) {
+                g_emitter.emit_error("--trace_every requires --trace_path.");
+                return 1;
+            }
+            if (!tracer.open(trace_path, trace_every, &error)) {
+                g_emitter.emit_error("Failed to open --trace_path: " + error);
+                return 1;
             }
-        );
-        if (!status_cb_status.ok()) {
-            g_emitter.emit_error("Failed to set status callback: " +
-                                 std::string(status_cb_status.message()));
-            return 1;
         }
+        focus_wizard::FrameTracer* frame_tracer = tracer.active() ? &tracer : nullptr;
 
-        // ── Initialize ──────────────────────────────────
-        g_emitter.emit_status("Opening camera and initializing pipeline...");
-        if (auto init_status = ss_container->Initialize(); !init_status.ok()) {
-            g_emitter.emit_error("Failed to initialize: " +
-                                 std::string(init_status.message()));
-            return 1;
+        // ── Optional Focus History ───────────────────────
+        std::unique_ptr<focus_wizard::FocusHistory> history;
+        if (absl::GetFlag(FLAGS_history)) {
+            focus_wizard::FocusHistoryOptions history_options;
+            history_options.path             = absl::GetFlag(FLAGS_history_path);
+            history_options.flush_interval_s = absl::GetFlag(FLAGS_history_flush_s);
+            history = std::make_unique<focus_wizard::FocusHistory>(history_options);
+            std::string error;
+            if (!history->open(&error)) {
+                g_emitter.emit_error("Failed to open --history_path: " + error);
+                return 1;
+            }
+            if (history->restored() > 0) {
+                g_emitter.emit_status("Restored " + std::to_string(history->restored()) +
+                                      " history buckets from " + history_options.path);
+            }
+        }
+        focus_wizard::FocusHistory* focus_history = history.get();
+        g_focus_history = focus_history;
+
+        // ── Optional Frame Features ──────────────────────
+        std::unique_ptr<focus_wizard::FrameFeatureStage> features;
+        if (absl::GetFlag(FLAGS_frame_features)) {
+            focus_wizard::FrameFeatureOptions feature_options;
+            feature_options.sample_width    = std::max(16, absl::GetFlag(FLAGS_frame_feature_width));
+            feature_options.interval_frames = std::max(1, absl::GetFlag(FLAGS_frame_feature_interval));
+            feature_options.min_brightness  = absl::GetFlag(FLAGS_min_frame_brightness);
+            feature_options.min_sharpness   = absl::GetFlag(FLAGS_min_face_sharpness);
+            feature_options.max_roi_clipped = absl::GetFlag(FLAGS_max_face_clipped);
+            feature_options.max_motion      = absl::GetFlag(FLAGS_max_frame_motion);
+            features = std::make_unique<focus_wizard::FrameFeatureStage>(feature_options);
+            features->start();
         }
+        focus_wizard::FrameFeatureStage* frame_features = features.get();
 
-        // ── Signal Ready ────────────────────────────────
-        g_emitter.emit_ready();
+        // ── Control Channel ──────────────────────────────
+        // Commands on stdin (control_channel.hpp). A daemon starts paused —
+        // the pipeline is built now, the session when the parent sends
+        // start — and exits with its parent.
+        focus_wizard::LiveThresholds live_thresholds(thresholds);
+        g_live_thresholds = &live_thresholds;
+        analyzer.set_live_thresholds(&live_thresholds);
+        if (daemon) g_session_active = false;
 
-        // ── Run (blocks until cancelled or error) ───────
-        if (auto run_status = ss_container->Run(); !run_status.ok()) {
-            // CancelledError is expected on graceful shutdown
-            if (run_status.code() != absl::StatusCode::kCancelled) {
-                g_emitter.emit_error("Processing failed: " +
-                                     std::string(run_status.message()));
+        focus_wizard::ControlChannel control;
+        {
+            std::string error;
+            if (!control.start(
+                    STDIN_FILENO, handle_control_command,
+                    [](const std::string& error) {
+                        g_emitter.emit_error("Bad command: " + error);
+                    },
+                    [daemon] { if (daemon) g_shutdown_requested = 1; }, &error)) {
+                g_emitter.emit_error("Failed to read commands: " + error);
                 return 1;
             }
         }
 
+        // ── REST Cadence ─────────────────────────────────
+        // The SDK only reads the buffer duration when a container is built,
+        // so the pipeline below is rebuilt whenever the cadence policy
+        // settles on another one (never with --rest_adaptive=false).
+        focus_wizard::RestCadence rest_cadence(rest_options, thresholds);
+        rest_cadence.set_live_thresholds(&live_thresholds);
+        const float rest_report_interval_s = absl::GetFlag(FLAGS_rest_report_interval_s);
+
+        // Why the video callback cancelled Run(), set just before it does.
+        // The loop branches on this, not on the cadence, whose pending flag
+        // the edge thread may clear again before Run() returns.
+        enum class StopReason { NONE, REST_CHANGE, CAPTURE_CHANGE };
+        std::atomic<StopReason> stop_reason{StopReason::NONE};
+
+        // Failures inside the loop set exit_code and break, so the teardown
+        // below still stops the control channel and drops the net sink
+        int exit_code = 0;
+        bool first_run = true;
+        StopReason last_stop = StopReason::NONE;
+        for (;;) {
+            float rest_buffer_s = rest_cadence.target_s();
+            if (!first_run &&
+                (last_stop == StopReason::REST_CHANGE || rest_cadence.restart_pending())) {
+                rest_cadence.restarted(rest_buffer_s, focus_wizard::governor_clock_us());
+            }
+            ss_settings.continuous.preprocessed_data_buffer_duration_s = rest_buffer_s;
+            if (g_rebuild_requested.exchange(false)) {
+                // Daemon configure: frame sources read the flags themselves
+                ss_settings.video_source.device_index      = absl::GetFlag(FLAGS_camera_device_index);
+                ss_settings.video_source.capture_width_px  = absl::GetFlag(FLAGS_capture_width);
+                ss_settings.video_source.capture_height_px = absl::GetFlag(FLAGS_capture_height);
+            }
+
+            // ── Create Container ─────────────────────────────
+            auto ss_container = std::make_unique<focus_wizard::BridgeContainer>(ss_settings,
+                                                                                backend);
+
+            // ── External Frame Source (shm/net) ──────────────
+            if (frame_provider) {
+                auto make_source = [frame_provider, frame_governor, presence_watch]()
+                        -> std::unique_ptr<vs::VideoSource> {
+                    auto source = std::make_unique<focus_wizard::FrameVideoSource>(
+                        *frame_provider,
+                        absl::GetFlag(FLAGS_capture_width), absl::GetFlag(FLAGS_capture_height),
+                        &g_shutdown_requested);
+                    source->set_governor(frame_governor);
+                    source->set_presence_watch(presence_watch);
+                    return source;
+                };
+                if (auto source_status = ss_container->SetVideoSourceFactory(make_source);
+                    !source_status.ok()) {
+                    g_emitter.emit_error("Failed to set video source: " +
+                                         std::string(source_status.message()));
+                    exit_code = 1;
+                    break;
+                }
+            }
+
+
+            // ── Core Metrics Callback ────────────────────────
+            // Fires when the Physiology REST API returns refined metrics
+            // (pulse rate, breathing rate, HRV, etc.)
+            // Focus analysis is not run here: the next edge frame (at most one
+            // frame period later) sees the updated vitals through change
+            // detection, so analysis happens once per frame, not per callback.
+            auto core_status = ss_container->SetOnCoreMetricsOutput(
+                [&collector, session_recorder, &rest_cadence, rest_report_interval_s](
+                    const presage::physiology::MetricsBuffer& metrics,
+                    int64_t timestamp
+                ) {
+                    if (!g_session_active.load(std::memory_order_relaxed)) {
+                        return absl::OkStatus();
+                    }
+                    if (session_recorder) session_recorder->record_core(metrics, timestamp);
+
+                    rest_cadence.on_batch(metrics);
+                    focus_wizard::RestReport report;
+                    if (rest_report_interval_s > 0.0f &&
+                        rest_cadence.take_report(rest_report_interval_s,
+                                                 focus_wizard::governor_clock_us(), &report)) {
+                        LOG(INFO) << "REST: " << report.requests << " requests in "
+                                  << report.interval_s << " s, round trip "
+                                  << report.mean_rtt_ms << " ms mean / " << report.max_rtt_ms
+                                  << " ms max, buffer " << report.buffer_s << " s";
+                    }
+
+                    // Extract metrics
+                    focus_wizard::publish_core(g_emitter, collector, metrics, timestamp);
+
+                    return absl::OkStatus();
+                }
+            );
+            if (!core_status.ok()) {
+                g_emitter.emit_error("Failed to set core metrics callback: " +
+                                     std::string(core_status.message()));
+                exit_code = 1;
+                break;
+            }
+
+            // ── Edge Metrics Callback ────────────────────────
+            // Fires per-frame with on-device computed data
+            // (face landmarks, blinks, talking, etc.)
+            auto edge_status = ss_container->SetOnEdgeMetricsOutput(
+                [&collector, &analyzer, session_recorder, frame_governor, presence_watch,
+                 gaze_estimator, &gaze_calibration_path, &gaze_calibrating, &rest_cadence,
+                 frame_tracer, focus_history, focus_summary, frame_features, &live_thresholds,
+                 emit_policy, smoothing](
+                    const presage::physiology::Metrics& metrics,
+                    int64_t timestamp
+                ) {
+                    if (!g_session_active.load(std::memory_order_relaxed)) {
+                        return absl::OkStatus();
+                    }
+                    if (g_session_reset.exchange(false)) {
+                        // A new session: don't carry the last one's state (or
+                        // the face absence while stopped) into this one
+                        analyzer = focus_wizard::FocusAnalyzer(live_thresholds.load(), emit_policy,
+                                                               smoothing);
+                        analyzer.set_live_thresholds(&live_thresholds);
+                        if (focus_summary) focus_summary->reset();
+                    }
+                    bool traced = frame_tracer &&
+                                  frame_tracer->begin(timestamp, focus_wizard::wall_clock_us());
+                    if (session_recorder) session_recorder->record_edge(metrics, timestamp);
+
+                    // Extract edge metrics
+                    focus_wizard::publish_edge(g_emitter, collector, metrics, timestamp);
+                    if (traced) frame_tracer->mark(focus_wizard::TraceStage::EDGE);
+                    if (gaze_estimator) {
+                        check_gaze_calibration(*gaze_estimator, gaze_calibration_path,
+                                               &gaze_calibrating);
+                    }
+
+                    // Run focus analysis once per frame (emits only on change)
+                    focus_wizard::FocusMetrics snapshot = collector.current();
+                    if (frame_features) {
+                        frame_features->update_face_roi(metrics);
+                        frame_features->apply(&snapshot);
+                    }
+                    focus_wizard::FocusResult result =
+                        focus_wizard::publish_focus(g_emitter, analyzer, snapshot);
+                    if (focus_history) {
+                        focus_history->add(snapshot, result, focus_wizard::wall_clock_us());
+                    }
+                    if (focus_summary) {
+                        focus_wizard::publish_summary(g_emitter, *focus_summary, snapshot, result);
+                    }
+                    if (traced) frame_tracer->mark(focus_wizard::TraceStage::FOCUS);
+                    rest_cadence.observe(analyzer.current_state(), snapshot, timestamp,
+                                         focus_wizard::governor_clock_us());
+
+                    if (frame_governor || presence_watch) {
+                        int64_t now = focus_wizard::governor_clock_us();
+                        if (frame_governor) {
+                            frame_governor->frame_processed(timestamp, now);
+                            frame_governor->observe(analyzer.current_state(),
+                                                    snapshot.face_detected, now);
+                        }
+                        if (presence_watch) {
+                            presence_watch->update_state(analyzer.current_state(), now);
+                        }
+                    }
+
+                    if (traced) frame_tracer->end();
+                    return absl::OkStatus();
+                }
+            );
+            if (!edge_status.ok()) {
+                g_emitter.emit_error("Failed to set edge metrics callback: " +
+                                     std::string(edge_status.message()));
+                exit_code = 1;
+                break;
+            }
+
+            // ── Video Output Callback (headless) ─────────────
+            // We don't display anything, but we need to handle the callback
+            // to keep the pipeline flowing. We also check for shutdown here.
+            // In local mode the SDK owns the capture loop, so the governor and
+            // the presence watch pace it from here: sleeping delays the next grab.
+            bool local_capture = !frame_provider;
+            focus_wizard::FrameGovernor* pace_governor = local_capture ? frame_governor : nullptr;
+            focus_wizard::PresenceWatch* pace_watch = local_capture ? presence_watch : nullptr;
+            auto video_status = ss_container->SetOnVideoOutput(
+                [pace_governor, pace_watch, watch_options, &rest_cadence, &stop_reason,
+                 frame_tracer, frame_features](
+                    cv::Mat& frame, int64_t timestamp) {
+                    if (g_shutdown_requested) {
+                        return absl::CancelledError("Shutdown requested");
+                    }
+                    focus_wizard::pipeline_metrics().add(
+                        focus_wizard::PipelineCounter::FRAMES_RECEIVED);
+                    if (frame_tracer) frame_tracer->on_video(timestamp);
+                    if (rest_cadence.restart_pending()) {
+                        stop_reason = StopReason::REST_CHANGE;
+                        return absl::CancelledError("REST buffer change");
+                    }
+                    if (g_rebuild_requested) {
+                        stop_reason = StopReason::CAPTURE_CHANGE;
+                        return absl::CancelledError("Capture settings change");
+                    }
+                    if (!g_session_active) {
+                        // Daemon stopped: hold the source, letting a keepalive
+                        // frame through now and then so the graph stays warm.
+                        // The edge/core callbacks discard what those produce.
+                        auto wake = std::chrono::steady_clock::now() +
+                                    std::chrono::milliseconds(watch_options.keepalive_ms);
+                        while (!g_shutdown_requested && !g_session_active && !g_rebuild_requested &&
+                               std::chrono::steady_clock::now() < wake) {
+                            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                        }
+                        return absl::OkStatus();
+                    }
+                    if (pace_watch && pace_watch->active()) {
+                        // The graph sees this frame anyway; no cheap check needed.
+                        // Ends early once the analyzer leaves AWAY.
+                        auto wake = std::chrono::steady_clock::now() +
+                                    std::chrono::milliseconds(watch_options.keepalive_ms);
+                        while (!g_shutdown_requested && pace_watch->active() &&
+                               std::chrono::steady_clock::now() < wake) {
+                            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                        }
+                        return absl::OkStatus();
+                    }
+                    if (pace_governor) {
+                        int64_t now = focus_wizard::governor_clock_us();
+                        int64_t wake = now + pace_governor->pace(timestamp, now);
+                        // Short slices: wake early on shutdown or a ramp back to full rate
+                        while (!g_shutdown_requested && pace_governor->interval_us() > 0 &&
+                               focus_wizard::governor_clock_us() < wake) {
+                            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                        }
+                    }
+                    // Sampled in place; the statistics run on the feature worker
+                    if (frame_features) frame_features->submit(frame, timestamp);
+                    return absl::OkStatus();
+                }
+            );
+            if (!video_status.ok()) {
+                g_emitter.emit_error("Failed to set video callback: " +
+                                     std::string(video_status.message()));
+                exit_code = 1;
+                break;
+            }
+
+            // ── Status Change Callback ───────────────────────
+            auto status_cb_status = ss_container->SetOnStatusChange(
+                [](presage::physiology::StatusValue imaging_status) {
+                    std::string desc = presage::physiology::GetStatusDescription(
+                        imaging_status.value()
+                    );
+                    g_emitter.emit_status(desc);
+                    return absl::OkStatus();
+                }
+            );
+            if (!status_cb_status.ok()) {
+                g_emitter.emit_error("Failed to set status callback: " +
+                                     std::string(status_cb_status.message()));
+                exit_code = 1;
+                break;
+            }
+
+            // ── Initialize ──────────────────────────────────
+            g_emitter.emit_status("Opening camera and initializing pipeline...");
+            if (auto init_status = ss_container->Initialize(); !init_status.ok()) {
+                g_emitter.emit_error("Failed to initialize: " +
+                                     std::string(init_status.message()));
+                exit_code = 1;
+                break;
+            }
+            if (first_run) {
+                if (!ss_container->fallback_reason().empty()) {
+                    g_emitter.emit_status(ss_container->fallback_reason() + "; using CPU");
+                }
+                LOG(INFO) << "Container backend: "
+                          << focus_wizard::backend_to_string(ss_container->backend());
+            }
+
+            // ── Signal Ready ────────────────────────────────
+            if (first_run) {
+                g_pipeline_ready = true;
+                if (g_session_active) {
+                    g_emitter.emit_ready();
+                } else {
+                    g_emitter.emit_status("Daemon ready; waiting for start");
+                }
+            }
+            first_run = false;
+
+            // ── Run (blocks until cancelled or error) ───────
+            if (auto run_status = ss_container->Run(); !run_status.ok()) {
+                // CancelledError is expected on graceful shutdown
+                if (run_status.code() != absl::StatusCode::kCancelled) {
+                    g_emitter.emit_error("Processing failed: " +
+                                         std::string(run_status.message()));
+                    exit_code = 1;
+                    break;
+                }
+            }
+
+            last_stop = stop_reason.exchange(StopReason::NONE);
+            if (g_shutdown_requested || last_stop == StopReason::NONE) break;
+            if (last_stop == StopReason::CAPTURE_CHANGE) {
+                g_emitter.emit_status("Rebuilding pipeline for new capture settings...");
+                continue;
+            }
+            int rest_buffer_ms = static_cast<int>(rest_cadence.target_s() * 1000.0f + 0.5f);
+            g_emitter.emit_status("Rebuilding pipeline for a " + std::to_string(rest_buffer_ms) +
+                                  " ms REST buffer...");
+        }
+
+        flush_summary(focus_summary);
         g_emitter.emit_status("Shutting down...");
-        return 0;
+        control.stop();
+        focus_wizard::RestReport rest_report;
+        rest_cadence.take_report(0.0f, focus_wizard::governor_clock_us(), &rest_report);
+        LOG(INFO) << "REST: " << rest_cadence.requests() << " requests, "
+                  << rest_cadence.restarts() << " pipeline rebuilds, final buffer "
+                  << rest_report.buffer_s << " s, level "
+                  << focus_wizard::rest_cadence_level_to_string(rest_cadence.level());
+        if (presence_watch) {
+            LOG(INFO) << "Presence watch: " << presence_watch->wakeups() << " wakeups, "
+                      << presence_watch->checks() << " checks, "
+                      << presence_watch->withheld() << " frames withheld";
+        }
+        if (history) {
+            history->close();
+        }
+        if (frame_features) {
+            frame_features->stop();
+            LOG(INFO) << "Frame features: " << frame_features->analyzed() << " samples, "
+                      << frame_features->low_quality() << " low quality, "
+                      << frame_features->replaced() << " replaced before analysis";
+        }
+        if (frame_tracer) {
+            LOG(INFO) << "Traced " << frame_tracer->traced() << " frames to "
+                      << absl::GetFlag(FLAGS_trace_path);
+        }
+        if (frame_governor) {
+            LOG(INFO) << "Frame governor: " << frame_governor->skipped() << " frames dropped, "
+                      << "final level " << focus_wizard::governor_level_to_string(
+                             frame_governor->level());
+        }
+        if (net_mode) {
+            g_emitter.set_sink(nullptr);
+            net_server.stop();
+            focus_wizard::NetChannel& channel = net_server.channel(0);
+            LOG(INFO) << "Net ingest: " << channel.skipped() << " frames skipped, "
+                      << channel.dropped() << " messages dropped, "
+                      << net_server.rejected() << " connections rejected";
+        }
+        if (recorder) {
+            recorder->close();
+            LOG(INFO) << "Recorded " << recorder->recorded() << " callbacks"
+                      << " (" << recorder->dropped() << " dropped)";
+        }
+        shutdown_output();
+        return exit_code;
 
     } catch (const std::exception& e) {
         g_emitter.emit_error(std::string("Fatal error: ") + e.what());
@@ -8,160 +8,375 @@
  *   MetricsBuffer: pulse(), breathing(), blood_pressure(), face(), metadata()
  *   Metrics (edge): breathing(), micromotion(), eda(), face()
  *   Pulse: rate(), trace(), pulse_respiration_quotient(), strict()
+ *   Measurement: time(), value(), stable(), timestamp()
  *   Face: blinking(), talking(), landmarks()
  *   DetectionStatus: time(), detected(), stable(), timestamp()
  *   MeasurementWithConfidence: time(), value(), stable(), confidence(), timestamp()
  */
 
 #include "metrics_collector.hpp"
+#include "frame_trace.hpp"
+#include "json_writer.hpp"
 
-#include <sstream>
-#include <iomanip>
-#include <chrono>
-#include <deque>
+#include <algorithm>
+#include <cmath>
+#include <tuple>
 
 namespace focus_wizard {
 
-// ── Blink rate estimator ─────────────────────────────────
-// We track blink event timestamps and compute blinks-per-minute
-// from a sliding 60-second window.
-static std::deque<std::chrono::steady_clock::time_point> blink_timestamps;
-static bool prev_blink_state = false;
+// ── Payload schemas ──────────────────────────────────────
+// Field order and precision are the wire format — don't reorder.
 
-static float estimate_blink_rate(bool currently_blinking) {
-    auto now = std::chrono::steady_clock::now();
+static constexpr auto kCoreSchema = std::make_tuple(
+    json_field("timestamp_us",       &FocusMetrics::timestamp_us),
+    json_field("pulse_rate_bpm",     &FocusMetrics::pulse_rate_bpm, 2),
+    json_field("has_pulse",          &FocusMetrics::has_pulse),
+    json_field("pulse_confidence",   &FocusMetrics::pulse_confidence, 2),
+    json_field("breathing_rate_bpm", &FocusMetrics::breathing_rate_bpm, 2),
+    json_field("has_breathing",      &FocusMetrics::has_breathing),
+    json_field("hrv_rmssd_ms",       &FocusMetrics::hrv_rmssd_ms, 1),
+    json_field("hrv_sdnn_ms",        &FocusMetrics::hrv_sdnn_ms, 1),
+    json_field("has_hrv",            &FocusMetrics::has_hrv),
+    json_field("capture_us",         &FocusMetrics::capture_us),
+    json_field("callback_us",        &FocusMetrics::callback_us)
+);
 
-    // Detect rising edge (transition from not-blinking to blinking)
-    if (currently_blinking && !prev_blink_state) {
-        blink_timestamps.push_back(now);
+static constexpr auto kEdgeSchema = std::make_tuple(
+    json_field("face_detected",      &FocusMetrics::face_detected),
+    json_field("is_blinking",        &FocusMetrics::is_blinking),
+    json_field("blink_rate_per_min", &FocusMetrics::blink_rate_per_min, 4),
+    json_field("is_talking",         &FocusMetrics::is_talking),
+    json_field("gaze_x",             &FocusMetrics::gaze_x, 4),
+    json_field("gaze_y",             &FocusMetrics::gaze_y, 4),
+    json_field("has_gaze",           &FocusMetrics::has_gaze),
+    json_field("capture_us",         &FocusMetrics::capture_us),
+    json_field("callback_us",        &FocusMetrics::callback_us)
+);
+
+// ── Gaze landmark layouts ────────────────────────────────
+
+// Indices of the landmarks gaze reads. The top edge of the face box is
+// the midpoint of two points so the sparse layout can use the eye pair.
+struct GazeLayout {
+    int min_points;
+    int nose;
+    int left, right;
+    int top_a, top_b;
+    int bottom;
+};
+
+// MediaPipe face mesh: nose tip, cheeks (234 is on the image left), forehead, chin
+static constexpr GazeLayout kDenseLayout{468, 4, 234, 454, 10, 10, 152};
+
+// MediaPipe face-detection keypoints: 0/1 eyes, 2 nose tip, 3 mouth, 4/5 ear tragions
+static constexpr GazeLayout kSparseLayout{6, 2, 4, 5, 0, 1, 3};
+
+bool parse_landmark_mode(const std::string& name, LandmarkMode* out) {
+    if (name == "dense") {
+        *out = LandmarkMode::DENSE;
+        return true;
+    }
+    if (name == "sparse") {
+        *out = LandmarkMode::SPARSE;
+        return true;
     }
-    prev_blink_state = currently_blinking;
+    if (name == "off") {
+        *out = LandmarkMode::OFF;
+        return true;
+    }
+    return false;
+}
 
-    // Evict entries older than 60 seconds
-    auto cutoff = now - std::chrono::seconds(60);
-    while (!blink_timestamps.empty() && blink_timestamps.front() < cutoff) {
-        blink_timestamps.pop_front();
+template <typename Schema>
+static std::string_view write_payload(const FocusMetrics& metrics, const Schema& schema) {
+    std::string& out = thread_payload_buffer();
+    out.clear();
+    JsonWriter writer(out);
+    writer.begin_object();
+    write_fields(writer, metrics, schema);
+    writer.field("emit_us", wall_clock_us());
+    writer.end_object();
+    return out;
+}
+
+// Nose tip relative to the face box centre as a proxy for head
+// orientation, refined by `estimator` if there is one. Reads the few
+// points it needs in place; nothing is copied out of the landmark
+// RepeatedPtrField.
+static void update_gaze(LandmarkMode mode, GazeEstimator* estimator,
+                        const presage::physiology::Metrics& metrics, int64_t timestamp_us,
+                        FocusMetrics& edge) {
+    if (mode == LandmarkMode::OFF || metrics.face().landmarks().empty()) return;
+
+    const auto& latest_lm = *metrics.face().landmarks().rbegin();
+    int lm_count = latest_lm.value_size();
+
+    const GazeLayout* layout;
+    if (lm_count >= kDenseLayout.min_points) {
+        layout = &kDenseLayout;
+    } else if (mode == LandmarkMode::SPARSE && lm_count >= kSparseLayout.min_points) {
+        layout = &kSparseLayout;
+    } else {
+        return;
     }
+    const GazeLayout& lm = *layout;
+
+    const auto& nose   = latest_lm.value(lm.nose);
+    const auto& left   = latest_lm.value(lm.left);
+    const auto& right  = latest_lm.value(lm.right);
+    const auto& bottom = latest_lm.value(lm.bottom);
+    float top_y = (latest_lm.value(lm.top_a).y() + latest_lm.value(lm.top_b).y()) / 2.0f;
+
+    float face_center_x = (left.x() + right.x()) / 2.0f;
+    float face_center_y = (top_y + bottom.y()) / 2.0f;
+    float face_width  = right.x() - left.x();
+    float face_height = bottom.y() - top_y;
+
+    if (face_width <= 1.0f || face_height <= 1.0f) return;
 
-    // Convert count-in-window to blinks-per-minute
-    return static_cast<float>(blink_timestamps.size());
+    float head_x = (nose.x() - face_center_x) / (face_width / 2.0f);
+    float head_y = (nose.y() - face_center_y) / (face_height / 2.0f);
+    if (!estimator) {
+        edge.gaze_x = head_x;
+        edge.gaze_y = head_y;
+        edge.has_gaze = true;
+    } else {
+        // No gaze while calibrating
+        edge.has_gaze = estimator->estimate(latest_lm, head_x, head_y, timestamp_us,
+                                            &edge.gaze_x, &edge.gaze_y);
+    }
+}
+
+// Edge breathing trace: plausible breath periods (40 .. 4 per minute) and
+// the seconds of breaths the rate is counted over
+static constexpr float kMinBreathPeriodS = 1.5f;
+static constexpr float kMaxBreathPeriodS = 15.0f;
+static constexpr float kBreathWindowS    = 30.0f;
+
+// When a REST measurement was taken: its own timestamp if the SDK filled
+// it in, else the callback's
+template <typename Sample>
+static int64_t sample_timestamp(const Sample& sample, int64_t callback_us) {
+    return sample.timestamp() > 0 ? sample.timestamp() : callback_us;
+}
+
+MetricsCollector::MetricsCollector(BlinkRateOptions blink_options, LandmarkMode landmark_mode,
+                                   FusionOptions fusion, VitalsOptions vitals)
+    : landmark_mode_(landmark_mode)
+    , fusion_(fusion)
+    , core_blinks_(blink_options)
+    , edge_blinks_(blink_options)
+    , pulse_rates_(vitals.rate_window_s)
+    , breathing_rates_(vitals.rate_window_s)
+    , hrv_(vitals.hrv_window_s)
+    , edge_breathing_(vitals.edge_breathing)
+    , edge_breathing_rates_(vitals.rate_window_s)
+    , edge_breathing_trace_(kMinBreathPeriodS, kMaxBreathPeriodS, kBreathWindowS)
+{
 }
 
-std::string MetricsCollector::process_core_metrics(
+std::string_view MetricsCollector::process_core_metrics(
     const presage::physiology::MetricsBuffer& metrics,
     int64_t timestamp_us
 ) {
-    current_metrics_.timestamp_us = timestamp_us;
-
-    // ── Pulse Rate ───────────────────────────────────────
-    if (metrics.has_pulse() && !metrics.pulse().rate().empty()) {
-        const auto& latest = *metrics.pulse().rate().rbegin();
-        current_metrics_.pulse_rate_bpm = latest.value();
-        current_metrics_.pulse_confidence = latest.confidence();
-        current_metrics_.has_pulse = true;
+    update_core_metrics(metrics, timestamp_us);
+    return core_json();
+}
+
+std::string_view MetricsCollector::process_edge_metrics(
+    const presage::physiology::Metrics& metrics,
+    int64_t timestamp_us
+) {
+    update_edge_metrics(metrics, timestamp_us);
+    return edge_json();
+}
+
+void MetricsCollector::update_core_metrics(
+    const presage::physiology::MetricsBuffer& metrics,
+    int64_t timestamp_us
+) {
+    FocusMetrics& core = core_working_.metrics;
+    core.callback_us = wall_clock_us();
+    core.timestamp_us = timestamp_us;
+    core.capture_us = timestamp_us;
+    core_working_.latest_us = std::max(core_working_.latest_us, timestamp_us);
+
+    // ── Pulse Rate & HRV ─────────────────────────────────
+    // Every sample of the batch goes into the rolling window, not just
+    // the newest
+    if (metrics.has_pulse()) {
+        if (pulse_rates_.add(metrics.pulse().rate(), timestamp_us)) {
+            core.pulse_rate_bpm = pulse_rates_.value();
+            core.pulse_confidence = pulse_rates_.confidence();
+            core.has_pulse = true;
+            core_working_.pulse_us = pulse_rates_.latest_us();
+        }
+        if (hrv_.add(metrics.pulse().trace())) {
+            HrvFeatures hrv = hrv_.features();
+            core.hrv_rmssd_ms = hrv.rmssd_ms;
+            core.hrv_sdnn_ms = hrv.sdnn_ms;
+            core.has_hrv = hrv.beats >= HrvEstimator::kMinBeats;
+        }
     }
 
     // ── Breathing Rate ───────────────────────────────────
-    if (metrics.has_breathing() && !metrics.breathing().rate().empty()) {
-        const auto& latest = *metrics.breathing().rate().rbegin();
-        current_metrics_.breathing_rate_bpm = latest.value();
-        current_metrics_.breathing_confidence = latest.confidence();
-        current_metrics_.has_breathing = true;
+    if (metrics.has_breathing() &&
+        breathing_rates_.add(metrics.breathing().rate(), timestamp_us)) {
+        core.breathing_rate_bpm = breathing_rates_.value();
+        core.breathing_confidence = breathing_rates_.confidence();
+        core.has_breathing = true;
+        core_working_.breathing_us = breathing_rates_.latest_us();
     }
 
     // ── Face data from core (blinking, talking, landmarks) ──
+    // Stamped with the detections' own times, which lag the callback
     if (metrics.has_face()) {
-        current_metrics_.face_detected = true;
+        int64_t face_us = 0;
 
+        // Walk the whole series so every onset inside the batch is
+        // counted; entries an overlapping batch already delivered are
+        // skipped so none is counted twice
         if (!metrics.face().blinking().empty()) {
-            current_metrics_.is_blinking = metrics.face().blinking().rbegin()->detected();
-            current_metrics_.blink_rate_per_min = estimate_blink_rate(current_metrics_.is_blinking);
+            for (const auto& blink : metrics.face().blinking()) {
+                int64_t blink_us = sample_timestamp(blink, timestamp_us);
+                if (blink.timestamp() > 0 && blink_us <= core_working_.blink_us) continue;
+                core.is_blinking = blink.detected();
+                core.blink_rate_per_min = core_blinks_.update(core.is_blinking, blink_us);
+                core_working_.blink_us = blink_us;
+            }
+            face_us = core_working_.blink_us;
         }
 
         if (!metrics.face().talking().empty()) {
-            current_metrics_.is_talking = metrics.face().talking().rbegin()->detected();
+            const auto& latest = *metrics.face().talking().rbegin();
+            core.is_talking = latest.detected();
+            core_working_.talk_us = sample_timestamp(latest, timestamp_us);
+            face_us = std::max(face_us, core_working_.talk_us);
         }
+
+        core.face_detected = true;
+        core_working_.face_us = face_us > 0 ? face_us : timestamp_us;
     }
 
-    // ── Build JSON ───────────────────────────────────────
-    std::ostringstream json;
-    json << std::fixed << std::setprecision(2);
-    json << "{";
-    json << "\"timestamp_us\":" << timestamp_us;
-    json << ",\"pulse_rate_bpm\":" << current_metrics_.pulse_rate_bpm;
-    json << ",\"has_pulse\":" << (current_metrics_.has_pulse ? "true" : "false");
-    json << ",\"pulse_confidence\":" << current_metrics_.pulse_confidence;
-    json << ",\"breathing_rate_bpm\":" << current_metrics_.breathing_rate_bpm;
-    json << ",\"has_breathing\":" << (current_metrics_.has_breathing ? "true" : "false");
-    json << "}";
-
-    return json.str();
+    core_published_.store(core_working_);
+}
+
+std::string_view MetricsCollector::core_json() const {
+    return write_payload(core_published_.load().metrics, kCoreSchema);
 }
 
-std::string MetricsCollector::process_edge_metrics(
-    const presage::physiology::Metrics& metrics
+void MetricsCollector::update_edge_metrics(
+    const presage::physiology::Metrics& metrics,
+    int64_t timestamp_us
 ) {
+    FocusMetrics& edge = edge_working_.metrics;
+    edge.callback_us = wall_clock_us();
+    edge.capture_us = timestamp_us;
+    edge_working_.latest_us = std::max(edge_working_.latest_us, timestamp_us);
+
     // ── Face Detection ─────────────────────────────────
+    edge_working_.face_us = timestamp_us;
     if (metrics.has_face()) {
-        current_metrics_.face_detected = true;
+        edge.face_detected = true;
 
         // ── Blink Detection ──────────────────────────────
         if (!metrics.face().blinking().empty()) {
-            current_metrics_.is_blinking = metrics.face().blinking().rbegin()->detected();
-            current_metrics_.blink_rate_per_min = estimate_blink_rate(current_metrics_.is_blinking);
+            edge.is_blinking = metrics.face().blinking().rbegin()->detected();
+            edge.blink_rate_per_min = edge_blinks_.update(edge.is_blinking, timestamp_us);
+            edge_working_.blink_us = timestamp_us;
         }
 
         // ── Talking Detection ────────────────────────────
         if (!metrics.face().talking().empty()) {
-            current_metrics_.is_talking = metrics.face().talking().rbegin()->detected();
+            edge.is_talking = metrics.face().talking().rbegin()->detected();
+            edge_working_.talk_us = timestamp_us;
         }
 
         // ── Gaze Estimation from Face Landmarks ──────────
-        // Uses MediaPipe face mesh: nose tip relative to face
-        // bounding box center as a proxy for head orientation.
-        if (!metrics.face().landmarks().empty()) {
-            const auto& latest_lm = *metrics.face().landmarks().rbegin();
-            int lm_count = latest_lm.value_size();
-
-            // Need 468 landmarks (full MediaPipe face mesh)
-            if (lm_count >= 468) {
-                const auto& nose_tip    = latest_lm.value(4);    // Nose tip
-                const auto& left_cheek  = latest_lm.value(234);  // Left face boundary
-                const auto& right_cheek = latest_lm.value(454);  // Right face boundary
-                const auto& forehead    = latest_lm.value(10);   // Forehead center
-                const auto& chin        = latest_lm.value(152);  // Chin
-
-                float face_center_x = (left_cheek.x() + right_cheek.x()) / 2.0f;
-                float face_center_y = (forehead.y() + chin.y()) / 2.0f;
-                float face_width  = right_cheek.x() - left_cheek.x();
-                float face_height = chin.y() - forehead.y();
-
-                if (face_width > 1.0f && face_height > 1.0f) {
-                    current_metrics_.gaze_x = (nose_tip.x() - face_center_x) / (face_width / 2.0f);
-                    current_metrics_.gaze_y = (nose_tip.y() - face_center_y) / (face_height / 2.0f);
-                    current_metrics_.has_gaze = true;
-                }
+        update_gaze(landmark_mode_, gaze_estimator_, metrics, timestamp_us, edge);
+    } else {
+        edge.face_detected = false;
+        edge.has_gaze = false;
+    }
+
+    // ── Breathing (without REST) ─────────────────────────
+    // The SDK's rate if the edge graph has one, else count breaths in the
+    // upper trace
+    if (edge_breathing_ && metrics.has_breathing()) {
+        const auto& breathing = metrics.breathing();
+        if (!breathing.rate().empty()) {
+            if (edge_breathing_rates_.add(breathing.rate(), timestamp_us)) {
+                edge.breathing_rate_bpm = edge_breathing_rates_.value();
+                edge.breathing_confidence = edge_breathing_rates_.confidence();
+                edge.has_breathing = true;
+                edge_working_.breathing_us = edge_breathing_rates_.latest_us();
             }
+        } else if (edge_breathing_trace_.add(breathing.upper_trace()) &&
+                   edge_breathing_trace_.has_rate()) {
+            edge.breathing_rate_bpm = edge_breathing_trace_.rate_per_min();
+            edge.breathing_confidence = edge_breathing_trace_.confidence();
+            edge.has_breathing = true;
+            edge_working_.breathing_us = edge_breathing_trace_.latest_us();
         }
-    } else {
-        current_metrics_.face_detected = false;
-        current_metrics_.has_gaze = false;
     }
 
-    // ── Build JSON ───────────────────────────────────────
-    std::ostringstream json;
-    json << std::fixed << std::setprecision(4);
-    json << "{";
-    json << "\"face_detected\":" << (current_metrics_.face_detected ? "true" : "false");
-    json << ",\"is_blinking\":" << (current_metrics_.is_blinking ? "true" : "false");
-    json << ",\"blink_rate_per_min\":" << current_metrics_.blink_rate_per_min;
-    json << ",\"is_talking\":" << (current_metrics_.is_talking ? "true" : "false");
-    json << ",\"gaze_x\":" << current_metrics_.gaze_x;
-    json << ",\"gaze_y\":" << current_metrics_.gaze_y;
-    json << ",\"has_gaze\":" << (current_metrics_.has_gaze ? "true" : "false");
-    json << "}";
-
-    return json.str();
+    edge_published_.store(edge_working_);
+}
+
+std::string_view MetricsCollector::edge_json() const {
+    return write_payload(current(), kEdgeSchema);
+}
+
+FocusMetrics MetricsCollector::current() const {
+    Published core = core_published_.load();
+    Published edge = edge_published_.load();
+
+    // Gaze comes from edge only; pulse and the timestamp from core only
+    FocusMetrics merged = edge.metrics;
+    merged.pulse_rate_bpm       = core.metrics.pulse_rate_bpm;
+    merged.pulse_confidence     = core.metrics.pulse_confidence;
+    merged.has_pulse            = core.metrics.has_pulse;
+    merged.hrv_rmssd_ms         = core.metrics.hrv_rmssd_ms;
+    merged.hrv_sdnn_ms          = core.metrics.hrv_sdnn_ms;
+    merged.has_hrv              = core.metrics.has_hrv;
+    merged.timestamp_us         = core.metrics.timestamp_us;
+
+    // Breathing: edge only when it has newer data (VitalsOptions::edge_breathing)
+    const Published& breathing = edge.breathing_us > core.breathing_us ? edge : core;
+    merged.breathing_rate_bpm   = breathing.metrics.breathing_rate_bpm;
+    merged.breathing_confidence = breathing.metrics.breathing_confidence;
+    merged.has_breathing        = breathing.metrics.has_breathing;
+
+    // Face fields: whichever path has the newer data (edge on a tie)
+    if (core.face_us > edge.face_us) {
+        merged.face_detected = core.metrics.face_detected;
+    }
+    if (core.blink_us > edge.blink_us) {
+        merged.is_blinking        = core.metrics.is_blinking;
+        merged.blink_rate_per_min = core.metrics.blink_rate_per_min;
+    }
+    if (core.talk_us > edge.talk_us) {
+        merged.is_talking = core.metrics.is_talking;
+    }
+
+    // Vitals: confidence, decayed by how far they lag the newest frame
+    int64_t now_us = std::max(core.latest_us, edge.latest_us);
+    if (core.metrics.has_pulse) {
+        merged.pulse_weight = std::clamp(core.metrics.pulse_confidence, 0.0f, 1.0f) *
+                              freshness(core.pulse_us, now_us);
+    }
+    if (merged.has_breathing) {
+        merged.breathing_weight = std::clamp(merged.breathing_confidence, 0.0f, 1.0f) *
+                                  freshness(breathing.breathing_us, now_us);
+    }
+
+    return merged;
+}
+
+float MetricsCollector::freshness(int64_t sample_us, int64_t now_us) const {
+    if (fusion_.vitals_half_life_s <= 0.0f || now_us <= sample_us) return 1.0f;
+    float age_s = static_cast<float>(now_us - sample_us) / 1e6f;
+    return std::exp2(-age_s / fusion_.vitals_half_life_s);
 }
 
 } // namespace focus_wizard
@@ -7,14 +7,45 @@
  *   2. Edge metrics (Metrics) — computed per-frame on-device, includes
  *      myofacial analysis (gaze, blinks, face points, talking).
  *
- * This collector turns both into JSON strings for the emitter.
+ * This collector turns both into JSON payloads for the emitter.
+ *
+ * Threading: the core and edge callbacks run on different SDK threads.
+ * Each path updates only its own working copy and publishes it through a
+ * seqlock, so neither blocks the other; current() merges the two latest
+ * publications into one consistent FocusMetrics. Each update_* method
+ * must only be called from one thread at a time.
+ *
+ * Fusion: every field group is stamped with the SDK timestamp of the data
+ * it came from (a REST batch arrives seconds after the frames it covers),
+ * and current() takes each group from whichever path has the newer data,
+ * not whichever wrote last — so a delayed batch can't overwrite newer
+ * edge results. Vitals additionally get a weight, their confidence decayed
+ * by how far they lag the newest frame (see FusionOptions).
+ *
+ * Batches: each MetricsBuffer holds seconds of samples. The core path
+ * takes all of them: rates are rolling confidence-weighted means, HRV
+ * comes from the beats in the pulse trace, and every blink onset in the
+ * batch is counted (see vitals_tracker.hpp). Without REST, breathing can
+ * come from the edge metrics instead (VitalsOptions::edge_breathing).
+ *
+ * Gaze: the edge path estimates gaze from a handful of face landmarks.
+ * LandmarkMode picks which set the SDK is asked for (see
+ * enable_dense_facemesh_points) and which indices are read from it.
+ * That estimate is head pose; with a GazeEstimator attached it is combined
+ * with the eyes' own offset and a per-user calibration.
  */
 
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <cstdint>
 
+#include "blink_rate_estimator.hpp"
+#include "gaze_estimator.hpp"
+#include "seqlock.hpp"
+#include "vitals_tracker.hpp"
+
 // SmartSpectra / Physiology headers
 #include <physiology/modules/messages/metrics.h>
 
@@ -29,12 +60,20 @@ struct FocusMetrics {
     float pulse_rate_bpm       = 0.0f;
     float pulse_confidence     = 0.0f;   // from MeasurementWithConfidence
     bool  has_pulse             = false;
+    float hrv_rmssd_ms          = 0.0f;  // from beats in pulse().trace()
+    float hrv_sdnn_ms           = 0.0f;
+    bool  has_hrv               = false;
 
     // ── Breathing ────────────────────────────────────────
     float breathing_rate_bpm   = 0.0f;
     float breathing_confidence = 0.0f;
     bool  has_breathing         = false;
 
+    // ── Fusion (set by MetricsCollector::current()) ──────
+    // Confidence x freshness, 0..1; 0 without a measurement
+    float pulse_weight          = 0.0f;
+    float breathing_weight      = 0.0f;
+
     // ── Myofacial (Edge & Core) ──────────────────────────
     bool  face_detected         = false;
     bool  is_blinking           = false;
@@ -46,36 +85,161 @@ struct FocusMetrics {
     float gaze_y                = 0.0f;  // Vertical: -1.0 (up) to +1.0 (down)
     bool  has_gaze              = false;
 
+    // ── Frame Features (set by FrameFeatureStage::apply) ─
+    float brightness            = 0.0f;  // mean frame luma, 0..1
+    float motion                = 0.0f;  // mean luma change between samples, 0..1
+    float sharpness             = 0.0f;  // Laplacian variance of the face box
+    float roi_exposure          = 0.0f;  // mean face-box luma, 0..1
+    bool  low_quality_frame     = false; // too dark, blurred or badly exposed
+    bool  has_frame_features    = false;
+
     // ── Timestamp ────────────────────────────────────────
     int64_t timestamp_us        = 0;
+
+    // ── Latency Tracing (see frame_trace.hpp) ────────────
+    int64_t capture_us          = 0;  // SDK timestamp of the frame / batch behind it
+    int64_t callback_us         = 0;  // wall clock when its callback started
+};
+
+/**
+ * Which face landmarks gaze is estimated from.
+ *
+ *   DENSE  — the 468-point MediaPipe face mesh; nose tip against the
+ *            cheek / forehead / chin box.
+ *   SPARSE — the SDK's default sparse landmarks, assumed to be the 6
+ *            MediaPipe face-detection keypoints (eyes, nose tip, mouth,
+ *            ear tragions); nose tip against the ear / eye-to-mouth box.
+ *            Frames that still carry a dense mesh use the DENSE indices.
+ *   OFF    — no gaze; has_gaze stays false.
+ *
+ * SPARSE and OFF let the SDK skip computing and serializing the dense
+ * mesh. SPARSE gaze_y spans a shorter box than DENSE, so it is noisier
+ * and reaches ±1 sooner for the same head pitch.
+ */
+enum class LandmarkMode {
+    DENSE,
+    SPARSE,
+    OFF,
+};
+
+/**
+ * Parse a --gaze_landmarks value ("dense", "sparse" or "off").
+ * Returns false if the name is not recognized.
+ */
+bool parse_landmark_mode(const std::string& name, LandmarkMode* out);
+
+/**
+ * How fast REST vitals lose weight as newer frames arrive without a newer
+ * batch.
+ */
+struct FusionOptions {
+    // Weight halves for every this many seconds the measurement lags the
+    // newest frame. 0 = confidence only, no decay.
+    float vitals_half_life_s = 15.0f;
 };
 
 class MetricsCollector {
 public:
+    explicit MetricsCollector(BlinkRateOptions blink_options = {},
+                              LandmarkMode landmark_mode = LandmarkMode::DENSE,
+                              FusionOptions fusion = {},
+                              VitalsOptions vitals = {});
+
     /**
      * Process core metrics from Physiology REST API callback.
-     * Returns a JSON string representing the update.
+     * Returns a JSON payload representing the update. Like every payload
+     * builder, the view points into this thread's reusable buffer and is
+     * valid until the next payload is built on the same thread.
      */
-    std::string process_core_metrics(
+    std::string_view process_core_metrics(
         const presage::physiology::MetricsBuffer& metrics,
         int64_t timestamp_us
     );
 
     /**
      * Process edge metrics computed on-device.
-     * Returns a JSON string representing the update.
+     * Returns a JSON payload representing the update (see above).
+     */
+    std::string_view process_edge_metrics(
+        const presage::physiology::Metrics& metrics,
+        int64_t timestamp_us
+    );
+
+    /**
+     * Same as process_core_metrics / process_edge_metrics, but only update
+     * the snapshot. Used when the output format doesn't need JSON.
      */
-    std::string process_edge_metrics(
-        const presage::physiology::Metrics& metrics
+    void update_core_metrics(
+        const presage::physiology::MetricsBuffer& metrics,
+        int64_t timestamp_us
     );
+    void update_edge_metrics(
+        const presage::physiology::Metrics& metrics,
+        int64_t timestamp_us
+    );
+
+    /**
+     * Serialize the current snapshot as a "metrics" / "edge" payload.
+     */
+    std::string_view core_json() const;
+    std::string_view edge_json() const;
 
     /**
-     * Get the current aggregated focus metrics snapshot.
+     * Get a consistent copy of the aggregated focus metrics.
+     * Safe to call from any thread; never blocks the callback paths.
      */
-    const FocusMetrics& current() const { return current_metrics_; }
+    FocusMetrics current() const;
+
+    /**
+     * Refine gaze with `estimator` (not owned; nullptr = head pose only).
+     * Set before the first edge update; the estimator then runs on the
+     * edge callback thread.
+     */
+    void set_gaze_estimator(GazeEstimator* estimator) { gaze_estimator_ = estimator; }
 
 private:
-    FocusMetrics current_metrics_;
+    /**
+     * What one callback path publishes. Both paths write the face fields;
+     * each group carries the SDK timestamp of the data it was taken from
+     * (0 = never written), and current() picks the newer one field by
+     * field.
+     */
+    struct Published {
+        FocusMetrics metrics;
+        int64_t latest_us    = 0;   // newest callback timestamp on this path
+        int64_t face_us      = 0;   // face_detected
+        int64_t blink_us     = 0;   // is_blinking, blink_rate_per_min
+        int64_t talk_us      = 0;   // is_talking
+        int64_t pulse_us     = 0;   // core only
+        int64_t breathing_us = 0;   // edge only with VitalsOptions::edge_breathing
+    };
+
+    float freshness(int64_t sample_us, int64_t now_us) const;
+
+    const LandmarkMode landmark_mode_;
+    const FusionOptions fusion_;
+    GazeEstimator* gaze_estimator_ = nullptr;
+
+    // Working copies — each touched only by its own callback thread
+    Published core_working_;
+    Published edge_working_;
+
+    // Blink onsets seen by each path, keyed on SDK timestamps
+    BlinkRateEstimator core_blinks_;
+    BlinkRateEstimator edge_blinks_;
+
+    // Rolling features over every REST sample (core thread)
+    RateWindow pulse_rates_;
+    RateWindow breathing_rates_;
+    HrvEstimator hrv_;
+
+    // Breathing from the edge metrics (edge thread)
+    const bool edge_breathing_;
+    RateWindow edge_breathing_rates_;
+    TraceRateEstimator edge_breathing_trace_;
+
+    SeqLock<Published> core_published_;
+    SeqLock<Published> edge_published_;
 };
 
 } // namespace focus_wizard
@@ -0,0 +1,299 @@
+/**
+ * metrics_server.cpp — Implementation
+ */
+
+#include "metrics_server.hpp"
+
+#include <cerrno>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+
+#include <netdb.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+namespace focus_wizard {
+
+namespace {
+
+constexpr size_t kMaxRequestBytes = 8 * 1024;
+constexpr int kSocketTimeoutMs = 1000;
+
+struct CounterInfo {
+    const char* name;
+    const char* help;
+};
+
+// Indexed by PipelineCounter
+constexpr CounterInfo kCounterInfo[kPipelineCounters] = {
+    {"focus_bridge_frames_received_total", "Frames delivered by the video source."},
+    {"focus_bridge_edge_callbacks_total", "Edge (per-frame) metrics callbacks."},
+    {"focus_bridge_core_callbacks_total", "Core (REST) metrics callbacks."},
+};
+
+// Indexed by PipelineHistogram
+constexpr CounterInfo kHistogramInfo[kPipelineHistograms] = {
+    {"focus_bridge_edge_callback_seconds", "Edge callback: collector fold and emit."},
+    {"focus_bridge_core_callback_seconds", "Core callback: collector fold and emit."},
+    {"focus_bridge_analyze_seconds", "Focus analysis of one snapshot."},
+    {"focus_bridge_rest_rtt_seconds", "REST round trip: age of a batch's newest sample."},
+};
+
+void append_header(std::string& out, const char* name, const char* help, const char* type) {
+    out += "# HELP ";
+    out += name;
+    out += ' ';
+    out += help;
+    out += "\n# TYPE ";
+    out += name;
+    out += ' ';
+    out += type;
+    out += '\n';
+}
+
+void append_number(std::string& out, double value) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.17g", value);
+    out += buffer;
+}
+
+void append_integer(std::string& out, uint64_t value) {
+    char buffer[24];
+    std::snprintf(buffer, sizeof(buffer), "%" PRIu64, value);
+    out += buffer;
+}
+
+void write_all(int fd, const char* data, size_t length) {
+    while (length > 0) {
+        ssize_t written = ::send(fd, data, length, MSG_NOSIGNAL);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return; // scraper went away or timed out
+        }
+        data += written;
+        length -= static_cast<size_t>(written);
+    }
+}
+
+} // namespace
+
+MetricsServer::MetricsServer(const PipelineMetrics& metrics)
+    : metrics_(metrics)
+{
+}
+
+MetricsServer::~MetricsServer() {
+    stop();
+}
+
+void MetricsServer::add_value(std::string name, std::string help, MetricType type,
+                              ValueFn value) {
+    values_.push_back({std::move(name), std::move(help), type, std::move(value)});
+}
+
+// ── Exposition ───────────────────────────────────────────
+
+std::string MetricsServer::render() const {
+    PipelineMetrics::Snapshot snapshot;
+    metrics_.snapshot(&snapshot);
+
+    std::string out;
+    out.reserve(8 * 1024);
+
+    for (size_t i = 0; i < kPipelineCounters; ++i) {
+        append_header(out, kCounterInfo[i].name, kCounterInfo[i].help, "counter");
+        out += kCounterInfo[i].name;
+        out += ' ';
+        append_integer(out, snapshot.counters[i]);
+        out += '\n';
+    }
+
+    const char* transitions = "focus_bridge_state_transitions_total";
+    append_header(out, transitions, "Committed focus state changes, by new state.", "counter");
+    for (size_t i = 0; i < kFocusStates; ++i) {
+        out += transitions;
+        out += "{to=\"";
+        out += focus_state_to_string(static_cast<FocusState>(i));
+        out += "\"} ";
+        append_integer(out, snapshot.transitions[i]);
+        out += '\n';
+    }
+
+    for (size_t h = 0; h < kPipelineHistograms; ++h) {
+        const char* name = kHistogramInfo[h].name;
+        const PipelineMetrics::HistogramSnapshot& histogram = snapshot.histograms[h];
+        append_header(out, name, kHistogramInfo[h].help, "histogram");
+
+        // _count from the buckets, so it always matches le="+Inf"
+        uint64_t cumulative = 0;
+        for (size_t b = 0; b < histogram.buckets.size(); ++b) {
+            cumulative += histogram.buckets[b];
+            out += name;
+            out += "_bucket{le=\"";
+            if (b < kLatencyBucketsUs.size()) {
+                append_number(out, static_cast<double>(kLatencyBucketsUs[b]) / 1e6);
+            } else {
+                out += "+Inf";
+            }
+            out += "\"} ";
+            append_integer(out, cumulative);
+            out += '\n';
+        }
+        out += name;
+        out += "_sum ";
+        append_number(out, static_cast<double>(histogram.sum_us) / 1e6);
+        out += '\n';
+        out += name;
+        out += "_count ";
+        append_integer(out, cumulative);
+        out += '\n';
+    }
+
+    for (const Value& value : values_) {
+        append_header(out, value.name.c_str(), value.help.c_str(),
+                      value.type == MetricType::COUNTER ? "counter" : "gauge");
+        out += value.name;
+        out += ' ';
+        append_number(out, value.value());
+        out += '\n';
+    }
+    return out;
+}
+
+// ── Server ───────────────────────────────────────────────
+
+bool MetricsServer::start(const std::string& host, int port, std::string* error) {
+    if (thread_.joinable()) {
+        *error = "metrics server already running";
+        return false;
+    }
+
+    struct addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+
+    const std::string port_text = std::to_string(port);
+    const std::string address = host + ":" + port_text;
+    struct addrinfo* addresses = nullptr;
+    int rc = ::getaddrinfo(host.empty() ? nullptr : host.c_str(), port_text.c_str(),
+                           &hints, &addresses);
+    if (rc != 0) {
+        *error = "resolve " + address + ": " + ::gai_strerror(rc);
+        return false;
+    }
+
+    std::string last_error = "no usable address";
+    for (auto* ai = addresses; ai; ai = ai->ai_next) {
+        int fd = ::socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC, ai->ai_protocol);
+        if (fd < 0) {
+            last_error = std::strerror(errno);
+            continue;
+        }
+        int one = 1;
+        ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        if (::bind(fd, ai->ai_addr, ai->ai_addrlen) == 0 && ::listen(fd, 16) == 0) {
+            listen_fd_ = fd;
+            break;
+        }
+        last_error = std::strerror(errno);
+        ::close(fd);
+    }
+    ::freeaddrinfo(addresses);
+    if (listen_fd_ < 0) {
+        *error = "listen " + address + ": " + last_error;
+        return false;
+    }
+
+    wake_fd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wake_fd_ < 0) {
+        *error = std::string("eventfd: ") + std::strerror(errno);
+        stop();
+        return false;
+    }
+
+    thread_ = std::thread([this] { run(); });
+    return true;
+}
+
+void MetricsServer::stop() {
+    if (thread_.joinable()) {
+        uint64_t one = 1;
+        (void)!::write(wake_fd_, &one, sizeof(one));
+        thread_.join();
+    }
+    for (int* fd : {&listen_fd_, &wake_fd_}) {
+        if (*fd >= 0) {
+            ::close(*fd);
+            *fd = -1;
+        }
+    }
+}
+
+void MetricsServer::run() {
+    for (;;) {
+        struct pollfd fds[2] = {
+            {listen_fd_, POLLIN, 0},
+            {wake_fd_, POLLIN, 0},
+        };
+        int ready = ::poll(fds, 2, -1);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        if (fds[1].revents) return;
+        if (!(fds[0].revents & POLLIN)) continue;
+
+        int fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) continue;
+
+        // A stuck scraper must not hold the thread (or stop()) for long
+        struct timeval timeout;
+        timeout.tv_sec = kSocketTimeoutMs / 1000;
+        timeout.tv_usec = (kSocketTimeoutMs % 1000) * 1000;
+        ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        serve(fd);
+        ::close(fd);
+    }
+}
+
+void MetricsServer::serve(int fd) {
+    // Only the request line matters; read until the end of the headers
+    std::string request;
+    char buffer[1024];
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < kMaxRequestBytes) {
+        ssize_t n = ::recv(fd, buffer, sizeof(buffer), 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        request.append(buffer, static_cast<size_t>(n));
+    }
+
+    size_t line_end = request.find("\r\n");
+    std::string line = request.substr(0, line_end);
+    bool is_get = line.compare(0, 4, "GET ") == 0;
+    std::string path = is_get ? line.substr(4, line.find(' ', 4) - 4) : "";
+
+    std::string response;
+    if (is_get && (path == "/metrics" || path.compare(0, 9, "/metrics?") == 0)) {
+        std::string body = render();
+        response = "HTTP/1.0 200 OK\r\n"
+                   "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                   "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                   "Connection: close\r\n\r\n";
+        response += body;
+    } else if (is_get) {
+        response = "HTTP/1.0 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+    } else {
+        response = "HTTP/1.0 405 Method Not Allowed\r\nContent-Length: 0\r\n"
+                   "Connection: close\r\n\r\n";
+    }
+    write_all(fd, response.data(), response.size());
+}
+
+} // namespace focus_wizard
@@ -0,0 +1,84 @@
+/**
+ * metrics_server.hpp — Prometheus text-format endpoint (--metrics_port)
+ *
+ * A small HTTP/1.0 server on its own thread. GET /metrics answers with
+ * the text exposition format (version 0.0.4, which Prometheus and
+ * OpenMetrics scrapers both accept):
+ *
+ *   - the hot-path counters and histograms of pipeline_metrics(), and
+ *   - values sampled at scrape time by callbacks added with add_value()
+ *     (emitter queue depth, dropped frames, REST totals, ...).
+ *
+ * Requests are served one at a time with short socket timeouts; a
+ * scraper every few seconds is the whole expected load. Scraping never
+ * touches the frame loop: it only reads atomics.
+ */
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "pipeline_metrics.hpp"
+
+namespace focus_wizard {
+
+enum class MetricType {
+    COUNTER,
+    GAUGE,
+};
+
+class MetricsServer {
+public:
+    using ValueFn = std::function<double()>;
+
+    explicit MetricsServer(const PipelineMetrics& metrics = pipeline_metrics());
+    ~MetricsServer();
+
+    MetricsServer(const MetricsServer&) = delete;
+    MetricsServer& operator=(const MetricsServer&) = delete;
+
+    /**
+     * Export `value()` as `name`. Call before start(); the callback runs
+     * on the server thread and must be thread-safe.
+     */
+    void add_value(std::string name, std::string help, MetricType type, ValueFn value);
+
+    /**
+     * Bind `host`:`port`, listen and start the server thread.
+     * On failure returns false and describes why in `error`.
+     */
+    bool start(const std::string& host, int port, std::string* error);
+
+    /**
+     * Close the socket and join the thread. Safe to call twice.
+     */
+    void stop();
+
+    /**
+     * The /metrics body.
+     */
+    std::string render() const;
+
+private:
+    struct Value {
+        std::string name;
+        std::string help;
+        MetricType type;
+        ValueFn value;
+    };
+
+    void run();
+    void serve(int fd);
+
+    const PipelineMetrics& metrics_;
+    std::vector<Value> values_;
+
+    int listen_fd_ = -1;
+    int wake_fd_ = -1;          // eventfd: stop
+    std::thread thread_;
+};
+
+} // namespace focus_wizard
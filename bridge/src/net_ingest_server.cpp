@@ -0,0 +1,440 @@
+/**
+ * net_ingest_server.cpp — Implementation
+ */
+
+#include "net_ingest_server.hpp"
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <limits>
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace focus_wizard {
+
+namespace {
+
+constexpr size_t kInitialInputBytes = 256 * 1024;
+constexpr int kMaxEvents = 16;
+
+// epoll_event.data tags; channels use their index
+constexpr uint64_t kListenTag = std::numeric_limits<uint64_t>::max();
+constexpr uint64_t kWakeTag   = kListenTag - 1;
+
+// Split "host:port", ":port" or "port". IPv6 hosts may be bracketed.
+void split_listen_address(const std::string& listen, std::string* host, std::string* port) {
+    size_t colon = listen.rfind(':');
+    if (colon == std::string::npos) {
+        host->clear();
+        *port = listen;
+        return;
+    }
+    *host = listen.substr(0, colon);
+    *port = listen.substr(colon + 1);
+    if (host->size() >= 2 && host->front() == '[' && host->back() == ']') {
+        *host = host->substr(1, host->size() - 2);
+    }
+}
+
+} // namespace
+
+// ── Channel ──────────────────────────────────────────────
+
+NetChannel::NetChannel(size_t index, const NetIngestOptions& options, int epoll_fd)
+    : index_(index)
+    , options_(options)
+    , epoll_fd_(epoll_fd)
+{
+    in_.resize(kInitialInputBytes);
+    out_.reserve(options_.max_outbound_bytes);
+}
+
+void NetChannel::attach(int fd) {
+    in_start_ = in_end_ = 0;
+
+    std::lock_guard<std::mutex> lock(out_mutex_);
+    struct epoll_event event{};
+    event.events = EPOLLIN | EPOLLRDHUP;
+    event.data.u64 = index_;
+    ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event);
+    fd_ = fd;
+    want_write_ = false;
+    generation_.fetch_add(1, std::memory_order_acq_rel);
+
+    // Deliver status/ready messages emitted while nobody was connected
+    flush_locked();
+    update_write_interest_locked();
+}
+
+void NetChannel::detach() {
+    {
+        std::lock_guard<std::mutex> lock(out_mutex_);
+        if (fd_ < 0) return;
+
+        ::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd_, nullptr);
+        ::close(fd_);
+        fd_ = -1;
+
+        // A half-sent message is useless to the next client
+        out_.clear();
+        out_sent_ = 0;
+        want_write_ = false;
+    }
+    in_start_ = in_end_ = 0;
+
+    // Nor is the last client's frame
+    std::lock_guard<std::mutex> lock(frame_mutex_);
+    has_pending_ = false;
+}
+
+bool NetChannel::read_input() {
+    for (;;) {
+        if (in_end_ == in_.size()) {
+            if (in_start_ > 0) {
+                std::memmove(in_.data(), in_.data() + in_start_, in_end_ - in_start_);
+                in_end_ -= in_start_;
+                in_start_ = 0;
+            } else {
+                // parse_input() caps records at max_frame_bytes, so this is bounded
+                in_.resize(in_.size() * 2);
+            }
+        }
+
+        ssize_t n = ::read(fd_, in_.data() + in_end_, in_.size() - in_end_);
+        if (n > 0) {
+            in_end_ += static_cast<size_t>(n);
+            if (!parse_input()) return false;
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return true;
+        return false; // EOF or reset
+    }
+}
+
+bool NetChannel::parse_input() {
+    while (in_end_ - in_start_ >= sizeof(RecordHeader)) {
+        const uint8_t* record = in_.data() + in_start_;
+        RecordHeader header;
+        std::memcpy(&header, record, sizeof(header));
+
+        if (header.version != kBinaryProtocolVersion ||
+            header.length > options_.max_frame_bytes + sizeof(FrameRecord)) {
+            return false;
+        }
+        if (in_end_ - in_start_ < sizeof(RecordHeader) + header.length) {
+            break; // wait for the rest
+        }
+
+        const uint8_t* payload = record + sizeof(RecordHeader);
+        if (header.type == static_cast<uint8_t>(MessageType::FRAME) &&
+            header.length >= sizeof(FrameRecord)) {
+            FrameRecord info;
+            std::memcpy(&info, payload, sizeof(info));
+            const uint8_t* pixels = payload + sizeof(FrameRecord);
+            size_t bytes = header.length - sizeof(FrameRecord);
+
+            {
+                std::lock_guard<std::mutex> lock(frame_mutex_);
+                if (has_pending_) {
+                    skipped_.fetch_add(1, std::memory_order_relaxed);
+                }
+                pending_.sequence = next_sequence_++;
+                pending_.timestamp_us = info.timestamp_us;
+                pending_.width = info.width;
+                pending_.height = info.height;
+                pending_.stride = info.stride;
+                pending_.format = static_cast<FramePixelFormat>(info.format);
+                pending_.data.assign(pixels, pixels + bytes);
+                has_pending_ = true;
+            }
+            frame_cv_.notify_one();
+        }
+
+        in_start_ += sizeof(RecordHeader) + header.length;
+    }
+
+    if (in_start_ == in_end_) {
+        in_start_ = in_end_ = 0;
+    }
+    return true;
+}
+
+void NetChannel::on_writable() {
+    std::lock_guard<std::mutex> lock(out_mutex_);
+    flush_locked();
+    update_write_interest_locked();
+}
+
+bool NetChannel::wait(int timeout_ms) {
+    std::unique_lock<std::mutex> lock(frame_mutex_);
+    return frame_cv_.wait_for(lock, std::chrono::milliseconds(timeout_ms),
+                              [this] { return has_pending_; });
+}
+
+bool NetChannel::read_latest(ReceivedFrame* frame) {
+    std::lock_guard<std::mutex> lock(frame_mutex_);
+    if (!has_pending_) return false;
+
+    // Swap so both buffers keep their capacity
+    frame->data.swap(pending_.data);
+    frame->sequence = pending_.sequence;
+    frame->timestamp_us = pending_.timestamp_us;
+    frame->width = pending_.width;
+    frame->height = pending_.height;
+    frame->stride = pending_.stride;
+    frame->format = pending_.format;
+    has_pending_ = false;
+    return true;
+}
+
+void NetChannel::send(MessageType type, const char* data, size_t length) {
+    enqueue(type, data, length, true, 0);
+}
+
+void NetChannel::send_to(uint64_t generation, MessageType type,
+                         const char* data, size_t length) {
+    enqueue(type, data, length, false, generation);
+}
+
+void NetChannel::enqueue(MessageType type, const char* data, size_t length,
+                         bool any_generation, uint64_t generation) {
+    // Per-frame snapshots go stale quickly; everything else must arrive
+    bool droppable = (type == MessageType::EDGE || type == MessageType::FOCUS);
+
+    std::lock_guard<std::mutex> lock(out_mutex_);
+    bool wrong_client = !any_generation &&
+        (fd_ < 0 || generation_.load(std::memory_order_relaxed) != generation);
+    size_t queued = out_.size() - out_sent_;
+    if (wrong_client || (droppable && fd_ < 0) ||
+        queued + length > options_.max_outbound_bytes) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // Reclaim the sent prefix before it grows past the cap
+    if (out_sent_ >= options_.max_outbound_bytes) {
+        out_.erase(out_.begin(), out_.begin() + static_cast<std::ptrdiff_t>(out_sent_));
+        out_sent_ = 0;
+    }
+    out_.insert(out_.end(), data, data + length);
+
+    if (fd_ >= 0) {
+        flush_locked();
+        update_write_interest_locked();
+    }
+}
+
+void NetChannel::flush_locked() {
+    while (fd_ >= 0 && out_sent_ < out_.size()) {
+        ssize_t n = ::send(fd_, out_.data() + out_sent_, out_.size() - out_sent_,
+                           MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            // EAGAIN: finish on EPOLLOUT. Anything else: the I/O thread sees
+            // the hangup and closes the connection.
+            break;
+        }
+        out_sent_ += static_cast<size_t>(n);
+    }
+    if (out_sent_ == out_.size()) {
+        out_.clear();
+        out_sent_ = 0;
+    }
+}
+
+void NetChannel::update_write_interest_locked() {
+    if (fd_ < 0) return;
+
+    bool need_write = out_sent_ < out_.size();
+    if (need_write == want_write_) return;
+
+    // epoll_ctl is thread-safe, so emitting threads can arm EPOLLOUT directly
+    struct epoll_event event{};
+    event.events = EPOLLIN | EPOLLRDHUP | (need_write ? EPOLLOUT : 0u);
+    event.data.u64 = index_;
+    ::epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd_, &event);
+    want_write_ = need_write;
+}
+
+// ── Server ───────────────────────────────────────────────
+
+NetIngestServer::~NetIngestServer() {
+    stop();
+}
+
+bool NetIngestServer::start(const NetIngestOptions& options, std::string* error) {
+    if (thread_.joinable()) {
+        *error = "ingest server already running";
+        return false;
+    }
+    options_ = options;
+    if (options_.max_clients == 0) options_.max_clients = 1;
+
+    std::string host, port;
+    split_listen_address(options_.listen, &host, &port);
+
+    struct addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+
+    struct addrinfo* addresses = nullptr;
+    int rc = ::getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(),
+                           &hints, &addresses);
+    if (rc != 0) {
+        *error = "resolve " + options_.listen + ": " + ::gai_strerror(rc);
+        return false;
+    }
+
+    std::string last_error = "no usable address";
+    for (auto* ai = addresses; ai; ai = ai->ai_next) {
+        int fd = ::socket(ai->ai_family, ai->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                          ai->ai_protocol);
+        if (fd < 0) {
+            last_error = std::strerror(errno);
+            continue;
+        }
+        int one = 1;
+        ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        if (::bind(fd, ai->ai_addr, ai->ai_addrlen) == 0 && ::listen(fd, 64) == 0) {
+            listen_fd_ = fd;
+            break;
+        }
+        last_error = std::strerror(errno);
+        ::close(fd);
+    }
+    ::freeaddrinfo(addresses);
+    if (listen_fd_ < 0) {
+        *error = "listen " + options_.listen + ": " + last_error;
+        return false;
+    }
+
+    epoll_fd_ = ::epoll_create1(EPOLL_CLOEXEC);
+    wake_fd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epoll_fd_ < 0 || wake_fd_ < 0) {
+        *error = std::string("epoll setup: ") + std::strerror(errno);
+        stop();
+        return false;
+    }
+    struct epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.u64 = kListenTag;
+    ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, listen_fd_, &event);
+    event.data.u64 = kWakeTag;
+    ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &event);
+
+    channels_.clear();
+    for (size_t i = 0; i < options_.max_clients; ++i) {
+        channels_.emplace_back(new NetChannel(i, options_, epoll_fd_));
+    }
+
+    stopping_.store(false, std::memory_order_relaxed);
+    thread_ = std::thread([this] { run(); });
+    return true;
+}
+
+void NetIngestServer::stop() {
+    if (thread_.joinable()) {
+        stopping_.store(true, std::memory_order_release);
+        uint64_t one = 1;
+        (void)!::write(wake_fd_, &one, sizeof(one));
+        thread_.join();
+    }
+
+    // Channels stay allocated: sessions may still hold references
+    for (auto& channel : channels_) {
+        channel->detach();
+        channel->frame_cv_.notify_all();
+    }
+    for (int* fd : {&listen_fd_, &wake_fd_, &epoll_fd_}) {
+        if (*fd >= 0) {
+            ::close(*fd);
+            *fd = -1;
+        }
+    }
+}
+
+void NetIngestServer::run() {
+    struct epoll_event events[kMaxEvents];
+
+    while (!stopping_.load(std::memory_order_acquire)) {
+        int ready = ::epoll_wait(epoll_fd_, events, kMaxEvents, -1);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+
+        for (int i = 0; i < ready; ++i) {
+            uint64_t tag = events[i].data.u64;
+            uint32_t flags = events[i].events;
+
+            if (tag == kWakeTag) {
+                uint64_t count;
+                (void)!::read(wake_fd_, &count, sizeof(count));
+                continue;
+            }
+            if (tag == kListenTag) {
+                accept_clients();
+                continue;
+            }
+
+            // A channel closed earlier in this batch may still have events
+            NetChannel& channel = *channels_[tag];
+            if (channel.fd_ < 0) continue;
+
+            if (flags & EPOLLOUT) {
+                channel.on_writable();
+            }
+            if (flags & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+                if (!channel.read_input()) {
+                    close_channel(channel);
+                }
+            }
+        }
+    }
+}
+
+void NetIngestServer::accept_clients() {
+    for (;;) {
+        int fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            return; // EAGAIN, or a transient error (EMFILE etc.)
+        }
+
+        NetChannel* free_channel = nullptr;
+        for (auto& channel : channels_) {
+            if (channel->fd_ < 0) {
+                free_channel = channel.get();
+                break;
+            }
+        }
+        if (!free_channel) {
+            ::close(fd);
+            rejected_.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+
+        int one = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        free_channel->attach(fd);
+        if (on_connection_) on_connection_(free_channel->index(), true);
+    }
+}
+
+void NetIngestServer::close_channel(NetChannel& channel) {
+    channel.detach();
+    if (on_connection_) on_connection_(channel.index(), false);
+}
+
+} // namespace focus_wizard
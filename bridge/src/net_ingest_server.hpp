@@ -0,0 +1,205 @@
+/**
+ * net_ingest_server.hpp — In-process TCP frame ingest (--mode=net/multi)
+ *
+ * Server mode needs a separate relay process that turns incoming webcam
+ * frames into numbered files. With --mode=net the bridge listens itself:
+ * a remote client connects, streams framed JPEG or raw frames, and gets
+ * the bridge's output (NDJSON lines or binary records, per
+ * --output_format) back on the same connection.
+ *
+ * Inbound framing reuses the binary protocol header:
+ *
+ *   RecordHeader { length, type = MessageType::FRAME, version }
+ *   FrameRecord  { timestamp_us, width, height, stride, format }
+ *   payload      (length - sizeof(FrameRecord) bytes)
+ *
+ * Records of other types are skipped, so the protocol can grow.
+ *
+ * The server has a fixed set of channels (max_clients); each accepted
+ * connection is bound to a free channel, and connections beyond that are
+ * closed at once. --mode=net uses a single channel, --mode=multi one per
+ * session (see session_host.hpp).
+ *
+ * All socket I/O is non-blocking and driven by one epoll thread shared by
+ * every channel. Frames land in a per-channel single-slot mailbox (newer
+ * frames replace unread ones, like the shm ring). Outbound messages are
+ * appended to a bounded buffer and sent opportunistically by the emitting
+ * thread; whatever the socket doesn't take is finished by the epoll thread
+ * on EPOLLOUT. A slow client loses stale edge/focus messages rather than
+ * stalling the pipeline.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "binary_protocol.hpp"
+#include "frame_provider.hpp"
+
+namespace focus_wizard {
+
+struct NetIngestOptions {
+    // "host:port", ":port" or "port"
+    std::string listen = "0.0.0.0:9000";
+
+    // Concurrent connections (= channels)
+    size_t max_clients = 1;
+
+    // Larger inbound records are a protocol error (the client is dropped)
+    size_t max_frame_bytes = 16 * 1024 * 1024;
+
+    // Outbound bytes held per channel for a slow or absent client
+    size_t max_outbound_bytes = 1024 * 1024;
+};
+
+/**
+ * One client slot: the frame mailbox and outbound buffer of whichever
+ * connection is currently bound to it.
+ */
+class NetChannel : public FrameProvider {
+public:
+    NetChannel(const NetChannel&) = delete;
+    NetChannel& operator=(const NetChannel&) = delete;
+
+    size_t index() const { return index_; }
+
+    /**
+     * Incremented each time a connection is bound to this channel.
+     */
+    uint64_t generation() const { return generation_.load(std::memory_order_acquire); }
+
+    bool wait(int timeout_ms) override;
+    bool read_latest(ReceivedFrame* frame) override;
+    uint64_t skipped() const override { return skipped_.load(std::memory_order_relaxed); }
+
+    /**
+     * Queue one already-framed message for the connected client.
+     * Thread-safe; never blocks on the socket. Edge and focus messages are
+     * dropped when no client is connected or the buffer is full; others
+     * are held (up to max_outbound_bytes) until a client connects.
+     */
+    void send(MessageType type, const char* data, size_t length);
+
+    /**
+     * Like send(), but only delivers to connection `generation`; once it
+     * has gone every message is dropped. Keeps a finishing session's last
+     * messages away from the next client of the channel.
+     */
+    void send_to(uint64_t generation, MessageType type, const char* data, size_t length);
+
+    /**
+     * Outbound messages dropped for lack of a client or buffer space.
+     */
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    friend class NetIngestServer;
+
+    NetChannel(size_t index, const NetIngestOptions& options, int epoll_fd);
+
+    // I/O thread only
+    void attach(int fd);
+    bool read_input();          // false once the connection is closed
+    bool parse_input();         // false on a protocol error
+    void on_writable();
+    void detach();
+
+    void enqueue(MessageType type, const char* data, size_t length,
+                 bool any_generation, uint64_t generation);
+
+    // Caller must hold out_mutex_
+    void flush_locked();
+    void update_write_interest_locked();
+
+    const size_t index_;
+    const NetIngestOptions& options_;
+    const int epoll_fd_;
+
+    // Inbound (I/O thread only)
+    std::vector<uint8_t> in_;
+    size_t in_start_ = 0;       // first unparsed byte in in_
+    size_t in_end_ = 0;         // end of received bytes in in_
+
+    // Frame mailbox
+    std::mutex frame_mutex_;
+    std::condition_variable frame_cv_;
+    ReceivedFrame pending_;
+    bool has_pending_ = false;
+    uint64_t next_sequence_ = 1;
+    std::atomic<uint64_t> skipped_{0};
+
+    // Outbound
+    std::mutex out_mutex_;
+    int fd_ = -1;               // guarded by out_mutex_; changed by the I/O thread
+    std::atomic<uint64_t> generation_{0};
+    std::vector<char> out_;
+    size_t out_sent_ = 0;       // bytes of out_ already on the wire
+    bool want_write_ = false;   // EPOLLOUT armed
+    std::atomic<uint64_t> dropped_{0};
+};
+
+class NetIngestServer {
+public:
+    /**
+     * Called on the I/O thread when channel `index` gains (`connected`) or
+     * loses its client. Must not block.
+     */
+    using ConnectionCallback = std::function<void(size_t index, bool connected)>;
+
+    NetIngestServer() = default;
+    ~NetIngestServer();
+
+    NetIngestServer(const NetIngestServer&) = delete;
+    NetIngestServer& operator=(const NetIngestServer&) = delete;
+
+    /**
+     * Set before start().
+     */
+    void set_connection_callback(ConnectionCallback callback) { on_connection_ = std::move(callback); }
+
+    /**
+     * Bind, listen and start the I/O thread.
+     * On failure returns false and describes why in `error`.
+     */
+    bool start(const NetIngestOptions& options, std::string* error);
+
+    /**
+     * Close all sockets and join the I/O thread. Safe to call twice.
+     */
+    void stop();
+
+    size_t channel_count() const { return channels_.size(); }
+    NetChannel& channel(size_t index) { return *channels_[index]; }
+
+    /**
+     * Connections refused because every channel was in use.
+     */
+    uint64_t rejected() const { return rejected_.load(std::memory_order_relaxed); }
+
+private:
+    void run();
+    void accept_clients();
+    void close_channel(NetChannel& channel);
+
+    NetIngestOptions options_;
+    std::vector<std::unique_ptr<NetChannel>> channels_;
+    ConnectionCallback on_connection_;
+
+    int listen_fd_ = -1;
+    int epoll_fd_ = -1;
+    int wake_fd_ = -1;          // eventfd: stop
+    std::thread thread_;
+    std::atomic<bool> stopping_{false};
+    std::atomic<uint64_t> rejected_{0};
+};
+
+} // namespace focus_wizard
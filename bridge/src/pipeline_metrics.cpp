@@ -0,0 +1,115 @@
+/**
+ * pipeline_metrics.cpp — Implementation
+ */
+
+#include "pipeline_metrics.hpp"
+
+#include <algorithm>
+
+namespace focus_wizard {
+
+// The calling thread's slot; given back when the thread exits
+struct ThreadSlot {
+    PipelineMetrics* metrics = nullptr;
+    PipelineMetrics::Slot* slot = nullptr;
+
+    ~ThreadSlot() { release(); }
+
+    void release() {
+        if (slot && slot != &metrics->overflow_) {
+            slot->owned.store(false, std::memory_order_release);
+        }
+        metrics = nullptr;
+        slot = nullptr;
+    }
+};
+
+static thread_local ThreadSlot t_slot;
+
+PipelineMetrics& pipeline_metrics() {
+    static PipelineMetrics metrics;
+    return metrics;
+}
+
+PipelineMetrics::Slot& PipelineMetrics::local_slot() {
+    if (t_slot.metrics != this) {
+        t_slot.release();
+        t_slot.metrics = this;
+        t_slot.slot = acquire_slot();
+    }
+    return *t_slot.slot;
+}
+
+PipelineMetrics::Slot* PipelineMetrics::acquire_slot() {
+    for (Slot& slot : slots_) {
+        bool expected = false;
+        // acquire: see the counts the previous owner left
+        if (!slot.owned.load(std::memory_order_relaxed) &&
+            slot.owned.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+            return &slot;
+        }
+    }
+    return &overflow_;
+}
+
+void PipelineMetrics::bump(Slot& slot, std::atomic<uint64_t>& cell, uint64_t n) {
+    if (&slot == &overflow_) {
+        cell.fetch_add(n, std::memory_order_relaxed);
+    } else {
+        // Single writer: a plain load and store, no locked instruction
+        cell.store(cell.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+}
+
+void PipelineMetrics::add(PipelineCounter counter, uint64_t n) {
+    if (!enabled()) return;
+    Slot& slot = local_slot();
+    bump(slot, slot.counters[static_cast<size_t>(counter)], n);
+}
+
+void PipelineMetrics::add_transition(FocusState to) {
+    if (!enabled()) return;
+    Slot& slot = local_slot();
+    bump(slot, slot.transitions[static_cast<size_t>(to)], 1);
+}
+
+void PipelineMetrics::observe(PipelineHistogram histogram, int64_t duration_us) {
+    if (!enabled()) return;
+    duration_us = std::max<int64_t>(duration_us, 0);
+
+    size_t bucket = static_cast<size_t>(
+        std::lower_bound(kLatencyBucketsUs.begin(), kLatencyBucketsUs.end(), duration_us) -
+        kLatencyBucketsUs.begin());
+
+    Slot& slot = local_slot();
+    size_t index = static_cast<size_t>(histogram);
+    bump(slot, slot.buckets[index][bucket], 1);
+    bump(slot, slot.sum_us[index], static_cast<uint64_t>(duration_us));
+    bump(slot, slot.count[index], 1);
+}
+
+void PipelineMetrics::snapshot(Snapshot* out) const {
+    *out = Snapshot();
+
+    auto accumulate = [out](const Slot& slot) {
+        for (size_t i = 0; i < kPipelineCounters; ++i) {
+            out->counters[i] += slot.counters[i].load(std::memory_order_relaxed);
+        }
+        for (size_t i = 0; i < kFocusStates; ++i) {
+            out->transitions[i] += slot.transitions[i].load(std::memory_order_relaxed);
+        }
+        for (size_t h = 0; h < kPipelineHistograms; ++h) {
+            HistogramSnapshot& histogram = out->histograms[h];
+            for (size_t b = 0; b < histogram.buckets.size(); ++b) {
+                histogram.buckets[b] += slot.buckets[h][b].load(std::memory_order_relaxed);
+            }
+            histogram.sum_us += slot.sum_us[h].load(std::memory_order_relaxed);
+            histogram.count += slot.count[h].load(std::memory_order_relaxed);
+        }
+    };
+
+    for (const Slot& slot : slots_) accumulate(slot);
+    accumulate(overflow_);
+}
+
+} // namespace focus_wizard
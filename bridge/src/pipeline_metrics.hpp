@@ -0,0 +1,144 @@
+/**
+ * pipeline_metrics.hpp — Process-wide counters and latency histograms
+ *
+ * The hot path (SDK callbacks, publish_*, the analyzer) counts events and
+ * records durations here; the metrics endpoint (metrics_server.hpp) sums
+ * them up when scraped.
+ *
+ * Every recording thread owns one slot of counters and histogram buckets.
+ * Only the owner writes a slot, so an update is a relaxed load and store
+ * of a thread-private cache line: no lock, no read-modify-write and no
+ * line shared with another callback thread. snapshot() adds the slots up
+ * with relaxed loads, which can be a few increments behind but never
+ * tears a value. A thread's slot is released when it exits and adopted,
+ * counts included, by the next new thread, so the SDK rebuilding its
+ * threads (REST cadence, multi-session) doesn't grow the table. Threads
+ * beyond kMaxThreads share one overflow slot with atomic adds.
+ *
+ * Nothing is recorded until set_enabled(true) (--metrics_port), so the
+ * default bridge reads no extra clocks.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "focus_analyzer.hpp"
+
+namespace focus_wizard {
+
+enum class PipelineCounter : uint8_t {
+    FRAMES_RECEIVED = 0,    // video callback
+    EDGE_CALLBACKS  = 1,
+    CORE_CALLBACKS  = 2,
+};
+
+enum class PipelineHistogram : uint8_t {
+    EDGE_CALLBACK = 0,      // publish_edge: collector fold + emit
+    CORE_CALLBACK = 1,      // publish_core: collector fold + emit
+    ANALYZE       = 2,      // FocusAnalyzer::update()
+    REST_RTT      = 3,      // see RestCadence::on_batch()
+};
+
+constexpr size_t kPipelineCounters = 3;
+constexpr size_t kPipelineHistograms = 4;
+constexpr size_t kFocusStates = static_cast<size_t>(FocusState::UNKNOWN) + 1;
+
+// Histogram bucket upper bounds, microseconds (+Inf is implied)
+constexpr std::array<int64_t, 15> kLatencyBucketsUs = {
+    100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000,
+    100000, 250000, 500000, 1000000, 2500000, 5000000,
+};
+
+inline int64_t pipeline_clock_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+class PipelineMetrics {
+public:
+    static constexpr size_t kMaxThreads = 64;
+
+    struct HistogramSnapshot {
+        // Per bucket (not cumulative); the last one is +Inf
+        std::array<uint64_t, kLatencyBucketsUs.size() + 1> buckets{};
+        uint64_t sum_us = 0;
+        uint64_t count = 0;
+    };
+
+    struct Snapshot {
+        std::array<uint64_t, kPipelineCounters> counters{};
+        std::array<uint64_t, kFocusStates> transitions{};   // by new state
+        std::array<HistogramSnapshot, kPipelineHistograms> histograms{};
+    };
+
+    PipelineMetrics() = default;
+    PipelineMetrics(const PipelineMetrics&) = delete;
+    PipelineMetrics& operator=(const PipelineMetrics&) = delete;
+
+    void set_enabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+    bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    void add(PipelineCounter counter, uint64_t n = 1);
+    void add_transition(FocusState to);
+    void observe(PipelineHistogram histogram, int64_t duration_us);
+
+    void snapshot(Snapshot* out) const;
+
+private:
+    struct alignas(64) Slot {
+        std::atomic<bool> owned{false};
+        std::atomic<uint64_t> counters[kPipelineCounters] = {};
+        std::atomic<uint64_t> transitions[kFocusStates] = {};
+        std::atomic<uint64_t> buckets[kPipelineHistograms][kLatencyBucketsUs.size() + 1] = {};
+        std::atomic<uint64_t> sum_us[kPipelineHistograms] = {};
+        std::atomic<uint64_t> count[kPipelineHistograms] = {};
+    };
+
+    friend struct ThreadSlot;
+
+    Slot& local_slot();
+    Slot* acquire_slot();
+    void bump(Slot& slot, std::atomic<uint64_t>& cell, uint64_t n);
+
+    std::atomic<bool> enabled_{false};
+    Slot slots_[kMaxThreads];
+    Slot overflow_;
+};
+
+/**
+ * The instance every runner records into.
+ */
+PipelineMetrics& pipeline_metrics();
+
+/**
+ * Records the time from construction to destruction into `histogram`,
+ * if metrics are enabled.
+ */
+class ScopedLatency {
+public:
+    explicit ScopedLatency(PipelineHistogram histogram)
+        : histogram_(histogram)
+        , start_us_(pipeline_metrics().enabled() ? pipeline_clock_us() : 0)
+    {
+    }
+
+    ~ScopedLatency() {
+        if (start_us_ != 0) {
+            pipeline_metrics().observe(histogram_, pipeline_clock_us() - start_us_);
+        }
+    }
+
+    ScopedLatency(const ScopedLatency&) = delete;
+    ScopedLatency& operator=(const ScopedLatency&) = delete;
+
+private:
+    PipelineHistogram histogram_;
+    int64_t start_us_;
+};
+
+} // namespace focus_wizard
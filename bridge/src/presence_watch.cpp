@@ -0,0 +1,135 @@
+/**
+ * presence_watch.cpp — Implementation
+ */
+
+#include "presence_watch.hpp"
+
+#include <algorithm>
+#include <vector>
+
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+
+namespace focus_wizard {
+
+PresenceWatch::PresenceWatch(PresenceWatchOptions options)
+    : options_(std::move(options))
+{
+}
+
+bool PresenceWatch::load(std::string* error) {
+    has_cascade_ = false;
+    if (options_.cascade_path.empty()) {
+        *error = "no cascade configured";
+        return false;
+    }
+    if (!cascade_.load(options_.cascade_path) || cascade_.empty()) {
+        *error = "failed to load cascade " + options_.cascade_path;
+        return false;
+    }
+    has_cascade_ = true;
+    return true;
+}
+
+void PresenceWatch::update_state(FocusState state, int64_t now_us) {
+    if (state != FocusState::AWAY) {
+        woke_at_us_.store(-1, std::memory_order_relaxed);
+        active_.store(false, std::memory_order_release);
+        return;
+    }
+    if (active()) return;
+
+    // Just woke up: frames from before the detection are still draining
+    // out of the graph and say AWAY. Give the graph time to see the face.
+    int64_t woke_at = woke_at_us_.load(std::memory_order_relaxed);
+    if (woke_at >= 0 &&
+        now_us - woke_at < static_cast<int64_t>(options_.rearm_s * 1e6f)) {
+        return;
+    }
+    woke_at_us_.store(-1, std::memory_order_relaxed);
+    active_.store(true, std::memory_order_release);
+}
+
+PresenceWatch::Action PresenceWatch::next(int64_t now_us) {
+    if (!active()) return Action::FORWARD;
+
+    if (now_us - last_forward_us_ >= static_cast<int64_t>(options_.keepalive_ms) * 1000) {
+        last_forward_us_ = now_us;
+        return Action::FORWARD;
+    }
+    if (has_cascade_ &&
+        now_us - last_check_us_ >= static_cast<int64_t>(options_.check_ms) * 1000) {
+        last_check_us_ = now_us;
+        return Action::CHECK;
+    }
+    withheld_.fetch_add(1, std::memory_order_relaxed);
+    return Action::DROP;
+}
+
+bool PresenceWatch::check(const ReceivedFrame& frame, int64_t now_us) {
+    auto* data = const_cast<uint8_t*>(frame.data.data());
+    int rows = static_cast<int>(frame.height);
+    int cols = static_cast<int>(frame.width);
+
+    switch (frame.format) {
+        case FramePixelFormat::JPEG: {
+            if (frame.data.empty()) return false;
+            // libjpeg decodes straight to 1/4 size gray: far cheaper than full color
+            cv::Mat encoded(1, static_cast<int>(frame.data.size()), CV_8UC1, data);
+            cv::imdecode(encoded, cv::IMREAD_REDUCED_GRAYSCALE_4, &gray_);
+            break;
+        }
+        case FramePixelFormat::RGBA:
+            if (!raw_frame_fits(frame, 4)) return false;
+            cv::cvtColor(cv::Mat(rows, cols, CV_8UC4, data, frame.stride),
+                         gray_, cv::COLOR_RGBA2GRAY);
+            break;
+        case FramePixelFormat::BGR:
+            if (!raw_frame_fits(frame, 3)) return false;
+            cv::cvtColor(cv::Mat(rows, cols, CV_8UC3, data, frame.stride),
+                         gray_, cv::COLOR_BGR2GRAY);
+            break;
+        default:
+            return false;
+    }
+    if (gray_.empty()) {
+        withheld_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    return detect(gray_, now_us);
+}
+
+bool PresenceWatch::check(const cv::Mat& bgr, int64_t now_us) {
+    if (bgr.empty()) return false;
+    cv::cvtColor(bgr, gray_, cv::COLOR_BGR2GRAY);
+    return detect(gray_, now_us);
+}
+
+bool PresenceWatch::detect(const cv::Mat& gray, int64_t now_us) {
+    checks_.fetch_add(1, std::memory_order_relaxed);
+
+    const cv::Mat* input = &gray;
+    if (gray.cols > options_.detect_width && options_.detect_width > 0) {
+        double scale = static_cast<double>(options_.detect_width) / gray.cols;
+        cv::resize(gray, small_, cv::Size(), scale, scale, cv::INTER_AREA);
+        input = &small_;
+    }
+    cv::equalizeHist(*input, small_);
+
+    // A face at desk distance is at least ~1/6 of the frame width
+    int min_face = std::max(16, options_.detect_width / 8);
+    std::vector<cv::Rect> faces;
+    cascade_.detectMultiScale(small_, faces, 1.15, 3, 0, cv::Size(min_face, min_face));
+    if (faces.empty()) {
+        withheld_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    wakeups_.fetch_add(1, std::memory_order_relaxed);
+    woke_at_us_.store(now_us, std::memory_order_relaxed);
+    active_.store(false, std::memory_order_release);
+    last_forward_us_ = now_us;
+    return true;
+}
+
+} // namespace focus_wizard
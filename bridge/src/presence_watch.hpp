@@ -0,0 +1,124 @@
+/**
+ * presence_watch.hpp — Low-power face-presence watch while AWAY
+ *
+ * Users leave their desks for hours, and the full pipeline (dense face
+ * mesh, edge metrics, REST uploads) keeps running on an empty chair. Once
+ * FocusAnalyzer reports AWAY — i.e. no face for face_absence_timeout_s —
+ * the watch takes over the frame stream:
+ *
+ *   - frames stop reaching the SDK, so the graph idles and has nothing to
+ *     upload; one keepalive frame every keepalive_ms keeps it alive
+ *   - every check_ms one frame is decoded small and grayscale and run
+ *     through a Haar cascade (a few ms at 160 px wide)
+ *   - the first positive check ends the watch and that frame goes straight
+ *     to the SDK at full resolution
+ *
+ * After a detection the watch stays off until the analyzer reports a
+ * non-AWAY state (frames already in the graph still say AWAY), or until
+ * rearm_s passes without one — a false positive on an empty chair.
+ *
+ * The SDK has no runtime switch for REST integration or the face mesh;
+ * withholding frames is the lever the bridge has. It applies where the
+ * bridge owns the frames (FrameVideoSource); in local mode the SDK owns the
+ * camera and only paces down to keepalive_ms.
+ *
+ * Threading: update_state() from the edge callback, the rest from the
+ * capture thread. Times are steady-clock microseconds (governor_clock_us).
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include <opencv2/core.hpp>
+#include <opencv2/objdetect.hpp>
+
+#include "focus_analyzer.hpp"
+#include "frame_provider.hpp"
+
+namespace focus_wizard {
+
+struct PresenceWatchOptions {
+    // Haar cascade for frontal faces (ships with OpenCV). Empty, or a file
+    // that fails to load, leaves only the keepalive frames to notice a face.
+    std::string cascade_path = "/usr/share/opencv4/haarcascades/haarcascade_frontalface_default.xml";
+
+    int check_ms = 300;
+    int keepalive_ms = 2000;
+    int detect_width = 160;
+    float rearm_s = 5.0f;
+};
+
+class PresenceWatch {
+public:
+    enum class Action {
+        FORWARD,    // hand the frame to the SDK
+        CHECK,      // run check() on it
+        DROP,
+    };
+
+    explicit PresenceWatch(PresenceWatchOptions options = {});
+
+    /**
+     * Load the cascade. Returns false (with `error`) if it can't be read;
+     * the watch still works, without the cheap detector.
+     */
+    bool load(std::string* error);
+
+    bool active() const { return active_.load(std::memory_order_acquire); }
+
+    // ── Analysis side ────────────────────────────────────
+
+    /**
+     * Feed the analyzer's state for each processed frame. Enters the watch
+     * on AWAY; leaves it on any other state.
+     */
+    void update_state(FocusState state, int64_t now_us);
+
+    // ── Capture side ─────────────────────────────────────
+
+    /**
+     * What to do with the next frame.
+     */
+    Action next(int64_t now_us);
+
+    /**
+     * Run the detector on a received frame (decoding only what it needs).
+     * Returns true if a face was found; the watch has then ended and the
+     * frame should be forwarded.
+     */
+    bool check(const ReceivedFrame& frame, int64_t now_us);
+
+    /**
+     * Same, on an already decoded BGR frame.
+     */
+    bool check(const cv::Mat& bgr, int64_t now_us);
+
+    uint64_t checks() const { return checks_.load(std::memory_order_relaxed); }
+    uint64_t wakeups() const { return wakeups_.load(std::memory_order_relaxed); }
+    uint64_t withheld() const { return withheld_.load(std::memory_order_relaxed); }
+
+private:
+    bool detect(const cv::Mat& gray, int64_t now_us);
+
+    PresenceWatchOptions options_;
+    cv::CascadeClassifier cascade_;
+    bool has_cascade_ = false;
+
+    std::atomic<bool> active_{false};
+    std::atomic<int64_t> woke_at_us_{-1};   // last detection; -1 = none pending
+
+    // Capture side only
+    int64_t last_check_us_ = 0;
+    int64_t last_forward_us_ = 0;
+    cv::Mat gray_;
+    cv::Mat small_;
+
+    std::atomic<uint64_t> checks_{0};
+    std::atomic<uint64_t> wakeups_{0};
+    std::atomic<uint64_t> withheld_{0};
+};
+
+} // namespace focus_wizard
@@ -0,0 +1,81 @@
+/**
+ * publish.cpp — Implementation
+ */
+
+#include "publish.hpp"
+#include "pipeline_metrics.hpp"
+
+namespace focus_wizard {
+
+void publish_core(JsonEmitter& emitter, MetricsCollector& collector,
+                  const presage::physiology::MetricsBuffer& metrics, int64_t timestamp) {
+    pipeline_metrics().add(PipelineCounter::CORE_CALLBACKS);
+    ScopedLatency latency(PipelineHistogram::CORE_CALLBACK);
+    if (!emitter.wants(MessageType::METRICS)) {
+        collector.update_core_metrics(metrics, timestamp);
+    } else if (emitter.format() == OutputFormat::BINARY) {
+        collector.update_core_metrics(metrics, timestamp);
+        emitter.emit_record(MessageType::METRICS, make_snapshot_record(collector.current()));
+    } else {
+        emitter.emit("metrics", collector.process_core_metrics(metrics, timestamp));
+    }
+}
+
+void publish_edge(JsonEmitter& emitter, MetricsCollector& collector,
+                  const presage::physiology::Metrics& metrics, int64_t timestamp) {
+    pipeline_metrics().add(PipelineCounter::EDGE_CALLBACKS);
+    ScopedLatency latency(PipelineHistogram::EDGE_CALLBACK);
+    if (!emitter.wants(MessageType::EDGE)) {
+        collector.update_edge_metrics(metrics, timestamp);
+    } else if (emitter.format() == OutputFormat::BINARY) {
+        collector.update_edge_metrics(metrics, timestamp);
+        emitter.emit_record(MessageType::EDGE, make_snapshot_record(collector.current()));
+    } else {
+        emitter.emit("edge", collector.process_edge_metrics(metrics, timestamp));
+    }
+}
+
+FocusResult publish_focus(JsonEmitter& emitter, FocusAnalyzer& analyzer,
+                          const FocusMetrics& snapshot) {
+    FocusResult result;
+    bool updated;
+    {
+        ScopedLatency latency(PipelineHistogram::ANALYZE);
+        updated = analyzer.update(snapshot, &result);
+    }
+    if (!updated) {
+        return result; // nothing new worth sending
+    }
+
+    if (emitter.wants(MessageType::FOCUS)) {
+        if (emitter.format() == OutputFormat::BINARY) {
+            emitter.emit_record(MessageType::FOCUS,
+                                make_snapshot_record(snapshot,
+                                                     static_cast<uint8_t>(result.state),
+                                                     result.focus_score));
+        } else {
+            emitter.emit("focus", analyzer.build_json(result, snapshot));
+        }
+    }
+
+    // Transitions are rare and low-rate, so both formats carry them as JSON
+    FocusTransition transition;
+    if (analyzer.take_transition(&transition)) {
+        pipeline_metrics().add_transition(transition.to);
+        if (emitter.wants(MessageType::STATE_CHANGED)) {
+            emitter.emit("state_changed", analyzer.build_transition_json(transition));
+        }
+    }
+    return result;
+}
+
+void publish_summary(JsonEmitter& emitter, FocusSummary& summary,
+                     const FocusMetrics& snapshot, const FocusResult& result) {
+    // Edge frame time: timestamp_us is the core batch time, which stays 0
+    // without REST and otherwise only moves at the REST cadence
+    if (summary.add(snapshot, result, snapshot.capture_us)) {
+        emitter.emit("summary", summary.json());
+    }
+}
+
+} // namespace focus_wizard
@@ -0,0 +1,51 @@
+/**
+ * publish.hpp — Callback-to-emitter glue shared by every runner
+ *
+ * The SDK callbacks, replay mode and each multi-session pipeline publish
+ * through these, so the NDJSON/binary decision is made in one place and
+ * JSON is only built when it will be written. Messages the emitter's level
+ * leaves out are never built; the collectors and the analyzer still see
+ * every callback.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include <physiology/modules/messages/metrics.h>
+
+#include "focus_analyzer.hpp"
+#include "focus_summary.hpp"
+#include "json_emitter.hpp"
+#include "metrics_collector.hpp"
+
+namespace focus_wizard {
+
+/**
+ * Fold a core (REST) metrics buffer into `collector` and emit "metrics".
+ */
+void publish_core(JsonEmitter& emitter, MetricsCollector& collector,
+                  const presage::physiology::MetricsBuffer& metrics, int64_t timestamp);
+
+/**
+ * Fold per-frame edge metrics into `collector` and emit "edge".
+ */
+void publish_edge(JsonEmitter& emitter, MetricsCollector& collector,
+                  const presage::physiology::Metrics& metrics, int64_t timestamp);
+
+/**
+ * Run focus analysis on `snapshot`; emits "focus" only when the analyzer
+ * reports something new, followed by "state_changed" when the state did.
+ * Returns the analyzer's latest result either way.
+ */
+FocusResult publish_focus(JsonEmitter& emitter, FocusAnalyzer& analyzer,
+                          const FocusMetrics& snapshot);
+
+/**
+ * Fold an analyzed frame into `summary`, on the edge frame's timestamp;
+ * emits "summary" when the frame closes a window.
+ */
+void publish_summary(JsonEmitter& emitter, FocusSummary& summary,
+                     const FocusMetrics& snapshot, const FocusResult& result);
+
+} // namespace focus_wizard
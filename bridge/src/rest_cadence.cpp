@@ -0,0 +1,179 @@
+/**
+ * rest_cadence.cpp — Implementation
+ */
+
+#include "rest_cadence.hpp"
+#include "pipeline_metrics.hpp"
+
+#include <algorithm>
+
+namespace focus_wizard {
+
+namespace {
+
+int64_t seconds_to_us(float seconds) {
+    return static_cast<int64_t>(std::max(seconds, 0.0f) * 1e6f);
+}
+
+// Newest SDK timestamp among the samples of a batch (0 = none stamped)
+template <typename Series>
+int64_t newest_stamp(const Series& series) {
+    return series.empty() ? 0 : series.rbegin()->timestamp();
+}
+
+} // namespace
+
+const char* rest_cadence_level_to_string(RestCadenceLevel level) {
+    switch (level) {
+        case RestCadenceLevel::BASE:   return "base";
+        case RestCadenceLevel::ALERT:  return "alert";
+        case RestCadenceLevel::STABLE: return "stable";
+        case RestCadenceLevel::IDLE:   return "idle";
+    }
+    return "base";
+}
+
+RestCadence::RestCadence(RestCadenceOptions options, FocusThresholds thresholds)
+    : options_(options)
+    , thresholds_(thresholds)
+    , target_s_(options.base_s)
+    , running_s_(options.base_s)
+{
+}
+
+// ── Edge Callback ────────────────────────────────────────
+
+void RestCadence::set_live_thresholds(const LiveThresholds* live) {
+    live_thresholds_ = live;
+    if (live) {
+        thresholds_version_ = live->version();
+        thresholds_ = live->load();
+    }
+}
+
+void RestCadence::observe(FocusState state, const FocusMetrics& metrics,
+                          int64_t frame_timestamp_us, int64_t now_us) {
+    if (frame_timestamp_us > latest_frame_us_.load(std::memory_order_relaxed)) {
+        latest_frame_us_.store(frame_timestamp_us, std::memory_order_relaxed);
+    }
+    if (!options_.adaptive) return;
+    if (live_thresholds_) {
+        if (uint64_t version = live_thresholds_->version(); version != thresholds_version_) {
+            thresholds_version_ = version;
+            thresholds_ = live_thresholds_->load();
+        }
+    }
+
+    if (!has_state_ || state != state_) {
+        state_ = state;
+        state_since_us_ = now_us;
+        has_state_ = true;
+    }
+
+    bool held = state != FocusState::UNKNOWN &&
+                now_us - state_since_us_ >= seconds_to_us(options_.stable_after_s);
+    RestCadenceLevel next;
+    if (state == FocusState::STRESSED || near_stress(metrics)) {
+        next = RestCadenceLevel::ALERT;
+    } else if (held) {
+        next = state == FocusState::AWAY ? RestCadenceLevel::IDLE : RestCadenceLevel::STABLE;
+    } else {
+        next = RestCadenceLevel::BASE;
+    }
+    level_.store(next, std::memory_order_relaxed);
+
+    float target = duration_for(next);
+    target_s_.store(target, std::memory_order_relaxed);
+
+    // Back to the base duration at once on ALERT; every other change waits
+    // until the last rebuild is old enough
+    float running = running_s_.load(std::memory_order_relaxed);
+    bool pending = target != running &&
+                   (next == RestCadenceLevel::ALERT ||
+                    now_us - last_restart_us_.load(std::memory_order_relaxed) >=
+                        seconds_to_us(options_.min_restart_interval_s));
+    restart_pending_.store(pending, std::memory_order_release);
+}
+
+bool RestCadence::near_stress(const FocusMetrics& metrics) const {
+    bool pulse_near = metrics.has_pulse &&
+                      metrics.pulse_weight >= thresholds_.min_vitals_weight &&
+                      metrics.pulse_rate_bpm >=
+                          options_.stress_fraction * thresholds_.pulse_stressed_threshold;
+    bool breathing_near = metrics.has_breathing &&
+                          metrics.breathing_weight >= thresholds_.min_vitals_weight &&
+                          metrics.breathing_rate_bpm >=
+                              options_.stress_fraction * thresholds_.breathing_stressed_threshold;
+    return pulse_near || breathing_near;
+}
+
+float RestCadence::duration_for(RestCadenceLevel level) const {
+    switch (level) {
+        case RestCadenceLevel::STABLE: return options_.stable_s;
+        case RestCadenceLevel::IDLE:   return options_.idle_s;
+        case RestCadenceLevel::BASE:
+        case RestCadenceLevel::ALERT:  break;
+    }
+    return options_.base_s;
+}
+
+// ── Core Callback ────────────────────────────────────────
+
+void RestCadence::on_batch(const presage::physiology::MetricsBuffer& metrics) {
+    total_requests_.fetch_add(1, std::memory_order_relaxed);
+    ++interval_requests_;
+
+    int64_t sample_us = 0;
+    if (metrics.has_pulse()) {
+        sample_us = std::max(sample_us, newest_stamp(metrics.pulse().rate()));
+        sample_us = std::max(sample_us, newest_stamp(metrics.pulse().trace()));
+    }
+    if (metrics.has_breathing()) {
+        sample_us = std::max(sample_us, newest_stamp(metrics.breathing().rate()));
+    }
+
+    // Batches repeating an earlier one's newest sample add no information
+    // about the round trip
+    int64_t latest_frame_us = latest_frame_us_.load(std::memory_order_relaxed);
+    if (sample_us > last_sample_us_ && latest_frame_us > sample_us) {
+        int64_t rtt_us = latest_frame_us - sample_us;
+        ++interval_rtt_samples_;
+        interval_rtt_sum_us_ += static_cast<double>(rtt_us);
+        interval_rtt_max_us_ = std::max(interval_rtt_max_us_, rtt_us);
+        pipeline_metrics().observe(PipelineHistogram::REST_RTT, rtt_us);
+    }
+    last_sample_us_ = std::max(last_sample_us_, sample_us);
+}
+
+bool RestCadence::take_report(float interval_s, int64_t now_us, RestReport* report) {
+    if (interval_start_us_ == 0) interval_start_us_ = now_us;
+    if (interval_s > 0.0f && now_us - interval_start_us_ < seconds_to_us(interval_s)) {
+        return false;
+    }
+
+    report->requests = interval_requests_;
+    report->interval_s = static_cast<float>(now_us - interval_start_us_) / 1e6f;
+    report->mean_rtt_ms = interval_rtt_samples_ > 0
+        ? static_cast<float>(interval_rtt_sum_us_ / interval_rtt_samples_ / 1000.0)
+        : 0.0f;
+    report->max_rtt_ms = static_cast<float>(interval_rtt_max_us_) / 1000.0f;
+    report->buffer_s = running_s_.load(std::memory_order_relaxed);
+
+    interval_start_us_ = now_us;
+    interval_requests_ = 0;
+    interval_rtt_samples_ = 0;
+    interval_rtt_sum_us_ = 0.0;
+    interval_rtt_max_us_ = 0;
+    return true;
+}
+
+// ── Container Side ───────────────────────────────────────
+
+void RestCadence::restarted(float buffer_s, int64_t now_us) {
+    running_s_.store(buffer_s, std::memory_order_relaxed);
+    last_restart_us_.store(now_us, std::memory_order_relaxed);
+    restart_pending_.store(false, std::memory_order_release);
+    restarts_.fetch_add(1, std::memory_order_relaxed);
+}
+
+} // namespace focus_wizard
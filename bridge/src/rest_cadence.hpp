@@ -0,0 +1,174 @@
+/**
+ * rest_cadence.hpp — REST buffer duration policy and round-trip accounting
+ *
+ * The SDK uploads one REST request per preprocessed_data_buffer_duration_s
+ * of frames: at 0.2 s that is five round trips per second per user. Most
+ * of them are wasted on a user who has been focused for ten minutes or is
+ * not at the desk. The policy picks a buffer duration from the analyzer's
+ * output:
+ *
+ *   ALERT   a vital within stress_fraction of its stress threshold, or
+ *           STRESSED: base_s (the --rest_buffer_duration_s value)
+ *   STABLE  the same non-UNKNOWN state for stable_after_s: stable_s
+ *   IDLE    AWAY for stable_after_s: idle_s
+ *   BASE    anything else: base_s
+ *
+ * The SDK reads the duration only when a container is built, so a new
+ * target is applied by rebuilding it (restart_pending()), which reopens
+ * the camera and costs a second or so of frames. ALERT is applied at
+ * once; any other change waits until min_restart_interval_s after the
+ * last rebuild, so a flapping state doesn't thrash the camera and graph.
+ *
+ * Every core callback is one REST response. on_batch() counts them and
+ * estimates the round trip as the age of the batch's newest sample
+ * against the newest frame seen — both SDK timestamps, so no clock has to
+ * be shared with the SDK. take_report() hands out per-interval totals.
+ *
+ * The stress thresholds can follow LiveThresholds (set_live_thresholds()).
+ *
+ * Threading: observe() from the edge callback, on_batch()/take_report()
+ * from the core callback, restart_pending() from the video callback; the
+ * shared values are atomics. Times are passed in (microseconds).
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "focus_analyzer.hpp"
+#include "metrics_collector.hpp"
+
+// SmartSpectra / Physiology headers
+#include <physiology/modules/messages/metrics.h>
+
+namespace focus_wizard {
+
+enum class RestCadenceLevel : uint8_t {
+    BASE   = 0,
+    ALERT  = 1,
+    STABLE = 2,
+    IDLE   = 3,
+};
+
+const char* rest_cadence_level_to_string(RestCadenceLevel level);
+
+struct RestCadenceOptions {
+    // What the container is built with, and the duration while ALERT
+    float base_s = 0.2f;
+
+    // Pick a duration from the focus state; false = base_s throughout
+    bool adaptive = false;
+
+    float stable_s = 1.0f;
+    float stable_after_s = 120.0f;
+    float idle_s = 2.0f;
+
+    // ALERT once a usable vital reaches this fraction of its stress
+    // threshold (FocusThresholds)
+    float stress_fraction = 0.9f;
+
+    // Minimum time between a rebuild and the next lengthening one
+    float min_restart_interval_s = 60.0f;
+};
+
+/**
+ * REST traffic over one reporting interval.
+ */
+struct RestReport {
+    uint64_t requests = 0;
+    float interval_s = 0.0f;
+    float mean_rtt_ms = 0.0f;    // 0 without a sample
+    float max_rtt_ms = 0.0f;
+    float buffer_s = 0.0f;       // duration the container is running with
+};
+
+class RestCadence {
+public:
+    RestCadence(RestCadenceOptions options, FocusThresholds thresholds);
+
+    // ── Edge callback ────────────────────────────────────
+
+    /**
+     * Feed the newest frame and the analyzer's output for it.
+     */
+    void observe(FocusState state, const FocusMetrics& metrics,
+                 int64_t frame_timestamp_us, int64_t now_us);
+
+    /**
+     * Follow `live` for the stress thresholds; call before the first
+     * observe(). `live` must outlive the cadence.
+     */
+    void set_live_thresholds(const LiveThresholds* live);
+
+    // ── Core callback ────────────────────────────────────
+
+    /**
+     * Count one REST response.
+     */
+    void on_batch(const presage::physiology::MetricsBuffer& metrics);
+
+    /**
+     * Once `interval_s` has passed since the previous report (or start),
+     * fill `report` with the traffic since then and start a new interval.
+     * interval_s <= 0 always reports.
+     */
+    bool take_report(float interval_s, int64_t now_us, RestReport* report);
+
+    // ── Container side ───────────────────────────────────
+
+    /**
+     * True when the policy wants a duration other than the running one;
+     * stop the container and rebuild it with target_s().
+     */
+    bool restart_pending() const { return restart_pending_.load(std::memory_order_acquire); }
+
+    float target_s() const { return target_s_.load(std::memory_order_relaxed); }
+    float running_s() const { return running_s_.load(std::memory_order_relaxed); }
+    RestCadenceLevel level() const { return level_.load(std::memory_order_relaxed); }
+
+    /**
+     * The container has been rebuilt with `buffer_s` (read from target_s()
+     * before building it).
+     */
+    void restarted(float buffer_s, int64_t now_us);
+
+    uint64_t requests() const { return total_requests_.load(std::memory_order_relaxed); }
+    uint64_t restarts() const { return restarts_.load(std::memory_order_relaxed); }
+
+private:
+    bool near_stress(const FocusMetrics& metrics) const;
+    float duration_for(RestCadenceLevel level) const;
+
+    const RestCadenceOptions options_;
+
+    // Edge callback only
+    FocusThresholds thresholds_;
+    const LiveThresholds* live_thresholds_ = nullptr;
+    uint64_t thresholds_version_ = 0;
+
+    // Shared
+    std::atomic<RestCadenceLevel> level_{RestCadenceLevel::BASE};
+    std::atomic<float> target_s_;
+    std::atomic<float> running_s_;
+    std::atomic<bool> restart_pending_{false};
+    std::atomic<int64_t> last_restart_us_{0};
+    std::atomic<int64_t> latest_frame_us_{0};
+    std::atomic<uint64_t> total_requests_{0};
+    std::atomic<uint64_t> restarts_{0};
+
+    // Edge callback only
+    FocusState state_ = FocusState::UNKNOWN;
+    int64_t state_since_us_ = 0;
+    bool has_state_ = false;
+
+    // Core callback only
+    int64_t interval_start_us_ = 0;
+    uint64_t interval_requests_ = 0;
+    uint64_t interval_rtt_samples_ = 0;
+    double interval_rtt_sum_us_ = 0.0;
+    int64_t interval_rtt_max_us_ = 0;
+    int64_t last_sample_us_ = 0;
+};
+
+} // namespace focus_wizard
@@ -0,0 +1,74 @@
+/**
+ * seqlock.hpp — Single-writer, wait-free-reader snapshot cell
+ *
+ * The writer bumps a sequence counter to odd, stores the value, and bumps
+ * it back to even; readers copy the value and retry if the counter moved
+ * or was odd. The writer never waits and readers never block it, which is
+ * what we want between the per-frame edge path and everything else.
+ *
+ * The payload lives in relaxed std::atomic words rather than a plain T, so
+ * a reader racing a writer is well-defined (it just retries) instead of a
+ * data race. T must be trivially copyable.
+ *
+ * Exactly one thread may call store() at a time.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace focus_wizard {
+
+template <typename T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "SeqLock payload must be trivially copyable");
+
+public:
+    SeqLock() { store(T{}); }
+
+    explicit SeqLock(const T& initial) { store(initial); }
+
+    SeqLock(const SeqLock&) = delete;
+    SeqLock& operator=(const SeqLock&) = delete;
+
+    void store(const T& value) {
+        uint64_t words[kWords] = {};
+        std::memcpy(words, &value, sizeof(T));
+
+        uint64_t seq = sequence_.load(std::memory_order_relaxed);
+        sequence_.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < kWords; ++i) {
+            words_[i].store(words[i], std::memory_order_relaxed);
+        }
+        sequence_.store(seq + 2, std::memory_order_release);
+    }
+
+    T load() const {
+        uint64_t words[kWords];
+        for (;;) {
+            uint64_t before = sequence_.load(std::memory_order_acquire);
+            if (before & 1) continue; // write in progress
+            for (size_t i = 0; i < kWords; ++i) {
+                words[i] = words_[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence_.load(std::memory_order_relaxed) == before) break;
+        }
+        T value;
+        std::memcpy(&value, words, sizeof(T));
+        return value;
+    }
+
+private:
+    static constexpr size_t kWords = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    std::atomic<uint64_t> sequence_{0};
+    std::atomic<uint64_t> words_[kWords];
+};
+
+} // namespace focus_wizard
@@ -0,0 +1,163 @@
+/**
+ * session_host.cpp — Implementation
+ */
+
+#include "session_host.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "frame_video_source.hpp"
+
+namespace focus_wizard {
+
+// How often run() re-checks the shutdown flag
+static constexpr int kPollIntervalMs = 100;
+
+struct SessionHost::Session {
+    Session(NetChannel& channel, uint64_t generation, const SessionHostOptions& options)
+        : channel(channel)
+        , generation(generation)
+        , pipeline(options, 0,
+                   [&channel, generation](MessageType type, const char* data, size_t length) {
+                       channel.send_to(generation, type, data, length);
+                   })
+    {
+        if (options.governor) {
+            governor = std::make_unique<FrameGovernor>(options.governor_options);
+        }
+        if (options.presence_watch) {
+            watch = std::make_unique<PresenceWatch>(options.presence_options);
+            std::string error;
+            watch->load(&error); // without a detector, keepalive frames still wake it
+        }
+    }
+
+    NetChannel& channel;
+    const uint64_t generation;
+
+    volatile std::sig_atomic_t stop = 0;
+    std::atomic<bool> finished{false};
+    std::thread thread;
+
+    TrackPipeline pipeline;
+    std::unique_ptr<FrameGovernor> governor;
+    std::unique_ptr<PresenceWatch> watch;
+};
+
+SessionHost::SessionHost(NetIngestServer& server, const BridgeSettings& settings,
+                         const SessionHostOptions& options, JsonEmitter& log)
+    : server_(server)
+    , settings_(settings)
+    , options_(options)
+    , log_(log)
+{
+    server_.set_connection_callback([this](size_t channel, bool connected) {
+        {
+            std::lock_guard<std::mutex> lock(events_mutex_);
+            events_.push_back({channel, server_.channel(channel).generation(), connected});
+        }
+        events_cv_.notify_one();
+    });
+}
+
+SessionHost::~SessionHost() {
+    for (size_t i = 0; i < sessions_.size(); ++i) {
+        stop_session(i);
+    }
+}
+
+void SessionHost::run(const volatile std::sig_atomic_t* shutdown) {
+    sessions_.resize(server_.channel_count());
+    std::vector<ConnectionEvent> pending;
+
+    while (!*shutdown) {
+        {
+            std::unique_lock<std::mutex> lock(events_mutex_);
+            events_cv_.wait_for(lock, std::chrono::milliseconds(kPollIntervalMs),
+                                [this] { return !events_.empty(); });
+            pending.swap(events_);
+        }
+
+        for (const ConnectionEvent& event : pending) {
+            Session* current = sessions_[event.channel].get();
+            if (event.connected) {
+                start_session(event.channel, event.generation);
+            } else if (current && current->generation == event.generation) {
+                stop_session(event.channel);
+            }
+        }
+        pending.clear();
+
+        // Reap sessions whose pipeline ended on its own (e.g. init failure)
+        for (size_t i = 0; i < sessions_.size(); ++i) {
+            if (sessions_[i] && sessions_[i]->finished.load(std::memory_order_acquire)) {
+                stop_session(i);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < sessions_.size(); ++i) {
+        stop_session(i);
+    }
+}
+
+void SessionHost::start_session(size_t channel, uint64_t generation) {
+    // The channel's previous session must be gone before the new client's
+    // frames start arriving on it
+    stop_session(channel);
+
+    auto session = std::make_unique<Session>(server_.channel(channel), generation, options_);
+    Session* raw = session.get();
+    sessions_[channel] = std::move(session);
+    raw->thread = std::thread([this, raw] { run_session(*raw); });
+    ++started_;
+
+    log_.emit_status("Session " + std::to_string(channel) + " started");
+}
+
+void SessionHost::stop_session(size_t channel) {
+    std::unique_ptr<Session>& session = sessions_[channel];
+    if (!session) return;
+
+    session->stop = 1;
+    if (session->thread.joinable()) {
+        session->thread.join();
+    }
+    session.reset();
+
+    log_.emit_status("Session " + std::to_string(channel) + " ended");
+}
+
+void SessionHost::run_session(Session& session) {
+    TrackPipelineHooks hooks;
+    hooks.make_source = [this, &session]()
+            -> std::unique_ptr<presage::smartspectra::video_source::VideoSource> {
+        auto source = std::make_unique<FrameVideoSource>(
+            session.channel, options_.capture_width, options_.capture_height, &session.stop);
+        source->set_governor(session.governor.get());
+        source->set_presence_watch(session.watch.get());
+        return source;
+    };
+    if (session.governor || session.watch) {
+        hooks.after_frame = [&session](const FocusMetrics& snapshot, int64_t timestamp) {
+            FocusState state = session.pipeline.analyzer.current_state();
+            int64_t now = governor_clock_us();
+            if (session.governor) {
+                session.governor->frame_processed(timestamp, now);
+                session.governor->observe(state, snapshot.face_detected, now);
+            }
+            if (session.watch) {
+                session.watch->update_state(state, now);
+            }
+        };
+    }
+    hooks.stop = &session.stop;
+
+    run_track_pipeline(session.pipeline, settings_, options_.backend, hooks);
+    session.finished.store(true, std::memory_order_release);
+}
+
+} // namespace focus_wizard
@@ -0,0 +1,108 @@
+/**
+ * session_host.hpp — Many users' pipelines in one process (--mode=multi)
+ *
+ * One bridge container per user reloads the MediaPipe graph, the runtime
+ * and every shared library for each user. --mode=multi serves up to
+ * --max_sessions clients from a single process instead: each connection
+ * to the ingest server gets its own session — a TrackPipeline
+ * (track_pipeline.hpp) fed from that connection — whose output goes back
+ * on that connection only.
+ *
+ * Sessions share the process (code, runtime, model files mapped once in
+ * the page cache) and the ingest server's single epoll I/O thread. The SDK
+ * offers no way to share one graph instance between containers, so each
+ * session still builds its own graph and runs it on its own thread (the
+ * container's Run() blocks for the session's lifetime).
+ *
+ * A session starts when its client connects and is torn down when the
+ * client disconnects or the process is asked to shut down.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <csignal>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <smartspectra/container/settings.hpp>
+
+#include "bridge_container.hpp"
+#include "frame_governor.hpp"
+#include "json_emitter.hpp"
+#include "net_ingest_server.hpp"
+#include "presence_watch.hpp"
+#include "track_pipeline.hpp"
+
+namespace focus_wizard {
+
+struct SessionHostOptions : TrackPipelineOptions {
+    // Reported by each session's video source until its first frame
+    int capture_width = 1280;
+    int capture_height = 720;
+
+    // Give every session its own frame governor
+    bool governor = false;
+    FrameGovernorOptions governor_options;
+
+    // ... and its own presence watch
+    bool presence_watch = false;
+    PresenceWatchOptions presence_options;
+};
+
+class SessionHost {
+public:
+    /**
+     * Installs the server's connection callback, so construct before
+     * `server.start()`. Host-level status (sessions opening and closing)
+     * goes to `log`.
+     */
+    SessionHost(NetIngestServer& server, const BridgeSettings& settings,
+                const SessionHostOptions& options, JsonEmitter& log);
+    ~SessionHost();
+
+    SessionHost(const SessionHost&) = delete;
+    SessionHost& operator=(const SessionHost&) = delete;
+
+    /**
+     * Start and stop sessions as clients come and go, until `*shutdown` is
+     * set. Returns after every session has been joined.
+     */
+    void run(const volatile std::sig_atomic_t* shutdown);
+
+    /**
+     * Sessions started so far.
+     */
+    uint64_t sessions_started() const { return started_; }
+
+private:
+    struct Session;
+
+    struct ConnectionEvent {
+        size_t channel;
+        uint64_t generation;
+        bool connected;
+    };
+
+    void start_session(size_t channel, uint64_t generation);
+    void stop_session(size_t channel);
+    void run_session(Session& session);
+
+    NetIngestServer& server_;
+    BridgeSettings settings_;
+    SessionHostOptions options_;
+    JsonEmitter& log_;
+
+    // Filled by the server's I/O thread, drained by run()
+    std::mutex events_mutex_;
+    std::condition_variable events_cv_;
+    std::vector<ConnectionEvent> events_;
+
+    std::vector<std::unique_ptr<Session>> sessions_;  // indexed by channel
+    uint64_t started_ = 0;
+};
+
+} // namespace focus_wizard
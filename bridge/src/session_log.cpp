@@ -0,0 +1,191 @@
+/**
+ * session_log.cpp — Implementation
+ */
+
+#include "session_log.hpp"
+
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace focus_wizard {
+
+// ── Encoding ─────────────────────────────────────────────
+
+void append_session_header(std::string& out) {
+    SessionFileHeader header{};
+    std::memcpy(header.magic, kSessionLogMagic, sizeof(header.magic));
+    header.version = kSessionLogVersion;
+    out.append(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+void append_session_record(std::string& out, SessionRecordKind kind,
+                           int64_t timestamp_us, const void* payload, uint32_t length) {
+    SessionRecordHeader header{};
+    header.length = length;
+    header.kind = static_cast<uint8_t>(kind);
+    header.timestamp_us = timestamp_us;
+    out.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.append(static_cast<const char*>(payload), length);
+}
+
+void append_session_index(std::string& out, uint64_t index_offset,
+                          const SessionIndexEntry* entries, size_t count) {
+    append_session_record(out, SessionRecordKind::INDEX, 0, entries,
+                          static_cast<uint32_t>(count * sizeof(SessionIndexEntry)));
+    append_session_record(out, SessionRecordKind::INDEX_TRAILER, 0,
+                          &index_offset, sizeof(index_offset));
+}
+
+// ── SessionLogView ───────────────────────────────────────
+
+SessionLogView::SessionLogView(const uint8_t* data, size_t size)
+    : data_(data)
+    , size_(size)
+{
+    SessionFileHeader header;
+    if (size_ < sizeof(header)) return;
+    std::memcpy(&header, data_, sizeof(header));
+    valid_ = std::memcmp(header.magic, kSessionLogMagic, sizeof(header.magic)) == 0 &&
+             header.version == kSessionLogVersion;
+    offset_ = sizeof(header);
+    end_ = size_;
+    if (valid_) load_index();
+}
+
+void SessionLogView::load_index() {
+    if (size_ < sizeof(SessionFileHeader) + kSessionTrailerSize) return;
+
+    size_t trailer_offset = size_ - kSessionTrailerSize;
+    SessionRecordHeader trailer;
+    std::memcpy(&trailer, data_ + trailer_offset, sizeof(trailer));
+    if (trailer.kind != static_cast<uint8_t>(SessionRecordKind::INDEX_TRAILER) ||
+        trailer.length != sizeof(uint64_t)) {
+        return; // not closed cleanly — no index
+    }
+
+    uint64_t index_offset;
+    std::memcpy(&index_offset, data_ + trailer_offset + sizeof(trailer), sizeof(index_offset));
+    if (index_offset < sizeof(SessionFileHeader) ||
+        index_offset + sizeof(SessionRecordHeader) > trailer_offset) {
+        return;
+    }
+
+    SessionRecordHeader index;
+    std::memcpy(&index, data_ + index_offset, sizeof(index));
+    if (index.kind != static_cast<uint8_t>(SessionRecordKind::INDEX) ||
+        index_offset + sizeof(index) + index.length != trailer_offset ||
+        index.length % sizeof(SessionIndexEntry) != 0) {
+        return;
+    }
+
+    index_ = data_ + index_offset + sizeof(index);
+    index_count_ = index.length / sizeof(SessionIndexEntry);
+    end_ = static_cast<size_t>(index_offset);
+}
+
+void SessionLogView::index_entry(size_t i, SessionIndexEntry* entry) const {
+    std::memcpy(entry, index_ + i * sizeof(SessionIndexEntry), sizeof(*entry));
+}
+
+bool SessionLogView::next(SessionRecord* record) {
+    if (!valid_) return false;
+
+    while (offset_ + sizeof(SessionRecordHeader) <= end_) {
+        SessionRecordHeader header;
+        std::memcpy(&header, data_ + offset_, sizeof(header));
+
+        size_t payload_offset = offset_ + sizeof(header);
+        if (header.length > end_ - payload_offset) {
+            truncated_ = true;
+            offset_ = end_;
+            return false;
+        }
+        offset_ = payload_offset + header.length;
+
+        auto kind = static_cast<SessionRecordKind>(header.kind);
+        if (kind != SessionRecordKind::CORE && kind != SessionRecordKind::EDGE) {
+            continue; // index, or written by a newer bridge — skip
+        }
+
+        record->kind = kind;
+        record->timestamp_us = header.timestamp_us;
+        record->data = data_ + payload_offset;
+        record->size = header.length;
+        return true;
+    }
+
+    if (offset_ < end_) truncated_ = true;
+    offset_ = end_;
+    return false;
+}
+
+void SessionLogView::rewind() {
+    offset_ = sizeof(SessionFileHeader);
+    truncated_ = false;
+}
+
+// ── MappedSessionLog ─────────────────────────────────────
+
+MappedSessionLog::~MappedSessionLog() {
+    close();
+}
+
+bool MappedSessionLog::open(const std::string& path, std::string* error) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        *error = "open " + path + ": " + std::strerror(errno);
+        return false;
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        *error = "stat " + path + ": " + std::strerror(errno);
+        ::close(fd);
+        return false;
+    }
+
+    size_t size = static_cast<size_t>(st.st_size);
+    if (size < sizeof(SessionFileHeader)) {
+        *error = path + ": too short to be a session log";
+        ::close(fd);
+        return false;
+    }
+
+    void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        *error = "mmap " + path + ": " + std::strerror(errno);
+        return false;
+    }
+
+    data_ = static_cast<const uint8_t*>(mapped);
+    size_ = size;
+
+    if (!view().valid()) {
+        *error = path + ": not a session log (bad magic or version)";
+        close();
+        return false;
+    }
+    return true;
+}
+
+SessionLogView MappedSessionLog::view() const {
+    return SessionLogView(data_, size_);
+}
+
+void MappedSessionLog::close() {
+    if (data_) {
+        ::munmap(const_cast<uint8_t*>(data_), size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+}
+
+} // namespace focus_wizard
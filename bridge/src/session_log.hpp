@@ -0,0 +1,187 @@
+/**
+ * session_log.hpp — On-disk log of raw SmartSpectra callbacks
+ *
+ * A session log is the sequence of Metrics / MetricsBuffer protobufs the
+ * bridge received, each with the SDK timestamp it arrived with, so a real
+ * session can be replayed through the pipeline offline (benchmarks,
+ * reproducing field issues).
+ *
+ * Layout (little-endian, no padding):
+ *
+ *   SessionFileHeader                      "FWSL", version
+ *   { SessionRecordHeader, payload }...    payload = serialized protobuf
+ *   INDEX record                           SessionIndexEntry[]      (optional)
+ *   INDEX_TRAILER record                   u64 offset of INDEX      (optional)
+ *
+ * Records are length-prefixed and append-only. The index is written when
+ * a recorder closes cleanly; it sits at a fixed distance from the end of
+ * the file, so a reader finds it without scanning. Readers skip record
+ * kinds they don't know, and stop cleanly at a truncated tail (a session
+ * cut short by a crash has no index but is still readable up to the last
+ * complete record).
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace focus_wizard {
+
+constexpr char     kSessionLogMagic[4]     = {'F', 'W', 'S', 'L'};
+constexpr uint16_t kSessionLogVersion      = 1;
+
+enum class SessionRecordKind : uint8_t {
+    CORE          = 1,  // presage::physiology::MetricsBuffer (OnCoreMetricsOutput)
+    EDGE          = 2,  // presage::physiology::Metrics       (OnEdgeMetricsOutput)
+    INDEX         = 3,  // SessionIndexEntry per CORE/EDGE record
+    INDEX_TRAILER = 4,  // uint64_t file offset of the INDEX record
+};
+
+#pragma pack(push, 1)
+struct SessionFileHeader {
+    char     magic[4];
+    uint16_t version;
+    uint16_t reserved;
+};
+
+struct SessionRecordHeader {
+    uint32_t length;         // payload bytes following this header
+    uint8_t  kind;           // SessionRecordKind
+    uint8_t  reserved[3];
+    int64_t  timestamp_us;   // SDK callback timestamp
+};
+
+struct SessionIndexEntry {
+    uint64_t offset;         // file offset of the record header
+    int64_t  timestamp_us;
+    uint8_t  kind;
+    uint8_t  reserved[7];
+};
+#pragma pack(pop)
+
+static_assert(sizeof(SessionFileHeader) == 8, "file header layout is part of the format");
+static_assert(sizeof(SessionRecordHeader) == 16, "record header layout is part of the format");
+static_assert(sizeof(SessionIndexEntry) == 24, "index entry layout is part of the format");
+
+// Size of the INDEX_TRAILER record that ends an indexed log
+constexpr size_t kSessionTrailerSize = sizeof(SessionRecordHeader) + sizeof(uint64_t);
+
+/**
+ * One record as seen by a reader. `data` points into the log's memory.
+ */
+struct SessionRecord {
+    SessionRecordKind kind;
+    int64_t timestamp_us;
+    const uint8_t* data;
+    uint32_t size;
+};
+
+// ── Encoding ─────────────────────────────────────────────
+
+/**
+ * Append the file header to `out`.
+ */
+void append_session_header(std::string& out);
+
+/**
+ * Append one record (header + payload) to `out`.
+ */
+void append_session_record(std::string& out, SessionRecordKind kind,
+                           int64_t timestamp_us, const void* payload, uint32_t length);
+
+/**
+ * Append the INDEX and INDEX_TRAILER records for `entries` to `out`,
+ * where `index_offset` is the file offset `out` will start at.
+ */
+void append_session_index(std::string& out, uint64_t index_offset,
+                          const SessionIndexEntry* entries, size_t count);
+
+// ── Reading ──────────────────────────────────────────────
+
+/**
+ * Non-owning cursor over a session log in memory.
+ */
+class SessionLogView {
+public:
+    SessionLogView() = default;
+    SessionLogView(const uint8_t* data, size_t size);
+
+    /**
+     * True if the buffer starts with a header this build understands.
+     */
+    bool valid() const { return valid_; }
+
+    /**
+     * Advance to the next known record. Returns false at the end of the
+     * log (or at a truncated tail, see truncated()).
+     */
+    bool next(SessionRecord* record);
+
+    /**
+     * Restart iteration from the first record.
+     */
+    void rewind();
+
+    /**
+     * True once next() hit a record that runs past the end of the buffer.
+     */
+    bool truncated() const { return truncated_; }
+
+    /**
+     * True if the log ends with a valid index.
+     */
+    bool has_index() const { return index_count_ > 0; }
+
+    size_t index_size() const { return index_count_; }
+
+    /**
+     * Copy index entry `i` (< index_size()) into `entry`. Entries are in
+     * file (arrival) order, which is not timestamp order: core batches
+     * arrive after the edge frames they cover.
+     */
+    void index_entry(size_t i, SessionIndexEntry* entry) const;
+
+private:
+    void load_index();
+
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+    size_t end_ = 0;        // end of CORE/EDGE records (start of index)
+    size_t offset_ = 0;
+    bool valid_ = false;
+    bool truncated_ = false;
+
+    const uint8_t* index_ = nullptr;
+    size_t index_count_ = 0;
+};
+
+/**
+ * Read-only memory mapping of a session log file.
+ */
+class MappedSessionLog {
+public:
+    MappedSessionLog() = default;
+    ~MappedSessionLog();
+
+    MappedSessionLog(const MappedSessionLog&) = delete;
+    MappedSessionLog& operator=(const MappedSessionLog&) = delete;
+
+    /**
+     * Map `path`. On failure returns false and describes why in `error`.
+     */
+    bool open(const std::string& path, std::string* error);
+
+    SessionLogView view() const;
+
+    size_t size() const { return size_; }
+
+private:
+    void close();
+
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+} // namespace focus_wizard
@@ -0,0 +1,174 @@
+/**
+ * session_recorder.cpp — Implementation
+ */
+
+#include "session_recorder.hpp"
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <limits>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace focus_wizard {
+
+SessionRecorder::SessionRecorder(SessionRecorderOptions options)
+    : options_(options)
+    , queue_(options.queue_capacity)
+{
+    // Reserve every cell's buffer now so recording never allocates on the
+    // callback thread (unless a message outgrows its cell).
+    for (size_t i = 0; i < queue_.capacity(); ++i) {
+        queue_.try_push([&](Cell& cell) { cell.bytes.reserve(options_.cell_bytes); });
+    }
+    while (queue_.try_pop([](Cell&) {})) {
+    }
+
+    out_buffer_.reserve(options_.flush_bytes * 2);
+}
+
+SessionRecorder::~SessionRecorder() {
+    close();
+}
+
+bool SessionRecorder::open(const std::string& path, std::string* error) {
+    if (fd_ >= 0) {
+        *error = "recorder already open";
+        return false;
+    }
+
+    fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        *error = "open " + path + ": " + std::strerror(errno);
+        return false;
+    }
+
+    append_session_header(out_buffer_);
+    file_offset_ = out_buffer_.size();
+    index_.reserve(64 * 1024);
+
+    stopping_.store(false, std::memory_order_relaxed);
+    thread_ = std::thread([this] { run(); });
+    return true;
+}
+
+void SessionRecorder::close() {
+    if (fd_ < 0) return;
+
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        stopping_.store(true, std::memory_order_release);
+    }
+    wake_cv_.notify_one();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+
+    // The writer thread has drained the queue; finish with the index
+    append_session_index(out_buffer_, file_offset_, index_.data(), index_.size());
+    flush();
+
+    ::close(fd_);
+    fd_ = -1;
+    index_.clear();
+}
+
+bool SessionRecorder::record_core(const presage::physiology::MetricsBuffer& metrics,
+                                  int64_t timestamp_us) {
+    return record(SessionRecordKind::CORE, metrics, timestamp_us);
+}
+
+bool SessionRecorder::record_edge(const presage::physiology::Metrics& metrics,
+                                  int64_t timestamp_us) {
+    return record(SessionRecordKind::EDGE, metrics, timestamp_us);
+}
+
+template <typename Message>
+bool SessionRecorder::record(SessionRecordKind kind, const Message& metrics,
+                             int64_t timestamp_us) {
+    size_t size = metrics.ByteSizeLong();
+    if (size > std::numeric_limits<uint32_t>::max()) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    bool queued = queue_.try_push([&](Cell& cell) {
+        cell.kind = kind;
+        cell.timestamp_us = timestamp_us;
+        cell.bytes.resize(size);
+        metrics.SerializeToArray(&cell.bytes[0], static_cast<int>(size));
+    });
+    if (!queued) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return queued;
+}
+
+void SessionRecorder::run() {
+    using clock = std::chrono::steady_clock;
+    const auto interval = std::chrono::milliseconds(options_.flush_interval_ms);
+    auto last_flush = clock::now();
+
+    for (;;) {
+        bool stopping = stopping_.load(std::memory_order_acquire);
+        size_t count = 0;
+        while (queue_.try_pop([&](Cell& cell) {
+            SessionIndexEntry entry{};
+            entry.offset = file_offset_;
+            entry.timestamp_us = cell.timestamp_us;
+            entry.kind = static_cast<uint8_t>(cell.kind);
+            index_.push_back(entry);
+
+            // Copy rather than swap so the cell keeps its reserved buffer
+            size_t before = out_buffer_.size();
+            append_session_record(out_buffer_, cell.kind, cell.timestamp_us,
+                                  cell.bytes.data(), static_cast<uint32_t>(cell.bytes.size()));
+            file_offset_ += out_buffer_.size() - before;
+        })) {
+            ++count;
+        }
+        recorded_.fetch_add(count, std::memory_order_relaxed);
+
+        if (!out_buffer_.empty() &&
+            (stopping ||
+             out_buffer_.size() >= options_.flush_bytes ||
+             clock::now() - last_flush >= interval)) {
+            flush();
+            last_flush = clock::now();
+        }
+
+        if (stopping && count == 0) {
+            break;
+        }
+
+        if (count == 0) {
+            std::unique_lock<std::mutex> lock(wake_mutex_);
+            wake_cv_.wait_for(lock, interval, [this] {
+                return stopping_.load(std::memory_order_acquire);
+            });
+        }
+    }
+}
+
+void SessionRecorder::flush() {
+    const char* data = out_buffer_.data();
+    size_t length = out_buffer_.size();
+
+    while (length > 0 && !output_broken_) {
+        ssize_t written = ::write(fd_, data, length);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            // Disk full etc. — stop writing but keep the pipeline running
+            output_broken_ = true;
+            break;
+        }
+        data += written;
+        length -= static_cast<size_t>(written);
+    }
+
+    out_buffer_.clear();
+}
+
+} // namespace focus_wizard
@@ -0,0 +1,116 @@
+/**
+ * session_recorder.hpp — Records SDK callbacks to a session log
+ *
+ * record_core() / record_edge() run on the SmartSpectra callback threads.
+ * They serialize the protobuf straight into a queue cell whose buffer was
+ * reserved at construction, and return; a dedicated thread appends the
+ * records to the file in large writes and builds the index, which is
+ * written when the recorder closes (see session_log.hpp for the format).
+ *
+ * Recording never blocks a callback. If the disk can't keep up and the
+ * queue fills, records are dropped and counted rather than stalling the
+ * pipeline — a partial recording is better than a late frame.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <physiology/modules/messages/metrics.h>
+
+#include "bounded_mpsc_queue.hpp"
+#include "session_log.hpp"
+
+namespace focus_wizard {
+
+struct SessionRecorderOptions {
+    // Queue cells (rounded up to a power of two)
+    size_t queue_capacity = 256;
+
+    // Bytes reserved per cell; a dense-mesh edge frame is ~10 KB
+    size_t cell_bytes = 32 * 1024;
+
+    // Write once this many bytes are buffered, or after flush_interval_ms
+    size_t flush_bytes = 256 * 1024;
+    int flush_interval_ms = 200;
+};
+
+class SessionRecorder {
+public:
+    explicit SessionRecorder(SessionRecorderOptions options = {});
+
+    /**
+     * Writes the index and closes the file if still open.
+     */
+    ~SessionRecorder();
+
+    SessionRecorder(const SessionRecorder&) = delete;
+    SessionRecorder& operator=(const SessionRecorder&) = delete;
+
+    /**
+     * Create (truncate) `path` and start the writer thread.
+     * On failure returns false and describes why in `error`.
+     */
+    bool open(const std::string& path, std::string* error);
+
+    /**
+     * Drain the queue, write the index and close the file.
+     * Call once the callbacks have stopped firing.
+     */
+    void close();
+
+    /**
+     * Queue one callback. Never blocks; returns false if dropped.
+     */
+    bool record_core(const presage::physiology::MetricsBuffer& metrics, int64_t timestamp_us);
+    bool record_edge(const presage::physiology::Metrics& metrics, int64_t timestamp_us);
+
+    /**
+     * Records refused because the queue was full.
+     */
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+    /**
+     * Records written so far.
+     */
+    uint64_t recorded() const { return recorded_.load(std::memory_order_relaxed); }
+
+private:
+    struct Cell {
+        SessionRecordKind kind = SessionRecordKind::EDGE;
+        int64_t timestamp_us = 0;
+        std::string bytes;
+    };
+
+    template <typename Message>
+    bool record(SessionRecordKind kind, const Message& metrics, int64_t timestamp_us);
+
+    void run();
+    void flush();
+
+    const SessionRecorderOptions options_;
+    BoundedMpscQueue<Cell> queue_;
+
+    int fd_ = -1;
+    uint64_t file_offset_ = 0;
+    std::string out_buffer_;
+    std::vector<SessionIndexEntry> index_;
+    bool output_broken_ = false;
+
+    std::atomic<bool> stopping_{false};
+    std::mutex wake_mutex_;
+    std::condition_variable wake_cv_;
+
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> recorded_{0};
+
+    std::thread thread_;
+};
+
+} // namespace focus_wizard
@@ -0,0 +1,55 @@
+/**
+ * signal_filter.cpp — Implementation
+ */
+
+#include "signal_filter.hpp"
+
+#include <cmath>
+
+namespace focus_wizard {
+
+namespace {
+
+constexpr float kTwoPi = 6.28318530718f;
+
+// Smoothing factor of a first-order low-pass with `cutoff_hz` over `dt_s`
+float low_pass_alpha(float cutoff_hz, float dt_s) {
+    float tau = 1.0f / (kTwoPi * cutoff_hz);
+    return 1.0f / (1.0f + tau / dt_s);
+}
+
+} // namespace
+
+float EmaFilter::filter(float value, float dt_s) {
+    if (!initialized_ || time_constant_s_ <= 0.0f) {
+        value_ = value;
+        initialized_ = true;
+        return value_;
+    }
+    if (dt_s > 0.0f) {
+        float alpha = 1.0f - std::exp(-dt_s / time_constant_s_);
+        value_ += alpha * (value - value_);
+    }
+    return value_;
+}
+
+float OneEuroFilter::filter(float value, float dt_s) {
+    if (!initialized_) {
+        value_ = value;
+        raw_ = value;
+        derivative_ = 0.0f;
+        initialized_ = true;
+        return value_;
+    }
+    if (dt_s <= 0.0f) return value_;
+
+    float speed = (value - raw_) / dt_s;
+    raw_ = value;
+    derivative_ += low_pass_alpha(options_.derivative_cutoff_hz, dt_s) * (speed - derivative_);
+
+    float cutoff = options_.min_cutoff_hz + options_.beta * std::fabs(derivative_);
+    value_ += low_pass_alpha(cutoff, dt_s) * (value - value_);
+    return value_;
+}
+
+} // namespace focus_wizard
@@ -0,0 +1,65 @@
+/**
+ * signal_filter.hpp — O(1) smoothing filters for per-frame signals
+ *
+ * Both filters keep a couple of floats of state, take the time since the
+ * previous sample (so irregular frame rates and dropped frames are
+ * handled), and never allocate.
+ *
+ *   EmaFilter      exponential moving average with a time constant; for
+ *                  slow signals such as pulse and breathing rate
+ *   OneEuroFilter  Casiez et al.'s 1€ filter: an EMA whose cutoff rises
+ *                  with the signal's speed, so jitter is smoothed hard
+ *                  while real movements (a gaze shift) come through with
+ *                  little lag
+ *
+ * The first sample after construction or reset() passes through as is.
+ */
+
+#pragma once
+
+namespace focus_wizard {
+
+class EmaFilter {
+public:
+    explicit EmaFilter(float time_constant_s = 1.0f) : time_constant_s_(time_constant_s) {}
+
+    float filter(float value, float dt_s);
+
+    void reset() { initialized_ = false; }
+    float value() const { return value_; }
+
+private:
+    float time_constant_s_;
+    float value_ = 0.0f;
+    bool initialized_ = false;
+};
+
+struct OneEuroOptions {
+    // Cutoff (Hz) at rest; lower = smoother but laggier when still
+    float min_cutoff_hz = 1.0f;
+
+    // How fast the cutoff rises with speed; higher = less lag on movement
+    float beta = 0.3f;
+
+    // Cutoff (Hz) of the speed estimate itself
+    float derivative_cutoff_hz = 1.0f;
+};
+
+class OneEuroFilter {
+public:
+    explicit OneEuroFilter(OneEuroOptions options = {}) : options_(options) {}
+
+    float filter(float value, float dt_s);
+
+    void reset() { initialized_ = false; }
+    float value() const { return value_; }
+
+private:
+    OneEuroOptions options_;
+    float value_ = 0.0f;
+    float raw_ = 0.0f;        // previous input, for the speed estimate
+    float derivative_ = 0.0f;
+    bool initialized_ = false;
+};
+
+} // namespace focus_wizard
@@ -0,0 +1,133 @@
+/**
+ * track_pipeline.cpp — Implementation
+ */
+
+#include "track_pipeline.hpp"
+
+#include <exception>
+#include <string>
+
+#include <physiology/modules/messages/metrics.h>
+#include <physiology/modules/messages/status.h>
+
+#include "pipeline_metrics.hpp"
+#include "publish.hpp"
+
+namespace focus_wizard {
+
+TrackPipeline::TrackPipeline(const TrackPipelineOptions& options, uint16_t track,
+                             MessageSink sink)
+    : collector(options.blink, options.landmark_mode, options.fusion, options.vitals)
+    , analyzer(options.live_thresholds ? options.live_thresholds->load() : options.thresholds,
+               options.emit_policy, options.smoothing)
+{
+    if (options.live_thresholds) {
+        analyzer.set_live_thresholds(options.live_thresholds);
+    }
+    if (options.emit_level == EmitLevel::SUMMARY) {
+        summary = std::make_unique<FocusSummary>(options.summary);
+    }
+    emitter.configure(options.format, -1);
+    emitter.set_level(options.emit_level);
+    emitter.set_track(track);
+    emitter.set_sink(std::move(sink));
+}
+
+static void run_container(TrackPipeline& pipeline, const BridgeSettings& settings,
+                          Backend backend, const TrackPipelineHooks& hooks) {
+    JsonEmitter& emitter = pipeline.emitter;
+    auto fail = [&emitter](const std::string& what, const absl::Status& status) {
+        emitter.emit_error(what + ": " + std::string(status.message()));
+    };
+
+    auto ss_container = std::make_unique<BridgeContainer>(settings, backend);
+
+    if (hooks.make_source) {
+        if (auto status = ss_container->SetVideoSourceFactory(hooks.make_source); !status.ok()) {
+            fail("Failed to set video source", status);
+            return;
+        }
+    }
+
+    auto core_status = ss_container->SetOnCoreMetricsOutput(
+        [&pipeline](const presage::physiology::MetricsBuffer& metrics, int64_t timestamp) {
+            publish_core(pipeline.emitter, pipeline.collector, metrics, timestamp);
+            return absl::OkStatus();
+        });
+    if (!core_status.ok()) {
+        fail("Failed to set core metrics callback", core_status);
+        return;
+    }
+
+    auto edge_status = ss_container->SetOnEdgeMetricsOutput(
+        [&pipeline, &hooks](const presage::physiology::Metrics& metrics, int64_t timestamp) {
+            publish_edge(pipeline.emitter, pipeline.collector, metrics, timestamp);
+            FocusMetrics snapshot = pipeline.collector.current();
+            FocusResult result = publish_focus(pipeline.emitter, pipeline.analyzer, snapshot);
+            if (pipeline.summary) {
+                publish_summary(pipeline.emitter, *pipeline.summary, snapshot, result);
+            }
+            if (hooks.after_frame) hooks.after_frame(snapshot, timestamp);
+            return absl::OkStatus();
+        });
+    if (!edge_status.ok()) {
+        fail("Failed to set edge metrics callback", edge_status);
+        return;
+    }
+
+    const volatile std::sig_atomic_t* stop = hooks.stop;
+    auto video_status = ss_container->SetOnVideoOutput(
+        [stop](cv::Mat& frame, int64_t timestamp) {
+            if (stop && *stop) {
+                return absl::CancelledError("Pipeline stopped");
+            }
+            pipeline_metrics().add(PipelineCounter::FRAMES_RECEIVED);
+            return absl::OkStatus();
+        });
+    if (!video_status.ok()) {
+        fail("Failed to set video callback", video_status);
+        return;
+    }
+
+    auto status_cb_status = ss_container->SetOnStatusChange(
+        [&emitter](presage::physiology::StatusValue imaging_status) {
+            emitter.emit_status(
+                presage::physiology::GetStatusDescription(imaging_status.value()));
+            return absl::OkStatus();
+        });
+    if (!status_cb_status.ok()) {
+        fail("Failed to set status callback", status_cb_status);
+        return;
+    }
+
+    emitter.emit_status("Initializing pipeline...");
+    if (auto init_status = ss_container->Initialize(); !init_status.ok()) {
+        fail("Failed to initialize", init_status);
+        return;
+    }
+    if (!ss_container->fallback_reason().empty()) {
+        emitter.emit_status(ss_container->fallback_reason() + "; using CPU");
+    }
+
+    emitter.emit_ready();
+    if (auto run_status = ss_container->Run(); !run_status.ok()) {
+        // CancelledError is expected once the host stops the pipeline
+        if (run_status.code() != absl::StatusCode::kCancelled) {
+            fail("Processing failed", run_status);
+        }
+    }
+}
+
+void run_track_pipeline(TrackPipeline& pipeline, const BridgeSettings& settings,
+                        Backend backend, const TrackPipelineHooks& hooks) {
+    try {
+        run_container(pipeline, settings, backend, hooks);
+    } catch (const std::exception& e) {
+        pipeline.emitter.emit_error(std::string("Fatal error: ") + e.what());
+    }
+    if (pipeline.summary && pipeline.summary->flush()) {
+        pipeline.emitter.emit("summary", pipeline.summary->json());
+    }
+}
+
+} // namespace focus_wizard
@@ -0,0 +1,82 @@
+/**
+ * track_pipeline.hpp — One SmartSpectra pipeline among several in a process
+ *
+ * Multi-session mode (session_host.hpp) runs a pipeline per network
+ * client and multi-camera mode (camera_host.hpp) one per camera. Each
+ * is the same thing: its own container, MetricsCollector, FocusAnalyzer,
+ * optional FocusSummary and a JsonEmitter whose sink carries its output to
+ * wherever the host sends it. TrackPipeline holds that state and
+ * run_track_pipeline() wires it to the container's callbacks and runs it;
+ * the hosts only add what differs (video source, per-frame extras, where
+ * the output goes and when to stop).
+ */
+
+#pragma once
+
+#include <csignal>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+#include "blink_rate_estimator.hpp"
+#include "bridge_container.hpp"
+#include "focus_analyzer.hpp"
+#include "focus_summary.hpp"
+#include "json_emitter.hpp"
+#include "metrics_collector.hpp"
+
+namespace focus_wizard {
+
+struct TrackPipelineOptions {
+    BlinkRateOptions blink;
+    LandmarkMode landmark_mode = LandmarkMode::DENSE;
+    FusionOptions fusion;
+    VitalsOptions vitals;
+    FocusThresholds thresholds;
+    FocusEmitPolicy emit_policy;
+    FocusSmoothing smoothing;
+    OutputFormat format = OutputFormat::NDJSON;
+    EmitLevel emit_level = EmitLevel::FULL;
+    FocusSummaryOptions summary;  // EmitLevel::SUMMARY
+
+    // Graph backend for every pipeline's container
+    Backend backend = Backend::CPU;
+
+    // Shared by every pipeline when set (the set_thresholds command);
+    // must outlive them
+    const LiveThresholds* live_thresholds = nullptr;
+};
+
+struct TrackPipeline {
+    /**
+     * Messages go to `sink`; the emitter is tagged with `track` (0 = none).
+     */
+    TrackPipeline(const TrackPipelineOptions& options, uint16_t track, MessageSink sink);
+
+    JsonEmitter emitter;
+    MetricsCollector collector;
+    FocusAnalyzer analyzer;
+    std::unique_ptr<FocusSummary> summary;
+};
+
+struct TrackPipelineHooks {
+    // Frames come from here; empty = the settings' own video source
+    BridgeContainer::VideoSourceFactory make_source;
+
+    // Edge thread, after each frame's focus and summary are published
+    std::function<void(const FocusMetrics& snapshot, int64_t timestamp)> after_frame;
+
+    // The video callback cancels Run() once this is set
+    const volatile std::sig_atomic_t* stop = nullptr;
+};
+
+/**
+ * Build a container from `settings`, wire `pipeline` to its callbacks and
+ * run it until `*hooks.stop` is set or it fails; the partial summary
+ * window then goes out. Blocks for the pipeline's lifetime. Errors,
+ * exceptions included, are reported on the pipeline's emitter.
+ */
+void run_track_pipeline(TrackPipeline& pipeline, const BridgeSettings& settings,
+                        Backend backend, const TrackPipelineHooks& hooks);
+
+} // namespace focus_wizard
@@ -0,0 +1,269 @@
+/**
+ * vitals_tracker.cpp — Implementation
+ */
+
+#include "vitals_tracker.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace focus_wizard {
+
+namespace {
+
+// Beat detection: plausible inter-beat intervals (200 .. 30 BPM) and the
+// time constant of the baseline a peak has to rise above
+constexpr float kMinBeatIntervalS = 0.3f;
+constexpr float kMaxBeatIntervalS = 2.0f;
+constexpr float kBeatBaselineTimeConstantS = 1.5f;
+
+int64_t window_to_us(float window_s) {
+    return static_cast<int64_t>(std::max(window_s, 0.0f) * 1e6f);
+}
+
+} // namespace
+
+// ── Rate Window ──────────────────────────────────────────
+
+RateWindow::RateWindow(float window_s, size_t capacity)
+    : window_us_(window_to_us(window_s))
+    , ring_(std::max<size_t>(capacity, 1))
+{
+}
+
+bool RateWindow::add(const google::protobuf::RepeatedPtrField<
+                         presage::physiology::MeasurementWithConfidence>& rates,
+                     int64_t callback_us) {
+    bool added = false;
+    for (const auto& rate : rates) {
+        // Skip what an earlier, overlapping batch already delivered.
+        // Unstamped samples can't be told apart and are always taken.
+        if (rate.timestamp() > 0 && count_ > 0 && rate.timestamp() <= latest_us_) continue;
+        int64_t timestamp_us = rate.timestamp() > 0 ? rate.timestamp() : callback_us;
+        push({timestamp_us, rate.value(), rate.confidence()});
+        added = true;
+    }
+    if (!added) return false;
+
+    // The newest sample always stays, however short the window
+    while (count_ > 1 && latest_us_ - ring_[head_].timestamp_us > window_us_) pop();
+
+    value_ = sum_weight_ > 0.0 ? static_cast<float>(sum_weighted_value_ / sum_weight_)
+                               : last_.value;
+    confidence_ = static_cast<float>(sum_confidence_ / static_cast<double>(count_));
+    return true;
+}
+
+void RateWindow::push(const Sample& sample) {
+    if (count_ == ring_.size()) pop();
+
+    ring_[(head_ + count_) % ring_.size()] = sample;
+    ++count_;
+
+    double weight = std::clamp(sample.confidence, 0.0f, 1.0f);
+    sum_weight_ += weight;
+    sum_weighted_value_ += weight * sample.value;
+    sum_confidence_ += sample.confidence;
+
+    last_ = sample;
+    latest_us_ = std::max(latest_us_, sample.timestamp_us);
+}
+
+void RateWindow::pop() {
+    const Sample& oldest = ring_[head_];
+    double weight = std::clamp(oldest.confidence, 0.0f, 1.0f);
+    sum_weight_ -= weight;
+    sum_weighted_value_ -= weight * oldest.value;
+    sum_confidence_ -= oldest.confidence;
+
+    head_ = (head_ + 1) % ring_.size();
+    --count_;
+    if (count_ == 0) {
+        // Don't let rounding in the running sums outlive the samples
+        sum_weight_ = 0.0;
+        sum_weighted_value_ = 0.0;
+        sum_confidence_ = 0.0;
+    }
+}
+
+// ── Peak Detection ───────────────────────────────────────
+
+PeakDetector::PeakDetector(float min_interval_s, float max_interval_s,
+                           float baseline_time_constant_s)
+    : min_interval_us_(window_to_us(min_interval_s))
+    , max_interval_us_(window_to_us(max_interval_s))
+    , baseline_time_constant_s_(baseline_time_constant_s)
+{
+}
+
+bool PeakDetector::add(int64_t timestamp_us, float value, int64_t* peak_us,
+                       int64_t* interval_us) {
+    // A gap in the trace: intervals across it would be meaningless
+    if (seen_ > 0 && timestamp_us - prev_us_ > max_interval_us_) {
+        seen_ = 0;
+        has_peak_ = false;
+    }
+
+    if (seen_ == 0) {
+        baseline_ = value;
+    } else {
+        float dt_s = static_cast<float>(timestamp_us - prev_us_) / 1e6f;
+        baseline_ += (1.0f - std::exp(-dt_s / baseline_time_constant_s_)) * (value - baseline_);
+    }
+
+    // The previous sample is a peak if it is a local maximum above the
+    // baseline, far enough from the last peak
+    bool found = false;
+    if (seen_ >= 2 && prev_ > prev2_ && prev_ >= value && prev_ > baseline_) {
+        int64_t interval = prev_us_ - last_peak_us_;
+        if (!has_peak_ || interval >= min_interval_us_) {
+            if (has_peak_ && interval <= max_interval_us_) {
+                *peak_us = prev_us_;
+                *interval_us = interval;
+                found = true;
+            }
+            last_peak_us_ = prev_us_;
+            has_peak_ = true;
+        }
+    }
+
+    prev2_ = prev_;
+    prev_ = value;
+    prev_us_ = timestamp_us;
+    seen_ = std::min(seen_ + 1, 2);
+    return found;
+}
+
+// ── Interval Window ──────────────────────────────────────
+
+IntervalWindow::IntervalWindow(float window_s, size_t capacity)
+    : window_us_(window_to_us(window_s))
+    , intervals_ms_(std::max<size_t>(capacity, 2))
+    , peak_us_(intervals_ms_.size())
+{
+}
+
+void IntervalWindow::add(int64_t peak_us, float interval_ms) {
+    const size_t capacity = intervals_ms_.size();
+    if (count_ == capacity) {
+        head_ = (head_ + 1) % capacity;
+        --count_;
+    }
+    size_t slot = (head_ + count_) % capacity;
+    intervals_ms_[slot] = interval_ms;
+    peak_us_[slot] = peak_us;
+    ++count_;
+}
+
+void IntervalWindow::expire(int64_t now_us) {
+    while (count_ > 0 && now_us - peak_us_[head_] > window_us_) {
+        head_ = (head_ + 1) % intervals_ms_.size();
+        --count_;
+    }
+}
+
+// Feed the samples of `trace` newer than the last one `detector` saw;
+// returns false if there were none
+template <typename OnInterval>
+static bool scan_trace(const google::protobuf::RepeatedPtrField<
+                           presage::physiology::Measurement>& trace,
+                       PeakDetector& detector, OnInterval on_interval) {
+    bool added = false;
+    for (const auto& sample : trace) {
+        int64_t timestamp_us = sample.timestamp() > 0
+            ? sample.timestamp()
+            : static_cast<int64_t>(static_cast<double>(sample.time()) * 1e6);
+        if (detector.started() && timestamp_us <= detector.last_sample_us()) continue;
+
+        int64_t peak_us;
+        int64_t interval_us;
+        if (detector.add(timestamp_us, sample.value(), &peak_us, &interval_us)) {
+            on_interval(peak_us, static_cast<float>(interval_us) / 1000.0f);
+        }
+        added = true;
+    }
+    return added;
+}
+
+// ── HRV ──────────────────────────────────────────────────
+
+HrvEstimator::HrvEstimator(float window_s, size_t capacity)
+    : beats_(kMinBeatIntervalS, kMaxBeatIntervalS, kBeatBaselineTimeConstantS)
+    , intervals_(window_s, capacity)
+{
+}
+
+bool HrvEstimator::add(const google::protobuf::RepeatedPtrField<
+                           presage::physiology::Measurement>& trace) {
+    bool added = scan_trace(trace, beats_, [this](int64_t peak_us, float interval_ms) {
+        intervals_.add(peak_us, interval_ms);
+    });
+    if (added) intervals_.expire(beats_.last_sample_us());
+    return added;
+}
+
+HrvFeatures HrvEstimator::features() const {
+    HrvFeatures features;
+    features.beats = static_cast<int>(intervals_.size());
+    if (features.beats < kMinBeats) return features;
+
+    const size_t count = intervals_.size();
+    double sum = 0.0;
+    double sum_squares = 0.0;
+    double sum_diff_squares = 0.0;
+    double previous = intervals_[0];
+    for (size_t i = 0; i < count; ++i) {
+        double interval = intervals_[i];
+        sum += interval;
+        sum_squares += interval * interval;
+        double diff = interval - previous;
+        sum_diff_squares += diff * diff;
+        previous = interval;
+    }
+
+    double n = static_cast<double>(count);
+    double mean = sum / n;
+    features.sdnn_ms  = static_cast<float>(std::sqrt(std::max(0.0, sum_squares / n - mean * mean)));
+    features.rmssd_ms = static_cast<float>(std::sqrt(sum_diff_squares / (n - 1.0)));
+    return features;
+}
+
+// ── Trace Rate ───────────────────────────────────────────
+
+TraceRateEstimator::TraceRateEstimator(float min_period_s, float max_period_s, float window_s,
+                                       size_t capacity)
+    : peaks_(min_period_s, max_period_s, max_period_s)
+    , intervals_(window_s, capacity)
+{
+}
+
+bool TraceRateEstimator::add(const google::protobuf::RepeatedPtrField<
+                                 presage::physiology::Measurement>& trace) {
+    bool added = scan_trace(trace, peaks_, [this](int64_t peak_us, float interval_ms) {
+        intervals_.add(peak_us, interval_ms);
+    });
+    if (!added) return false;
+    intervals_.expire(peaks_.last_sample_us());
+
+    if (!has_rate()) {
+        rate_per_min_ = 0.0f;
+        confidence_ = 0.0f;
+        return true;
+    }
+
+    const size_t count = intervals_.size();
+    double sum = 0.0;
+    double sum_squares = 0.0;
+    for (size_t i = 0; i < count; ++i) {
+        double interval = intervals_[i];
+        sum += interval;
+        sum_squares += interval * interval;
+    }
+    double mean = sum / static_cast<double>(count);
+    double variance = std::max(0.0, sum_squares / static_cast<double>(count) - mean * mean);
+    rate_per_min_ = static_cast<float>(60000.0 / mean);
+    confidence_ = std::clamp(1.0f - static_cast<float>(std::sqrt(variance) / mean), 0.0f, 1.0f);
+    return true;
+}
+
+} // namespace focus_wizard
@@ -0,0 +1,216 @@
+/**
+ * vitals_tracker.hpp — Rolling vitals features over whole REST batches
+ *
+ * Every MetricsBuffer carries a few seconds of samples: a series of pulse
+ * and breathing rate estimates and the pulse trace itself. These trackers
+ * consume a batch's repeated fields in one pass each, so nothing between
+ * the first and the last sample is lost:
+ *
+ *   RateWindow     confidence-weighted mean of the rate samples of the last
+ *                  window_s seconds (running sums, evicted in order)
+ *   HrvEstimator   beats detected in the pulse trace; RMSSD and SDNN of the
+ *                  inter-beat intervals of the last window_s seconds
+ *   TraceRateEstimator
+ *                  a rate counted from the peaks of a trace, for edge
+ *                  breathing, which comes as a trace without a rate
+ *
+ * Samples are expected in time order, as the SDK delivers them.
+ * Consecutive batches overlap; samples no newer than the last one taken
+ * are skipped, so each is counted once. Both keep their samples in rings
+ * sized at construction and never allocate afterwards.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// SmartSpectra / Physiology headers
+#include <physiology/modules/messages/metrics.h>
+
+namespace focus_wizard {
+
+struct VitalsOptions {
+    // Pulse / breathing rate = confidence-weighted mean over this many
+    // seconds of REST samples. 0 = the latest sample only.
+    float rate_window_s = 5.0f;
+
+    // Seconds of inter-beat intervals the HRV features are computed over
+    float hrv_window_s = 60.0f;
+
+    // Also take breathing from the edge metrics: their breathing() rate,
+    // or one counted from its upper trace. For running without REST; with
+    // REST the edge estimate, being newer, would replace a better one.
+    bool edge_breathing = false;
+};
+
+class RateWindow {
+public:
+    explicit RateWindow(float window_s, size_t capacity = 512);
+
+    /**
+     * Add every sample of `rates` newer than the last one added.
+     * Samples without an SDK timestamp are stamped `callback_us`.
+     * Returns false if none were new.
+     */
+    bool add(const google::protobuf::RepeatedPtrField<
+                 presage::physiology::MeasurementWithConfidence>& rates,
+             int64_t callback_us);
+
+    // Weighted mean value and mean confidence of the window
+    float value() const { return value_; }
+    float confidence() const { return confidence_; }
+
+    // SDK timestamp of the newest sample in the window
+    int64_t latest_us() const { return latest_us_; }
+
+private:
+    struct Sample {
+        int64_t timestamp_us;
+        float value;
+        float confidence;
+    };
+
+    void push(const Sample& sample);
+    void pop();
+
+    const int64_t window_us_;
+    std::vector<Sample> ring_;
+    size_t head_ = 0;    // oldest sample
+    size_t count_ = 0;
+
+    // Running sums over the ring (double: samples are added and removed
+    // for hours)
+    double sum_weight_ = 0.0;
+    double sum_weighted_value_ = 0.0;
+    double sum_confidence_ = 0.0;
+
+    Sample last_{};      // newest sample, for window 0 / zero confidence
+    int64_t latest_us_ = 0;
+    float value_ = 0.0f;
+    float confidence_ = 0.0f;
+};
+
+/**
+ * Streaming peak detector for a periodic trace: a sample is a peak if it
+ * is a local maximum above a slow baseline of the trace and at least
+ * min_interval after the previous peak. Intervals longer than
+ * max_interval (missed peaks, gaps in the trace) are not reported.
+ */
+class PeakDetector {
+public:
+    PeakDetector(float min_interval_s, float max_interval_s, float baseline_time_constant_s);
+
+    /**
+     * Feed one sample. Returns true when it reveals a peak that closes a
+     * plausible interval: `peak_us` is when that peak was, `interval_us`
+     * the time since the one before.
+     */
+    bool add(int64_t timestamp_us, float value, int64_t* peak_us, int64_t* interval_us);
+
+    bool started() const { return seen_ > 0; }
+    int64_t last_sample_us() const { return prev_us_; }
+
+private:
+    const int64_t min_interval_us_;
+    const int64_t max_interval_us_;
+    const float baseline_time_constant_s_;
+
+    int64_t prev_us_ = 0;
+    float prev_ = 0.0f;
+    float prev2_ = 0.0f;
+    int seen_ = 0;       // samples in prev_ / prev2_ (0..2)
+    float baseline_ = 0.0f;
+    int64_t last_peak_us_ = 0;
+    bool has_peak_ = false;
+};
+
+/**
+ * The intervals between peaks of the last window_s seconds.
+ */
+class IntervalWindow {
+public:
+    IntervalWindow(float window_s, size_t capacity);
+
+    void add(int64_t peak_us, float interval_ms);
+
+    // Drop intervals older than the window, measured back from `now_us`
+    void expire(int64_t now_us);
+
+    size_t size() const { return count_; }
+
+    // Interval `i` in time order (0 = oldest)
+    float operator[](size_t i) const { return intervals_ms_[(head_ + i) % intervals_ms_.size()]; }
+
+private:
+    const int64_t window_us_;
+    std::vector<float> intervals_ms_;
+    std::vector<int64_t> peak_us_;
+    size_t head_ = 0;
+    size_t count_ = 0;
+};
+
+struct HrvFeatures {
+    float rmssd_ms = 0.0f;   // root mean square of successive differences
+    float sdnn_ms  = 0.0f;   // standard deviation of the intervals
+    int   beats    = 0;      // intervals in the window
+};
+
+class HrvEstimator {
+public:
+    explicit HrvEstimator(float window_s, size_t capacity = 256);
+
+    /**
+     * Detect beats in `trace` (samples newer than the last one seen).
+     * Returns false if none of the samples were new.
+     */
+    bool add(const google::protobuf::RepeatedPtrField<
+                 presage::physiology::Measurement>& trace);
+
+    /**
+     * Features of the current window; `beats` < kMinBeats means there
+     * isn't enough yet and the values are 0.
+     */
+    HrvFeatures features() const;
+
+    static constexpr int kMinBeats = 5;
+
+private:
+    PeakDetector beats_;
+    IntervalWindow intervals_;
+};
+
+/**
+ * A rate (cycles per minute) counted from the peaks of a trace, for
+ * signals that come without one — the edge breathing trace. Confidence is
+ * how regular the cycles are: 1 - their coefficient of variation.
+ */
+class TraceRateEstimator {
+public:
+    TraceRateEstimator(float min_period_s, float max_period_s, float window_s,
+                       size_t capacity = 64);
+
+    /**
+     * Count the cycles in `trace` (samples newer than the last one seen).
+     * Returns false if none of the samples were new.
+     */
+    bool add(const google::protobuf::RepeatedPtrField<
+                 presage::physiology::Measurement>& trace);
+
+    // False until kMinCycles cycles are in the window
+    bool has_rate() const { return intervals_.size() >= kMinCycles; }
+
+    float rate_per_min() const { return rate_per_min_; }
+    float confidence() const { return confidence_; }
+    int64_t latest_us() const { return peaks_.last_sample_us(); }
+
+    static constexpr size_t kMinCycles = 3;
+
+private:
+    PeakDetector peaks_;
+    IntervalWindow intervals_;
+    float rate_per_min_ = 0.0f;
+    float confidence_ = 0.0f;
+};
+
+} // namespace focus_wizard
@@ -0,0 +1,76 @@
+/**
+ * control_channel_test.cpp — Command line parsing and typed lookups
+ *
+ * Commands come from the parent process over stdin; a value of the wrong
+ * type must be refused by the getter, not coerced.
+ */
+
+#include <string>
+
+#include "control_channel.hpp"
+#include "test_harness.hpp"
+
+using namespace focus_wizard;
+
+namespace {
+
+ControlCommand parse(const std::string& line) {
+    ControlCommand command;
+    std::string error;
+    EXPECT_TRUE(parse_control_command(line, &command, &error));
+    return command;
+}
+
+bool parses(const std::string& line) {
+    ControlCommand command;
+    std::string error;
+    return parse_control_command(line, &command, &error);
+}
+
+} // namespace
+
+TEST(ControlCommand, ReadsTypedValues) {
+    ControlCommand command = parse(
+        R"({"cmd":"configure","capture_width":640,"id":"q1","verbose":true,"gap":-1.5e2})");
+    EXPECT_TRUE(command.cmd == "configure");
+
+    double number = 0.0;
+    EXPECT_TRUE(command.get_number("capture_width", &number));
+    EXPECT_EQ(number, 640.0);
+    EXPECT_TRUE(command.get_number("gap", &number));
+    EXPECT_EQ(number, -150.0);
+
+    std::string text;
+    EXPECT_TRUE(command.get_string("id", &text));
+    EXPECT_TRUE(text == "q1");
+
+    bool flag = false;
+    EXPECT_TRUE(command.get_bool("verbose", &flag));
+    EXPECT_TRUE(flag);
+}
+
+TEST(ControlCommand, QuotedValuesAreNotNumbersOrBools) {
+    ControlCommand command =
+        parse(R"({"cmd":"configure","capture_width":"640","x":"nan","y":"inf","b":"true"})");
+    double number = 0.0;
+    EXPECT_FALSE(command.get_number("capture_width", &number));
+    EXPECT_FALSE(command.get_number("x", &number));
+    EXPECT_FALSE(command.get_number("y", &number));
+    bool flag = false;
+    EXPECT_FALSE(command.get_bool("b", &flag));
+    EXPECT_TRUE(command.has("capture_width"));
+}
+
+TEST(ControlCommand, UnquotedValuesAreNotStrings) {
+    ControlCommand command = parse(R"({"cmd":"query_history","tier":60})");
+    std::string text;
+    EXPECT_FALSE(command.get_string("tier", &text));
+}
+
+TEST(ControlCommand, RejectsNonJsonNumberLiterals) {
+    EXPECT_FALSE(parses(R"({"cmd":"set_thresholds","gaze_threshold":nan})"));
+    EXPECT_FALSE(parses(R"({"cmd":"set_thresholds","gaze_threshold":inf})"));
+    EXPECT_FALSE(parses(R"({"cmd":"set_thresholds","gaze_threshold":0x10})"));
+    EXPECT_FALSE(parses(R"({"cmd":"set_thresholds","gaze_threshold":.5})"));
+    EXPECT_TRUE(parses(R"({"cmd":"set_thresholds","gaze_threshold":0.5})"));
+}
@@ -0,0 +1,146 @@
+/**
+ * fixtures.hpp — Synthetic SDK messages and a mock clock for the tests
+ *
+ * The SDK callbacks hand the bridge protobuf Metrics (edge, per frame) and
+ * MetricsBuffer (core, per REST batch). These builders produce the same
+ * messages without a camera or the network: a face with the 468-point mesh
+ * (or the 6 sparse keypoints) whose nose sits a given fraction of the face
+ * half-width off centre, and a batch with pulse and breathing rates.
+ *
+ * MockClock replaces steady_clock in FocusAnalyzer (set_clock), so dwell
+ * and face-absence timing advance only when a test says so.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#include <physiology/modules/messages/metrics.h>
+
+#include "focus_analyzer.hpp"
+#include "metrics_collector.hpp"
+
+namespace focus_wizard::test {
+
+// 30 fps
+constexpr int64_t kFramePeriodUs = 33333;
+
+class MockClock {
+public:
+    static FocusAnalyzer::Clock::time_point now() { return now_; }
+
+    static void reset() { now_ = FocusAnalyzer::Clock::time_point(std::chrono::hours(1)); }
+
+    static void advance_ms(int64_t ms) { now_ += std::chrono::milliseconds(ms); }
+
+private:
+    static inline FocusAnalyzer::Clock::time_point now_{std::chrono::hours(1)};
+};
+
+/**
+ * A FocusAnalyzer on the mock clock, reset to its start.
+ */
+inline FocusAnalyzer make_analyzer(FocusThresholds thresholds = {}, FocusEmitPolicy policy = {},
+                                   FocusSmoothing smoothing = {}) {
+    MockClock::reset();
+    FocusAnalyzer analyzer(thresholds, policy, smoothing);
+    analyzer.set_clock(&MockClock::now);
+    return analyzer;
+}
+
+struct FaceFixture {
+    bool face = true;
+    bool blinking = false;
+    bool talking = false;
+
+    // Nose offset from the face box centre, in face half-sizes: what the
+    // collector reports as head-pose gaze
+    float nose_dx = 0.0f;
+    float nose_dy = 0.0f;
+
+    LandmarkMode landmarks = LandmarkMode::DENSE;
+};
+
+/**
+ * Edge metrics for one frame of a 640x480 camera with a 200x240 face.
+ */
+inline presage::physiology::Metrics edge_frame(const FaceFixture& fixture) {
+    presage::physiology::Metrics metrics;
+    if (!fixture.face) return metrics;
+
+    auto* face = metrics.mutable_face();
+    face->add_blinking()->set_detected(fixture.blinking);
+    face->add_talking()->set_detected(fixture.talking);
+    if (fixture.landmarks == LandmarkMode::OFF) return metrics;
+
+    constexpr float kLeft = 220.0f, kRight = 420.0f;
+    constexpr float kTop = 120.0f, kBottom = 360.0f;
+    const float center_x = (kLeft + kRight) / 2.0f;
+    const float center_y = (kTop + kBottom) / 2.0f;
+    const float nose_x = center_x + fixture.nose_dx * (kRight - kLeft) / 2.0f;
+    const float nose_y = center_y + fixture.nose_dy * (kBottom - kTop) / 2.0f;
+
+    const bool dense = fixture.landmarks == LandmarkMode::DENSE;
+    auto* points = face->add_landmarks();
+    for (int i = 0; i < (dense ? 468 : 6); ++i) {
+        auto* point = points->add_value();
+        point->set_x(center_x);
+        point->set_y(center_y);
+    }
+    if (dense) {
+        points->mutable_value(234)->set_x(kLeft);
+        points->mutable_value(454)->set_x(kRight);
+        points->mutable_value(10)->set_y(kTop);      // forehead, read twice as the top
+        points->mutable_value(152)->set_y(kBottom);  // chin
+        points->mutable_value(4)->set_x(nose_x);
+        points->mutable_value(4)->set_y(nose_y);
+    } else {
+        points->mutable_value(4)->set_x(kLeft);      // ear tragions
+        points->mutable_value(5)->set_x(kRight);
+        points->mutable_value(0)->set_y(kTop);       // eyes
+        points->mutable_value(1)->set_y(kTop);
+        points->mutable_value(3)->set_y(kBottom);    // mouth
+        points->mutable_value(2)->set_x(nose_x);     // nose tip
+        points->mutable_value(2)->set_y(nose_y);
+    }
+    return metrics;
+}
+
+/**
+ * A REST batch with one pulse and one breathing rate taken at `timestamp_us`.
+ */
+inline presage::physiology::MetricsBuffer core_batch(int64_t timestamp_us, float pulse_bpm,
+                                                     float breathing_bpm,
+                                                     float confidence = 0.9f) {
+    presage::physiology::MetricsBuffer buffer;
+    auto* pulse = buffer.mutable_pulse()->add_rate();
+    pulse->set_value(pulse_bpm);
+    pulse->set_confidence(confidence);
+    pulse->set_timestamp(timestamp_us);
+
+    auto* breathing = buffer.mutable_breathing()->add_rate();
+    breathing->set_value(breathing_bpm);
+    breathing->set_confidence(confidence);
+    breathing->set_timestamp(timestamp_us);
+    return buffer;
+}
+
+/**
+ * A face looking at the screen with calm, trusted vitals.
+ */
+inline FocusMetrics focused_metrics() {
+    FocusMetrics metrics;
+    metrics.face_detected = true;
+    metrics.has_gaze = true;
+    metrics.blink_rate_per_min = 15.0f;
+    metrics.pulse_rate_bpm = 70.0f;
+    metrics.has_pulse = true;
+    metrics.pulse_weight = 0.9f;
+    metrics.breathing_rate_bpm = 15.0f;
+    metrics.has_breathing = true;
+    metrics.breathing_weight = 0.9f;
+    return metrics;
+}
+
+} // namespace focus_wizard::test
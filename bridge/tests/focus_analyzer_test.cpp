@@ -0,0 +1,441 @@
+/**
+ * focus_analyzer_test.cpp — FocusAnalyzer unit and property tests
+ *
+ * Every analyzer runs on MockClock, so dwell and away timing are exact.
+ */
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "fixtures.hpp"
+#include "focus_analyzer.hpp"
+#include "test_harness.hpp"
+
+using namespace focus_wizard;
+using namespace focus_wizard::test;
+
+namespace {
+
+// Decision rules alone: commits are immediate and inputs unfiltered
+FocusSmoothing no_smoothing() {
+    FocusSmoothing smoothing;
+    smoothing.enabled = false;
+    return smoothing;
+}
+
+// One frame period on the mock clock, then evaluate
+FocusResult step(FocusAnalyzer& analyzer, const FocusMetrics& metrics) {
+    MockClock::advance_ms(33);
+    return analyzer.evaluate(metrics);
+}
+
+} // namespace
+
+// ── Decision Rules ───────────────────────────────────────
+
+TEST(FocusAnalyzer, UnknownBeforeAnyFace) {
+    FocusAnalyzer analyzer = make_analyzer();
+    FocusResult result = step(analyzer, FocusMetrics{});
+    EXPECT_EQ(result.state, FocusState::UNKNOWN);
+    EXPECT_NEAR(result.focus_score, 0.5, 1e-6);
+}
+
+TEST(FocusAnalyzer, FocusedWithCalmVitals) {
+    FocusAnalyzer analyzer = make_analyzer({}, {}, no_smoothing());
+    FocusResult result = step(analyzer, focused_metrics());
+    EXPECT_EQ(result.state, FocusState::FOCUSED);
+    EXPECT_NEAR(result.focus_score, 1.0, 1e-6);
+}
+
+TEST(FocusAnalyzer, ElevatedPulseLowersFocusedScore) {
+    FocusAnalyzer analyzer = make_analyzer({}, {}, no_smoothing());
+    FocusMetrics metrics = focused_metrics();
+    metrics.pulse_rate_bpm = 125.0f;     // above the threshold, breathing calm
+    metrics.pulse_weight = 1.0f;
+    FocusResult result = step(analyzer, metrics);
+    EXPECT_EQ(result.state, FocusState::FOCUSED);
+    EXPECT_NEAR(result.focus_score, 100.0 / 125.0, 1e-5);
+}
+
+TEST(FocusAnalyzer, TalkingTakesPriorityOverGaze) {
+    FocusAnalyzer analyzer = make_analyzer({}, {}, no_smoothing());
+    FocusMetrics metrics = focused_metrics();
+    metrics.is_talking = true;
+    metrics.gaze_x = 0.9f;
+    FocusResult result = step(analyzer, metrics);
+    EXPECT_EQ(result.state, FocusState::TALKING);
+    EXPECT_NEAR(result.focus_score, 0.3, 1e-6);
+}
+
+TEST(FocusAnalyzer, GazePastThresholdIsDistracted) {
+    FocusAnalyzer analyzer = make_analyzer({}, {}, no_smoothing());
+    FocusMetrics metrics = focused_metrics();
+    metrics.gaze_x = 0.3f;
+    metrics.gaze_y = 0.4f;               // magnitude 0.5
+    FocusResult result = step(analyzer, metrics);
+    EXPECT_EQ(result.state, FocusState::DISTRACTED);
+    EXPECT_NEAR(result.focus_score, 0.6 - 0.5 * 0.3, 1e-5);
+
+    metrics.gaze_x = 0.2f;
+    metrics.gaze_y = 0.0f;
+    EXPECT_EQ(step(analyzer, metrics).state, FocusState::FOCUSED);
+}
+
+TEST(FocusAnalyzer, HighBlinkRateIsDrowsy) {
+    FocusAnalyzer analyzer = make_analyzer({}, {}, no_smoothing());
+    FocusMetrics metrics = focused_metrics();
+    metrics.blink_rate_per_min = 30.0f;
+    FocusResult result = step(analyzer, metrics);
+    EXPECT_EQ(result.state, FocusState::DROWSY);
+    EXPECT_NEAR(result.focus_score, 0.15, 1e-6);
+}
+
+TEST(FocusAnalyzer, StressNeedsPulseAndBreathing) {
+    FocusAnalyzer analyzer = make_analyzer({}, {}, no_smoothing());
+    FocusMetrics metrics = focused_metrics();
+    metrics.pulse_rate_bpm = 110.0f;
+    EXPECT_EQ(step(analyzer, metrics).state, FocusState::FOCUSED);
+
+    metrics.breathing_rate_bpm = 25.0f;
+    FocusResult result = step(analyzer, metrics);
+    EXPECT_EQ(result.state, FocusState::STRESSED);
+    EXPECT_NEAR(result.focus_score, 0.25, 1e-6);
+}
+
+TEST(FocusAnalyzer, UntrustedVitalsAreIgnored) {
+    FocusAnalyzer analyzer = make_analyzer({}, {}, no_smoothing());
+    FocusMetrics metrics = focused_metrics();
+    metrics.pulse_rate_bpm = 110.0f;
+    metrics.breathing_rate_bpm = 25.0f;
+    metrics.pulse_weight = 0.1f;         // below min_vitals_weight
+    metrics.breathing_weight = 0.1f;
+    FocusResult result = step(analyzer, metrics);
+    EXPECT_EQ(result.state, FocusState::FOCUSED);
+    EXPECT_NEAR(result.focus_score, 1.0, 1e-6);
+}
+
+TEST(FocusAnalyzer, LowQualityFrameHoldsState) {
+    FocusAnalyzer analyzer = make_analyzer({}, {}, no_smoothing());
+    EXPECT_EQ(step(analyzer, focused_metrics()).state, FocusState::FOCUSED);
+
+    FocusMetrics metrics = focused_metrics();
+    metrics.gaze_x = 0.9f;
+    metrics.low_quality_frame = true;
+    EXPECT_EQ(step(analyzer, metrics).state, FocusState::FOCUSED);
+
+    metrics.low_quality_frame = false;
+    EXPECT_EQ(step(analyzer, metrics).state, FocusState::DISTRACTED);
+}
+
+TEST(FocusAnalyzer, HeadTurnWithMotionBecomesDistracted) {
+    // Turning away moves the whole frame; with the default gates the
+    // frame-feature stage reports the motion without flagging the frame
+    FocusAnalyzer analyzer = make_analyzer();
+    for (int i = 0; i < 60; ++i) step(analyzer, focused_metrics());
+    EXPECT_EQ(analyzer.current_state(), FocusState::FOCUSED);
+
+    FocusMetrics turning = focused_metrics();
+    turning.has_frame_features = true;
+    turning.motion = 0.45f;
+    turning.gaze_x = 0.9f;
+    for (int i = 0; i < 60; ++i) step(analyzer, turning);
+    EXPECT_EQ(analyzer.current_state(), FocusState::DISTRACTED);
+
+    FocusTransition transition;
+    EXPECT_TRUE(analyzer.take_transition(&transition));
+    EXPECT_EQ(transition.from, FocusState::FOCUSED);
+    EXPECT_EQ(transition.to, FocusState::DISTRACTED);
+}
+
+// ── Timing ───────────────────────────────────────────────
+
+TEST(FocusAnalyzer, AwayAfterAbsenceTimeout) {
+    FocusAnalyzer analyzer = make_analyzer();
+    step(analyzer, focused_metrics());
+
+    FocusMetrics gone;
+    MockClock::advance_ms(2900);
+    EXPECT_FALSE(analyzer.evaluate(gone).state == FocusState::AWAY);
+
+    MockClock::advance_ms(200);
+    FocusResult result = analyzer.evaluate(gone);
+    EXPECT_EQ(result.state, FocusState::AWAY);
+    EXPECT_NEAR(result.focus_score, 0.0, 1e-6);
+
+    // Back at the desk: leaving AWAY is immediate
+    EXPECT_EQ(step(analyzer, focused_metrics()).state, FocusState::FOCUSED);
+}
+
+TEST(FocusAnalyzer, AwayTimerRunsFromLastUnchangedFrame) {
+    // Unchanged frames are skipped by update(), but still show the face
+    FocusAnalyzer analyzer = make_analyzer();
+    FocusResult result;
+    for (int i = 0; i < 300; ++i) {
+        MockClock::advance_ms(33);
+        analyzer.update(focused_metrics(), &result);
+    }
+
+    FocusMetrics gone;
+    MockClock::advance_ms(1000);
+    analyzer.update(gone, &result);
+    EXPECT_FALSE(result.state == FocusState::AWAY);
+    MockClock::advance_ms(2500);
+    analyzer.update(gone, &result);
+    EXPECT_EQ(result.state, FocusState::AWAY);
+}
+
+TEST(FocusAnalyzer, NewStateWaitsOutDwell) {
+    FocusSmoothing smoothing;
+    smoothing.dwell_s = 1.0f;
+    FocusAnalyzer analyzer = make_analyzer({}, {}, smoothing);
+    for (int i = 0; i < 30; ++i) step(analyzer, focused_metrics());
+    EXPECT_EQ(analyzer.current_state(), FocusState::FOCUSED);
+
+    FocusMetrics talking = focused_metrics();
+    talking.is_talking = true;
+    MockClock::advance_ms(10);
+    EXPECT_EQ(analyzer.evaluate(talking).state, FocusState::FOCUSED);
+    MockClock::advance_ms(900);
+    EXPECT_EQ(analyzer.evaluate(talking).state, FocusState::FOCUSED);
+    MockClock::advance_ms(200);
+    EXPECT_EQ(analyzer.evaluate(talking).state, FocusState::TALKING);
+
+    FocusTransition transition;
+    EXPECT_TRUE(analyzer.take_transition(&transition));
+    EXPECT_EQ(transition.from, FocusState::FOCUSED);
+    EXPECT_EQ(transition.to, FocusState::TALKING);
+    EXPECT_FALSE(analyzer.take_transition(&transition));
+}
+
+TEST(FocusAnalyzer, TransitionReportsDwellOnMockClock) {
+    FocusAnalyzer analyzer = make_analyzer({}, {}, no_smoothing());
+    step(analyzer, focused_metrics());
+    FocusTransition transition;
+    EXPECT_TRUE(analyzer.take_transition(&transition));   // UNKNOWN -> FOCUSED
+
+    MockClock::advance_ms(5000);
+    FocusMetrics metrics = focused_metrics();
+    metrics.blink_rate_per_min = 40.0f;
+    analyzer.evaluate(metrics);
+    EXPECT_TRUE(analyzer.take_transition(&transition));
+    EXPECT_EQ(transition.from, FocusState::FOCUSED);
+    EXPECT_EQ(transition.to, FocusState::DROWSY);
+    EXPECT_NEAR(transition.previous_duration_s, 5.0, 1e-3);
+}
+
+// ── Emit Policy ──────────────────────────────────────────
+
+TEST(FocusAnalyzer, UnchangedInputsAreNotReemitted) {
+    FocusAnalyzer analyzer = make_analyzer();
+    FocusResult result;
+    EXPECT_TRUE(analyzer.update(focused_metrics(), &result));
+    MockClock::advance_ms(33);
+    EXPECT_FALSE(analyzer.update(focused_metrics(), &result));
+    EXPECT_EQ(result.state, FocusState::FOCUSED);
+
+    // Jitter below the serialized precision isn't a change either
+    FocusMetrics jitter = focused_metrics();
+    jitter.gaze_x += 0.0001f;
+    MockClock::advance_ms(33);
+    EXPECT_FALSE(analyzer.update(jitter, &result));
+
+    FocusMetrics moved = focused_metrics();
+    moved.gaze_x = 0.1f;
+    MockClock::advance_ms(33);
+    EXPECT_TRUE(analyzer.update(moved, &result));
+}
+
+TEST(FocusAnalyzer, RateCapDelaysInputOnlyUpdates) {
+    FocusEmitPolicy policy;
+    policy.max_emit_hz = 2.0f;
+    FocusAnalyzer analyzer = make_analyzer({}, policy, no_smoothing());
+    FocusResult result;
+    FocusMetrics metrics = focused_metrics();
+    EXPECT_TRUE(analyzer.update(metrics, &result));
+
+    metrics.gaze_x = 0.05f;
+    MockClock::advance_ms(100);
+    EXPECT_FALSE(analyzer.update(metrics, &result));
+    metrics.gaze_x = 0.1f;
+    MockClock::advance_ms(450);
+    EXPECT_TRUE(analyzer.update(metrics, &result));
+
+    // A state change goes out at once regardless
+    metrics.is_talking = true;
+    MockClock::advance_ms(10);
+    EXPECT_TRUE(analyzer.update(metrics, &result));
+    EXPECT_EQ(result.state, FocusState::TALKING);
+}
+
+TEST(FocusAnalyzer, LiveThresholdsApplyOnNextFrame) {
+    FocusAnalyzer analyzer = make_analyzer({}, {}, no_smoothing());
+    FocusThresholds thresholds;
+    LiveThresholds live(thresholds);
+    analyzer.set_live_thresholds(&live);
+
+    FocusMetrics metrics = focused_metrics();
+    metrics.gaze_x = 0.5f;
+    FocusResult result;
+    EXPECT_TRUE(analyzer.update(metrics, &result));
+    EXPECT_EQ(result.state, FocusState::DISTRACTED);
+
+    thresholds.gaze_distraction_threshold = 0.8f;
+    live.store(thresholds);
+    MockClock::advance_ms(33);
+    EXPECT_TRUE(analyzer.update(metrics, &result));   // same inputs, new thresholds
+    EXPECT_EQ(result.state, FocusState::FOCUSED);
+}
+
+TEST(FocusAnalyzer, FocusPayloadFields) {
+    FocusAnalyzer analyzer = make_analyzer({}, {}, no_smoothing());
+    MockClock::advance_ms(33);
+    std::string json(analyzer.analyze(focused_metrics()));
+    EXPECT_TRUE(json.find("\"state\":\"focused\"") != std::string::npos);
+    EXPECT_TRUE(json.find("\"face_detected\":true") != std::string::npos);
+    EXPECT_TRUE(json.find("\"brightness\"") == std::string::npos);
+
+    FocusMetrics featured = focused_metrics();
+    featured.has_frame_features = true;
+    std::string with_features(analyzer.build_json(FocusResult{}, featured));
+    EXPECT_TRUE(with_features.find("\"low_quality_frame\":false") != std::string::npos);
+}
+
+// ── Properties ───────────────────────────────────────────
+// Seeded random sessions: a face that comes and goes, looks around,
+// talks, blinks and has wandering vitals.
+
+namespace {
+
+struct RandomFrame {
+    FocusMetrics metrics;
+    int64_t advance_ms;
+};
+
+std::vector<RandomFrame> random_session(uint32_t seed, int frames, bool steady_weights) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    auto chance = [&](float p) { return unit(rng) < p; };
+    // Inputs quantized to the serialized precision, so change detection
+    // sees every change the decision does
+    auto quantized = [](float value) { return std::round(value * 100.0f) / 100.0f; };
+
+    std::vector<RandomFrame> session;
+    FocusMetrics metrics = focused_metrics();
+    for (int i = 0; i < frames; ++i) {
+        // Mostly small changes, with occasional jumps
+        if (chance(0.01f)) metrics.face_detected = !metrics.face_detected;
+        if (chance(0.02f)) metrics.is_talking = !metrics.is_talking;
+        metrics.is_blinking = chance(0.05f);
+        if (chance(0.1f)) metrics.gaze_x = quantized(unit(rng) * 1.2f - 0.6f);
+        if (chance(0.1f)) metrics.gaze_y = quantized(unit(rng) * 1.2f - 0.6f);
+        if (chance(0.02f)) metrics.blink_rate_per_min = quantized(unit(rng) * 40.0f);
+        if (chance(0.02f)) metrics.pulse_rate_bpm = quantized(55.0f + unit(rng) * 70.0f);
+        if (chance(0.02f)) metrics.breathing_rate_bpm = quantized(8.0f + unit(rng) * 20.0f);
+        if (!steady_weights && chance(0.02f)) metrics.pulse_weight = unit(rng);
+        if (chance(0.01f)) metrics.low_quality_frame = !metrics.low_quality_frame;
+        metrics.has_gaze = metrics.face_detected;
+
+        int64_t advance_ms = chance(0.005f) ? 4000 : 33;   // the odd long gap
+        session.push_back({metrics, advance_ms});
+    }
+    return session;
+}
+
+bool valid_state(FocusState state) {
+    return static_cast<int>(state) >= static_cast<int>(FocusState::FOCUSED) &&
+           static_cast<int>(state) <= static_cast<int>(FocusState::UNKNOWN);
+}
+
+} // namespace
+
+TEST(FocusAnalyzerProperty, ScoreAndStateStayInRange) {
+    for (uint32_t seed = 1; seed <= 20; ++seed) {
+        FocusAnalyzer analyzer = make_analyzer();
+        for (const RandomFrame& frame : random_session(seed, 3000, false)) {
+            MockClock::advance_ms(frame.advance_ms);
+            FocusResult result = analyzer.evaluate(frame.metrics);
+            EXPECT_TRUE(valid_state(result.state));
+            EXPECT_TRUE(result.focus_score >= 0.0f && result.focus_score <= 1.0f);
+            if (result.state == FocusState::AWAY) {
+                EXPECT_FALSE(frame.metrics.face_detected);
+            }
+        }
+    }
+}
+
+TEST(FocusAnalyzerProperty, SameInputsSameResults) {
+    for (uint32_t seed = 1; seed <= 10; ++seed) {
+        std::vector<RandomFrame> session = random_session(seed, 2000, false);
+        std::vector<FocusResult> first;
+        FocusAnalyzer a = make_analyzer();
+        for (const RandomFrame& frame : session) {
+            MockClock::advance_ms(frame.advance_ms);
+            first.push_back(a.evaluate(frame.metrics));
+        }
+
+        FocusAnalyzer b = make_analyzer();
+        for (size_t i = 0; i < session.size(); ++i) {
+            MockClock::advance_ms(session[i].advance_ms);
+            FocusResult result = b.evaluate(session[i].metrics);
+            EXPECT_EQ(result.state, first[i].state);
+            EXPECT_EQ(result.focus_score, first[i].focus_score);
+        }
+    }
+}
+
+TEST(FocusAnalyzerProperty, SmoothedTransitionsWaitOutDwell) {
+    FocusSmoothing smoothing;
+    smoothing.dwell_s = 0.75f;
+    for (uint32_t seed = 1; seed <= 20; ++seed) {
+        FocusAnalyzer analyzer = make_analyzer({}, {}, smoothing);
+        for (const RandomFrame& frame : random_session(seed, 3000, false)) {
+            MockClock::advance_ms(frame.advance_ms);
+            analyzer.evaluate(frame.metrics);
+            FocusTransition transition;
+            if (!analyzer.take_transition(&transition)) continue;
+
+            bool immediate = transition.from == FocusState::UNKNOWN ||
+                             transition.from == FocusState::AWAY ||
+                             transition.to == FocusState::AWAY;
+            if (!immediate) {
+                EXPECT_TRUE(transition.previous_duration_s >= smoothing.dwell_s - 1e-3f);
+            }
+            EXPECT_FALSE(transition.from == transition.to);
+        }
+    }
+}
+
+TEST(FocusAnalyzerProperty, ChangeDetectionMatchesFullEvaluation) {
+    // Without smoothing the decision depends only on the inputs and the
+    // away timer, so skipping unchanged frames must never change a result
+    for (uint32_t seed = 1; seed <= 20; ++seed) {
+        std::vector<RandomFrame> session = random_session(seed, 3000, true);
+        FocusAnalyzer full = make_analyzer({}, {}, no_smoothing());
+        std::vector<FocusResult> expected;
+        for (const RandomFrame& frame : session) {
+            MockClock::advance_ms(frame.advance_ms);
+            expected.push_back(full.evaluate(frame.metrics));
+        }
+
+        FocusAnalyzer gated = make_analyzer({}, {}, no_smoothing());
+        FocusState last_emitted = FocusState::UNKNOWN;
+        bool emitted_any = false;
+        for (size_t i = 0; i < session.size(); ++i) {
+            MockClock::advance_ms(session[i].advance_ms);
+            FocusResult result;
+            bool emitted = gated.update(session[i].metrics, &result);
+            EXPECT_EQ(result.state, expected[i].state);
+            EXPECT_NEAR(result.focus_score, expected[i].focus_score, 1e-6);
+
+            // Every state change is emitted
+            if (emitted_any && result.state != last_emitted) {
+                EXPECT_TRUE(emitted);
+            }
+            if (emitted) {
+                last_emitted = result.state;
+                emitted_any = true;
+            }
+        }
+    }
+}
@@ -0,0 +1,54 @@
+/**
+ * frame_provider_test.cpp — Raw frame geometry checks
+ *
+ * Frame headers come from other processes and network clients;
+ * raw_frame_fits() is what stands between them and a cv::Mat view.
+ */
+
+#include <cstdint>
+
+#include "frame_provider.hpp"
+#include "test_harness.hpp"
+
+using namespace focus_wizard;
+
+namespace {
+
+ReceivedFrame raw_frame(uint32_t width, uint32_t height, uint32_t stride, size_t bytes) {
+    ReceivedFrame frame;
+    frame.width = width;
+    frame.height = height;
+    frame.stride = stride;
+    frame.format = FramePixelFormat::BGR;
+    frame.data.resize(bytes);
+    return frame;
+}
+
+} // namespace
+
+TEST(RawFrameFits, AcceptsPackedAndPaddedRows) {
+    EXPECT_TRUE(raw_frame_fits(raw_frame(640, 480, 640 * 3, 640 * 3 * 480), 3));
+    EXPECT_TRUE(raw_frame_fits(raw_frame(640, 480, 640 * 4, 640 * 4 * 480), 4));
+    // The last row's padding may be left off
+    EXPECT_TRUE(raw_frame_fits(raw_frame(10, 2, 64, 64 + 30), 3));
+}
+
+TEST(RawFrameFits, RejectsZeroDimensions) {
+    EXPECT_FALSE(raw_frame_fits(raw_frame(0, 480, 0, 4096), 3));
+    EXPECT_FALSE(raw_frame_fits(raw_frame(640, 0, 640 * 3, 4096), 3));
+}
+
+TEST(RawFrameFits, RejectsStrideShorterThanRow) {
+    // Enough bytes for stride * height, but each row would read past its stride
+    EXPECT_FALSE(raw_frame_fits(raw_frame(4096, 2, 16, 32), 3));
+    EXPECT_FALSE(raw_frame_fits(raw_frame(640, 480, 640 * 3, 640 * 3 * 480), 4));
+}
+
+TEST(RawFrameFits, RejectsShortBuffer) {
+    EXPECT_FALSE(raw_frame_fits(raw_frame(10, 2, 64, 64 + 29), 3));
+    EXPECT_FALSE(raw_frame_fits(raw_frame(640, 480, 640 * 3, 0), 3));
+}
+
+TEST(RawFrameFits, RejectsDimensionsBeyondInt) {
+    EXPECT_FALSE(raw_frame_fits(raw_frame(1, 0x80000000u, 3, 4096), 3));
+}
@@ -0,0 +1,245 @@
+/**
+ * metrics_collector_test.cpp — MetricsCollector and BlinkRateEstimator tests
+ *
+ * Edge and core callbacks are fed synthetic SDK messages (fixtures.hpp)
+ * with SDK timestamps, as the live callbacks would be.
+ */
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "blink_rate_estimator.hpp"
+#include "fixtures.hpp"
+#include "metrics_collector.hpp"
+#include "test_harness.hpp"
+
+using namespace focus_wizard;
+using namespace focus_wizard::test;
+
+// ── Gaze ─────────────────────────────────────────────────
+
+TEST(MetricsCollector, GazeFromDenseMesh) {
+    MetricsCollector collector;
+    FaceFixture face;
+    face.nose_dx = 0.5f;
+    face.nose_dy = -0.25f;
+    collector.update_edge_metrics(edge_frame(face), 1'000'000);
+
+    FocusMetrics metrics = collector.current();
+    EXPECT_TRUE(metrics.face_detected);
+    EXPECT_TRUE(metrics.has_gaze);
+    EXPECT_NEAR(metrics.gaze_x, 0.5, 1e-5);
+    EXPECT_NEAR(metrics.gaze_y, -0.25, 1e-5);
+}
+
+TEST(MetricsCollector, GazeFromSparseKeypoints) {
+    MetricsCollector collector({}, LandmarkMode::SPARSE);
+    FaceFixture face;
+    face.landmarks = LandmarkMode::SPARSE;
+    face.nose_dx = -0.4f;
+    collector.update_edge_metrics(edge_frame(face), 1'000'000);
+
+    FocusMetrics metrics = collector.current();
+    EXPECT_TRUE(metrics.has_gaze);
+    EXPECT_NEAR(metrics.gaze_x, -0.4, 1e-5);
+}
+
+TEST(MetricsCollector, DenseModeIgnoresSparseKeypoints) {
+    MetricsCollector collector({}, LandmarkMode::DENSE);
+    FaceFixture face;
+    face.landmarks = LandmarkMode::SPARSE;
+    collector.update_edge_metrics(edge_frame(face), 1'000'000);
+    EXPECT_FALSE(collector.current().has_gaze);
+}
+
+TEST(MetricsCollector, LandmarksOffMeansNoGaze) {
+    MetricsCollector collector({}, LandmarkMode::OFF);
+    collector.update_edge_metrics(edge_frame(FaceFixture{}), 1'000'000);
+    FocusMetrics metrics = collector.current();
+    EXPECT_TRUE(metrics.face_detected);
+    EXPECT_FALSE(metrics.has_gaze);
+}
+
+TEST(MetricsCollector, LostFaceClearsDetectionAndGaze) {
+    MetricsCollector collector;
+    collector.update_edge_metrics(edge_frame(FaceFixture{}), 1'000'000);
+    FaceFixture gone;
+    gone.face = false;
+    collector.update_edge_metrics(edge_frame(gone), 1'033'333);
+
+    FocusMetrics metrics = collector.current();
+    EXPECT_FALSE(metrics.face_detected);
+    EXPECT_FALSE(metrics.has_gaze);
+}
+
+// ── Blinks and Talking ───────────────────────────────────
+
+TEST(MetricsCollector, BlinkRateCountsOnsets) {
+    BlinkRateOptions blink;
+    blink.window_s = 60.0f;
+    MetricsCollector collector(blink);
+
+    // 30 s at 30 fps, a three-frame blink every 100 frames: 9 onsets
+    int64_t ts = 1'000'000;
+    for (int i = 0; i < 900; ++i, ts += kFramePeriodUs) {
+        FaceFixture face;
+        face.blinking = i % 100 >= 50 && i % 100 < 53;
+        collector.update_edge_metrics(edge_frame(face), ts);
+    }
+    EXPECT_NEAR(collector.current().blink_rate_per_min, 9.0, 1e-4);
+}
+
+TEST(MetricsCollector, TalkingFromEdge) {
+    MetricsCollector collector;
+    FaceFixture face;
+    face.talking = true;
+    collector.update_edge_metrics(edge_frame(face), 1'000'000);
+    EXPECT_TRUE(collector.current().is_talking);
+}
+
+// ── Core Vitals and Fusion ───────────────────────────────
+
+TEST(MetricsCollector, CoreVitalsCarryConfidence) {
+    MetricsCollector collector;
+    collector.update_core_metrics(core_batch(2'000'000, 72.0f, 15.0f, 0.8f), 2'000'000);
+
+    FocusMetrics metrics = collector.current();
+    EXPECT_TRUE(metrics.has_pulse);
+    EXPECT_NEAR(metrics.pulse_rate_bpm, 72.0, 1e-4);
+    EXPECT_NEAR(metrics.pulse_weight, 0.8, 1e-4);
+    EXPECT_TRUE(metrics.has_breathing);
+    EXPECT_NEAR(metrics.breathing_rate_bpm, 15.0, 1e-4);
+}
+
+TEST(MetricsCollector, VitalsDecayWithNewerFrames) {
+    FusionOptions fusion;
+    fusion.vitals_half_life_s = 15.0f;
+    MetricsCollector collector({}, LandmarkMode::DENSE, fusion);
+    collector.update_core_metrics(core_batch(1'000'000, 72.0f, 15.0f, 1.0f), 1'000'000);
+    collector.update_edge_metrics(edge_frame(FaceFixture{}), 16'000'000);
+
+    EXPECT_NEAR(collector.current().pulse_weight, 0.5, 1e-3);
+}
+
+TEST(MetricsCollector, LateBatchDoesNotOverrideNewerFace) {
+    MetricsCollector collector;
+    FaceFixture gone;
+    gone.face = false;
+    collector.update_edge_metrics(edge_frame(gone), 10'000'000);
+
+    // A REST batch arriving now about a face seen five seconds ago
+    presage::physiology::MetricsBuffer batch = core_batch(5'000'000, 70.0f, 14.0f);
+    auto* blink = batch.mutable_face()->add_blinking();
+    blink->set_detected(false);
+    blink->set_timestamp(5'000'000);
+    collector.update_core_metrics(batch, 10'100'000);
+
+    FocusMetrics metrics = collector.current();
+    EXPECT_FALSE(metrics.face_detected);
+    EXPECT_TRUE(metrics.has_pulse);
+}
+
+TEST(MetricsCollector, EdgePayloadFields) {
+    MetricsCollector collector;
+    std::string json(collector.process_edge_metrics(edge_frame(FaceFixture{}), 1'000'000));
+    EXPECT_TRUE(json.find("\"face_detected\":true") != std::string::npos);
+    EXPECT_TRUE(json.find("\"has_gaze\":true") != std::string::npos);
+}
+
+// ── BlinkRateEstimator ───────────────────────────────────
+
+TEST(BlinkRateEstimator, WindowExpiresOldBlinks) {
+    BlinkRateOptions options;
+    options.window_s = 10.0f;
+    options.resolution_s = 1.0f;
+    BlinkRateEstimator estimator(options);
+
+    estimator.update(true, 1'000'000);
+    estimator.update(false, 1'100'000);
+    estimator.update(true, 2'000'000);
+    EXPECT_NEAR(estimator.rate(), 2 * 6.0, 1e-4);
+
+    // Held blink is one onset
+    estimator.update(true, 2'100'000);
+    EXPECT_NEAR(estimator.rate(), 2 * 6.0, 1e-4);
+
+    estimator.update(false, 11'500'000);   // first blink's bucket has left
+    EXPECT_NEAR(estimator.rate(), 1 * 6.0, 1e-4);
+    estimator.update(false, 40'000'000);   // jumped past the whole window
+    EXPECT_NEAR(estimator.rate(), 0.0, 1e-6);
+}
+
+TEST(BlinkRateEstimatorProperty, MatchesBruteForceCount) {
+    // Reference: keep every onset's bucket and count those in the window
+    BlinkRateOptions options;
+    options.window_s = 20.0f;
+    options.resolution_s = 0.5f;
+    const int64_t resolution_us = 500'000;
+    const int64_t buckets = 40;
+
+    for (uint32_t seed = 1; seed <= 20; ++seed) {
+        std::mt19937 rng(seed);
+        std::uniform_int_distribution<int64_t> gap_us(1'000, 400'000);
+        std::bernoulli_distribution toggle(0.2);
+
+        BlinkRateEstimator estimator(options);
+        std::vector<int64_t> onset_buckets;
+        bool blinking = false;
+        int64_t ts = 5'000'000;
+        for (int i = 0; i < 5000; ++i) {
+            ts += gap_us(rng);
+            if (i % 997 == 0) ts += 30'000'000;     // now and then, a long pause
+            bool now_blinking = toggle(rng) ? !blinking : blinking;
+            if (now_blinking && !blinking) onset_buckets.push_back(ts / resolution_us);
+            blinking = now_blinking;
+
+            float rate = estimator.update(blinking, ts);
+            int64_t head = ts / resolution_us;
+            int64_t in_window = 0;
+            for (int64_t bucket : onset_buckets) {
+                if (bucket > head - buckets) ++in_window;
+            }
+            EXPECT_NEAR(rate, in_window * 60.0 / options.window_s, 1e-3);
+        }
+    }
+}
+
+// ── Properties ───────────────────────────────────────────
+
+TEST(MetricsCollectorProperty, GazeFollowsNoseAndWeightsStayInRange) {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> offset(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    MetricsCollector collector;
+    int64_t ts = 1'000'000;
+    for (int i = 0; i < 3000; ++i, ts += kFramePeriodUs) {
+        FaceFixture face;
+        face.face = unit(rng) > 0.05f;
+        face.nose_dx = offset(rng);
+        face.nose_dy = offset(rng);
+        face.blinking = unit(rng) < 0.05f;
+        collector.update_edge_metrics(edge_frame(face), ts);
+
+        // REST batches arrive late, sometimes out of order
+        if (i % 30 == 29) {
+            int64_t taken_us = ts - static_cast<int64_t>(unit(rng) * 3e6f);
+            collector.update_core_metrics(
+                core_batch(taken_us, 60.0f + 40.0f * unit(rng), 10.0f + 10.0f * unit(rng),
+                           unit(rng)),
+                ts);
+        }
+
+        FocusMetrics metrics = collector.current();
+        EXPECT_EQ(metrics.face_detected, face.face);
+        if (face.face) {
+            EXPECT_TRUE(metrics.has_gaze);
+            EXPECT_NEAR(metrics.gaze_x, face.nose_dx, 1e-4);
+            EXPECT_NEAR(metrics.gaze_y, face.nose_dy, 1e-4);
+        }
+        EXPECT_TRUE(metrics.pulse_weight >= 0.0f && metrics.pulse_weight <= 1.0f);
+        EXPECT_TRUE(metrics.breathing_weight >= 0.0f && metrics.breathing_weight <= 1.0f);
+        EXPECT_TRUE(metrics.blink_rate_per_min >= 0.0f);
+    }
+}
@@ -0,0 +1,198 @@
+/**
+ * microbench.cpp — Microbenchmarks for the per-frame hot paths
+ *
+ * Run with `focus_bridge_tests --benchmarks`. Each reports ns and heap
+ * allocations per iteration (bench/allocation_counter.hpp); the replay benchmark
+ * (focus_bridge_bench) measures the same stages end to end instead.
+ *
+ *   analyze      FocusAnalyzer decision + payload, and the unchanged-input
+ *                fast path of update()
+ *   blinks       BlinkRateEstimator::update
+ *   gaze         edge update with dense / sparse landmarks, and the
+ *                GazeEstimator eye-offset refinement
+ *   serialize    focus / edge JSON payloads, NDJSON lines and binary
+ *                records through a JsonEmitter (into a discarding sink)
+ */
+
+#include <cstdint>
+#include <string>
+
+#include "binary_protocol.hpp"
+#include "blink_rate_estimator.hpp"
+#include "fixtures.hpp"
+#include "focus_analyzer.hpp"
+#include "gaze_estimator.hpp"
+#include "json_emitter.hpp"
+#include "metrics_collector.hpp"
+#include "test_harness.hpp"
+
+using namespace focus_wizard;
+using namespace focus_wizard::test;
+
+namespace {
+
+// A JsonEmitter whose output is counted and thrown away, so the numbers
+// are formatting only, not syscalls
+struct DiscardingEmitter {
+    explicit DiscardingEmitter(OutputFormat format) {
+        emitter.configure(format, -1);
+        emitter.set_sink([this](MessageType, const char*, size_t length) { bytes += length; });
+    }
+
+    JsonEmitter emitter;
+    uint64_t bytes = 0;
+};
+
+// Alternating inputs, so every iteration is a real decision
+FocusMetrics alternate(int64_t i) {
+    FocusMetrics metrics = focused_metrics();
+    metrics.gaze_x = (i & 1) ? 0.1f : 0.5f;
+    return metrics;
+}
+
+} // namespace
+
+// ── Analyze ──────────────────────────────────────────────
+
+static void BM_AnalyzerEvaluate(State& state) {
+    FocusAnalyzer analyzer = make_analyzer();
+    int64_t i = 0;
+    for (auto _ : state) {
+        MockClock::advance_ms(33);
+        do_not_optimize(analyzer.evaluate(alternate(i++)));
+    }
+}
+BENCHMARK(BM_AnalyzerEvaluate);
+
+static void BM_AnalyzerAnalyze(State& state) {
+    FocusAnalyzer analyzer = make_analyzer();
+    int64_t i = 0;
+    for (auto _ : state) {
+        MockClock::advance_ms(33);
+        do_not_optimize(analyzer.analyze(alternate(i++)));
+    }
+}
+BENCHMARK(BM_AnalyzerAnalyze);
+
+static void BM_AnalyzerUpdateUnchanged(State& state) {
+    FocusAnalyzer analyzer = make_analyzer();
+    FocusMetrics metrics = focused_metrics();
+    FocusResult result;
+    analyzer.update(metrics, &result);
+    for (auto _ : state) {
+        MockClock::advance_ms(33);
+        do_not_optimize(analyzer.update(metrics, &result));
+    }
+}
+BENCHMARK(BM_AnalyzerUpdateUnchanged);
+
+// ── Blinks ───────────────────────────────────────────────
+
+static void BM_BlinkRateUpdate(State& state) {
+    BlinkRateEstimator estimator;
+    int64_t ts = 1'000'000;
+    int64_t i = 0;
+    for (auto _ : state) {
+        do_not_optimize(estimator.update(i++ % 100 < 3, ts));
+        ts += kFramePeriodUs;
+    }
+}
+BENCHMARK(BM_BlinkRateUpdate);
+
+// ── Gaze ─────────────────────────────────────────────────
+
+static void BM_EdgeUpdateDense(State& state) {
+    MetricsCollector collector({}, LandmarkMode::DENSE);
+    FaceFixture face;
+    face.nose_dx = 0.2f;
+    presage::physiology::Metrics frame = edge_frame(face);
+    int64_t ts = 1'000'000;
+    for (auto _ : state) {
+        collector.update_edge_metrics(frame, ts);
+        ts += kFramePeriodUs;
+    }
+    do_not_optimize(collector.current());
+}
+BENCHMARK(BM_EdgeUpdateDense);
+
+static void BM_EdgeUpdateSparse(State& state) {
+    MetricsCollector collector({}, LandmarkMode::SPARSE);
+    FaceFixture face;
+    face.landmarks = LandmarkMode::SPARSE;
+    face.nose_dx = 0.2f;
+    presage::physiology::Metrics frame = edge_frame(face);
+    int64_t ts = 1'000'000;
+    for (auto _ : state) {
+        collector.update_edge_metrics(frame, ts);
+        ts += kFramePeriodUs;
+    }
+    do_not_optimize(collector.current());
+}
+BENCHMARK(BM_EdgeUpdateSparse);
+
+static void BM_GazeEstimatorEstimate(State& state) {
+    GazeEstimator estimator;
+    presage::physiology::Metrics frame = edge_frame(FaceFixture{});
+    const auto& landmarks = *frame.face().landmarks().rbegin();
+    float gaze_x = 0.0f, gaze_y = 0.0f;
+    int64_t ts = 1'000'000;
+    for (auto _ : state) {
+        do_not_optimize(estimator.estimate(landmarks, 0.1f, -0.1f, ts, &gaze_x, &gaze_y));
+        ts += kFramePeriodUs;
+    }
+}
+BENCHMARK(BM_GazeEstimatorEstimate);
+
+static void BM_CollectorCurrent(State& state) {
+    MetricsCollector collector;
+    collector.update_edge_metrics(edge_frame(FaceFixture{}), 1'000'000);
+    collector.update_core_metrics(core_batch(1'000'000, 72.0f, 15.0f), 1'000'000);
+    for (auto _ : state) {
+        do_not_optimize(collector.current());
+    }
+}
+BENCHMARK(BM_CollectorCurrent);
+
+// ── Serialization ────────────────────────────────────────
+
+static void BM_FocusJson(State& state) {
+    FocusAnalyzer analyzer = make_analyzer();
+    FocusMetrics metrics = focused_metrics();
+    FocusResult result{FocusState::FOCUSED, 0.92f};
+    for (auto _ : state) {
+        do_not_optimize(analyzer.build_json(result, metrics));
+    }
+}
+BENCHMARK(BM_FocusJson);
+
+static void BM_EdgeJson(State& state) {
+    MetricsCollector collector;
+    collector.update_edge_metrics(edge_frame(FaceFixture{}), 1'000'000);
+    for (auto _ : state) {
+        do_not_optimize(collector.edge_json());
+    }
+}
+BENCHMARK(BM_EdgeJson);
+
+static void BM_EmitFocusNdjson(State& state) {
+    DiscardingEmitter out(OutputFormat::NDJSON);
+    FocusAnalyzer analyzer = make_analyzer();
+    std::string_view json = analyzer.build_json(FocusResult{}, focused_metrics());
+    std::string payload(json);
+    for (auto _ : state) {
+        out.emitter.emit("focus", payload);
+    }
+    do_not_optimize(out.bytes);
+}
+BENCHMARK(BM_EmitFocusNdjson);
+
+static void BM_EmitFocusBinary(State& state) {
+    DiscardingEmitter out(OutputFormat::BINARY);
+    FocusMetrics metrics = focused_metrics();
+    for (auto _ : state) {
+        out.emitter.emit_record(MessageType::FOCUS,
+                                make_snapshot_record(metrics, 0, 0.92f));
+    }
+    do_not_optimize(out.bytes);
+}
+BENCHMARK(BM_EmitFocusBinary);
@@ -0,0 +1,92 @@
+/**
+ * publish_test.cpp — The shared publish path, end to end
+ *
+ * Synthetic SDK callbacks go through publish_edge / publish_core /
+ * publish_focus / publish_summary into a JsonEmitter whose sink keeps the
+ * NDJSON lines, as a runner's callbacks would.
+ */
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "fixtures.hpp"
+#include "focus_summary.hpp"
+#include "json_emitter.hpp"
+#include "publish.hpp"
+#include "test_harness.hpp"
+
+using namespace focus_wizard;
+using namespace focus_wizard::test;
+
+namespace {
+
+struct Pipeline {
+    explicit Pipeline(float window_s) : summary(FocusSummaryOptions{window_s}) {
+        emitter.configure(OutputFormat::NDJSON, -1);
+        emitter.set_sink([this](MessageType type, const char* data, size_t length) {
+            if (type == MessageType::SUMMARY) summaries.emplace_back(data, length);
+        });
+    }
+
+    // One edge callback, as the SDK would deliver it at `timestamp_us`
+    void edge(int64_t timestamp_us) {
+        publish_edge(emitter, collector, edge_frame(FaceFixture{}), timestamp_us);
+        FocusMetrics snapshot = collector.current();
+        FocusResult result = publish_focus(emitter, analyzer, snapshot);
+        publish_summary(emitter, summary, snapshot, result);
+    }
+
+    JsonEmitter emitter;
+    MetricsCollector collector;
+    FocusAnalyzer analyzer = make_analyzer();
+    FocusSummary summary;
+    std::vector<std::string> summaries;
+};
+
+bool contains(const std::string& text, const std::string& part) {
+    return text.find(part) != std::string::npos;
+}
+
+} // namespace
+
+TEST(PublishSummary, EdgeOnlyFramesCloseWindows) {
+    // --integration=edge_only: no core batch ever arrives
+    Pipeline pipeline(10.0f);
+    int64_t ts = 1'000'000;
+    for (int i = 0; i < 25 * 30; ++i) {
+        pipeline.edge(ts);
+        MockClock::advance_ms(33);
+        ts += kFramePeriodUs;
+    }
+
+    EXPECT_EQ(pipeline.summaries.size(), size_t{2});
+    if (pipeline.summaries.size() == 2) {
+        EXPECT_TRUE(contains(pipeline.summaries[0], "\"start_us\":1000000"));
+        EXPECT_TRUE(contains(pipeline.summaries[0], "\"end_us\":11000000"));
+        EXPECT_TRUE(contains(pipeline.summaries[1], "\"start_us\":11000000"));
+    }
+}
+
+TEST(PublishSummary, CoreBatchesDoNotMoveWindows) {
+    // A REST batch every 3 s, lagging the frames by a second
+    Pipeline pipeline(10.0f);
+    int64_t ts = 1'000'000;
+    int64_t next_batch_us = ts + 3'000'000;
+    for (int i = 0; i < 15 * 30; ++i) {
+        if (ts >= next_batch_us) {
+            publish_core(pipeline.emitter, pipeline.collector,
+                         core_batch(ts - 1'000'000, 70.0f, 15.0f), ts - 1'000'000);
+            next_batch_us += 3'000'000;
+        }
+        pipeline.edge(ts);
+        MockClock::advance_ms(33);
+        ts += kFramePeriodUs;
+    }
+
+    EXPECT_EQ(pipeline.summaries.size(), size_t{1});
+    if (!pipeline.summaries.empty()) {
+        EXPECT_TRUE(contains(pipeline.summaries[0], "\"start_us\":1000000"));
+        EXPECT_TRUE(contains(pipeline.summaries[0], "\"end_us\":11000000"));
+    }
+}
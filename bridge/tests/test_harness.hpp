@@ -0,0 +1,160 @@
+/**
+ * test_harness.hpp — Minimal test and microbenchmark registry
+ *
+ * The bridge's Docker image has no test framework, so focus_bridge_tests
+ * carries its own: TEST(suite, name) registers a test, EXPECT_* record a
+ * failure and carry on, and BENCHMARK(fn) registers a Google-Benchmark-
+ * style function that loops over a State:
+ *
+ *   static void BM_Analyze(State& state) {
+ *       for (auto _ : state) do_not_optimize(analyzer.analyze(metrics));
+ *   }
+ *   BENCHMARK(BM_Analyze);
+ *
+ * The runner (test_main.cpp) grows the iteration count until a run takes
+ * --bench_min_time_s and reports nanoseconds and heap allocations per
+ * iteration, so before/after numbers of a change are comparable.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace focus_wizard::test {
+
+// ── Tests ────────────────────────────────────────────────
+
+struct TestCase {
+    const char* suite;
+    const char* name;
+    void (*fn)();
+};
+
+std::vector<TestCase>& test_registry();
+
+struct TestRegistrar {
+    TestRegistrar(const char* suite, const char* name, void (*fn)()) {
+        test_registry().push_back({suite, name, fn});
+    }
+};
+
+/**
+ * Record a failed check in the running test.
+ */
+void report_failure(const char* file, int line, const std::string& message);
+
+template <typename T>
+void print_value(std::ostream& out, const T& value) {
+    if constexpr (std::is_enum_v<T>) {
+        out << static_cast<long long>(value);
+    } else {
+        out << value;
+    }
+}
+
+template <typename A, typename B>
+std::string describe_values(const A& a, const B& b) {
+    std::ostringstream out;
+    out << " (";
+    print_value(out, a);
+    out << " vs ";
+    print_value(out, b);
+    out << ")";
+    return out.str();
+}
+
+// ── Benchmarks ───────────────────────────────────────────
+
+class State {
+public:
+    explicit State(uint64_t iterations) : iterations_(iterations) {}
+
+    // What `for (auto _ : state)` binds; never read
+    struct [[maybe_unused]] Value {};
+
+    struct Iterator {
+        uint64_t remaining;
+        bool operator!=(const Iterator& other) const { return remaining != other.remaining; }
+        void operator++() { --remaining; }
+        Value operator*() const { return {}; }
+    };
+
+    Iterator begin() const { return {iterations_}; }
+    Iterator end() const { return {0}; }
+
+    uint64_t iterations() const { return iterations_; }
+
+private:
+    uint64_t iterations_;
+};
+
+struct BenchmarkCase {
+    const char* name;
+    void (*fn)(State&);
+};
+
+std::vector<BenchmarkCase>& benchmark_registry();
+
+struct BenchmarkRegistrar {
+    BenchmarkRegistrar(const char* name, void (*fn)(State&)) {
+        benchmark_registry().push_back({name, fn});
+    }
+};
+
+/**
+ * Keep `value` (and the work that produced it) from being optimized away.
+ */
+template <typename T>
+inline void do_not_optimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+} // namespace focus_wizard::test
+
+#define TEST(suite, name)                                                        \
+    static void suite##_##name##_test();                                         \
+    static ::focus_wizard::test::TestRegistrar suite##_##name##_registrar(       \
+        #suite, #name, &suite##_##name##_test);                                  \
+    static void suite##_##name##_test()
+
+#define EXPECT_TRUE(condition)                                                   \
+    do {                                                                         \
+        if (!(condition)) {                                                      \
+            ::focus_wizard::test::report_failure(__FILE__, __LINE__,             \
+                                                 "expected " #condition);        \
+        }                                                                        \
+    } while (0)
+
+#define EXPECT_FALSE(condition) EXPECT_TRUE(!(condition))
+
+#define EXPECT_EQ(a, b)                                                          \
+    do {                                                                         \
+        const auto& a_value_ = (a);                                              \
+        const auto& b_value_ = (b);                                              \
+        if (!(a_value_ == b_value_)) {                                           \
+            ::focus_wizard::test::report_failure(                                \
+                __FILE__, __LINE__,                                              \
+                "expected " #a " == " #b +                                       \
+                    ::focus_wizard::test::describe_values(a_value_, b_value_));  \
+        }                                                                        \
+    } while (0)
+
+#define EXPECT_NEAR(a, b, tolerance)                                             \
+    do {                                                                         \
+        double a_value_ = (a);                                                   \
+        double b_value_ = (b);                                                   \
+        if (!(std::fabs(a_value_ - b_value_) <= (tolerance))) {                  \
+            ::focus_wizard::test::report_failure(                                \
+                __FILE__, __LINE__,                                              \
+                "expected " #a " ~= " #b +                                       \
+                    ::focus_wizard::test::describe_values(a_value_, b_value_));  \
+        }                                                                        \
+    } while (0)
+
+#define BENCHMARK(fn)                                                            \
+    static ::focus_wizard::test::BenchmarkRegistrar fn##_registrar(#fn, &fn)
@@ -0,0 +1,130 @@
+/**
+ * test_main.cpp — Runner for focus_bridge_tests
+ *
+ * Runs every registered test (ctest runs it this way) or, with
+ * --benchmarks, every registered microbenchmark instead. --filter keeps
+ * the cases whose "suite.name" (or benchmark name) contains the string.
+ *
+ * Usage:
+ *   ./focus_bridge_tests
+ *   ./focus_bridge_tests --filter=FocusAnalyzer
+ *   ./focus_bridge_tests --benchmarks --bench_min_time_s=1
+ */
+
+// ── Standard Library ─────────────────────────────────────
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// ── Third-party ──────────────────────────────────────────
+#include <absl/flags/flag.h>
+#include <absl/flags/parse.h>
+#include <absl/flags/usage.h>
+
+// ── Focus Wizard ─────────────────────────────────────────
+#include "allocation_counter.hpp"
+#include "test_harness.hpp"
+
+// ── Command-line Flags ───────────────────────────────────
+ABSL_FLAG(std::string, filter, "",
+    "Run only the cases whose name contains this string.");
+ABSL_FLAG(bool, benchmarks, false,
+    "Run the microbenchmarks instead of the tests.");
+ABSL_FLAG(double, bench_min_time_s, 0.2,
+    "Grow each benchmark's iteration count until one run takes this long.");
+
+namespace focus_wizard::test {
+
+std::vector<TestCase>& test_registry() {
+    static std::vector<TestCase> registry;
+    return registry;
+}
+
+std::vector<BenchmarkCase>& benchmark_registry() {
+    static std::vector<BenchmarkCase> registry;
+    return registry;
+}
+
+static int g_test_failures = 0;
+
+void report_failure(const char* file, int line, const std::string& message) {
+    std::fprintf(stderr, "  %s:%d: %s\n", file, line, message.c_str());
+    ++g_test_failures;
+}
+
+} // namespace focus_wizard::test
+
+namespace {
+
+using namespace focus_wizard::test;
+using Clock = std::chrono::steady_clock;
+
+int run_tests(const std::string& filter) {
+    int run = 0;
+    int failed = 0;
+    for (const TestCase& test : test_registry()) {
+        std::string name = std::string(test.suite) + "." + test.name;
+        if (!filter.empty() && name.find(filter) == std::string::npos) continue;
+
+        int failures_before = g_test_failures;
+        test.fn();
+        ++run;
+        bool ok = g_test_failures == failures_before;
+        if (!ok) ++failed;
+        std::printf("[%s] %s\n", ok ? "  OK  " : " FAIL ", name.c_str());
+    }
+    std::printf("%d tests, %d failed\n", run, failed);
+    return failed == 0 ? 0 : 1;
+}
+
+int run_benchmarks(const std::string& filter, double min_time_s) {
+    std::printf("%-32s %14s %12s %12s\n", "benchmark", "iterations", "ns/iter", "allocs/iter");
+    for (const BenchmarkCase& bench : benchmark_registry()) {
+        if (!filter.empty() && std::string(bench.name).find(filter) == std::string::npos) {
+            continue;
+        }
+
+        // Unmeasured first run, so buffers reach their steady-state size
+        { State warmup(1); bench.fn(warmup); }
+
+        uint64_t iterations = 1;
+        for (;;) {
+            State state(iterations);
+            focus_wizard::bench::start_counting_allocations();
+            auto start = Clock::now();
+            bench.fn(state);
+            double elapsed_s = std::chrono::duration<double>(Clock::now() - start).count();
+            uint64_t allocations = focus_wizard::bench::stop_counting_allocations();
+
+            if (elapsed_s >= min_time_s || iterations >= (1ull << 40)) {
+                double ns = elapsed_s * 1e9 / static_cast<double>(iterations);
+                double allocs = static_cast<double>(allocations) / iterations;
+                std::printf("%-32s %14llu %12.1f %12.2f\n", bench.name,
+                            static_cast<unsigned long long>(iterations), ns, allocs);
+                break;
+            }
+            // Aim a little past the target so the next run usually settles it
+            double scale = elapsed_s > 0.0 ? 1.4 * min_time_s / elapsed_s : 10.0;
+            iterations = static_cast<uint64_t>(
+                static_cast<double>(iterations) * std::min(10.0, std::max(2.0, scale)));
+        }
+    }
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    absl::SetProgramUsageMessage(
+        "Unit and property tests (and microbenchmarks) for the bridge pipeline.");
+    absl::ParseCommandLine(argc, argv);
+
+    std::string filter = absl::GetFlag(FLAGS_filter);
+    if (absl::GetFlag(FLAGS_benchmarks)) {
+        return run_benchmarks(filter, std::max(0.001, absl::GetFlag(FLAGS_bench_min_time_s)));
+    }
+    return run_tests(filter);
+}
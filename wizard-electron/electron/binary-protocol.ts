@@ -0,0 +1,183 @@
+/**
+ * binary-protocol.ts — Decoder for the bridge's --output_format=binary stream
+ *
+ * Mirrors bridge/src/binary_protocol.hpp. Each record is an 8-byte header
+ * (uint32 length, uint8 type, uint8 version, uint16 track) followed by
+ * `length` payload bytes. edge/metrics/focus payloads are a packed
+ * SnapshotRecord (44 bytes, 68 with the latency fields); status/error/ready/
+ * state_changed/history/summary payloads are the NDJSON `data` object.
+ * SnapshotRecord only grows at the end, so fields are read when the record
+ * is long enough. A non-zero track becomes the message's `track`.
+ *
+ * Decoded messages have the same shape as the NDJSON protocol so the rest
+ * of BridgeManager doesn't care which format is on the wire.
+ */
+
+import type { BridgeMessage } from "./bridge-manager";
+
+const HEADER_SIZE = 8;
+const SNAPSHOT_SIZE = 44;
+const SNAPSHOT_TIMING_SIZE = 68;
+const PROTOCOL_VERSION = 1;
+
+const MESSAGE_TYPES: Record<number, BridgeMessage["type"]> = {
+  1: "status",
+  2: "ready",
+  3: "edge",
+  4: "metrics",
+  5: "focus",
+  6: "error",
+  8: "state_changed",
+  9: "history",
+  10: "summary",
+};
+
+/** FocusState enum order in focus_analyzer.hpp */
+const FOCUS_STATES = [
+  "focused",
+  "distracted",
+  "drowsy",
+  "stressed",
+  "away",
+  "talking",
+  "unknown",
+] as const;
+
+const FLAG_HAS_PULSE = 1 << 0;
+const FLAG_HAS_BREATHING = 1 << 1;
+const FLAG_FACE_DETECTED = 1 << 2;
+const FLAG_IS_BLINKING = 1 << 3;
+const FLAG_IS_TALKING = 1 << 4;
+const FLAG_HAS_GAZE = 1 << 5;
+
+/** Round to the precision the NDJSON protocol uses for the same field. */
+function round(value: number, digits: number): number {
+  const scale = 10 ** digits;
+  return Math.round(value * scale) / scale;
+}
+
+/** capture_us / callback_us / emit_us, if the bridge sent them */
+function decodeTiming(view: DataView): Record<string, number> {
+  if (view.byteLength < SNAPSHOT_TIMING_SIZE) return {};
+  return {
+    capture_us: Number(view.getBigInt64(44, true)),
+    callback_us: Number(view.getBigInt64(52, true)),
+    emit_us: Number(view.getBigInt64(60, true)),
+  };
+}
+
+function decodeSnapshot(
+  type: BridgeMessage["type"],
+  view: DataView,
+): Record<string, unknown> {
+  const flags = view.getUint16(40, true);
+  const timestampUs = Number(view.getBigInt64(0, true));
+  const pulse = view.getFloat32(8, true);
+  const pulseConfidence = view.getFloat32(12, true);
+  const breathing = view.getFloat32(16, true);
+  const blinkRate = view.getFloat32(24, true);
+  const gazeX = view.getFloat32(28, true);
+  const gazeY = view.getFloat32(32, true);
+
+  switch (type) {
+    case "metrics":
+      return {
+        timestamp_us: timestampUs,
+        pulse_rate_bpm: round(pulse, 2),
+        has_pulse: (flags & FLAG_HAS_PULSE) !== 0,
+        pulse_confidence: round(pulseConfidence, 2),
+        breathing_rate_bpm: round(breathing, 2),
+        has_breathing: (flags & FLAG_HAS_BREATHING) !== 0,
+        ...decodeTiming(view),
+      };
+    case "edge":
+      return {
+        face_detected: (flags & FLAG_FACE_DETECTED) !== 0,
+        is_blinking: (flags & FLAG_IS_BLINKING) !== 0,
+        blink_rate_per_min: round(blinkRate, 4),
+        is_talking: (flags & FLAG_IS_TALKING) !== 0,
+        gaze_x: round(gazeX, 4),
+        gaze_y: round(gazeY, 4),
+        has_gaze: (flags & FLAG_HAS_GAZE) !== 0,
+        ...decodeTiming(view),
+      };
+    default:
+      return {
+        state: FOCUS_STATES[view.getUint8(42)] ?? "unknown",
+        focus_score: round(view.getFloat32(36, true), 3),
+        face_detected: (flags & FLAG_FACE_DETECTED) !== 0,
+        is_talking: (flags & FLAG_IS_TALKING) !== 0,
+        is_blinking: (flags & FLAG_IS_BLINKING) !== 0,
+        blink_rate_per_min: round(blinkRate, 3),
+        gaze_x: round(gazeX, 3),
+        gaze_y: round(gazeY, 3),
+        has_gaze: (flags & FLAG_HAS_GAZE) !== 0,
+        pulse_bpm: round(pulse, 3),
+        breathing_bpm: round(breathing, 3),
+        ...decodeTiming(view),
+      };
+  }
+}
+
+/**
+ * Incremental decoder: feed it stdout chunks, get complete messages back.
+ */
+export class BinaryRecordDecoder {
+  private pending: Buffer = Buffer.alloc(0);
+
+  /** Append a chunk and return every record completed by it. */
+  push(chunk: Buffer): BridgeMessage[] {
+    this.pending = this.pending.length === 0
+      ? chunk
+      : Buffer.concat([this.pending, chunk]);
+
+    const messages: BridgeMessage[] = [];
+    let offset = 0;
+
+    while (this.pending.length - offset >= HEADER_SIZE) {
+      const length = this.pending.readUInt32LE(offset);
+      if (this.pending.length - offset < HEADER_SIZE + length) break;
+
+      const typeTag = this.pending.readUInt8(offset + 4);
+      const version = this.pending.readUInt8(offset + 5);
+      const track = this.pending.readUInt16LE(offset + 6);
+      const payloadStart = offset + HEADER_SIZE;
+      offset = payloadStart + length;
+
+      const type = MESSAGE_TYPES[typeTag];
+      if (!type || version !== PROTOCOL_VERSION) {
+        console.warn(
+          `[BinaryRecordDecoder] Skipping record type=${typeTag} version=${version}`,
+        );
+        continue;
+      }
+
+      const payload = this.pending.subarray(payloadStart, offset);
+      if (type === "edge" || type === "metrics" || type === "focus") {
+        if (length < SNAPSHOT_SIZE) continue;
+        const view = new DataView(
+          payload.buffer,
+          payload.byteOffset,
+          payload.byteLength,
+        );
+        const data = decodeSnapshot(type, view);
+        messages.push(track ? { type, track, data } : { type, data });
+      } else {
+        try {
+          const data = JSON.parse(payload.toString("utf8"));
+          messages.push(track ? { type, track, data } : { type, data });
+        } catch {
+          console.warn(`[BinaryRecordDecoder] Bad ${type} payload`);
+        }
+      }
+    }
+
+    this.pending = this.pending.subarray(offset);
+    return messages;
+  }
+
+  /** Drop any partially received record. */
+  reset(): void {
+    this.pending = Buffer.alloc(0);
+  }
+}
@@ -5,11 +5,14 @@
  *   DOCKER (default): Runs the bridge in an Ubuntu 22.04 Docker container.
  *     Webcam frames are written to a shared directory by the Electron main
  *     process; SmartSpectra's FileStreamVideoSource reads them inside Docker.
+ *     With `frameTransport: "shm"` (Linux hosts) frames go through a
+ *     shared-memory ring instead (bridge --mode=shm).
  *
  *   LOCAL: Runs a native binary directly (for Ubuntu desktops or when
  *     the SDK is installed natively on macOS via partner package).
  *
- * Both modes emit JSON Lines on stdout that we parse here.
+ * Both modes emit JSON Lines on stdout that we parse here, or
+ * length-prefixed binary records when `outputFormat: "binary"` is set.
  */
 
 import { ChildProcess, execSync, spawn } from "child_process";
@@ -17,14 +20,26 @@ import { EventEmitter } from "events";
 import * as path from "path";
 import * as fs from "fs";
 import { fileURLToPath } from "url";
-import { FrameWriter } from "./frame-writer";
+import { FrameTransport, FrameWriter } from "./frame-writer";
+import { BinaryRecordDecoder } from "./binary-protocol";
 
 const __filename = fileURLToPath(import.meta.url);
 const __dirname = path.dirname(__filename);
 
 /** Message types emitted by the C++ bridge */
 export interface BridgeMessage {
-  type: "status" | "ready" | "edge" | "metrics" | "focus" | "error";
+  type:
+    | "status"
+    | "ready"
+    | "edge"
+    | "metrics"
+    | "focus"
+    | "state_changed"
+    | "history"
+    | "summary"
+    | "error";
+  /** Camera track (1 = first of cameraIndices); absent with one camera */
+  track?: number;
   data: Record<string, unknown>;
 }
 
@@ -47,6 +62,82 @@ export interface FocusData {
   has_gaze: boolean;
   pulse_bpm: number;
   breathing_bpm: number;
+  // Only with the bridge's --frame_features
+  /** Mean frame luma, 0..1 */
+  brightness?: number;
+  /** Mean luma change between samples, 0..1 */
+  motion?: number;
+  /** Laplacian variance of the face (low = blurred) */
+  sharpness?: number;
+  /** Mean face luma, 0..1 */
+  roi_exposure?: number;
+  /** The frame was too poor to read; the state was held */
+  low_quality_frame?: boolean;
+  /** SDK timestamp of the frame behind this result (µs) */
+  capture_us?: number;
+  /** Wall clock (µs since epoch) when the edge callback started on it */
+  callback_us?: number;
+  /** Wall clock (µs since epoch) when the message was built */
+  emit_us?: number;
+}
+
+/** A committed focus state change (`state_changed` message) */
+export interface FocusTransitionData {
+  from: FocusData["state"];
+  to: FocusData["state"];
+  focus_score: number;
+  /** How long the previous state lasted */
+  previous_duration_s: number;
+}
+
+/** Aggregates over a time range of the bridge's focus history */
+export interface HistorySummary {
+  id?: string;
+  /** Bucket size the aggregates were taken from */
+  tier: "1s" | "1m" | "1h";
+  from_ms: number;
+  to_ms: number;
+  buckets: number;
+  samples: number;
+  first_ms?: number;
+  last_ms?: number;
+  /** Seconds with frames in them */
+  covered_s: number;
+  focus_score: number;
+  blink_rate_per_min: number;
+  has_pulse: boolean;
+  pulse_bpm?: number;
+  has_breathing: boolean;
+  breathing_bpm?: number;
+  has_gaze: boolean;
+  gaze_x?: number;
+  gaze_y?: number;
+  /** Seconds spent in each focus state */
+  state_s: Record<FocusData["state"], number>;
+}
+
+/** One --emit=summary window of focus aggregates */
+export interface FocusSummaryData {
+  /** Window bounds, in frame timestamps (µs) */
+  start_us: number;
+  end_us: number;
+  frames: number;
+  /** Seconds with frames in them */
+  covered_s: number;
+  focus_score: {
+    mean: number;
+    min: number;
+    max: number;
+    p10: number;
+    p50: number;
+    p90: number;
+  };
+  /** Seconds spent in each focus state (states never entered are left out) */
+  state_s: Partial<Record<FocusData["state"], number>>;
+  dominant_state: FocusData["state"];
+  blinks: number;
+  blinks_per_min: number;
+  transitions: number;
 }
 
 export interface BridgeManagerOptions {
@@ -55,41 +146,105 @@ export interface BridgeManagerOptions {
   /** 'docker' (default) or 'local' (native binary on Ubuntu/macOS) */
   mode?: "docker" | "local";
 
+  /**
+   * Wire format on the bridge's stdout: 'ndjson' (default) or 'binary'
+   * (fixed-layout records, no per-message JSON.parse).
+   */
+  outputFormat?: "ndjson" | "binary";
+
+  /**
+   * 'rest' (default) or 'edge_only': on-device edge metrics only — no
+   * uploads and no API key needed, but no pulse and a coarser breathing rate.
+   */
+  integration?: "rest" | "edge_only";
+
+  /**
+   * Keep the bridge resident between sessions (--daemon): stopSession()
+   * pauses it and the next start() resumes it over stdin, skipping process
+   * start, SDK setup and camera open. stop() still tears it down.
+   */
+  daemon?: boolean;
+
   // ── Docker mode options ──────────────────────────────
   /** Docker image name (default: 'focus-wizard-bridge') */
   dockerImage?: string;
   /** Host directory for frame exchange (default: /tmp/focus-wizard-frames) */
   frameDir?: string;
+  /**
+   * How frames reach the container: 'files' (default, works everywhere) or
+   * 'shm' (shared-memory ring; Linux hosts only, falls back to 'files').
+   */
+  frameTransport?: FrameTransport;
 
   // ── Local mode options ───────────────────────────────
   /** Path to the native focus_bridge binary */
   bridgePath?: string;
   /** Camera device index (default: 0) */
   cameraIndex?: number;
+  /**
+   * Several cameras in one bridge (overrides cameraIndex). Per-frame events
+   * then carry the camera's track (1 = the first index) as a second argument.
+   */
+  cameraIndices?: number[];
   /** Capture width in px */
   captureWidth?: number;
   /** Capture height in px */
   captureHeight?: number;
 
   // ── Analysis thresholds (both modes) ─────────────────
+  // Changeable while running with setThresholds()
   gazeThreshold?: number;
   blinkThreshold?: number;
   pulseThreshold?: number;
   breathingThreshold?: number;
+  /** Seconds without a face before the state becomes away */
+  faceAbsenceTimeoutS?: number;
+
+  // ── Focus history (both modes) ───────────────────────
+  /** Keep a focus history in the bridge for queryHistory() */
+  history?: boolean;
+  /** File the history is kept in across restarts, as the bridge sees it */
+  historyPath?: string;
+
+  // ── Emit level (both modes) ──────────────────────────
+  /**
+   * 'full' (default), 'focus' (no edge/metrics events) or 'summary' (only
+   * a "summary" event every summaryWindowS seconds)
+   */
+  emit?: "full" | "focus" | "summary";
+  summaryWindowS?: number;
 }
 
+/** The analysis thresholds setThresholds() can change. */
+export type BridgeThresholds = Pick<
+  BridgeManagerOptions,
+  | "gazeThreshold"
+  | "blinkThreshold"
+  | "pulseThreshold"
+  | "breathingThreshold"
+  | "faceAbsenceTimeoutS"
+>;
+
 export class BridgeManager extends EventEmitter {
   private process: ChildProcess | null = null;
   private lineBuffer = "";
+  private readonly binaryDecoder = new BinaryRecordDecoder();
   private isReady = false;
   private _frameWriter: FrameWriter | null = null;
   private readonly dockerImage: string;
   private readonly mode: "docker" | "local";
+  private readonly outputFormat: "ndjson" | "binary";
+  private historyQueries = 0;
+  private readonly pendingHistory = new Map<
+    string,
+    { resolve: (summary: HistorySummary) => void; reject: (err: Error) => void }
+  >();
 
   constructor(private options: BridgeManagerOptions) {
     super();
     this.dockerImage = options.dockerImage || "focus-wizard-bridge";
     this.mode = options.mode || "docker";
+    this.outputFormat = options.outputFormat || "ndjson";
   }
 
   /** The FrameWriter instance (Docker mode only). */
@@ -225,9 +380,14 @@ export class BridgeManager extends EventEmitter {
   // ── Start ────────────────────────────────────────────
 
   /**
-   * Start the bridge (Docker or local depending on mode).
+   * Start the bridge (Docker or local depending on mode). A resident
+   * daemon bridge is resumed instead.
    */
   async start(): Promise<void> {
+    if (this.process && this.options.daemon) {
+      this.sendCommand({ cmd: "start" });
+      return;
+    }
     if (this.process) {
       throw new Error("Bridge is already running");
     }
@@ -259,14 +419,39 @@ export class BridgeManager extends EventEmitter {
       });
     } catch { /* no leftover container — fine */ }
 
-    // Set up the shared frame directory
-    this._frameWriter = new FrameWriter(this.options.frameDir);
+    // Set up the shared frame directory (or ring)
+    let transport = this.options.frameTransport || "files";
+    if (transport === "shm" && process.platform !== "linux") {
+      // Docker Desktop runs containers in a VM; /dev/shm isn't shared with it
+      console.warn(
+        "[BridgeManager] frameTransport 'shm' needs a Linux host; using 'files'",
+      );
+      transport = "files";
+    }
+    this._frameWriter = new FrameWriter(this.options.frameDir, transport);
     this._frameWriter.init();
 
+    const frameArgs = transport === "shm"
+      ? [
+        "--mode=shm",
+        `--shm_path=${this._frameWriter.containerShmDir}/${this._frameWriter.ringFileName}`,
+      ]
+      : [
+        "--mode=server",
+        `--file_stream_path=${this._frameWriter.containerFileStreamPath}`,
+        "--erase_read_files=true",
+        "--rescan_delay_ms=5",
+      ];
+    const mountTarget = transport === "shm"
+      ? this._frameWriter.containerShmDir
+      : "/frames";
+
     // Assemble docker run arguments
     const args = [
       "run",
       "--rm",
+      // Keep stdin open for control commands
+      "-i",
       "--platform",
       "linux/amd64",
       "--name",
@@ -277,14 +462,11 @@ export class BridgeManager extends EventEmitter {
       "--dns",
       "8.8.4.4",
       "-v",
-      `${this._frameWriter.directory}:/frames`,
+      `${this._frameWriter.directory}:${mountTarget}`,
       "-e",
       `SMARTSPECTRA_API_KEY=${this.options.apiKey}`,
       this.dockerImage,
-      "--mode=server",
-      `--file_stream_path=${this._frameWriter.containerFileStreamPath}`,
-      "--erase_read_files=true",
-      "--rescan_delay_ms=5",
+      ...frameArgs,
     ];
 
     this.addThresholdArgs(args);
@@ -293,7 +475,7 @@ export class BridgeManager extends EventEmitter {
     this.emit("status", "Starting SmartSpectra container...");
 
     this.process = spawn("docker", args, {
-      stdio: ["ignore", "pipe", "pipe"],
+      stdio: ["pipe", "pipe", "pipe"],
     });
 
     this.attachProcessHandlers();
@@ -306,7 +488,9 @@ export class BridgeManager extends EventEmitter {
       `--api_key=${this.options.apiKey}`,
     ];
 
-    if (this.options.cameraIndex !== undefined) {
+    if (this.options.cameraIndices?.length) {
+      args.push(`--camera_device_indices=${this.options.cameraIndices.join(",")}`);
+    } else if (this.options.cameraIndex !== undefined) {
       args.push(`--camera_device_index=${this.options.cameraIndex}`);
     }
     if (this.options.captureWidth !== undefined) {
@@ -323,15 +507,36 @@ export class BridgeManager extends EventEmitter {
     );
 
     this.process = spawn(bridgePath, args, {
-      stdio: ["ignore", "pipe", "pipe"],
+      stdio: ["pipe", "pipe", "pipe"],
       env: { ...process.env },
     });
 
     this.attachProcessHandlers();
   }
 
-  /** Append analysis threshold flags to an argument array. */
+  /** Append analysis threshold, output format and integration flags to an argument array. */
   private addThresholdArgs(args: string[]): void {
+    if (this.outputFormat === "binary") {
+      args.push("--output_format=binary");
+    }
+    if (this.options.integration === "edge_only") {
+      args.push("--integration=edge_only");
+    }
+    if (this.options.daemon) {
+      args.push("--daemon");
+    }
+    if (this.options.emit && this.options.emit !== "full") {
+      args.push(`--emit=${this.options.emit}`);
+      if (this.options.summaryWindowS !== undefined) {
+        args.push(`--summary_window_s=${this.options.summaryWindowS}`);
+      }
+    }
+    if (this.options.history) {
+      args.push("--history");
+      if (this.options.historyPath) {
+        args.push(`--history_path=${this.options.historyPath}`);
+      }
+    }
     if (this.options.gazeThreshold !== undefined) {
       args.push(`--gaze_threshold=${this.options.gazeThreshold}`);
     }
@@ -344,12 +549,23 @@ export class BridgeManager extends EventEmitter {
     if (this.options.breathingThreshold !== undefined) {
       args.push(`--breathing_threshold=${this.options.breathingThreshold}`);
     }
+    if (this.options.faceAbsenceTimeoutS !== undefined) {
+      args.push(`--face_absence_timeout_s=${this.options.faceAbsenceTimeoutS}`);
+    }
   }
 
   /** Wire up stdout/stderr/close/error handlers on the spawned process. */
   private attachProcessHandlers(): void {
-    // Read JSON Lines from stdout
+    // Read JSON Lines (or binary records) from stdout
+    this.lineBuffer = "";
+    this.binaryDecoder.reset();
     this.process!.stdout?.on("data", (chunk: Buffer) => {
+      if (this.outputFormat === "binary") {
+        for (const message of this.binaryDecoder.push(chunk)) {
+          this.handleMessage(message);
+        }
+        return;
+      }
       this.lineBuffer += chunk.toString();
       this.processLines();
     });
@@ -366,6 +582,10 @@ export class BridgeManager extends EventEmitter {
       console.log(`[BridgeManager] Process exited with code ${code}`);
       this.process = null;
       this.isReady = false;
+      for (const pending of this.pendingHistory.values()) {
+        pending.reject(new Error("Bridge exited"));
+      }
+      this.pendingHistory.clear();
       this.emit("close", code);
     });
 
@@ -407,15 +627,44 @@ export class BridgeManager extends EventEmitter {
         break;
 
       case "focus":
-        this.emit("focus", message.data as unknown as FocusData);
+        this.emit("focus", message.data as unknown as FocusData, message.track);
+        break;
+
+      case "state_changed":
+        this.emit(
+          "state-changed",
+          message.data as unknown as FocusTransitionData,
+          message.track,
+        );
+        break;
+
+      case "history": {
+        const summary = message.data as unknown as HistorySummary;
+        const pending = summary.id
+          ? this.pendingHistory.get(summary.id)
+          : undefined;
+        if (pending) {
+          this.pendingHistory.delete(summary.id!);
+          pending.resolve(summary);
+        }
+        this.emit("history", summary);
+        break;
+      }
+
+      case "summary":
+        this.emit(
+          "summary",
+          message.data as unknown as FocusSummaryData,
+          message.track,
+        );
         break;
 
       case "metrics":
-        this.emit("metrics", message.data);
+        this.emit("metrics", message.data, message.track);
         break;
 
       case "edge":
-        this.emit("edge", message.data);
+        this.emit("edge", message.data, message.track);
         break;
 
       case "status":
@@ -434,10 +683,108 @@ export class BridgeManager extends EventEmitter {
     }
   }
 
+  // ── Control Commands ─────────────────────────────────
+
+  /** Write one JSON command line to the bridge's stdin. */
+  private sendCommand(command: Record<string, unknown>): boolean {
+    const stdin = this.process?.stdin;
+    if (!stdin || stdin.destroyed) return false;
+    stdin.write(`${JSON.stringify(command)}\n`);
+    return true;
+  }
+
+  /**
+   * End the current session. A daemon bridge stays resident (camera open
+   * in local mode) until the next start(); otherwise this is stop().
+   */
+  stopSession(): void {
+    if (!this.options.daemon || !this.sendCommand({ cmd: "stop" })) {
+      this.stop();
+      return;
+    }
+    this.isReady = false;
+  }
+
+  /**
+   * Change the camera or capture size of a resident bridge. It rebuilds
+   * its pipeline in-process; without a daemon the change applies from the
+   * next start().
+   */
+  configure(
+    settings: Pick<
+      BridgeManagerOptions,
+      "cameraIndex" | "captureWidth" | "captureHeight"
+    >,
+  ): void {
+    Object.assign(this.options, settings);
+    if (!this.options.daemon) return;
+    this.sendCommand({
+      cmd: "configure",
+      camera_device_index: settings.cameraIndex,
+      capture_width: settings.captureWidth,
+      capture_height: settings.captureHeight,
+    });
+  }
+
+  /**
+   * Change analysis thresholds. A running bridge applies them from its next
+   * frame, without a restart; omitted thresholds keep their value.
+   */
+  setThresholds(thresholds: BridgeThresholds): void {
+    Object.assign(this.options, thresholds);
+    this.sendCommand({
+      cmd: "set_thresholds",
+      gaze_threshold: thresholds.gazeThreshold,
+      blink_threshold: thresholds.blinkThreshold,
+      pulse_threshold: thresholds.pulseThreshold,
+      breathing_threshold: thresholds.breathingThreshold,
+      face_absence_timeout_s: thresholds.faceAbsenceTimeoutS,
+    });
+  }
+
+  /**
+   * Aggregate the bridge's focus history over [fromMs, toMs) (epoch ms;
+   * default: everything until now). Needs the `history` option.
+   */
+  queryHistory(
+    range: { fromMs?: number; toMs?: number; tier?: "1s" | "1m" | "1h" } = {},
+  ): Promise<HistorySummary> {
+    const id = `history-${++this.historyQueries}`;
+    return new Promise((resolve, reject) => {
+      const sent = this.sendCommand({
+        cmd: "query_history",
+        id,
+        from_ms: range.fromMs,
+        to_ms: range.toMs,
+        tier: range.tier,
+      });
+      if (!sent) {
+        reject(new Error("Bridge is not running"));
+        return;
+      }
+      this.pendingHistory.set(id, { resolve, reject });
+      setTimeout(() => {
+        if (this.pendingHistory.delete(id)) {
+          reject(new Error("History query timed out"));
+        }
+      }, 5000);
+    });
+  }
+
+  /** Whether a daemon bridge process is alive (running or paused). */
+  get resident(): boolean {
+    return this.process !== null && Boolean(this.options.daemon);
+  }
+
   /**
    * Gracefully stop the bridge.
    */
   stop(): void {
+    // The bridge exits on shutdown; the signals below are the fallback
+    if (this.sendCommand({ cmd: "shutdown" })) {
+      this.process?.stdin?.end();
+    }
+
     // Signal the C++ bridge to stop via end_of_stream marker
     if (this._frameWriter) {
       this._frameWriter.writeEndOfStream();
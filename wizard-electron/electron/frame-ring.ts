@@ -0,0 +1,167 @@
+/**
+ * frame-ring.ts — Producer side of the bridge's shared-memory frame ring
+ *
+ * Writes webcam frames into a fixed ring of slots in a file under
+ * /dev/shm, which `focus_bridge --mode=shm` maps and reads in place. See
+ * bridge/src/frame_ring.hpp for the layout and the publish protocol; the
+ * two must stay in sync.
+ *
+ * Node has no shm_open/mmap, so slots are filled with positioned writes
+ * into the tmpfs file — still no directory entry, scan or unlink per
+ * frame. After each frame one byte is written to a FIFO doorbell so the
+ * bridge can sleep instead of polling.
+ */
+
+import { execFileSync } from "child_process";
+import * as fs from "fs";
+
+const MAGIC = Buffer.from("FWFR", "ascii");
+const VERSION = 1;
+const RING_HEADER_BYTES = 64;
+const SLOT_HEADER_BYTES = 64;
+const WRITE_SEQUENCE_OFFSET = 16;
+
+/** Payload encodings understood by the bridge (FramePixelFormat). */
+export enum FramePixelFormat {
+  JPEG = 1,
+  RGBA = 2,
+  BGR = 3,
+}
+
+export interface FrameRingOptions {
+  /** Number of slots (default 4). */
+  slotCount?: number;
+  /** Payload capacity per slot in bytes (default: one 720p RGBA frame). */
+  slotBytes?: number;
+}
+
+export class FrameRingWriter {
+  private fd: number | null = null;
+  private doorbellFd: number | null = null;
+  private sequence = 0n;
+  private readonly slotCount: number;
+  private readonly slotBytes: number;
+  private readonly slotHeader = Buffer.alloc(SLOT_HEADER_BYTES);
+  private readonly sequenceBuffer = Buffer.alloc(8);
+  private readonly bell = Buffer.from([1]);
+
+  constructor(
+    readonly ringPath: string,
+    readonly doorbellPath: string,
+    options: FrameRingOptions = {},
+  ) {
+    this.slotCount = options.slotCount ?? 4;
+    // Keep slots 64-byte aligned so the 8-byte sequence words stay aligned
+    const requested = options.slotBytes ?? 1280 * 720 * 4;
+    this.slotBytes = Math.ceil(requested / 64) * 64;
+  }
+
+  /** Frames published so far. */
+  get count(): number {
+    return Number(this.sequence);
+  }
+
+  /**
+   * Create (or reset) the ring file and the doorbell FIFO.
+   */
+  create(): void {
+    const size = RING_HEADER_BYTES +
+      this.slotCount * (SLOT_HEADER_BYTES + this.slotBytes);
+
+    this.fd = fs.openSync(this.ringPath, "w+", 0o644);
+    fs.ftruncateSync(this.fd, size);
+
+    const header = Buffer.alloc(RING_HEADER_BYTES);
+    MAGIC.copy(header, 0);
+    header.writeUInt32LE(VERSION, 4);
+    header.writeUInt32LE(this.slotCount, 8);
+    header.writeUInt32LE(this.slotBytes, 12);
+    header.writeBigUInt64LE(0n, WRITE_SEQUENCE_OFFSET);
+    fs.writeSync(this.fd, header, 0, header.length, 0);
+    this.sequence = 0n;
+
+    // Created here rather than by the bridge so it is owned by this user
+    // even when the bridge runs as root inside Docker.
+    if (!fs.existsSync(this.doorbellPath)) {
+      try {
+        execFileSync("mkfifo", ["-m", "0600", this.doorbellPath]);
+      } catch (err) {
+        console.warn(`[FrameRing] mkfifo failed, bridge will create it: ${err}`);
+      }
+    }
+  }
+
+  /**
+   * Publish one frame. Drops (returns false) frames larger than a slot.
+   */
+  writeFrame(
+    timestampUs: number,
+    format: FramePixelFormat,
+    width: number,
+    height: number,
+    stride: number,
+    data: Uint8Array,
+  ): boolean {
+    if (this.fd === null || data.length > this.slotBytes) return false;
+
+    const n = this.sequence + 1n;
+    const slot = Number((n - 1n) % BigInt(this.slotCount));
+    const offset = RING_HEADER_BYTES +
+      slot * (SLOT_HEADER_BYTES + this.slotBytes);
+
+    // 1. Invalidate the slot
+    this.sequenceBuffer.writeBigUInt64LE(0n, 0);
+    fs.writeSync(this.fd, this.sequenceBuffer, 0, 8, offset);
+
+    // 2. Payload, then the rest of the slot header
+    fs.writeSync(this.fd, data, 0, data.length, offset + SLOT_HEADER_BYTES);
+    const h = this.slotHeader;
+    h.writeBigInt64LE(BigInt(Math.floor(timestampUs)), 8);
+    h.writeUInt32LE(width, 16);
+    h.writeUInt32LE(height, 20);
+    h.writeUInt32LE(stride, 24);
+    h.writeUInt32LE(format, 28);
+    h.writeUInt32LE(data.length, 32);
+    fs.writeSync(this.fd, h, 8, SLOT_HEADER_BYTES - 8, offset + 8);
+
+    // 3. Publish the slot, 4. then the ring
+    this.sequenceBuffer.writeBigUInt64LE(n, 0);
+    fs.writeSync(this.fd, this.sequenceBuffer, 0, 8, offset);
+    fs.writeSync(this.fd, this.sequenceBuffer, 0, 8, WRITE_SEQUENCE_OFFSET);
+    this.sequence = n;
+
+    this.ringDoorbell();
+    return true;
+  }
+
+  /** Close the ring and doorbell (files are left for the caller to remove). */
+  close(): void {
+    if (this.doorbellFd !== null) {
+      fs.closeSync(this.doorbellFd);
+      this.doorbellFd = null;
+    }
+    if (this.fd !== null) {
+      fs.closeSync(this.fd);
+      this.fd = null;
+    }
+  }
+
+  private ringDoorbell(): void {
+    if (this.doorbellFd === null) {
+      try {
+        // Non-blocking: fails with ENXIO until the bridge has opened its end
+        this.doorbellFd = fs.openSync(
+          this.doorbellPath,
+          fs.constants.O_WRONLY | fs.constants.O_NONBLOCK,
+        );
+      } catch {
+        return; // bridge not up yet — it polls write_sequence anyway
+      }
+    }
+    try {
+      fs.writeSync(this.doorbellFd, this.bell, 0, 1);
+    } catch {
+      // EAGAIN: FIFO full, the bridge already has a wakeup pending
+    }
+  }
+}
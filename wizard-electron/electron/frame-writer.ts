@@ -3,27 +3,40 @@
  *
  * The Electron renderer captures webcam frames via getUserMedia,
  * sends them to the main process as JPEG buffers, and this module
- * writes them as numbered files that SmartSpectra's FileStreamVideoSource
- * picks up inside the Docker container.
+ * hands them to the bridge inside the Docker container.
  *
- * Naming convention:
- *   frame{timestamp_us_padded_to_16_digits}.jpg
- *   e.g. frame0001707312345678.jpg
+ * Two transports:
+ *   "files" (default): numbered files that SmartSpectra's
+ *     FileStreamVideoSource picks up.
+ *       frame{timestamp_us_padded_to_16_digits}.jpg
+ *       e.g. frame0001707312345678.jpg
+ *     The Docker container volume-mounts this directory at /frames.
  *
- * The Docker container volume-mounts this directory at /frames.
+ *   "shm": a shared-memory frame ring under /dev/shm (see frame-ring.ts)
+ *     read by `focus_bridge --mode=shm`. The directory is mounted at /shm.
+ *     Linux hosts only — /dev/shm is not shared across the Docker Desktop VM.
  */
 
 import * as fs from "fs";
 import * as path from "path";
 import * as os from "os";
+import { FramePixelFormat, FrameRingWriter } from "./frame-ring";
+
+export type FrameTransport = "files" | "shm";
 
 export class FrameWriter {
   private readonly frameDir: string;
+  private readonly transport: FrameTransport;
+  private ring: FrameRingWriter | null = null;
   private frameCount = 0;
   private active = false;
 
-  constructor(frameDir?: string) {
-    this.frameDir = frameDir || path.join(os.tmpdir(), "focus-wizard-frames");
+  constructor(frameDir?: string, transport: FrameTransport = "files") {
+    this.transport = transport;
+    this.frameDir = frameDir ||
+      (transport === "shm"
+        ? path.join("/dev/shm", "focus-wizard")
+        : path.join(os.tmpdir(), "focus-wizard-frames"));
   }
 
   /** The host directory where frames are written. */
@@ -41,6 +54,20 @@ export class FrameWriter {
     return "/frames/frame0000000000000000.jpg";
   }
 
+  /** Where the container mounts the directory (shm transport). */
+  get containerShmDir(): string {
+    return "/shm";
+  }
+
+  /** Frame ring file name inside the directory (shm transport). */
+  get ringFileName(): string {
+    return "frames.ring";
+  }
+
+  get frameTransport(): FrameTransport {
+    return this.transport;
+  }
+
   /** Total frames written this session. */
   get count(): number {
     return this.frameCount;
@@ -60,6 +87,12 @@ export class FrameWriter {
     }
     this.clearFrames();
     this.frameCount = 0;
+
+    if (this.transport === "shm") {
+      const ringPath = path.join(this.frameDir, this.ringFileName);
+      this.ring = new FrameRingWriter(ringPath, `${ringPath}.bell`);
+      this.ring.create();
+    }
     this.active = true;
   }
 
@@ -71,6 +104,19 @@ export class FrameWriter {
   writeFrame(timestampUs: number, jpegData: Buffer): void {
     if (!this.active) return;
 
+    if (this.ring) {
+      const written = this.ring.writeFrame(
+        timestampUs,
+        FramePixelFormat.JPEG,
+        0,
+        0,
+        0,
+        jpegData,
+      );
+      if (written) this.frameCount++;
+      return;
+    }
+
     const padded = Math.floor(timestampUs).toString().padStart(16, "0");
     const filename = `frame${padded}.jpg`;
     const filepath = path.join(this.frameDir, filename);
@@ -84,11 +130,34 @@ export class FrameWriter {
     }
   }
 
+  /**
+   * Publish an unencoded RGBA frame (e.g. canvas ImageData). Shm transport
+   * only — skips the JPEG encode/decode round trip entirely.
+   */
+  writeRawFrame(
+    timestampUs: number,
+    width: number,
+    height: number,
+    rgba: Uint8Array,
+  ): void {
+    if (!this.active || !this.ring) return;
+    const written = this.ring.writeFrame(
+      timestampUs,
+      FramePixelFormat.RGBA,
+      width,
+      height,
+      width * 4,
+      rgba,
+    );
+    if (written) this.frameCount++;
+  }
+
   /**
    * Write the end_of_stream marker file.
    * SmartSpectra's FileStreamVideoSource stops when it sees this.
    */
   writeEndOfStream(): void {
+    if (this.transport === "shm") return; // the bridge stops on SIGTERM
     try {
       const filepath = path.join(this.frameDir, "end_of_stream");
       fs.writeFileSync(filepath, "");
@@ -116,6 +185,8 @@ export class FrameWriter {
    */
   cleanup(): void {
     this.active = false;
+    this.ring?.close();
+    this.ring = null;
     try {
       fs.rmSync(this.frameDir, { recursive: true, force: true });
     } catch {
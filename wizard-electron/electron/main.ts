@@ -12,7 +12,12 @@ import { fileURLToPath } from "node:url";
 import path from "node:path";
 import fs from "node:fs/promises";
 import crypto from "node:crypto";
-import { BridgeManager, FocusData } from "./bridge-manager";
+import {
+  BridgeManager,
+  BridgeThresholds,
+  FocusData,
+  FocusTransitionData,
+} from "./bridge-manager";
 
 const __dirname = path.dirname(fileURLToPath(import.meta.url));
 
@@ -595,6 +600,11 @@ ipcMain.handle("focus-wizard:hide-window", () => {
 
 async function startBridge(): Promise<void> {
   const apiKey = process.env.SMARTSPECTRA_API_KEY || "";
+  // FOCUS_BRIDGE_INTEGRATION=edge_only runs without REST (and without a key)
+  const integration =
+    process.env.FOCUS_BRIDGE_INTEGRATION === "edge_only" ? "edge_only" : "rest";
+  // The bridge stays resident between sessions unless FOCUS_BRIDGE_DAEMON=0
+  const daemon = process.env.FOCUS_BRIDGE_DAEMON !== "0";
 
   const broadcastToWindows = (channel: string, ...args: unknown[]) => {
     const targets = [win, settingsWin].filter(
@@ -614,7 +624,7 @@ async function startBridge(): Promise<void> {
     }
   };
 
-  if (!apiKey) {
+  if (!apiKey && integration === "rest") {
     console.warn("[Main] No SMARTSPECTRA_API_KEY set — bridge will not start.");
     console.warn(
       "[Main] Set it in your environment or pass it via the app settings.",
@@ -626,7 +636,7 @@ async function startBridge(): Promise<void> {
     return;
   }
 
-  bridge = new BridgeManager({ apiKey, mode: "docker" });
+  bridge = new BridgeManager({ apiKey, mode: "docker", integration, daemon });
 
   bridge.on("ready", () => {
     console.log("[Main] Bridge is ready!");
@@ -637,6 +647,10 @@ async function startBridge(): Promise<void> {
     broadcastToWindows("bridge:focus", data);
   });
 
+  bridge.on("state-changed", (data: FocusTransitionData) => {
+    broadcastToWindows("bridge:state-changed", data);
+  });
+
   bridge.on("metrics", (data: Record<string, unknown>) => {
     broadcastToWindows("bridge:metrics", data);
   });
@@ -677,15 +691,28 @@ ipcMain.handle("bridge:start", async (_event, apiKey?: string) => {
   if (bridge?.running) {
     return { success: true, message: "Bridge already running" };
   }
+  if (bridge?.resident) {
+    // Warm start: resume the paused bridge, its API key is kept
+    await bridge.start();
+    return { success: true, message: "Bridge resumed" };
+  }
   await startBridge();
   return { success: true };
 });
 
 ipcMain.handle("bridge:stop", async () => {
-  bridge?.stop();
+  bridge?.stopSession();
   return { success: true };
 });
 
+ipcMain.handle(
+  "bridge:set-thresholds",
+  async (_event, thresholds: BridgeThresholds) => {
+    bridge?.setThresholds(thresholds);
+    return { success: bridge !== null };
+  },
+);
+
 ipcMain.handle("bridge:status", async () => {
   return {
     running: bridge?.running ?? false,
@@ -717,6 +744,39 @@ ipcMain.on("frame:data", (_event, timestampUs: number, data: unknown) => {
   }
 });
 
+ipcMain.on(
+  "frame:raw",
+  (
+    _event,
+    timestampUs: number,
+    width: number,
+    height: number,
+    data: unknown,
+  ) => {
+    const frameWriter = bridge?.frameWriter;
+    if (!frameWriter) {
+      console.warn("[Main] Received frame but frame writer not initialized");
+      return;
+    }
+
+    const pixels = Buffer.isBuffer(data)
+      ? data
+      : Buffer.from(data as ArrayBuffer);
+    if (width * height * 4 !== pixels.length) {
+      console.error(
+        `[Main] Raw frame is ${pixels.length} bytes, not ${width}x${height} RGBA`,
+      );
+      return;
+    }
+    frameWriter.writeRawFrame(timestampUs, width, height, pixels);
+  },
+);
+
+// Renderers send raw pixels only to the shm ring; files need JPEG
+ipcMain.handle("frame:transport", () => {
+  return bridge?.frameWriter?.frameTransport ?? null;
+});
+
 ipcMain.handle("focus-wizard:quit-app", () => {
   app.quit();
 });
@@ -60,6 +60,8 @@ contextBridge.exposeInMainWorld("wizardAPI", {
   // Bridge API
   startBridge: (apiKey?: string) => ipcRenderer.invoke("bridge:start", apiKey),
   stopBridge: () => ipcRenderer.invoke("bridge:stop"),
+  setBridgeThresholds: (thresholds: Record<string, number>) =>
+    ipcRenderer.invoke("bridge:set-thresholds", thresholds),
   getBridgeStatus: () => ipcRenderer.invoke("bridge:status"),
   checkDocker: () => ipcRenderer.invoke("docker:check"),
 
@@ -67,9 +69,20 @@ contextBridge.exposeInMainWorld("wizardAPI", {
   sendFrame: (timestampUs: number, data: ArrayBuffer) => {
     ipcRenderer.send("frame:data", timestampUs, data);
   },
+  // Unencoded RGBA pixels (canvas ImageData); shm transport only
+  sendRawFrame: (
+    timestampUs: number,
+    width: number,
+    height: number,
+    data: ArrayBuffer,
+  ) => {
+    ipcRenderer.send("frame:raw", timestampUs, width, height, data);
+  },
+  getFrameTransport: () => ipcRenderer.invoke("frame:transport"),
 
   // Bridge event listeners
   onFocus: createListener("bridge:focus"),
+  onStateChanged: createListener("bridge:state-changed"),
   onMetrics: createListener("bridge:metrics"),
   onEdge: createListener("bridge:edge"),
   onStatus: createListener("bridge:status"),
@@ -3,7 +3,9 @@
  *
  * Manages getUserMedia, draws video frames to an offscreen canvas,
  * converts to JPEG, and sends them to the Electron main process
- * which writes them to the shared Docker volume.
+ * which writes them to the shared Docker volume. When the bridge reads
+ * the shared-memory ring, the canvas pixels go as raw RGBA instead and
+ * skip the JPEG encode and the bridge's decode.
  */
 
 import { useCallback, useEffect, useRef, useState } from "react";
@@ -60,6 +62,7 @@ export function useWebcam(options: UseWebcamOptions = {}): UseWebcamReturn {
   const streamRef = useRef<MediaStream | null>(null);
   const intervalRef = useRef<ReturnType<typeof setInterval> | null>(null);
   const capturingRef = useRef(false); // Guard against overlapping captures
+  const rawFramesRef = useRef(false); // shm transport: send RGBA, not JPEG
 
   const dutyTimerRef = useRef<ReturnType<typeof setTimeout> | null>(null);
   const dutyOnRef = useRef(true);
@@ -173,6 +176,22 @@ export function useWebcam(options: UseWebcamOptions = {}): UseWebcamReturn {
       return;
     }
 
+    if (rawFramesRef.current && window.wizardAPI?.sendRawFrame) {
+      try {
+        const image = ctx.getImageData(0, 0, canvas.width, canvas.height);
+        window.wizardAPI.sendRawFrame(
+          Date.now() * 1000,
+          image.width,
+          image.height,
+          image.data.buffer,
+        );
+      } catch (err) {
+        console.error("[useWebcam] Error sending raw frame:", err);
+      }
+      capturingRef.current = false;
+      return;
+    }
+
     canvas.toBlob(
       (blob) => {
         capturingRef.current = false;
@@ -238,10 +257,23 @@ export function useWebcam(options: UseWebcamOptions = {}): UseWebcamReturn {
         }
       }
 
+      // Raw pixels only reach the bridge through the shm ring
+      let transport: string | null = null;
+      try {
+        transport = (await window.wizardAPI?.getFrameTransport?.()) ?? null;
+      } catch {
+        // JPEG works on every transport
+      }
+      rawFramesRef.current = transport === "shm";
+
       // Create offscreen canvas for frame extraction
       const canvas = document.createElement("canvas");
       canvas.width = width;
       canvas.height = height;
+      if (rawFramesRef.current) {
+        // Every frame is read back; keep the canvas on the CPU
+        canvas.getContext("2d", { willReadFrequently: true });
+      }
       canvasRef.current = canvas;
 
       // Start the capture interval
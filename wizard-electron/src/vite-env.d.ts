@@ -17,12 +17,27 @@ interface Window {
 
     startBridge: (apiKey?: string) => Promise<unknown>;
     stopBridge: () => Promise<unknown>;
+    setBridgeThresholds: (thresholds: {
+      gazeThreshold?: number;
+      blinkThreshold?: number;
+      pulseThreshold?: number;
+      breathingThreshold?: number;
+      faceAbsenceTimeoutS?: number;
+    }) => Promise<{ success: boolean }>;
     getBridgeStatus: () => Promise<{ running: boolean; status?: string }>
     checkDocker: () => Promise<{ available: boolean }>;
 
     sendFrame: (timestampUs: number, data: ArrayBuffer) => void;
+    sendRawFrame: (
+      timestampUs: number,
+      width: number,
+      height: number,
+      data: ArrayBuffer,
+    ) => void;
+    getFrameTransport: () => Promise<"files" | "shm" | null>;
 
     onFocus: (callback: (data: unknown) => void) => () => void;
+    onStateChanged: (callback: (data: unknown) => void) => () => void;
     onMetrics: (callback: (data: unknown) => void) => () => void;
     onEdge: (callback: (data: unknown) => void) => () => void;
     onStatus: (callback: (status: string) => void) => () => void;